@@ -1,3 +1,6 @@
+# Repository root, so projects other than the firmware (e.g. the host tests) can include this file
+set(GP2040_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
 function (compile_proto)
 	find_package(Python3 REQUIRED COMPONENTS Interpreter)
 
@@ -10,42 +13,42 @@ function (compile_proto)
 	endif()
 
 	add_custom_command(
-		DEPENDS ${CMAKE_SOURCE_DIR}/lib/nanopb/extra/requirements.txt
+		DEPENDS ${GP2040_SOURCE_DIR}/lib/nanopb/extra/requirements.txt
 		COMMAND ${Python3_EXECUTABLE} -m venv ${VENV}
-		COMMAND ${VENV_BIN_DIR}/pip --disable-pip-version-check install -r ${CMAKE_SOURCE_DIR}/lib/nanopb/extra/requirements.txt
+		COMMAND ${VENV_BIN_DIR}/pip --disable-pip-version-check install -r ${GP2040_SOURCE_DIR}/lib/nanopb/extra/requirements.txt
 		COMMAND ${VENV_BIN_DIR}/pip freeze > ${VENV_FILE}
 		OUTPUT ${VENV_FILE}
 		COMMENT "Setting up Python Virtual Environment"
 	)
 
-	set(NANOPB_GENERATOR ${CMAKE_SOURCE_DIR}/lib/nanopb/generator/nanopb_generator.py)
+	set(NANOPB_GENERATOR ${GP2040_SOURCE_DIR}/lib/nanopb/generator/nanopb_generator.py)
 	set(PROTO_OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/proto)
 	set(PROTO_OUTPUT_DIR ${PROTO_OUTPUT_DIR} PARENT_SCOPE)
 
 	add_custom_command(
-		DEPENDS ${VENV_FILE} ${NANOPB_GENERATOR} ${CMAKE_SOURCE_DIR}/proto/enums.proto ${CMAKE_SOURCE_DIR}/lib/nanopb/generator/proto/nanopb.proto
-		WORKING_DIRECTORY ${CMAKE_SOURCE_DIR}
+		DEPENDS ${VENV_FILE} ${NANOPB_GENERATOR} ${GP2040_SOURCE_DIR}/proto/enums.proto ${GP2040_SOURCE_DIR}/lib/nanopb/generator/proto/nanopb.proto
+		WORKING_DIRECTORY ${GP2040_SOURCE_DIR}
 		COMMAND ${CMAKE_COMMAND} -E make_directory ${PROTO_OUTPUT_DIR}
 		COMMAND ${VENV_BIN_DIR}/python ${NANOPB_GENERATOR}
 			-q
 			-D ${PROTO_OUTPUT_DIR}
-			-I ${CMAKE_SOURCE_DIR}/proto
-			-I ${CMAKE_SOURCE_DIR}/lib/nanopb/generator/proto
-			${CMAKE_SOURCE_DIR}/proto/enums.proto
+			-I ${GP2040_SOURCE_DIR}/proto
+			-I ${GP2040_SOURCE_DIR}/lib/nanopb/generator/proto
+			${GP2040_SOURCE_DIR}/proto/enums.proto
 		OUTPUT ${PROTO_OUTPUT_DIR}/enums.pb.c ${PROTO_OUTPUT_DIR}/enums.pb.h
 		COMMENT "Compiling enums.proto"
 	)
 
 	add_custom_command(
-		DEPENDS ${VENV_FILE} ${NANOPB_GENERATOR} ${CMAKE_SOURCE_DIR}/proto/enums.proto ${CMAKE_SOURCE_DIR}/proto/config.proto ${CMAKE_SOURCE_DIR}/lib/nanopb/generator/proto/nanopb.proto
-		WORKING_DIRECTORY ${CMAKE_SOURCE_DIR}
+		DEPENDS ${VENV_FILE} ${NANOPB_GENERATOR} ${GP2040_SOURCE_DIR}/proto/enums.proto ${GP2040_SOURCE_DIR}/proto/config.proto ${GP2040_SOURCE_DIR}/lib/nanopb/generator/proto/nanopb.proto
+		WORKING_DIRECTORY ${GP2040_SOURCE_DIR}
 		COMMAND ${CMAKE_COMMAND} -E make_directory ${PROTO_OUTPUT_DIR}
 		COMMAND ${VENV_BIN_DIR}/python ${NANOPB_GENERATOR}
 			-q
 			-D ${PROTO_OUTPUT_DIR}
-			-I ${CMAKE_SOURCE_DIR}/proto
-			-I ${CMAKE_SOURCE_DIR}/lib/nanopb/generator/proto
-			${CMAKE_SOURCE_DIR}/proto/config.proto
+			-I ${GP2040_SOURCE_DIR}/proto
+			-I ${GP2040_SOURCE_DIR}/lib/nanopb/generator/proto
+			${GP2040_SOURCE_DIR}/proto/config.proto
 		OUTPUT ${PROTO_OUTPUT_DIR}/config.pb.c ${PROTO_OUTPUT_DIR}/config.pb.h
 		COMMENT "Compiling config.proto"
 	)
@@ -0,0 +1,72 @@
+#ifndef _ADDONPIPELINE_H_
+#define _ADDONPIPELINE_H_
+
+#include "gpaddon.h"
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+// True if T provides its own preprocess() rather than the empty GPAddon default
+template <typename T>
+constexpr bool addonHasPreprocess = !std::is_same<decltype(&T::preprocess), void (GPAddon::*)()>::value;
+
+// Statically dispatched addon chain for a fixed, build-time set of addons
+//
+// Every addon is created at setup and kept only if it is available, like the core1 tasks, so the
+// ones a board doesn't use cost a null pointer instead of their storage. The calls name the
+// addon's own preprocess()/process(), which skips the virtual dispatch and lets them be inlined.
+template <typename... Addons>
+class AddonPipeline {
+public:
+    AddonPipeline() : addons{} {}
+
+    void setup() { setupAll(std::index_sequence_for<Addons...>{}); }
+    void preprocess() { preprocessAll(std::index_sequence_for<Addons...>{}); }
+    void process() { processAll(std::index_sequence_for<Addons...>{}); }
+
+    // Returns nullptr if the addon isn't available
+    template <typename T>
+    T* get() { return std::get<T*>(addons); }
+private:
+    template <size_t... I>
+    void setupAll(std::index_sequence<I...>) { (setupOne<I>(), ...); }
+
+    template <size_t... I>
+    void preprocessAll(std::index_sequence<I...>) { (preprocessOne<I>(), ...); }
+
+    template <size_t... I>
+    void processAll(std::index_sequence<I...>) { (processOne<I>(), ...); }
+
+    template <size_t I>
+    void setupOne() {
+        using T = std::tuple_element_t<I, std::tuple<Addons...>>;
+        T* addon = new T();
+        if (addon->available()) {
+            addon->setup();
+            std::get<I>(addons) = addon;
+        } else {
+            delete addon;
+        }
+    }
+
+    template <size_t I>
+    void preprocessOne() {
+        using T = std::tuple_element_t<I, std::tuple<Addons...>>;
+        if constexpr (addonHasPreprocess<T>) {
+            if (T* addon = std::get<I>(addons))
+                addon->T::preprocess();
+        }
+    }
+
+    template <size_t I>
+    void processOne() {
+        using T = std::tuple_element_t<I, std::tuple<Addons...>>;
+        if (T* addon = std::get<I>(addons))
+            addon->T::process();
+    }
+
+    std::tuple<Addons*...> addons;
+};
+
+#endif
@@ -65,7 +65,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // Analog Setup
 	virtual void process();     // Analog Process
-	virtual void preprocess() {}
     virtual std::string name() { return AnalogName; }
 private:
 	uint16_t adc_1_x_center = 0;
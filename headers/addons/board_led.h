@@ -25,7 +25,7 @@ public:
 	virtual bool available();
 	virtual void setup();       // BoardLed Setup
 	virtual void process();     // BoardLed Process
-	virtual void preprocess() {}
+	virtual void handleEvent(const GamepadEvent& event);
 	virtual std::string name() { return OnBoardLedName; }
 private:
 	OnBoardLedMode onBoardLedMode;
@@ -1,9 +1,11 @@
 #ifndef BUZZER_H_
 #define BUZZER_H_
 
-#include <vector>
+#include <stddef.h>
+#include <stdint.h>
 #include <string>
 #include "gpaddon.h"
+#include "BuzzerSynth.h"
 
 #ifndef BUZZER_ENABLED
 #define BUZZER_ENABLED 0
@@ -17,10 +19,36 @@
 #define BUZZER_VOLUME 100
 #endif
 
+// Events that play a sound cue, bits of BuzzerOptions.cueMask
+#define BUZZER_CUE_SOCD_MODE  (1 << 0)
+#define BUZZER_CUE_DPAD_MODE  (1 << 1)
+#define BUZZER_CUE_PROFILE    (1 << 2)
+#define BUZZER_CUE_INPUT_MODE (1 << 3)
+#define BUZZER_CUE_TOGGLE     (1 << 4) // invert axis and 4-way mode hotkeys
+#define BUZZER_CUE_TURBO_RATE (1 << 5)
+#define BUZZER_CUE_FOCUS_MODE (1 << 6)
+
+#ifndef BUZZER_CUE_MASK
+#define BUZZER_CUE_MASK 0x7F
+#endif
+
+// PWM carrier wrap, the carrier runs at clk_sys / 256 which is far above the audible range
+#define BUZZER_PWM_WRAP 255
+
+// Synthesizer output, paced by a DMA timer
+#define BUZZER_SAMPLE_RATE 24000
+#define BUZZER_BUFFER_SAMPLES 256
+
+// Default envelope of song notes
+#define BUZZER_ATTACK_MS 5
+#define BUZZER_DECAY_MS 40
+#define BUZZER_SUSTAIN 180
+#define BUZZER_RELEASE_MS 30
+
 // Buzzer Speaker Module
 #define BuzzerSpeakerName "BuzzerSpeaker"
 
-enum Tone {
+enum Tone : uint16_t {
 	B0 = 31,
 	C1 = 33,
 	CS1 = 35,
@@ -112,13 +140,15 @@ enum Tone {
 	PAUSE = 0
 };
 
+// Songs are constant tables, so they stay in flash
 struct Song {
 	uint16_t toneDuration;
-	std::vector<Tone> song;
-	Song(uint16_t t, std::vector<Tone> s){
-		toneDuration = t;
-		song = s;
-	};
+	const Tone* tones;
+	uint8_t length;
+	template<size_t N>
+	constexpr Song(uint16_t t, const Tone (&s)[N]) : toneDuration(t), tones(s), length(N) {
+		static_assert(N <= UINT8_MAX, "Song is too long");
+	}
 };
 
 // Buzzer Speaker
@@ -127,21 +157,24 @@ class BuzzerSpeakerAddon : public GPAddon
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
+	virtual void handleEvent(const GamepadEvent& event);
 	virtual std::string name() { return BuzzerSpeakerName; }
 private:
 	void processBuzzer();
-	void play(Song *song);
+	void play(const Song *song, uint8_t repeat = 1);
+	void playCue(const GamepadEvent& event);
 	void playIntro();
 	void stop();
-	uint32_t pwmSetFreqDuty(uint slice, uint channel, uint32_t frequency, float duty);
+	void setupOutput();
+	void startOutput();
 	uint8_t buzzerPin;
 	uint8_t buzzerPinSlice;
-	uint8_t buzzerPinChannel;
 	uint8_t buzzerVolume;
-	uint32_t startedSongMils;
-	Song *currentSong;
+	uint32_t cueMask;
+	const Song *currentSong;
+	uint16_t currentTonePosition;
+	uint16_t currentSongLength;
 	bool introPlayed;
 };
 
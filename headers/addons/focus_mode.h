@@ -36,11 +36,11 @@ public:
 	virtual bool available();
 	virtual void setup();       // FocusMode Setup
 	virtual void process();     // FocusMode Process
-	virtual void preprocess() {}
 	virtual std::string name() { return FocusModeName; }
 private:
 	uint32_t buttonLockMask;
 	uint8_t focusModePin;
+	bool focusModeActive;
 };
 
 #endif  // _FocusMode_H_
\ No newline at end of file
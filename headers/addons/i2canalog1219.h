@@ -42,7 +42,6 @@ class I2CAnalog1219Input : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();       // Analog Setup
-	virtual void preprocess() {}
 	virtual void process();     // Analog Process
     virtual std::string name() { return I2CAnalog1219Name; }
 private:
@@ -62,6 +62,10 @@
 #define SPLASH_DURATION 7500 // Duration in milliseconds
 #endif
 
+#ifndef PIN_CONFLICT_DURATION
+#define PIN_CONFLICT_DURATION 5000 // Pin conflicts are shown before the splash, duration in milliseconds
+#endif
+
 #ifndef DEFAULT_SPLASH
 #define DEFAULT_SPLASH \
 	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, \
@@ -139,8 +143,8 @@ class I2CDisplayAddon : public GPAddon
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
+	virtual void handleEvent(const GamepadEvent& event);
 	virtual std::string name() { return I2CDisplayName; }
 private:
 	int initDisplay(int typeOverride);
@@ -150,6 +154,7 @@ private:
 	void drawWasdBox(int startX, int startY, int buttonRadius, int buttonPadding);
 	void drawArcadeStick(int startX, int startY, int buttonRadius, int buttonPadding);
 	void drawStatusBar(Gamepad*);
+	void drawPinConflicts(int startRow);
 	void drawText(int startX, int startY, std::string text);
 	void initMenu(char**);
 	//Adding my stuff here, remember to sort before PR
@@ -203,7 +208,8 @@ private:
 	enum DisplayMode {
 		CONFIG_INSTRUCTION,
 		BUTTONS,
-		SPLASH
+		SPLASH,
+		PIN_CONFLICT
 	};
 
 	DisplayMode getDisplayMode();
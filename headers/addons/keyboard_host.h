@@ -36,6 +36,7 @@ struct KeyboardButtonMapping
 	bool isAssigned() const { return key != 0xff; }
 };
 
+// USB host port on PIO-USB, keyboards go through the keyboard mapping and HID gamepads are passed through
 class KeyboardHostAddon : public GPAddon {
 public:
 	virtual bool available();
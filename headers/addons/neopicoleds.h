@@ -15,6 +15,7 @@
 #include "helper.h"
 #include "gamepad.h"
 #include "gpaddon.h"
+#include "addonservices.h"
 #include "storagemanager.h"
 
 // MPGS
@@ -163,13 +164,15 @@ public:
 #define NeoPicoLEDName "NeoPicoLED"
 
 // NeoPico LED Addon
-class NeoPicoLEDAddon : public GPAddon {
+class NeoPicoLEDAddon : public GPAddon, public PlayerLEDSink {
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
+	virtual void handleEvent(const GamepadEvent& event);
 	virtual std::string name() { return NeoPicoLEDName; }
+	virtual void setPlayerLEDs(const PLEDAnimationState& animationState);
+	virtual void releasePlayerLEDs();
 	void configureLEDs();
 	uint32_t frame[100];
 private:
@@ -180,13 +183,10 @@ private:
 	std::vector<std::vector<Pixel>> generatedLEDWasdFBM(std::vector<std::vector<uint8_t>> *positions);
 	std::vector<std::vector<Pixel>> createLEDLayout(ButtonLayout layout, uint8_t ledsPerPixel, uint8_t ledButtonCount);
 	uint8_t setupButtonPositions();
-	const uint32_t intervalMS = 10;
-	absolute_time_t nextRunTime;
 	uint8_t ledCount;
 	PixelMatrix matrix;
 	NeoPico *neopico;
-	InputMode inputMode; // HACK
-	PLEDAnimationState animationState; // NeoPico can control the player LEDs
+	bool playerLEDsActive = false; // NeoPico can control the player LEDs
 	NeoPicoPlayerLEDs * neoPLEDs = nullptr;
 	AnimationStation as;
 	std::map<std::string, int> buttonPositions;
@@ -2,6 +2,7 @@
 #define _PlayerNum_H
 
 #include "gpaddon.h"
+#include "addonservices.h"
 
 #include "GamepadEnums.h"
 
@@ -15,21 +16,40 @@
 #define PLAYER_NUMBER 1
 #endif
 
+// Wait before rejoining after getting the wrong slot, multiplied by the player number
+#ifndef PLAYERNUM_RECONNECT_DELAY_MS
+#define PLAYERNUM_RECONNECT_DELAY_MS 500
+#endif
+
+// Retries double the wait up to this many times
+#define PLAYERNUM_MAX_BACKOFF_SHIFT 3
+// After this many retries the slot the host gives is kept
+#define PLAYERNUM_MAX_ATTEMPTS 6
+
 // Analog Module Name
 #define PlayerNumName "PlayerNum"
 
-class PlayerNumAddon : public GPAddon {
+enum class PlayerNumState
+{
+	WAITING,      // mounted, waiting for the host to report our slot
+	RECONNECTING, // detached or re-enumerating after a wrong slot
+	ASSIGNED,
+};
+
+class PlayerNumAddon : public GPAddon, public PlayerNumberProvider {
 public:
 	virtual bool available();
 	virtual void setup();       // Analog Setup
 	virtual void process();     // Analog Process
-	virtual void preprocess() {}
     virtual std::string name() { return PlayerNumName; }
+	virtual uint8_t getPlayerNumber() { return assigned; }
 private:
-	void handleLED(int);
+	uint8_t readSlot();
+	void handleSlot(uint8_t);
+	PlayerNumState state;
 	uint8_t assigned;
 	uint8_t playerNum;
-	uint8_t xinputIDs[4];
+	uint8_t attempts;
 };
 
 #endif  // _PlayerNum_H
\ No newline at end of file
@@ -16,6 +16,8 @@
 
 #include "enums.pb.h"
 
+class PlayerLEDSink;
+
 // This needs to be moved to storage if we're going to share between modules
 extern NeoPico *neopico;
 extern AnimationStation as;
@@ -25,6 +27,9 @@ class PWMPlayerLEDs : public PlayerLEDs
 public:
 	void setup();
 	void display();
+	void off();
+private:
+	int32_t pins[PLED_COUNT];	// Pins this module claimed, -1 if unused or owned by another feature
 };
 
 // Player LED Module
@@ -36,8 +41,8 @@ class PlayerLEDAddon : public GPAddon
 public:
 	virtual bool available();
 	virtual void setup();
-	virtual void preprocess() {}
 	virtual void process();
+	virtual void handleEvent(const GamepadEvent& event);
 	virtual std::string name() { return PLEDName; }
 	PlayerLEDAddon() {
 		type = static_cast<PLEDType>(Storage::getInstance().getLedOptions().pledType);
@@ -45,9 +50,12 @@ public:
 	PlayerLEDAddon(PLEDType type) : type(type) {}
 
 protected:
+	bool updateAnimationState(uint8_t inputMode);
 	PLEDType type;
 	PWMPlayerLEDs *pwmLEDs = nullptr;
 	PLEDAnimationState animationState;
+	bool driven = false;                   // the host or the player number decides what the LEDs show
+	PlayerLEDSink * drivenSink = nullptr;  // sink that was handed the last state
 };
 
 #endif
@@ -17,10 +17,13 @@ class PS4ModeAddon : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();       // TURBO Button Setup
-	virtual void preprocess() {}
 	virtual void process();     // TURBO Setting of buttons (Enable/Disable)
 	virtual std::string name() { return PS4ModeName; }
 private:
+	bool importKey(const PS4Options& options);
+	bool loadKeyCache(const PS4Options& options);
+	void saveKeyCache();
+	bool precomputeMontgomery();
 	struct mbedtls_rsa_context rsa_context;
 	bool ready;
 };
@@ -20,7 +20,6 @@ class ReverseInput : public GPAddon {
 public:
 	virtual bool available();
 	virtual void setup();       // Reverse Button Setup
-	virtual void preprocess() {}
 	virtual void process();     // Reverse process
     virtual std::string name() { return ReverseName; }
 private:
@@ -33,7 +33,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // SNESpad Setup
 	virtual void process();     // SNESpad Process
-	virtual void preprocess() {}
 	virtual std::string name() { return SNESpadName; }
 private:
     SNESpad * snes;
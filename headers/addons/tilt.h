@@ -53,9 +53,63 @@
 #define TILT_SOCD_MODE SOCD_MODE_NEUTRAL
 #endif
 
+// Stick factors are Q15 fixed point, 32768 = 1.0
+
+#ifndef TILT1_FACTOR_LEFT_X
+#define TILT1_FACTOR_LEFT_X 11469 // 0.35
+#endif
+
+#ifndef TILT1_FACTOR_LEFT_Y
+#define TILT1_FACTOR_LEFT_Y 14746 // 0.45
+#endif
+
+#ifndef TILT2_FACTOR_LEFT_X
+#define TILT2_FACTOR_LEFT_X 21299 // 0.65
+#endif
+
+#ifndef TILT2_FACTOR_LEFT_Y
+#define TILT2_FACTOR_LEFT_Y 11469 // 0.35
+#endif
+
+#ifndef TILT1_FACTOR_RIGHT_X
+#define TILT1_FACTOR_RIGHT_X 9830 // 0.3
+#endif
+
+#ifndef TILT1_FACTOR_RIGHT_Y
+#define TILT1_FACTOR_RIGHT_Y 55706 // 1.7
+#endif
+
+#ifndef TILT2_FACTOR_RIGHT_X
+#define TILT2_FACTOR_RIGHT_X 9830 // 0.3
+#endif
+
+#ifndef TILT2_FACTOR_RIGHT_Y
+#define TILT2_FACTOR_RIGHT_Y 9830 // 0.3
+#endif
+
 // Tilt Module Name
 #define TiltName "Tilt"
 
+#define TILT_FACTOR_ONE 32768
+
+// Which tilt buttons change the stick output, both held counts as tilt 1 for the left stick
+enum TiltModifier
+{
+	TILT_MODIFIER_NONE,
+	TILT_MODIFIER_1,
+	TILT_MODIFIER_2,
+	TILT_MODIFIER_COUNT
+};
+
+// Every combination of the four direction bits
+#define TILT_DIRECTION_COUNT 16
+
+struct TiltStickOutput
+{
+	uint16_t x;
+	uint16_t y;
+};
+
 class TiltInput : public GPAddon {
 public:
 	virtual bool available();
@@ -64,20 +118,17 @@ public:
 	virtual void preprocess();  // Tilt Pre-Process (Cheat)
 	virtual std::string name() { return TiltName; }
 private:
-	void debounce();
 	void SOCDTiltClean(SOCDMode);
 	uint8_t SOCDCombine(SOCDMode, uint8_t);
 	uint8_t SOCDGamepadClean(uint8_t);
 	void OverrideGamepad(Gamepad*, uint8_t, uint8_t);
-	uint8_t dDebLeftState;          // Debounce State (stored)
-	uint8_t dDebRightState;          // Debounce State (stored)
+	void buildOutputTables(const TiltOptions&);
 	uint8_t tiltLeftState;          // Tilt State
 	uint8_t tiltRightState;          // Tilt Righjt Analog State
 	DpadDirection lastGPUD; // Gamepad Last Up-Down
 	DpadDirection lastGPLR; // Gamepad Last Left-Right
 	DpadDirection lastTiltUD; // Tilt Last Up-Down
 	DpadDirection lastTiltLR; // Gamepad Last Left-Right
-	uint32_t dpadTime[4];
 	uint8_t pinTilt1;
 	uint8_t pinTilt2;
 	uint8_t pinTiltLeftAnalogDown;
@@ -89,6 +140,9 @@ private:
 	uint8_t pinTiltRightAnalogLeft;
 	uint8_t pinTiltRightAnalogRight;
 	SOCDMode tiltSOCDMode;
+	const TiltOptions* activeOptions; // Options the tables were built from
+	TiltStickOutput leftOutput[TILT_MODIFIER_COUNT][TILT_DIRECTION_COUNT];  // Precomputed per modifier and direction
+	TiltStickOutput rightOutput[TILT_MODIFIER_COUNT][TILT_DIRECTION_COUNT];
 };
 
 #endif  // _Tilt_H
@@ -90,27 +90,23 @@ class TurboInput : public GPAddon {
 public:
     virtual bool available();
 	virtual void setup();       // TURBO Button Setup
-    virtual void preprocess() {}
 	virtual void process();     // TURBO Setting of buttons (Enable/Disable)
     virtual std::string name() { return TurboName; }
 private:
     void read(const TurboOptions&);                // Read TURBO Buttons and Dials
-    void debounce();            // TURBO Button Debouncer
     void updateTurboShotCount(uint8_t turboShotCount);
-    bool bDebState;             // Debounce TURBO Button State
-    uint32_t uDebTime;          // Debounce TURBO Button Time
-    uint32_t debChargeState;    // Debounce Charge Button State
-    uint32_t debChargeTime[4];  // Debounce Charge Button Time
-    uint32_t debounceMS;        // Debounce MS from Gamepad
     uint16_t lastPressed;       // Last buttons pressed (for Turbo Enable)
     uint16_t lastDpad;          // Last d-pad pressed (for Turbo Change)
     uint16_t turboButtonsPressed;    // Turbo Buttons Enabled
     uint16_t alwaysEnabled;     // Turbo SHMUP Always Enabled
     uint32_t uIntervalMS;       // Turbo Interval
+    const TurboOptions* activeOptions; // Options the interval was computed from
     bool bTurboState;           // Turbo Buttons State
     uint32_t chargeState;       // Turbo Charge Button States
     bool bTurboFlicker;         // Turbo Enable Buttons Toggle OFF Flag ??
     uint32_t nextTimer;         // Turbo Timer
+    bool dialEnabled;           // Turbo Dial pin claimed
+    uint8_t pinLED;             // Turbo LED Pin, 0xff if none
     uint8_t adcShmupDial;       // Turbo ADC Dial Input
     uint16_t dialValue;         // Turbo Dial Value (Raw)
     uint16_t incrementValue;    // Turbo Dial Increment Value
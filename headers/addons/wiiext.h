@@ -42,7 +42,6 @@ public:
 	virtual bool available();
 	virtual void setup();       // WiiExtension Setup
 	virtual void process();     // WiiExtension Process
-	virtual void preprocess() {}
 	virtual std::string name() { return WiiExtensionName; }
 private:
     WiiExtension * wii;
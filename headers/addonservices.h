@@ -0,0 +1,64 @@
+#ifndef _ADDONSERVICES_H_
+#define _ADDONSERVICES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PlayerLEDs.h"
+
+// Capabilities addons can publish for each other to use
+enum class AddonServiceId : uint8_t {
+    PLAYER_LED_SINK,
+    PLAYER_NUMBER_PROVIDER,
+    COUNT
+};
+
+// Drives the player LEDs from a decoded host LED state
+class PlayerLEDSink {
+public:
+    static constexpr AddonServiceId ServiceId = AddonServiceId::PLAYER_LED_SINK;
+    virtual void setPlayerLEDs(const PLEDAnimationState& animationState) = 0;
+    // Nothing drives the player LEDs anymore, the sink gets its LEDs back
+    virtual void releasePlayerLEDs() = 0;
+};
+
+// Player slot this controller ended up with, 0 until the host has assigned one
+class PlayerNumberProvider {
+public:
+    static constexpr AddonServiceId ServiceId = AddonServiceId::PLAYER_NUMBER_PROVIDER;
+    virtual uint8_t getPlayerNumber() = 0;
+};
+
+// One slot per service, indexed by the service's compile-time ID
+class AddonServices {
+public:
+    AddonServices(AddonServices const&) = delete;
+    void operator=(AddonServices const&) = delete;
+    static AddonServices& getInstance() // Thread-safe storage ensures cross-thread talk
+    {
+        static AddonServices instance;
+        return instance;
+    }
+
+    template <typename S>
+    void publish(S* service) { services[index<S>()] = static_cast<void*>(service); }
+
+    template <typename S>
+    void withdraw(S* service) {
+        if (services[index<S>()] == static_cast<void*>(service))
+            services[index<S>()] = nullptr;
+    }
+
+    // Returns nullptr if no loaded addon provides the service
+    template <typename S>
+    S* get() const { return static_cast<S*>(services[index<S>()]); }
+private:
+    AddonServices() : services{} {}
+
+    template <typename S>
+    static constexpr size_t index() { return static_cast<size_t>(S::ServiceId); }
+
+    void* services[static_cast<size_t>(AddonServiceId::COUNT)];
+};
+
+#endif
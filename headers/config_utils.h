@@ -13,6 +13,13 @@ namespace ConfigUtils {
     std::string toJSON(const Config& config);
     bool fromJSON(Config& config, const char* data, size_t dataLen);
     bool fromLegacyStorage(Config& config);
+
+    // Profile overlays are sparse messages, only the fields a profile overrides are encoded
+    bool mergeOverlay(const pb_msgdesc_t* fields, void* dest, const uint8_t* data, size_t size);
+    bool encodeOverlay(const pb_msgdesc_t* fields, void* value, const void* base, uint8_t* data, pb_size_t& size, size_t maxSize);
+
+    std::string profileSettingsToJSON(const ProfileOptions& profileOptions);
+    bool profileSettingsFromJSON(ProfileOptions& profileOptions, const char* data, size_t dataLen);
 }
 
 #endif
@@ -0,0 +1,99 @@
+#ifndef _CROSSCORE_H_
+#define _CROSSCORE_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+// Lock-free primitives for handing data between core0 and core1
+//
+// Both only need plain 32-bit atomic loads and stores, which the Cortex-M0+ supports natively.
+// The SIO FIFO is not used since core1's multicore_lockout victim handler already owns it.
+
+// Single-writer snapshot: the writer never blocks, readers retry if they raced with an update
+template <typename T>
+class SeqLock {
+public:
+    SeqLock() : sequence(0), value() {}
+
+    void write(const T& newValue) {
+        const uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed); // odd while the write is in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &newValue, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Returns false if a write was in progress, out may then hold a torn copy
+    bool tryRead(T& out) const {
+        const uint32_t seq = sequence.load(std::memory_order_acquire);
+        if (seq & 1)
+            return false;
+        memcpy(&out, &value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == seq;
+    }
+
+    void read(T& out) const {
+        while (!tryRead(out)) {}
+    }
+
+    // Changes every time a new value is written
+    uint32_t version() const { return sequence.load(std::memory_order_acquire); }
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+};
+
+// Single-producer single-consumer ring buffer, Size must be a power of two
+template <typename T, uint32_t Size>
+class SPSCQueue {
+    static_assert((Size & (Size - 1)) == 0, "SPSCQueue size must be a power of two");
+public:
+    SPSCQueue() : head(0), tail(0) {}
+
+    // Producer side, returns false and drops the item if the queue is full
+    bool push(const T& item) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Size)
+            return false;
+        items[h & (Size - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false if the queue is empty
+    bool pop(T& item) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        item = items[t & (Size - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire); }
+private:
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    T items[Size];
+};
+
+enum class GamepadEventType : uint8_t {
+    PROFILE_CHANGE,     // data0: new profile number
+    USB_SUSPEND,        // host suspended the bus, core1 blanks its outputs and stops running tasks
+    USB_RESUME,         // host resumed the bus
+    HOTKEY_ACTION,      // data0: GamepadHotkey that changed a setting, data1: new value of that setting
+    TURBO_RATE_CHANGE,  // data0: new turbo shot count, data1: 1 if it went up
+    FOCUS_MODE_CHANGE,  // data0: 1 if focus mode was engaged, 0 if released
+};
+
+struct GamepadEvent {
+    GamepadEventType type;
+    uint32_t data0;
+    uint32_t data1;
+};
+
+#define GAMEPAD_EVENT_QUEUE_SIZE 32
+
+#endif
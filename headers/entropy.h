@@ -0,0 +1,54 @@
+#ifndef _ENTROPY_H_
+#define _ENTROPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pico/critical_section.h"
+
+// Whitened bytes kept ready for callers, at least one output block
+#define ENTROPY_POOL_SIZE 64
+// Bytes of pool that go into each 32 byte output block
+#define ENTROPY_BLOCK_SIZE 32
+// ROSC bit pairs read per process() call
+#define ENTROPY_PAIRS_PER_PASS 64
+
+// Random numbers from the ring oscillator. The ROSC random bit is biased and correlated, so
+// pairs of bits go through a von Neumann extractor into a pool that core1 tops up in the
+// background. Every output block is the SHA-256 of fresh pool bytes chained with the last one.
+class Entropy {
+public:
+    Entropy(Entropy const&) = delete;
+    void operator=(Entropy const&) = delete;
+    static Entropy& getInstance() // Thread-safe storage ensures cross-thread talk
+    {
+        static Entropy instance;
+        return instance;
+    }
+
+    // Tops up the pool, called from the core1 loop
+    void process();
+    // Only waits on the ROSC if the pool has run dry
+    void getBytes(uint8_t* output, size_t length);
+    uint32_t getRandom32();
+
+    // mbedtls f_rng callback, the context is unused
+    static int mbedtlsRandom(void* context, unsigned char* output, size_t length);
+private:
+    Entropy();
+    void gather(uint32_t pairs);
+    size_t takeReady(uint8_t* output, size_t length);
+    static void hashBlock(const uint8_t* lastBlock, const uint8_t* input, uint32_t blockCounter, uint8_t* block);
+
+    critical_section_t lock;
+    uint8_t pool[ENTROPY_POOL_SIZE];
+    uint32_t poolCount;
+    uint8_t pendingByte;  // whitened bits not yet in the pool
+    uint8_t pendingBits;
+    uint8_t chain[32];    // last output block
+    uint8_t ready[32];    // copy of it, cleared as it is handed out
+    uint32_t readyCount;  // bytes at the end of ready not handed out yet
+    uint32_t counter;
+};
+
+#endif
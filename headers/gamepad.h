@@ -12,6 +12,8 @@
 #include "gamepad/descriptors/XInputDescriptors.h"
 #include "gamepad/descriptors/KeyboardDescriptors.h"
 #include "gamepad/descriptors/PS4Descriptors.h"
+#include "gamepad/HIDGenericDescriptor.h"
+#include "gamepad/HIDCompositeDescriptor.h"
 
 #include "pico/stdlib.h"
 
@@ -26,6 +28,9 @@ extern uint64_t getMicro();
 
 #define GAMEPAD_FEATURE_REPORT_SIZE 32
 
+// Bits of gpio_get_all() that are real bank 0 pins
+#define GAMEPAD_PIN_MASK ((1u << NUM_BANK0_GPIOS) - 1)
+
 struct GamepadButtonMapping
 {
 	GamepadButtonMapping(uint8_t p, uint16_t bm) : 
@@ -63,6 +68,7 @@ public:
 
 	void setup();
 	void teardown_and_reinit(const uint32_t profileNum);
+	void reloadOptions();		// follow the options of the active profile
 	void process();
 	void read();
 	void save();
@@ -88,10 +94,12 @@ public:
 	void *getReport();
 	uint16_t getReportSize();
 	HIDReport *getHIDReport();
+	uint8_t *getHIDGenericReport();
 	SwitchReport *getSwitchReport();
 	XInputReport *getXInputReport();
 	KeyboardReport *getKeyboardReport();
 	PS4Report *getPS4Report();
+	HIDCompositeKeys *getCompositeKeys();
 
 	/**
 	 * @brief Check for a button press. Used by `pressed[Button]` helper methods.
@@ -112,6 +120,14 @@ public:
 		return (state.aux & mask) == mask;
 	}
 
+	/**
+	 * @brief Check a GPIO in the debounced pin snapshot taken by `read`, pressed means pulled low.
+	 * Input add-ons use this instead of sampling their pins again.
+	 */
+	inline bool __attribute__((always_inline)) pressedPin(const uint8_t pin) {
+		return pin < NUM_BANK0_GPIOS && (debouncedPins & (1u << pin));
+	}
+
 	/**
 	 * @brief Check for a hotkey combination press. Checks aux, buttons, and dpad.
 	 */
@@ -148,14 +164,16 @@ public:
 	inline bool __attribute__((always_inline)) pressedA1()    { return pressedButton(GAMEPAD_MASK_A1); }
 	inline bool __attribute__((always_inline)) pressedA2()    { return pressedButton(GAMEPAD_MASK_A2); }
 
-	const GamepadOptions& getOptions() const { return options; }
+	const GamepadOptions& getOptions() const { return *options; }
 
-	void setInputMode(InputMode inputMode) { options.inputMode = inputMode; }
-	void setSOCDMode(SOCDMode socdMode) { options.socdMode = socdMode; }
-	void setDpadMode(DpadMode dpadMode) { options.dpadMode = dpadMode; }
+	void setInputMode(InputMode inputMode) { options->inputMode = inputMode; }
+	void setSOCDMode(SOCDMode socdMode) { options->socdMode = socdMode; }
+	void setDpadMode(DpadMode dpadMode) { options->dpadMode = dpadMode; }
 
 	GamepadDebouncer debouncer;
 	const uint8_t debounceMS;
+	uint32_t rawPins {0};       // pressed GPIOs of the last read, bit n is GPIO n
+	uint32_t debouncedPins {0}; // same snapshot after debouncing, what all inputs are built from
 	GamepadState rawState;
 	GamepadState state;
 	GamepadButtonMapping *mapDpadUp;
@@ -187,14 +205,15 @@ public:
 	};
 
 private:
+	void mapPins(uint32_t values);
 	void releaseAllKeys(void);
 	void pressKey(uint8_t code);
 	uint8_t getModifier(uint8_t code);
 	uint8_t getMultimedia(uint8_t code);
 	void processHotkeyIfNewAction(GamepadHotkey action);
 
-	GamepadOptions& options;
-	const HotkeyOptions& hotkeyOptions;
+	GamepadOptions* options;
+	const HotkeyOptions* hotkeyOptions;
 
 	GamepadHotkey lastAction = HOTKEY_NONE;
 };
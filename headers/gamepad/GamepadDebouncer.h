@@ -11,17 +11,22 @@
 
 // Implement this wrapper function for your platform
 // TODO: Make this a pure virtual member instead.
-uint32_t getMillis();
+uint64_t getMicro();
 
+#define GAMEPAD_DEBOUNCE_PIN_COUNT 32
+
+// Debounces a bitmask of pressed pins, bit n is pin n. A change is taken right away,
+// then that pin ignores further changes for debounceMS. This is the only pin debouncer,
+// add-on pins are part of the same snapshot as the gamepad buttons.
 class GamepadDebouncer
 {
 	public:
-		GamepadDebouncer(const uint8_t debounceMS = 5) : debounceMS(debounceMS) { }
+		GamepadDebouncer(const uint8_t debounceMS = 5) : debounceMS(debounceMS), debounceUs(debounceMS * 1000) { }
 
-		void debounce(GamepadState *state);
+		uint32_t debounce(uint32_t pins);
 
 		const uint8_t debounceMS;
-		GamepadState debounceState;
-		uint32_t dpadTime[4];
-		uint32_t buttonTime[GAMEPAD_BUTTON_COUNT];
+		const uint32_t debounceUs;
+		uint32_t debouncePins = 0;
+		uint32_t pinTime[GAMEPAD_DEBOUNCE_PIN_COUNT] = { }; // microseconds, wraps safely
 };
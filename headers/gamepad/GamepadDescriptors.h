@@ -12,6 +12,8 @@
 #include "descriptors/XInputDescriptors.h"
 #include "descriptors/KeyboardDescriptors.h"
 #include "descriptors/PS4Descriptors.h"
+#include "HIDGenericDescriptor.h"
+#include "HIDCompositeDescriptor.h"
 
 #include "enums.pb.h"
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+// HID mode variant that adds a keyboard and a consumer control interface next to the gamepad.
+//
+// Each interface has its own IN endpoint, so key presses never take the place of a gamepad
+// report. Interfaces and TinyUSB HID instances share the same numbering:
+//   0  gamepad, fixed PS3-style or the configurable generic layout
+//   1  keyboard, 256 bit key bitmap (no report ID)
+//   2  consumer control, the seven media keys of keyboard mode (no report ID)
+
+#define HID_COMPOSITE_GAMEPAD_INSTANCE 0
+#define HID_COMPOSITE_KEYBOARD_INSTANCE 1
+#define HID_COMPOSITE_CONSUMER_INSTANCE 2
+#define HID_COMPOSITE_INTERFACE_COUNT 3
+
+#define HID_COMPOSITE_KEYBOARD_ENDPOINT 0x82
+#define HID_COMPOSITE_CONSUMER_ENDPOINT 0x83
+
+#define HID_COMPOSITE_KEYBOARD_REPORT_SIZE 32
+#define HID_COMPOSITE_CONSUMER_REPORT_SIZE 1
+
+struct HIDCompositeKeys
+{
+	uint8_t keycode[HID_COMPOSITE_KEYBOARD_REPORT_SIZE];
+	uint8_t consumer;
+};
+
+namespace HIDComposite {
+	// Adds a key to the keyboard bitmap, or to the consumer report for the KEYBOARD_MULTIMEDIA_* codes
+	void pressKey(HIDCompositeKeys& keys, uint8_t code);
+
+	// Build the composite configuration around the active gamepad interface, must run after HIDGeneric is configured
+	void configure();
+	void disable();
+	bool isEnabled();
+	const uint8_t* getReportDescriptor(uint8_t instance, uint16_t* size);
+	const uint8_t* getConfigurationDescriptor(uint16_t* size);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include "GamepadState.h"
+
+// Generic HID gamepad whose report layout is chosen at setup instead of the fixed PS3-style one.
+//
+// Report layout (no report ID):
+//   buttons    buttonCount bits, padded to a whole byte. Buttons 1-14 follow the DInput column of
+//              the mapping table in GamepadState.h, buttons 15+ come from GamepadState::aux.
+//   hat        4 bits + 4 bits padding
+//   axes       axisCount values of 8 or 16 bits, little endian, in the order
+//              X (lx), Y (ly), Z (rx), Rz (ry), Rx (lt), Ry (rt)
+
+#define HID_GENERIC_MAX_BUTTONS 30 // 14 gamepad buttons + 16 aux bits
+#define HID_GENERIC_MAX_AXES 6
+#define HID_GENERIC_MAX_REPORT_SIZE (4 + 1 + HID_GENERIC_MAX_AXES * 2)
+#define HID_GENERIC_MAX_DESCRIPTOR_SIZE 128
+
+#define HID_GENERIC_DEFAULT_BUTTONS 16
+#define HID_GENERIC_DEFAULT_AXES 6
+#define HID_GENERIC_DEFAULT_AXIS_BITS 16
+
+struct HIDGenericLayout
+{
+	uint8_t buttonCount;
+	uint8_t axisCount;
+	uint8_t axisBits;    // 8 or 16
+	uint8_t hatOffset;   // byte offsets into the report
+	uint8_t axisOffset;
+	uint8_t reportSize;
+};
+
+namespace HIDGeneric {
+	// Clamp the requested sizes and work out the byte offsets
+	HIDGenericLayout makeLayout(uint32_t buttonCount, uint32_t axisCount, uint32_t axisBits);
+	// Writes the report descriptor for a layout, returns its length
+	uint16_t buildReportDescriptor(const HIDGenericLayout& layout, uint8_t* descriptor, uint16_t maxSize);
+	// Packs a gamepad state into a report for a layout, returns the report size
+	uint8_t packReport(const HIDGenericLayout& layout, const GamepadState& state, uint8_t* report);
+
+	// Build the descriptors used by the USB callbacks, must run before the USB stack starts
+	void configure(uint32_t buttonCount, uint32_t axisCount, uint32_t axisBits);
+	// Fall back to the fixed PS3-style HID descriptor
+	void disable();
+	bool isEnabled();
+	const HIDGenericLayout& getLayout();
+	const uint8_t* getReportDescriptor(uint16_t* size);
+	const uint8_t* getConfigurationDescriptor();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include "GamepadState.h"
+
+// Turns the input reports of a gamepad attached to the USB host port into a GamepadState.
+//
+// Generic HID gamepads and joysticks are read through their report descriptor, buttons 1-14
+// follow the DInput column of the mapping table in GamepadState.h and axes are taken in the
+// order X (lx), Y (ly), Z (rx), Rz (ry), Rx (lt), Ry (rt). DualShock 4, DualSense and Switch
+// Pro controllers are recognised by VID/PID and decoded from their fixed report layouts.
+
+#define HID_HOST_MAX_BUTTONS GAMEPAD_BUTTON_COUNT
+#define HID_HOST_MAX_AXES 6
+
+enum class HIDHostDeviceType : uint8_t
+{
+	NONE,       // no usable gamepad fields
+	GENERIC,
+	DUALSHOCK4,
+	DUALSENSE,
+	SWITCH_PRO,
+};
+
+struct HIDHostField
+{
+	uint16_t bitOffset; // from the first byte after the report ID
+	uint8_t bitSize;    // 0 if the field isn't present
+	int32_t logicalMin;
+	int32_t logicalMax;
+};
+
+// Every input is a field of the report, fixed decoders are just prefilled layouts
+struct HIDHostLayout
+{
+	HIDHostDeviceType type;
+	uint8_t reportId;   // 0 if the device doesn't use report IDs
+	HIDHostField buttons[HID_HOST_MAX_BUTTONS]; // GP2040 order, B1 to A2
+	HIDHostField hat;
+	HIDHostField dpad[4];                       // up, down, left, right, used by devices without a hat
+	HIDHostField axes[HID_HOST_MAX_AXES];       // lx, ly, rx, ry, lt, rt. logicalMin > logicalMax inverts the axis
+};
+
+namespace HIDHostParser {
+	// Picks a fixed decoder for known controllers, otherwise parses the report descriptor
+	HIDHostLayout makeLayout(uint16_t vid, uint16_t pid, const uint8_t* descriptor, uint16_t length);
+	// Reads the first gamepad or joystick application collection of a report descriptor
+	HIDHostLayout parseDescriptor(const uint8_t* descriptor, uint16_t length);
+	// Decodes an input report, returns false if it isn't the gamepad report of the layout
+	bool decodeReport(const HIDHostLayout& layout, const uint8_t* report, uint16_t length, GamepadState& state);
+}
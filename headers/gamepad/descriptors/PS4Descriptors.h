@@ -274,7 +274,7 @@ static const uint8_t ps4_configuration_descriptor[] =
 	1,	                           // bNumInterfaces
 	1,	                           // bConfigurationValue
 	0,	                           // iConfiguration
-	0x80,                          // bmAttributes
+	0xA0,                          // bmAttributes (bus powered, remote wakeup)
 	50,	                           // bMaxPower
 		// interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
 	9,				               // bLength
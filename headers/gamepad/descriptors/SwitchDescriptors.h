@@ -112,7 +112,7 @@ static const uint8_t switch_configuration_descriptor[] =
 	0x01,        // bNumInterfaces 1
 	0x01,        // bConfigurationValue
 	0x00,        // iConfiguration (String Index)
-	0x80,        // bmAttributes
+	0xA0,        // bmAttributes (bus powered, remote wakeup)
 	0xFA,        // bMaxPower 500mA
 
 	0x09,        // bLength
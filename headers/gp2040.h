@@ -8,7 +8,25 @@
 
 // GP2040 Classes
 #include "gamepad.h"
-#include "addonmanager.h"
+#include "addonpipeline.h"
+#include "inputmodedetector.h"
+#include "usbsuspendmonitor.h"
+
+#include "addons/analog.h" // Inputs for Core0
+#include "addons/bootsel_button.h"
+#include "addons/focus_mode.h"
+#include "addons/dualdirectional.h"
+#include "addons/tilt.h"
+#include "addons/extra_button.h"
+#include "addons/keyboard_host.h"
+#include "addons/i2canalog1219.h"
+#include "addons/jslider.h"
+#include "addons/playernum.h"
+#include "addons/reverse.h"
+#include "addons/turbo.h"
+#include "addons/slider_socd.h"
+#include "addons/wiiext.h"
+#include "addons/snes_input.h"
 
 #include "pico/types.h"
 
@@ -21,7 +39,28 @@ public:
 private:
     uint64_t nextRuntime;
     Gamepad snapshot;
-    AddonManager addons;
+
+    // Core0 addons, set up and run in this order, only the available ones are allocated
+    AddonPipeline<
+        KeyboardHostAddon,
+        AnalogInput,
+        BootselButtonAddon,
+        DualDirectionalInput,
+        ExtraButtonAddon,
+        FocusModeAddon,
+        I2CAnalog1219Input,
+        JSliderInput,
+        ReverseInput,
+        TurboInput,
+        WiiExtensionInput,
+        SNESpadInput,
+        SliderSOCDInput,
+        TiltInput
+    > inputAddons;
+    AddonPipeline<PlayerNumAddon> usbReportAddons;
+
+    InputModeDetector inputModeDetector;
+    void processInputModeDetection(Gamepad* gamepad);
 
     struct RebootHotkeys {
         RebootHotkeys();
@@ -36,6 +75,23 @@ private:
     };
     RebootHotkeys rebootHotkeys;
 
+    struct ClockGovernor {
+        ClockGovernor();
+        void setup();
+        void process(Gamepad* gamepad);
+
+        bool enabled;
+        bool idleScalingAllowed;
+        uint32_t idleDivider;
+        uint32_t usbSafeDivider;
+        uint32_t idleTimeoutMs;
+        absolute_time_t idleTimeout;
+        GamepadState lastState;
+    };
+    ClockGovernor clockGovernor;
+
+    UsbSuspendMonitor usbSuspendMonitor;
+
     enum class BootAction {
         NONE,
         ENTER_WEBCONFIG_MODE,
@@ -47,6 +103,7 @@ private:
         SET_INPUT_MODE_PS4
     };
     static BootAction getBootAction();
+    static void configureHIDDescriptor(InputMode inputMode, const GamepadOptions& options);
 };
 
 #endif
@@ -9,7 +9,7 @@
 #include <vector>
 
 #include "gpaddon.h"
-#include "addonmanager.h"
+#include "taskscheduler.h"
 
 class GP2040Aux {
 public:
@@ -18,8 +18,9 @@ public:
     void setup();           // setup core1
     void run();             // loop core1
 private:
+    void loadTask(GPAddon*, uint32_t periodUs);
     uint64_t nextRuntime;
-    AddonManager addons;
+    bool suspended;
 };
 
 #endif
@@ -2,17 +2,20 @@
 #define _GPAddon_H_
 
 #include "gamepad.h"
+#include "crosscore.h"
 
 #include <string>
 
 class GPAddon
 {
 public:
+	virtual ~GPAddon() {}
 	virtual bool available() = 0;
 	virtual void setup() = 0;
 	virtual void process() = 0;
-	virtual void preprocess() = 0;
+	virtual void preprocess() {} // only addons that override this are dispatched in their pre-process phase
 	virtual std::string name() = 0;
+	virtual void handleEvent(const GamepadEvent& event) {} // core1 addons only, called before process()
 };
 
 #endif
\ No newline at end of file
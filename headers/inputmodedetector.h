@@ -0,0 +1,57 @@
+#ifndef _INPUTMODEDETECTOR_H_
+#define _INPUTMODEDETECTOR_H_
+
+#include <stdint.h>
+
+#include "enums.pb.h"
+#include "usb_driver.h"
+
+#define INPUT_MODE_DETECT_MAX_CANDIDATES 5
+
+// Picks the input mode by watching how the host reacts to each candidate
+//
+// Every candidate is enumerated in turn, starting with the mode that last worked. Modes with a
+// handshake (XInput LED report, PS4 auth) lock once the host performs it, HID and Switch have
+// none and lock when the host mounts them and stays quiet for a short settle time. A host that
+// gives itself away (PS4 auth, PS3 feature request, Windows MS OS descriptor) redirects straight
+// to its mode. If a whole pass goes by without a lock the last good mode is kept.
+//
+// Times are passed in so the state machine can be replayed from a recorded event log.
+class InputModeDetector {
+public:
+    InputModeDetector();
+    InputMode start(InputMode lastGoodMode, uint32_t nowMs); // returns the first mode to enumerate
+    void onHostEvent(UsbHostEvent event, uint32_t nowMs);
+    InputMode update(uint32_t nowMs);                         // returns the mode USB should be in
+    bool isActive() const { return state == State::PROBING; }
+    bool isLocked() const { return state == State::LOCKED; }
+    InputMode getDetectedMode() const { return currentMode; }
+private:
+    enum class State {
+        IDLE,
+        PROBING,
+        LOCKED,
+        FALLBACK,
+    };
+
+    void beginAttempt(InputMode mode, uint32_t nowMs);
+    void lock();
+    static bool hasHandshake(InputMode mode);
+
+    State state;
+    InputMode lastGoodMode;
+    InputMode currentMode;
+    InputMode candidates[INPUT_MODE_DETECT_MAX_CANDIDATES];
+    uint8_t candidateCount;
+    uint8_t candidateIndex;
+
+    uint32_t attemptStartMs;
+    uint32_t mountedMs;
+    bool mounted;
+    bool confirmed;
+    bool redirected;        // the current attempt was chosen by a host hint
+    bool redirectPending;
+    InputMode redirectMode;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _PINREGISTRY_H_
+#define _PINREGISTRY_H_
+
+#include <stdint.h>
+
+#include "hardware/gpio.h"
+#include "pico/critical_section.h"
+
+#define PIN_OWNER_GAMEPAD "Gamepad"
+// I2C pins are shared by everything on the bus
+#define PIN_OWNER_I2C "I2C"
+
+// Who uses which GPIO. Every feature claims its pins here during setup, so two features
+// reading or driving the same pin show up as a conflict instead of silently fighting.
+// Owners are static strings, usually the add-on name.
+class PinRegistry {
+public:
+    PinRegistry(PinRegistry const&) = delete;
+    void operator=(PinRegistry const&) = delete;
+    static PinRegistry& getInstance() // Thread-safe storage ensures cross-thread talk
+    {
+        static PinRegistry instance;
+        return instance;
+    }
+
+    // Returns false if the pin is invalid or already owned by another feature
+    bool claim(int32_t pin, const char* owner);
+    // Same as claim for a pulled-up button input, the GPIO is set up by the next initInputs()
+    bool claimInput(int32_t pin, const char* owner);
+    // Returns false if the pin isn't owned by this feature
+    bool release(int32_t pin, const char* owner);
+    // Sets up every input claimed since the last call in one batch
+    void initInputs();
+
+    const char* getOwner(uint8_t pin) const { return pin < NUM_BANK0_GPIOS ? owners[pin] : nullptr; }
+    // First feature that was refused the pin, only set for pins in the conflict mask
+    const char* getConflictOwner(uint8_t pin) const { return pin < NUM_BANK0_GPIOS ? conflictOwners[pin] : nullptr; }
+    uint32_t getConflictMask() const { return conflictMask; }
+private:
+    PinRegistry();
+
+    critical_section_t lock;
+    const char* owners[NUM_BANK0_GPIOS];
+    const char* conflictOwners[NUM_BANK0_GPIOS];
+    uint32_t conflictMask;
+    uint32_t pendingInputMask;
+};
+
+#endif
@@ -4,37 +4,31 @@
 #include "addons/buzzerspeaker.h"
 
 // Intro example
-Song introSong{
-    100,
-    {
-        D5,
-        AS5,
-        B5,
-        C6,
-        CS6,
-        D6,
-        DS6,
-        E6,
-        C7,
-        CS7,
-        D7,
-        DS7,
-        E7,
-        F7,
-        D8,
-        DS8,
-    }
+static constexpr Tone introTones[] = {
+    D5, AS5, B5, C6, CS6, D6, DS6, E6,
+    C7, CS7, D7, DS7, E7, F7, D8, DS8,
 };
+static constexpr Song introSong(100, introTones);
 
-Song configModeSong{
-    150,
-    {
-        E5,
-        E5,
-        G4,
-        FS5,
-        E5
-    }
+static constexpr Tone configModeTones[] = {
+    E5, E5, G4, FS5, E5,
 };
+static constexpr Song configModeSong(150, configModeTones);
+
+// Sound cues, modes are told apart by how often the cue repeats
+static constexpr Tone cueModeTones[] = { E6, PAUSE };
+static constexpr Song cueModeSong(60, cueModeTones);
+
+static constexpr Tone cueProfileTones[] = { A5, PAUSE };
+static constexpr Song cueProfileSong(80, cueProfileTones);
+
+static constexpr Tone cueInputModeTones[] = { C6, E6, G6, C7 };
+static constexpr Song cueInputModeSong(60, cueInputModeTones);
+
+static constexpr Tone cueOnTones[] = { C6, G6 };
+static constexpr Song cueOnSong(60, cueOnTones);
+
+static constexpr Tone cueOffTones[] = { G6, C6 };
+static constexpr Song cueOffSong(60, cueOffTones);
 
 #endif
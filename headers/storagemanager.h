@@ -13,13 +13,12 @@
 #include "enums.h"
 #include "helper.h"
 #include "gamepad.h"
+#include "crosscore.h"
 
 #include "config.pb.h"
 
 #include <atomic>
 
-#include "pico/critical_section.h"
-
 #define SI Storage::getInstance()
 
 // Storage manager for board, LED options, and thread-safe settings
@@ -34,19 +33,20 @@ public:
 	}
 
 	Config& getConfig() { return config; }
-	GamepadOptions& getGamepadOptions() { return config.gamepadOptions; }
-	HotkeyOptions& getHotkeyOptions() { return config.hotkeyOptions; }
+	GamepadOptions& getGamepadOptions() { return *gamepadOptions; }
+	HotkeyOptions& getHotkeyOptions() { return *hotkeyOptions; }
 	ForcedSetupOptions& getForcedSetupOptions() { return config.forcedSetupOptions; }
 	PinMappings& getPinMappings() { return config.pinMappings; }
 	KeyboardMapping& getKeyboardMapping() { return config.keyboardMapping; }
 	DisplayOptions& getDisplayOptions() { return config.displayOptions; }
 	DisplayOptions& getPreviewDisplayOptions() { return previewDisplayOptions; }
 	LEDOptions& getLedOptions() { return config.ledOptions; }
-	AddonOptions& getAddonOptions() { return config.addonOptions; }
-	AnimationOptions_Proto& getAnimationOptions() { return config.animationOptions; }
+	AddonOptions& getAddonOptions() { return *addonOptions; }
+	AnimationOptions_Proto& getAnimationOptions() { return *animationOptions; }
 	ProfileOptions& getProfileOptions() { return config.profileOptions; }
+	PowerOptions& getPowerOptions() { return config.powerOptions; }
 
-	bool save();
+	bool save();						// false if the config or the active profile's changes could not be stored
 
 	PinMappings& getProfilePinMappings();
 
@@ -55,6 +55,16 @@ public:
 
 	void enqueueAnimationOptionsSave(const AnimationOptions& animationOptions);
 
+	// Private exponent and CRT values of the PS4 key, computed once on core1 and kept in the config
+	struct PS4KeyCache
+	{
+		uint8_t rsaD[256];
+		uint8_t rsaDP[128];
+		uint8_t rsaDQ[128];
+		uint8_t rsaQP[128];
+	};
+	void enqueuePS4KeyCacheSave(const PS4KeyCache& keyCache);
+
 	void SetConfigMode(bool); 			// Config Mode (on-boot)
 	bool GetConfigMode();
 
@@ -63,12 +73,17 @@ public:
 
 	void SetProcessedGamepad(Gamepad *); // MPGS Processed Gamepad Get/Set
 	Gamepad * GetProcessedGamepad();
+	void PublishProcessedState(const GamepadState&); // core0: publish the processed state for core1
+	void RefreshProcessedGamepad();		// core1: copy the latest complete snapshot into the processed gamepad
+
+	bool PushGamepadEvent(const GamepadEvent&); // core0 -> core1 event queue
+	bool PopGamepadEvent(GamepadEvent&);
 
 	void SetFeatureData(uint8_t *); 	// USB Feature Data Get/Set
 	void ClearFeatureData();
 	uint8_t * GetFeatureData();
 
-	void setProfile(const uint32_t);		// profile support for multiple mappings
+	void setProfile(const uint32_t);		// profile support for multiple mappings and settings
 	void setFunctionalPinMappings(const uint32_t);
 
 	void ResetSettings(); 				// EEPROM Reset Feature
@@ -81,11 +96,31 @@ private:
 	uint8_t featureData[32]; // USB X-Input Feature Data
 	DisplayOptions previewDisplayOptions;
 	Config config;
+	SeqLock<GamepadState> processedGamepadState;
+	SPSCQueue<GamepadEvent, GAMEPAD_EVENT_QUEUE_SIZE> gamepadEvents;
 	std::atomic<bool> animationOptionsSavePending;
-	critical_section_t animationOptionsCs;
-	uint32_t animationOptionsCrc = 0;
-	AnimationOptions animationOptionsToSave = {};
+	uint32_t animationOptionsCrc = 0;	// only accessed from core1
+	SeqLock<AnimationOptions> animationOptionsToSave;
+	std::atomic<bool> ps4KeyCacheSavePending;
+	SeqLock<PS4KeyCache> ps4KeyCacheToSave;
 	PinMappings* functionalPinMappings = nullptr;
+
+	// Profiles 2-4 can override parts of the gamepad, add-on, animation and hotkey options
+	static constexpr size_t PROFILE_SETTINGS_COUNT = sizeof(ProfileOptions::profileSettings) / sizeof(ProfileSettings);
+	void activateProfile(const uint32_t);
+	void buildProfiles();
+	bool storeActiveProfile();
+	uint32_t activeProfile = 1;
+	// Options of the active profile, switching profiles only swaps these pointers
+	GamepadOptions* gamepadOptions = &config.gamepadOptions;
+	AddonOptions* addonOptions = &config.addonOptions;
+	AnimationOptions_Proto* animationOptions = &config.animationOptions;
+	HotkeyOptions* hotkeyOptions = &config.hotkeyOptions;
+	// Base options with a profile's overrides merged in, only allocated for the parts a profile overrides
+	GamepadOptions* profileGamepadOptions[PROFILE_SETTINGS_COUNT] = {};
+	AddonOptions* profileAddonOptions[PROFILE_SETTINGS_COUNT] = {};
+	AnimationOptions_Proto* profileAnimationOptions[PROFILE_SETTINGS_COUNT] = {};
+	HotkeyOptions* profileHotkeyOptions[PROFILE_SETTINGS_COUNT] = {};
 };
 
 #endif
@@ -15,6 +15,43 @@ namespace System {
     // Returns the about of heap memory currently allocated in bytes
     uint32_t getUsedHeap();
 
+    // Fills the unused part of a core's stack with a known pattern so its high-water mark can be measured later
+    // Core 0 is painted below the current stack pointer, core 1 must be painted before it is launched
+    void paintStack(uint32_t core);
+    // Returns the size of a core's stack in bytes
+    uint32_t getStackSize(uint32_t core);
+    // Returns the deepest stack usage observed on a core since it was painted in bytes
+    uint32_t getStackHighWaterMark(uint32_t core);
+    // Periodically checks the calling core's stack and panics if less than STACK_PANIC_MARGIN bytes were left free
+    void checkStack();
+
+    // Sleeps with WFE until the supplied time in microseconds since boot and accounts it as idle time of the calling core
+    // Returns true if the wait was cut short by an edge on one of the wake pins
+    bool idleUntil(uint64_t us);
+    // Lets an edge on any of the supplied GPIO pins wake both cores and restore full clock speed
+    void setWakePins(uint32_t pinMask);
+    // Closes the calling core's current load sample once it is complete, call once per loop iteration
+    void updateLoad();
+    // Returns the share of time a core was busy in the last second, or since boot if that is shorter, in tenths of a percent
+    uint32_t getLoad1s(uint32_t core);
+    // Returns the share of time a core was busy in the last ten seconds, in tenths of a percent
+    uint32_t getLoad10s(uint32_t core);
+    // Keeps the load figures of both cores in watchdog scratch registers, so the next boot can show them
+    void keepLoadForReboot();
+    // Returns the load figures kept before the last watchdog reboot, or false if there are none
+    // Core0 only, the registers are taken on the first call and later calls return the same figures
+    bool getPreviousLoad(uint32_t core, uint32_t& load1s, uint32_t& load10s);
+
+    // Prepares clk_sys for divider scaling, moving clk_peri onto pll_sys so UART and SPI baud rates are unaffected
+    // I2C, PWM and PIO stay on clk_sys and slow down with it
+    // Returns false if clk_sys is not driven directly by pll_sys and cannot be scaled
+    bool initClockScaling();
+    // Runs clk_sys at pll_sys divided by the supplied integer divider, 1 is full speed
+    void setClockDivider(uint32_t divider);
+    uint32_t getClockDivider();
+    // Returns the clk_sys frequency at a divider of 1 in Hz
+    uint32_t getFullClockHz();
+
     enum class BootMode : uint32_t {
         DEFAULT = 0,
         GAMEPAD = 0x43d566cd,
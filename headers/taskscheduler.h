@@ -0,0 +1,44 @@
+#ifndef _TASKSCHEDULER_H_
+#define _TASKSCHEDULER_H_
+
+#include "gpaddon.h"
+#include "crosscore.h"
+
+#include <vector>
+
+struct TaskStats {
+    uint32_t runs;
+    uint32_t overruns;      // times the task was dispatched more than one period late
+    uint32_t lastRunUs;
+    uint32_t maxRunUs;
+};
+
+struct ScheduledTask {
+    GPAddon * addon;
+    uint32_t periodUs;
+    uint64_t deadline;      // microseconds since boot
+    TaskStats stats;
+};
+
+// Cooperative scheduler for the core1 addons, each addon runs once per period in deadline order.
+// Tasks are only added during core1 setup, after that core0 may read them for the web config.
+class TaskScheduler {
+public:
+    TaskScheduler(TaskScheduler const&) = delete;
+    void operator=(TaskScheduler const&) = delete;
+    static TaskScheduler& getInstance()
+    {
+        static TaskScheduler instance;
+        return instance;
+    }
+
+    void AddTask(GPAddon*, uint32_t periodUs);
+    uint64_t RunTasks();    // run every task that is due when called, returns the next deadline
+    void DispatchEvent(const GamepadEvent&); // hand a core0 event to every task
+    const std::vector<ScheduledTask>& GetTasks() const { return tasks; }
+private:
+    TaskScheduler() {}
+    std::vector<ScheduledTask> tasks;
+};
+
+#endif
@@ -137,7 +137,7 @@
 //------------- CLASS -------------//
 #define CFG_TUD_CDC              0
 #define CFG_TUD_ECM_RNDIS        1
-#define CFG_TUD_HID              2
+#define CFG_TUD_HID              3 // gamepad, keyboard and consumer control in composite HID mode
 
 //--------------------------------------------------------------------
 // HOST CONFIGURATION
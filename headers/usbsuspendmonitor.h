@@ -0,0 +1,18 @@
+#ifndef _USBSUSPENDMONITOR_H_
+#define _USBSUSPENDMONITOR_H_
+
+// Follows the host's bus suspend on core0 and tells core1 about every change
+//
+// Core1 blanks its outputs on USB_SUSPEND and restores them on USB_RESUME, so the state only moves
+// once its event is queued. A full queue is retried on the next update. The bus state is passed in
+// so the state machine can be replayed from a recorded sequence.
+class UsbSuspendMonitor {
+public:
+    UsbSuspendMonitor() : suspended(false) {}
+    bool update(bool busSuspended); // returns whether core1 was told the bus is suspended
+    bool isSuspended() const { return suspended; }
+private:
+    bool suspended;
+};
+
+#endif
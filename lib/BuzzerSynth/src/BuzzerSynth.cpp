@@ -0,0 +1,174 @@
+#include "BuzzerSynth.h"
+
+#include <atomic>
+
+#define BUZZER_SYNTH_ENVELOPE_MAX (1u << 24)
+#define BUZZER_SYNTH_QUEUE_MASK (BUZZER_SYNTH_QUEUE_SIZE - 1)
+
+static_assert((BUZZER_SYNTH_QUEUE_SIZE & BUZZER_SYNTH_QUEUE_MASK) == 0, "BUZZER_SYNTH_QUEUE_SIZE must be a power of two");
+
+static uint32_t envelopeStep(uint32_t range, uint32_t samples)
+{
+	return samples == 0 ? range : (range + samples - 1) / samples;
+}
+
+void BuzzerSynth::init(uint32_t sampleRate, uint16_t maxLevel, const BuzzerEnvelope& envelope)
+{
+	this->sampleRate = sampleRate;
+	voiceLevel = maxLevel / BUZZER_SYNTH_VOICES;
+
+	sustainLevel = (BUZZER_SYNTH_ENVELOPE_MAX >> 8) * envelope.sustain;
+	attackStep = envelopeStep(BUZZER_SYNTH_ENVELOPE_MAX, msToSamples(envelope.attackMs));
+	decayStep = envelopeStep(BUZZER_SYNTH_ENVELOPE_MAX - sustainLevel, msToSamples(envelope.decayMs));
+	releaseStep = envelopeStep(BUZZER_SYNTH_ENVELOPE_MAX, msToSamples(envelope.releaseMs));
+
+	for (Voice& voice : voices)
+		voice = { };
+	nextVoice = 0;
+	waitSamples = 0;
+	head = 0;
+	tail = 0;
+	stopHead = 0;
+	stopRequested = false;
+}
+
+bool BuzzerSynth::queue(const BuzzerNote& note)
+{
+	const uint32_t index = head;
+	if (index - tail >= BUZZER_SYNTH_QUEUE_SIZE)
+		return false;
+
+	notes[index & BUZZER_SYNTH_QUEUE_MASK] = note;
+	// The note has to be in place before render() can see it
+	std::atomic_signal_fence(std::memory_order_release);
+	head = index + 1;
+	return true;
+}
+
+void BuzzerSynth::stop()
+{
+	// Notes queued after this call still play
+	stopHead = head;
+	stopRequested = true;
+}
+
+bool BuzzerSynth::isIdle() const
+{
+	if (head != tail)
+		return false;
+	for (const Voice& voice : voices) {
+		if (voice.stage != Stage::OFF)
+			return false;
+	}
+	return true;
+}
+
+void BuzzerSynth::render(uint16_t* samples, uint32_t count)
+{
+	if (stopRequested) {
+		stopRequested = false;
+		tail = stopHead;
+		waitSamples = 0;
+		for (Voice& voice : voices) {
+			if (voice.stage != Stage::OFF)
+				voice.stage = Stage::RELEASE;
+		}
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		while (waitSamples == 0 && tail != head) {
+			std::atomic_signal_fence(std::memory_order_acquire);
+			startNote(notes[tail & BUZZER_SYNTH_QUEUE_MASK]);
+			tail = tail + 1;
+		}
+		if (waitSamples > 0)
+			waitSamples--;
+
+		uint32_t level = 0;
+		for (Voice& voice : voices) {
+			if (voice.stage == Stage::OFF)
+				continue;
+
+			updateEnvelope(voice);
+			if (voice.phase & 0x80000000u) {
+				const uint32_t amplitude = ((voice.level >> 8) * voice.velocity) >> 8;
+				level += (amplitude * voiceLevel) >> 16;
+			}
+			voice.phase += voice.phaseStep;
+		}
+		samples[i] = level;
+	}
+}
+
+void BuzzerSynth::startNote(const BuzzerNote& note)
+{
+	waitSamples = msToSamples(note.advanceMs);
+	if (note.frequency == 0 || note.velocity == 0)
+		return;
+
+	// Take a free voice, otherwise steal the oldest one
+	uint8_t index = nextVoice;
+	for (uint8_t v = 0; v < BUZZER_SYNTH_VOICES; v++) {
+		if (voices[v].stage == Stage::OFF) {
+			index = v;
+			break;
+		}
+	}
+	nextVoice = (index + 1) % BUZZER_SYNTH_VOICES;
+
+	Voice& voice = voices[index];
+	voice.phase = 0;
+	voice.phaseStep = (uint32_t)(((uint64_t)note.frequency << 32) / sampleRate);
+	voice.level = 0;
+	voice.gateSamples = msToSamples(note.durationMs);
+	voice.velocity = note.velocity;
+	voice.stage = Stage::ATTACK;
+}
+
+void BuzzerSynth::updateEnvelope(Voice& voice)
+{
+	if (voice.stage != Stage::RELEASE) {
+		if (voice.gateSamples == 0)
+			voice.stage = Stage::RELEASE;
+		else
+			voice.gateSamples--;
+	}
+
+	switch (voice.stage)
+	{
+		case Stage::ATTACK:
+			if (BUZZER_SYNTH_ENVELOPE_MAX - voice.level <= attackStep) {
+				voice.level = BUZZER_SYNTH_ENVELOPE_MAX;
+				voice.stage = Stage::DECAY;
+			} else {
+				voice.level += attackStep;
+			}
+			break;
+
+		case Stage::DECAY:
+			if (voice.level <= sustainLevel + decayStep) {
+				voice.level = sustainLevel;
+				voice.stage = Stage::SUSTAIN;
+			} else {
+				voice.level -= decayStep;
+			}
+			break;
+
+		case Stage::RELEASE:
+			if (voice.level <= releaseStep) {
+				voice.level = 0;
+				voice.stage = Stage::OFF;
+			} else {
+				voice.level -= releaseStep;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+uint32_t BuzzerSynth::msToSamples(uint32_t ms) const
+{
+	return (uint32_t)(((uint64_t)ms * sampleRate) / 1000);
+}
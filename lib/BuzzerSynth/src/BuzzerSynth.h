@@ -0,0 +1,88 @@
+#ifndef BUZZER_SYNTH_H_
+#define BUZZER_SYNTH_H_
+
+#include <stdint.h>
+
+// Square wave synthesizer with a few ADSR voices, rendering PWM levels for the buzzer.
+//
+// Notes are queued by the owner and started by the renderer in queue order. Each note holds
+// back the next one for advanceMs, so an advance of 0 builds a chord and a frequency of 0 is
+// a rest. The queue is single producer / single consumer: queue() and stop() are called from
+// thread context, render() from the interrupt that refills the output buffers.
+//
+// Nothing in here depends on the pico-sdk, songs can be rendered off target as well.
+
+#define BUZZER_SYNTH_VOICES 3
+#define BUZZER_SYNTH_QUEUE_SIZE 32 // power of two
+
+struct BuzzerNote
+{
+	uint16_t frequency;  // Hz, 0 is a rest
+	uint16_t durationMs; // time until the release starts
+	uint16_t advanceMs;  // time until the next note starts
+	uint8_t velocity;    // 0-255
+};
+
+struct BuzzerEnvelope
+{
+	uint16_t attackMs;
+	uint16_t decayMs;
+	uint8_t sustain;     // level held after the decay, 0-255 of the peak
+	uint16_t releaseMs;
+};
+
+class BuzzerSynth
+{
+public:
+	// maxLevel is the output level with every voice at its peak
+	void init(uint32_t sampleRate, uint16_t maxLevel, const BuzzerEnvelope& envelope);
+	// Returns false if the queue is full
+	bool queue(const BuzzerNote& note);
+	// Drops the queued notes and releases the playing ones
+	void stop();
+	bool isIdle() const;
+	void render(uint16_t* samples, uint32_t count);
+
+private:
+	enum class Stage : uint8_t
+	{
+		OFF,
+		ATTACK,
+		DECAY,
+		SUSTAIN,
+		RELEASE,
+	};
+
+	struct Voice
+	{
+		uint32_t phase;
+		uint32_t phaseStep;
+		uint32_t level;       // envelope level, BUZZER_SYNTH_ENVELOPE_MAX at the peak
+		uint32_t gateSamples; // samples until the release starts
+		uint8_t velocity;
+		Stage stage;
+	};
+
+	void startNote(const BuzzerNote& note);
+	void updateEnvelope(Voice& voice);
+	uint32_t msToSamples(uint32_t ms) const;
+
+	uint32_t sampleRate;
+	uint16_t voiceLevel;
+	uint32_t attackStep;
+	uint32_t decayStep;
+	uint32_t sustainLevel;
+	uint32_t releaseStep;
+
+	Voice voices[BUZZER_SYNTH_VOICES];
+	uint8_t nextVoice;
+	uint32_t waitSamples;  // samples until the next queued note may start
+
+	BuzzerNote notes[BUZZER_SYNTH_QUEUE_SIZE];
+	volatile uint32_t head; // written by queue()
+	volatile uint32_t tail; // written by render()
+	volatile uint32_t stopHead; // queue position up to which stop() drops notes
+	volatile bool stopRequested;
+};
+
+#endif
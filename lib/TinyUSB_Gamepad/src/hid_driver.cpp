@@ -37,6 +37,14 @@ bool send_keyboard_report(void *report)
 	return false;
 }
 
+bool send_hid_instance_report(uint8_t instance, void *report, uint8_t report_size)
+{
+	if (tud_hid_n_ready(instance))
+		return tud_hid_n_report(instance, 0, report, report_size);
+
+	return false;
+}
+
 bool hid_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const * request)
 {
 	if (
@@ -46,6 +54,8 @@ bool hid_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t c
 		request->wValue == 0x0300
 	)
 	{
+		if (stage == CONTROL_STAGE_SETUP)
+			notify_usb_host_event(USB_HOST_EVENT_PS3_FEATURE_REQUEST);
 		return tud_control_xfer(rhport, request, (void *) magic_init_bytes, sizeof(magic_init_bytes));
 	}
 	else
@@ -22,6 +22,28 @@ UsbMode usb_mode = USB_MODE_HID;
 InputMode input_mode = INPUT_MODE_XINPUT;
 bool usb_mounted = false;
 
+// Time the host is given to notice a detach before we reattach with new descriptors
+#define USB_REENUMERATE_DELAY_MS 100
+
+// PS4 output report that carries rumble and the lightbar colour
+#define PS4_OUTPUT_REPORT_ID 0x05
+#define PS4_OUTPUT_LIGHTBAR_OFFSET 5 // red, green, blue, counted after the report ID
+
+static bool reconnect_pending = false;
+static absolute_time_t reconnect_time;
+static uint8_t ps4_lightbar[3] = { };
+static bool ps4_lightbar_set = false;
+static UsbHostEventCallback host_event_callback = nullptr;
+static bool remote_wakeup_enabled = false;
+
+// Every input report has to fit the change detection buffer in send_report
+static_assert(sizeof(HIDReport) <= CFG_TUD_ENDPOINT0_SIZE, "HID report too large");
+static_assert(sizeof(SwitchReport) <= CFG_TUD_ENDPOINT0_SIZE, "Switch report too large");
+static_assert(sizeof(XInputReport) <= CFG_TUD_ENDPOINT0_SIZE, "XInput report too large");
+static_assert(sizeof(PS4Report) <= CFG_TUD_ENDPOINT0_SIZE, "PS4 report too large");
+static_assert(sizeof(KeyboardReport) <= CFG_TUD_ENDPOINT0_SIZE, "Keyboard report too large");
+static_assert(HID_GENERIC_MAX_REPORT_SIZE <= CFG_TUD_ENDPOINT0_SIZE, "Generic HID report too large");
+
 InputMode get_input_mode(void)
 {
 	return input_mode;
@@ -41,6 +63,33 @@ void initialize_driver(InputMode mode)
 	tud_init(TUD_OPT_RHPORT);
 }
 
+void set_usb_host_event_callback(UsbHostEventCallback callback)
+{
+	host_event_callback = callback;
+}
+
+void notify_usb_host_event(UsbHostEvent event)
+{
+	if (host_event_callback != nullptr)
+		host_event_callback(event);
+}
+
+static bool is_ps4_auth_report(uint8_t report_id)
+{
+	switch (report_id)
+	{
+		case PS4AuthReport::PS4_UNKNOWN_0X03:
+		case PS4AuthReport::PS4_SET_AUTH_PAYLOAD:
+		case PS4AuthReport::PS4_GET_SIGNATURE_NONCE:
+		case PS4AuthReport::PS4_GET_SIGNING_STATE:
+		case PS4AuthReport::PS4_RESET_AUTH:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
 void receive_report(uint8_t *buffer)
 {
 	if (input_mode == INPUT_MODE_XINPUT)
@@ -54,8 +103,17 @@ void send_report(void *report, uint16_t report_size)
 {
 	static uint8_t previous_report[CFG_TUD_ENDPOINT0_SIZE] = { };
 
+	if (reconnect_pending || report_size > sizeof(previous_report))
+		return;
+
+	// Nothing goes out while the bus is suspended. A changed report signals resume once per suspend if
+	// the host allowed remote wakeup, the report itself is sent after the host has resumed the bus.
 	if (tud_suspended())
-		tud_remote_wakeup();
+	{
+		if (remote_wakeup_enabled && memcmp(previous_report, report, report_size) != 0 && tud_remote_wakeup())
+			remote_wakeup_enabled = false;
+		return;
+	}
 
 	if (memcmp(previous_report, report, report_size) != 0)
 	{
@@ -79,29 +137,161 @@ void send_report(void *report, uint16_t report_size)
 	}
 }
 
+// Each key interface has its own endpoint and only sends when its report changed
+void send_composite_keys(const HIDCompositeKeys *keys)
+{
+	static HIDCompositeKeys previous_keys = { };
+
+	if (reconnect_pending)
+		return;
+
+	if (memcmp(previous_keys.keycode, keys->keycode, sizeof(keys->keycode)) != 0 &&
+		send_hid_instance_report(HID_COMPOSITE_KEYBOARD_INSTANCE, (void *)keys->keycode, sizeof(keys->keycode)))
+	{
+		memcpy(previous_keys.keycode, keys->keycode, sizeof(keys->keycode));
+	}
+
+	if (previous_keys.consumer != keys->consumer &&
+		send_hid_instance_report(HID_COMPOSITE_CONSUMER_INSTANCE, (void *)&keys->consumer, sizeof(keys->consumer)))
+	{
+		previous_keys.consumer = keys->consumer;
+	}
+}
+
 /* USB Driver Callback (Required for XInput) */
 
+// Class driver for the current input mode
+static const usbd_class_driver_t *gamepad_class_driver(void)
+{
+	switch (input_mode)
+	{
+		case INPUT_MODE_XINPUT:
+			return &xinput_driver;
+
+		case INPUT_MODE_PS4:
+			return &ps4_driver;
+
+		default:
+			return &hid_driver;
+	}
+}
+
+// TinyUSB caches the app driver table in tud_init, so gamepad modes are served through
+// a proxy that forwards to whichever driver matches input_mode at the time of the call
+static void gamepad_driver_init(void)
+{
+	xinput_driver.init();
+	hid_driver.init();
+	ps4_driver.init();
+}
+
+static void gamepad_driver_reset(uint8_t rhport)
+{
+	gamepad_class_driver()->reset(rhport);
+}
+
+static uint16_t gamepad_driver_open(uint8_t rhport, tusb_desc_interface_t const *itf_descriptor, uint16_t max_length)
+{
+	return gamepad_class_driver()->open(rhport, itf_descriptor, max_length);
+}
+
+static bool gamepad_driver_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request)
+{
+	return gamepad_class_driver()->control_xfer_cb(rhport, stage, request);
+}
+
+static bool gamepad_driver_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes)
+{
+	return gamepad_class_driver()->xfer_cb(rhport, ep_addr, result, xferred_bytes);
+}
+
+static const usbd_class_driver_t gamepad_driver = {
+#if CFG_TUSB_DEBUG >= 2
+	.name = "GAMEPAD",
+#endif
+	.init = gamepad_driver_init,
+	.reset = gamepad_driver_reset,
+	.open = gamepad_driver_open,
+	.control_xfer_cb = gamepad_driver_control_xfer_cb,
+	.xfer_cb = gamepad_driver_xfer_cb,
+	.sof = NULL};
+
 const usbd_class_driver_t *usbd_app_driver_get_cb(uint8_t *driver_count)
 {
 	*driver_count = 1;
 
 	if (usb_mode == USB_MODE_NET)
-	{
 		return &net_driver;
-	}
 	else
+		return &gamepad_driver;
+}
+
+bool switch_input_mode(InputMode mode)
+{
+	if (usb_mode != USB_MODE_HID || mode == INPUT_MODE_CONFIG || mode == input_mode)
+		return false;
+
+	// Detach first so the host stops polling, then let the old driver drop its endpoint state
+	tud_disconnect();
+	gamepad_class_driver()->reset(TUD_OPT_RHPORT);
+
+	input_mode = mode;
+	usb_mounted = false;
+	ps4_lightbar_set = false;
+	reconnect_pending = true;
+	reconnect_time = make_timeout_time_ms(USB_REENUMERATE_DELAY_MS);
+	return true;
+}
+
+void reconnect_usb(uint32_t delay_ms)
+{
+	if (usb_mode != USB_MODE_HID)
+		return;
+
+	tud_disconnect();
+	gamepad_class_driver()->reset(TUD_OPT_RHPORT);
+
+	usb_mounted = false;
+	ps4_lightbar_set = false;
+	reconnect_pending = true;
+	reconnect_time = make_timeout_time_ms(delay_ms > USB_REENUMERATE_DELAY_MS ? delay_ms : USB_REENUMERATE_DELAY_MS);
+}
+
+bool get_ps4_lightbar(uint8_t *rgb)
+{
+	if (!ps4_lightbar_set)
+		return false;
+
+	memcpy(rgb, ps4_lightbar, sizeof(ps4_lightbar));
+	return true;
+}
+
+// Output reports come in on the OUT endpoint with the report ID in the data, or as SET_REPORT without it
+static void store_ps4_lightbar(uint8_t report_id, uint8_t const *buffer, uint16_t bufsize)
+{
+	if (report_id == 0 && bufsize > 0 && buffer[0] == PS4_OUTPUT_REPORT_ID)
 	{
-		switch (input_mode)
-		{
-			case INPUT_MODE_XINPUT:
-				return &xinput_driver;
+		buffer++;
+		bufsize--;
+	}
+	else if (report_id != PS4_OUTPUT_REPORT_ID)
+	{
+		return;
+	}
 
-			case INPUT_MODE_PS4:
-				return &ps4_driver;
+	if (bufsize < PS4_OUTPUT_LIGHTBAR_OFFSET + sizeof(ps4_lightbar))
+		return;
 
-			default:
-				return &hid_driver;
-		}
+	memcpy(ps4_lightbar, &buffer[PS4_OUTPUT_LIGHTBAR_OFFSET], sizeof(ps4_lightbar));
+	ps4_lightbar_set = true;
+}
+
+void usb_reconnect_task(void)
+{
+	if (reconnect_pending && time_reached(reconnect_time))
+	{
+		reconnect_pending = false;
+		tud_connect();
 	}
 }
 
@@ -113,40 +303,51 @@ const usbd_class_driver_t *usbd_app_driver_get_cb(uint8_t *driver_count)
 uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen)
 {
 	// TODO: Handle the correct report type, if required
-	(void)itf;
-
-	uint8_t report_size = 0;
-	SwitchReport switch_report;
-	HIDReport hid_report;
-	KeyboardReport keyboard_report;
-	PS4Report ps4_report;
+	if (report_type == HID_REPORT_TYPE_FEATURE && is_ps4_auth_report(report_id))
+		notify_usb_host_event(USB_HOST_EVENT_PS4_AUTH_REQUEST);
+
+	uint16_t report_size = 0;
+	SwitchReport switch_report = { };
+	HIDReport hid_report = { };
+	KeyboardReport keyboard_report = { };
+	PS4Report ps4_report = { };
 	switch (input_mode)
 	{
 		case INPUT_MODE_SWITCH:
 			report_size = sizeof(SwitchReport);
-			memcpy(buffer, &switch_report, report_size);
+			memcpy(buffer, &switch_report, TU_MIN(report_size, reqlen));
 			break;
 		case INPUT_MODE_KEYBOARD:
 			report_size = report_id == KEYBOARD_KEY_REPORT_ID ? sizeof(KeyboardReport::keycode) : sizeof(KeyboardReport::multimedia);
 			memcpy(buffer, report_id == KEYBOARD_KEY_REPORT_ID ?
-				(void*) keyboard_report.keycode : (void*) &keyboard_report.multimedia, report_size);
+				(void*) keyboard_report.keycode : (void*) &keyboard_report.multimedia, TU_MIN(report_size, reqlen));
 			break;
 		case INPUT_MODE_PS4:
 			if ( report_type == HID_REPORT_TYPE_FEATURE ) {
-				// Get feature report (for Auth)
-				report_size = get_ps4_report(report_id, buffer, reqlen);
+				// Get feature report (for Auth), a negative length stalls the request
+				ssize_t feature_size = get_ps4_report(report_id, buffer, reqlen);
+				report_size = feature_size > 0 ? feature_size : 0;
 			} else {
 				report_size = sizeof(PS4Report);
-				memcpy(buffer, &ps4_report, report_size);
+				memcpy(buffer, &ps4_report, TU_MIN(report_size, reqlen));
 			}
 			break;
 		default:
-			report_size = sizeof(HIDReport);
-			memcpy(buffer, &hid_report, report_size);
+			if (HIDComposite::isEnabled() && itf != HID_COMPOSITE_GAMEPAD_INSTANCE) {
+				report_size = itf == HID_COMPOSITE_KEYBOARD_INSTANCE ? HID_COMPOSITE_KEYBOARD_REPORT_SIZE : HID_COMPOSITE_CONSUMER_REPORT_SIZE;
+				memset(buffer, 0, TU_MIN(report_size, reqlen));
+			} else if (HIDGeneric::isEnabled()) {
+				report_size = HIDGeneric::getLayout().reportSize;
+				memset(buffer, 0, TU_MIN(report_size, reqlen));
+			} else {
+				report_size = sizeof(HIDReport);
+				memcpy(buffer, &hid_report, TU_MIN(report_size, reqlen));
+			}
 			break;
 	}
 
-	return report_size;
+	// Never report more than the host asked for
+	return TU_MIN(report_size, reqlen);
 }
 
 // Invoked when received SET_REPORT control request or
@@ -154,11 +355,16 @@ uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t
 void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize)
 {
 	(void) itf;
+
+	if (report_type == HID_REPORT_TYPE_FEATURE && is_ps4_auth_report(report_id))
+		notify_usb_host_event(USB_HOST_EVENT_PS4_AUTH_REQUEST);
 	switch (input_mode)
 	{
 		case INPUT_MODE_PS4:
 			if ( report_type == HID_REPORT_TYPE_FEATURE ) {
 				set_ps4_report(report_id, buffer, bufsize);
+			} else {
+				store_ps4_lightbar(report_id, buffer, bufsize);
 			}
 			break;
 	}
@@ -174,12 +380,14 @@ void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t rep
 void tud_mount_cb(void)
 {
 	usb_mounted = true;
+	notify_usb_host_event(USB_HOST_EVENT_MOUNTED);
 }
 
 // Invoked when device is unmounted
 void tud_umount_cb(void)
 {
 	usb_mounted = false;
+	remote_wakeup_enabled = false;
 }
 
 // Invoked when usb bus is suspended
@@ -187,10 +395,11 @@ void tud_umount_cb(void)
 // Within 7ms, device must draw an average of current less than 2.5 mA from bus
 void tud_suspend_cb(bool remote_wakeup_en)
 {
-	(void)remote_wakeup_en;
+	remote_wakeup_enabled = remote_wakeup_en;
 }
 
 // Invoked when usb bus is resumed
 void tud_resume_cb(void)
 {
+	remote_wakeup_enabled = false;
 }
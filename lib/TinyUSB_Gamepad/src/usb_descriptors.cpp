@@ -22,6 +22,10 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
 	}
 	else
 	{
+		// Only Windows asks for the MS OS descriptor
+		if (index == 0xEE)
+			notify_usb_host_event(USB_HOST_EVENT_MS_OS_DESCRIPTOR);
+
 		uint16_t size = 0;
 		return getStringDescriptor(&size, get_input_mode(), index);
 	}
@@ -58,7 +62,6 @@ uint8_t const *tud_descriptor_device_cb(void)
 // Descriptor contents must exist long enough for transfer to complete
 uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
 {
-	(void) itf;
 	switch (get_input_mode())
 	{
 		case INPUT_MODE_SWITCH:
@@ -72,6 +75,14 @@ uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
 			return keyboard_report_descriptor;
 
 		default:
+			if (HIDComposite::isEnabled()) {
+				uint16_t size = 0;
+				return HIDComposite::getReportDescriptor(itf, &size);
+			}
+			if (HIDGeneric::isEnabled()) {
+				uint16_t size = 0;
+				return HIDGeneric::getReportDescriptor(&size);
+			}
 			return hid_report_descriptor;
 	}
 }
@@ -99,6 +110,12 @@ uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
 			return keyboard_configuration_descriptor;
 
 		default:
+			if (HIDComposite::isEnabled()) {
+				uint16_t size = 0;
+				return HIDComposite::getConfigurationDescriptor(&size);
+			}
+			if (HIDGeneric::isEnabled())
+				return HIDGeneric::getConfigurationDescriptor();
 			return hid_configuration_descriptor;
 	}
 }
\ No newline at end of file
@@ -14,9 +14,28 @@ typedef enum
 	USB_MODE_NET,
 } UsbMode;
 
+// Host behaviour the input mode detector listens for
+typedef enum
+{
+	USB_HOST_EVENT_MOUNTED,
+	USB_HOST_EVENT_MS_OS_DESCRIPTOR,    // Windows asked for the MS OS string descriptor
+	USB_HOST_EVENT_XINPUT_OUT_REPORT,   // LED/rumble data on the XInput OUT endpoint
+	USB_HOST_EVENT_PS3_FEATURE_REQUEST, // PS3 GET_REPORT for the PS button enable bytes
+	USB_HOST_EVENT_PS4_AUTH_REQUEST,    // feature report used by PS4 controller authentication
+} UsbHostEvent;
+
+typedef void (*UsbHostEventCallback)(UsbHostEvent event);
+
 InputMode get_input_mode(void);
 bool get_usb_mounted(void);
 void initialize_driver(InputMode mode);
+bool switch_input_mode(InputMode mode); // detach, swap descriptors and class driver, then reattach
+void reconnect_usb(uint32_t delay_ms);  // detach and reattach in the same mode once delay_ms has passed
+void usb_reconnect_task(void);
+bool get_ps4_lightbar(uint8_t *rgb);    // last lightbar colour set by a PS4 host, false until one arrives
+void set_usb_host_event_callback(UsbHostEventCallback callback);
+void notify_usb_host_event(UsbHostEvent event);
 void receive_report(uint8_t *buffer);
 void send_report(void *report, uint16_t report_size);
+void send_composite_keys(const HIDCompositeKeys *keys); // keyboard and consumer interfaces of composite HID mode
 
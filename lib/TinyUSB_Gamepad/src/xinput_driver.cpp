@@ -4,6 +4,7 @@
  */
 
 #include "xinput_driver.h"
+#include "usb_driver.h"
 
 uint8_t endpoint_in = 0;
 uint8_t endpoint_out = 0;
@@ -46,6 +47,8 @@ static void xinput_init(void)
 static void xinput_reset(uint8_t rhport)
 {
 	(void)rhport;
+	// Forget the last LED/rumble command, the host sends a new one after the next mount
+	memset(xinput_out_buffer, 0, XINPUT_OUT_SIZE);
 }
 
 static uint16_t xinput_open(uint8_t rhport, tusb_desc_interface_t const *itf_descriptor, uint16_t max_length)
@@ -100,7 +103,10 @@ static bool xinput_xfer_callback(uint8_t rhport, uint8_t ep_addr, xfer_result_t
 	(void)xferred_bytes;
 
 	if (ep_addr == endpoint_out)
+	{
+		notify_usb_host_event(USB_HOST_EVENT_XINPUT_OUT_REPORT);
 		usbd_edpt_xfer(0, endpoint_out, xinput_out_buffer, XINPUT_OUT_SIZE);
+	}
 
 	return true;
 }
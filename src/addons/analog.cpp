@@ -1,5 +1,6 @@
 #include "addons/analog.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "helper.h"
 #include "config.pb.h"
 
@@ -21,16 +22,16 @@ void AnalogInput::setup() {
     const AnalogOptions& analogOptions = Storage::getInstance().getAddonOptions().analogOptions;
 
     // Make sure GPIO is high-impedance, no pullups etc
-    if ( isValidPin(analogOptions.analogAdc1PinX) ) {
+    if ( isValidPin(analogOptions.analogAdc1PinX) && PinRegistry::getInstance().claim(analogOptions.analogAdc1PinX, AnalogName) ) {
         adc_gpio_init(analogOptions.analogAdc1PinX);
     }
-    if ( isValidPin(analogOptions.analogAdc1PinY) ) {
+    if ( isValidPin(analogOptions.analogAdc1PinY) && PinRegistry::getInstance().claim(analogOptions.analogAdc1PinY, AnalogName) ) {
         adc_gpio_init(analogOptions.analogAdc1PinY);
     }
-    if ( isValidPin(analogOptions.analogAdc2PinX) ) {
+    if ( isValidPin(analogOptions.analogAdc2PinX) && PinRegistry::getInstance().claim(analogOptions.analogAdc2PinX, AnalogName) ) {
         adc_gpio_init(analogOptions.analogAdc2PinX);
     }
-    if ( isValidPin(analogOptions.analogAdc2PinY) ) {
+    if ( isValidPin(analogOptions.analogAdc2PinY) && PinRegistry::getInstance().claim(analogOptions.analogAdc2PinY, AnalogName) ) {
         adc_gpio_init(analogOptions.analogAdc2PinY);
     }
 	
@@ -1,6 +1,7 @@
 #include "addons/board_led.h"
 #include "usb_driver.h" // Required to check USB state
 #include "helper.h"
+#include "pinregistry.h"
 #include "config.pb.h"
 
 bool BoardLedAddon::available() {
@@ -15,10 +16,22 @@ void BoardLedAddon::setup() {
     timeSinceBlink = getMillis();
     prevState = -1;
 
+    if (!PinRegistry::getInstance().claim(BOARD_LED_PIN, OnBoardLedName)) {
+        // Another feature drives the pin
+        onBoardLedMode = OnBoardLedMode::ON_BOARD_LED_MODE_OFF;
+        return;
+    }
     gpio_init(BOARD_LED_PIN);
     gpio_set_dir(BOARD_LED_PIN, GPIO_OUT);
 }
 
+void BoardLedAddon::handleEvent(const GamepadEvent& event) {
+    if (event.type == GamepadEventType::USB_SUSPEND && onBoardLedMode != OnBoardLedMode::ON_BOARD_LED_MODE_OFF) {
+        gpio_put(BOARD_LED_PIN, 0);
+        prevState = 0;
+    }
+}
+
 void BoardLedAddon::process() {
     bool state = 0;
     Gamepad * processedGamepad;
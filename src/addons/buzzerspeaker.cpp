@@ -1,12 +1,46 @@
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "hardware/pwm.h"
 #include "addons/buzzerspeaker.h"
 #include "songs.h"
 #include "storagemanager.h"
-#include "math.h"
+#include "pinregistry.h"
 #include "usb_driver.h"
 #include "helper.h"
 #include "config.pb.h"
 
+#include <algorithm>
+
+// Shared with the DMA interrupt, which refills whichever buffer has just been played
+static BuzzerSynth synth;
+static uint16_t buffers[2][BUZZER_BUFFER_SAMPLES];
+static int dmaChannels[2];
+static dma_channel_config dmaConfigs[2];
+static volatile bool outputRunning = false;
+
+static void __isr buzzerDmaIRQ() {
+	for (uint32_t i = 0; i < 2; i++) {
+		if (dma_channel_get_irq1_status(dmaChannels[i])) {
+			dma_channel_acknowledge_irq1(dmaChannels[i]);
+			if (!outputRunning) {
+				// The last buffer has played out, startOutput() takes it from here
+			} else if (synth.isIdle()) {
+				// The buffer playing now ends in silence, let the output stop after it instead of
+				// waking up for nothing ~94 times a second
+				dma_channel_config lastConfig = dmaConfigs[1 - i];
+				channel_config_set_chain_to(&lastConfig, dmaChannels[1 - i]);
+				dma_channel_set_config(dmaChannels[1 - i], &lastConfig, false);
+				outputRunning = false;
+			} else {
+				// The other channel is playing now, rearm this one for when it is chained again
+				dma_channel_set_read_addr(dmaChannels[i], buffers[i], false);
+				synth.render(buffers[i], BUZZER_BUFFER_SAMPLES);
+			}
+		}
+	}
+}
+
 bool BuzzerSpeakerAddon::available() {
     const BuzzerOptions& options = Storage::getInstance().getAddonOptions().buzzerOptions;
 	return options.enabled && isValidPin(options.pin);
@@ -15,12 +49,143 @@ bool BuzzerSpeakerAddon::available() {
 void BuzzerSpeakerAddon::setup() {
 	const BuzzerOptions& options = Storage::getInstance().getAddonOptions().buzzerOptions;
 	buzzerPin = options.pin;
+	buzzerVolume = options.volume;
+	cueMask = options.cueMask;
+	currentSong = NULL;
+	currentTonePosition = 0;
+	currentSongLength = 0;
+	introPlayed = false;
+
+	if (!PinRegistry::getInstance().claim(buzzerPin, BuzzerSpeakerName)) {
+		// Another feature owns the pin, stay silent
+		cueMask = 0;
+		introPlayed = true;
+		return;
+	}
 	gpio_set_function(buzzerPin, GPIO_FUNC_PWM);
 	buzzerPinSlice = pwm_gpio_to_slice_num (buzzerPin);
-	buzzerPinChannel = pwm_gpio_to_channel (buzzerPin);
 
-	buzzerVolume = options.volume;
-	introPlayed = false;
+	setupOutput();
+}
+
+// Two chained DMA channels write the synthesizer output to the PWM compare register, one
+// sample per DMA timer tick. Both timer and PWM carrier run from clk_sys, so the sample rate
+// is derived from the real system clock (120 MHz with the keyboard host add-on).
+void BuzzerSpeakerAddon::setupOutput() {
+	pwm_config pwmConfig = pwm_get_default_config();
+	pwm_config_set_wrap(&pwmConfig, BUZZER_PWM_WRAP);
+	pwm_init(buzzerPinSlice, &pwmConfig, true);
+
+	const uint32_t systemClock = clock_get_hz(clk_sys);
+	const uint32_t timerDivider = systemClock / BUZZER_SAMPLE_RATE;
+	const int dmaTimer = dma_claim_unused_timer(true);
+	dma_timer_set_fraction(dmaTimer, 1, timerDivider);
+
+	const BuzzerEnvelope envelope = { BUZZER_ATTACK_MS, BUZZER_DECAY_MS, BUZZER_SUSTAIN, BUZZER_RELEASE_MS };
+	synth.init(systemClock / timerDivider, BUZZER_PWM_WRAP * buzzerVolume / 100, envelope);
+
+	dmaChannels[0] = dma_claim_unused_channel(true);
+	dmaChannels[1] = dma_claim_unused_channel(true);
+	for (uint32_t i = 0; i < 2; i++) {
+		dma_channel_config& dmaConfig = dmaConfigs[i];
+		dmaConfig = dma_channel_get_default_config(dmaChannels[i]);
+		channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_16);
+		channel_config_set_read_increment(&dmaConfig, true);
+		channel_config_set_write_increment(&dmaConfig, false);
+		channel_config_set_dreq(&dmaConfig, dma_get_timer_dreq(dmaTimer));
+		channel_config_set_chain_to(&dmaConfig, dmaChannels[1 - i]);
+		// Narrow writes are replicated across the register, so both channels of the slice get the level
+		dma_channel_configure(dmaChannels[i], &dmaConfig, &pwm_hw->slice[buzzerPinSlice].cc,
+			buffers[i], BUZZER_BUFFER_SAMPLES, false);
+		dma_channel_set_irq1_enabled(dmaChannels[i], true);
+	}
+
+	irq_add_shared_handler(DMA_IRQ_1, buzzerDmaIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_1, true);
+	// Output starts with the first note
+}
+
+// Restarts the ping-pong once the synthesizer has something to play. The buffer that was playing
+// when the output stopped has to finish first, until then the next process() tries again.
+void BuzzerSpeakerAddon::startOutput() {
+	if (outputRunning || synth.isIdle() ||
+		dma_channel_is_busy(dmaChannels[0]) || dma_channel_is_busy(dmaChannels[1])) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < 2; i++) {
+		dma_channel_set_config(dmaChannels[i], &dmaConfigs[i], false);
+		dma_channel_set_read_addr(dmaChannels[i], buffers[i], false);
+		synth.render(buffers[i], BUZZER_BUFFER_SAMPLES);
+	}
+	outputRunning = true;
+	dma_channel_start(dmaChannels[0]);
+}
+
+void BuzzerSpeakerAddon::handleEvent(const GamepadEvent& event) {
+	if (event.type == GamepadEventType::USB_SUSPEND) {
+		stop();
+	} else {
+		playCue(event);
+	}
+}
+
+// Cues replace whatever is playing, a burst of hotkeys only plays the last one
+void BuzzerSpeakerAddon::playCue(const GamepadEvent& event) {
+	switch (event.type) {
+		case GamepadEventType::HOTKEY_ACTION:
+			switch (event.data0) {
+				case HOTKEY_SOCD_UP_PRIORITY:
+				case HOTKEY_SOCD_NEUTRAL:
+				case HOTKEY_SOCD_LAST_INPUT:
+				case HOTKEY_SOCD_FIRST_INPUT:
+				case HOTKEY_SOCD_BYPASS:
+					if (cueMask & BUZZER_CUE_SOCD_MODE)
+						play(&cueModeSong, event.data1 + 1);
+					break;
+				case HOTKEY_DPAD_DIGITAL:
+				case HOTKEY_DPAD_LEFT_ANALOG:
+				case HOTKEY_DPAD_RIGHT_ANALOG:
+					if (cueMask & BUZZER_CUE_DPAD_MODE)
+						play(&cueModeSong, event.data1 + 1);
+					break;
+				case HOTKEY_NEXT_INPUT_MODE:
+					if (cueMask & BUZZER_CUE_INPUT_MODE)
+						play(&cueInputModeSong);
+					break;
+				case HOTKEY_INVERT_X_AXIS:
+				case HOTKEY_INVERT_Y_AXIS:
+				case HOTKEY_TOGGLE_4_WAY_MODE:
+				case HOTKEY_TOGGLE_DDI_4_WAY_MODE:
+					if (cueMask & BUZZER_CUE_TOGGLE)
+						play(event.data1 ? &cueOnSong : &cueOffSong);
+					break;
+				default:
+					break;
+			}
+			break;
+
+		case GamepadEventType::PROFILE_CHANGE:
+			if (cueMask & BUZZER_CUE_PROFILE)
+				play(&cueProfileSong, event.data0);
+			break;
+
+		case GamepadEventType::FOCUS_MODE_CHANGE:
+			if (cueMask & BUZZER_CUE_FOCUS_MODE)
+				play(event.data0 ? &cueOnSong : &cueOffSong);
+			break;
+
+		case GamepadEventType::TURBO_RATE_CHANGE:
+			// One short blip, higher for faster turbo
+			if (cueMask & BUZZER_CUE_TURBO_RATE) {
+				stop();
+				synth.queue({ (uint16_t)(C5 + 50 * std::min<uint32_t>(event.data0, 60)), 40, 40, 0xFF });
+			}
+			break;
+
+		default:
+			break;
+	}
 }
 
 void BuzzerSpeakerAddon::process() {
@@ -29,6 +194,7 @@ void BuzzerSpeakerAddon::process() {
 	}
 
 	processBuzzer();
+	startOutput();
 }
 
 void BuzzerSpeakerAddon::playIntro() {
@@ -46,51 +212,36 @@ void BuzzerSpeakerAddon::playIntro() {
 	introPlayed = true;
 }
 
+// Hands the song over to the synthesizer as far as its queue allows, timing is up to the renderer
 void BuzzerSpeakerAddon::processBuzzer() {
 	if (currentSong == NULL) {
 		return;
 	}
 
-	uint32_t currentTimeSong = getMillis() - startedSongMils;
-	uint32_t totalTimeSong = currentSong->song.size() * currentSong->toneDuration;
-	uint16_t currentTonePosition = floor((currentTimeSong * currentSong->song.size()) / totalTimeSong);
-	Tone currentTone = currentSong->song[currentTonePosition];
-
-	if (currentTonePosition > currentSong->song.size()) {
-		stop();
-		return;
-	}
-
-	if (currentTone == PAUSE) {
-		pwm_set_enabled (buzzerPinSlice, false);
-		return;
+	while (currentTonePosition < currentSongLength) {
+		const BuzzerNote note = {
+			currentSong->tones[currentTonePosition % currentSong->length],
+			currentSong->toneDuration,
+			currentSong->toneDuration,
+			0xFF,
+		};
+		if (!synth.queue(note)) {
+			return;
+		}
+		currentTonePosition++;
 	}
 
-	pwmSetFreqDuty(buzzerPinSlice, buzzerPinChannel, currentTone, 0.03 * ((float) buzzerVolume));
-	pwm_set_enabled (buzzerPinSlice, true);
+	currentSong = NULL;
 }
 
-void BuzzerSpeakerAddon::play(Song *song) {
-	startedSongMils = getMillis();
+void BuzzerSpeakerAddon::play(const Song *song, uint8_t repeat) {
+	synth.stop();
 	currentSong = song;
+	currentTonePosition = 0;
+	currentSongLength = song->length * repeat;
 }
 
 void BuzzerSpeakerAddon::stop() {
-	pwm_set_enabled (buzzerPinSlice, false);
+	synth.stop();
 	currentSong = NULL;
 }
-
-uint32_t BuzzerSpeakerAddon::pwmSetFreqDuty(uint slice, uint channel, uint32_t frequency, float duty) {
-	uint32_t clock = 125000000;
-	uint32_t divider16 = clock / frequency / 4096 +
-							(clock % (frequency * 4096) != 0);
-	if (divider16 / 16 == 0)
-	divider16 = 16;
-	uint32_t wrap = clock * 16 / divider16 / frequency - 1;
-	pwm_set_clkdiv_int_frac(slice, divider16/16,
-										divider16 & 0xF);
-	pwm_set_wrap(slice, wrap);
-	pwm_set_chan_level(slice, channel, wrap * duty / 100);
-	return wrap;
-}
-
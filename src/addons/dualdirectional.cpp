@@ -1,6 +1,7 @@
 #include "addons/dualdirectional.h"
 #include "GamepadOptions.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "helper.h"
 #include "config.pb.h"
 
@@ -26,13 +27,10 @@ void DualDirectionalInput::setup() {
 
     for (int i = 0; i < 4; i++) {
         if ( isValidPin(pinDualDir[i]) ) {
-            gpio_init(pinDualDir[i]);             // Initialize pin
-            gpio_set_dir(pinDualDir[i], GPIO_IN); // Set as INPUT
-            gpio_pull_up(pinDualDir[i]);          // Set as PULLUP
+            PinRegistry::getInstance().claimInput(pinDualDir[i], DualDirectionalName);
         }
     }
 
-    dDebState = 0;
     dualState = 0;
 
     lastGPUD = DIRECTION_NONE;
@@ -40,27 +38,6 @@ void DualDirectionalInput::setup() {
 
     lastDualUD = DIRECTION_NONE;
     lastDualLR = DIRECTION_NONE;
-
-    uint32_t now = getMillis();
-    for(int i = 0; i < 4; i++) {
-        dpadTime[i] = now;
-    }
-}
-
-void DualDirectionalInput::debounce()
-{
-	uint32_t now = getMillis();
-    Gamepad * gamepad = Storage::getInstance().GetGamepad();
-
-	for (int i = 0; i < 4; i++)
-	{
-		if ((dDebState & dpadMasks[i]) != (dualState & dpadMasks[i]) && (now - dpadTime[i]) > gamepad->debounceMS)
-		{
-			dDebState ^= dpadMasks[i];
-			dpadTime[i] = now;
-		}
-	}
-    dualState = dDebState;
 }
 
 void DualDirectionalInput::preprocess()
@@ -70,21 +47,18 @@ void DualDirectionalInput::preprocess()
  	// Need to invert since we're using pullups
     dualState = 0;
     if ( pinDualDirUp != (uint8_t)-1 ) {
-        dualState |= (!gpio_get(pinDualDirUp) ? gamepad->mapDpadUp->buttonMask : 0);
+        dualState |= (gamepad->pressedPin(pinDualDirUp) ? gamepad->mapDpadUp->buttonMask : 0);
     }
     if ( pinDualDirDown != (uint8_t)-1 ) {
-        dualState |= (!gpio_get(pinDualDirDown) ? gamepad->mapDpadDown->buttonMask : 0);
+        dualState |= (gamepad->pressedPin(pinDualDirDown) ? gamepad->mapDpadDown->buttonMask : 0);
     }
     if ( pinDualDirLeft != (uint8_t)-1 ) {
-        dualState |= (!gpio_get(pinDualDirLeft) ? gamepad->mapDpadLeft->buttonMask  : 0);
+        dualState |= (gamepad->pressedPin(pinDualDirLeft) ? gamepad->mapDpadLeft->buttonMask  : 0);
     }
     if ( pinDualDirRight != (uint8_t)-1 ) {
-        dualState |= (!gpio_get(pinDualDirRight) ? gamepad->mapDpadRight->buttonMask : 0);
+        dualState |= (gamepad->pressedPin(pinDualDirRight) ? gamepad->mapDpadRight->buttonMask : 0);
     }
 
-    // Debounce our directional pins
-    debounce();
-
     // Convert gamepad from process() output to uint8 value
     uint8_t gamepadState = gamepad->state.dpad;
     const SOCDMode socdMode = getSOCDMode(gamepad->getOptions());
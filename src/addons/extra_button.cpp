@@ -1,5 +1,6 @@
 #include "addons/extra_button.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "hardware/gpio.h"
 #include "helper.h"
 #include "config.pb.h"
@@ -14,14 +15,12 @@ void ExtraButtonAddon::setup() {
 	extraButtonMap = options.buttonMap;
 	extraButtonPin = options.pin;
 
-	gpio_init(extraButtonPin);             // Initialize pin
-	gpio_set_dir(extraButtonPin, GPIO_IN); // Set as INPUT
-	gpio_pull_up(extraButtonPin);          // Set as PULLUP
+	PinRegistry::getInstance().claimInput(extraButtonPin, ExtraButtonName);
 }
 
 void ExtraButtonAddon::preprocess() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
-	if (!gpio_get(extraButtonPin)) {
+	if (gamepad->pressedPin(extraButtonPin)) {
 		if (extraButtonMap > (GAMEPAD_MASK_A2)) {
 			switch (extraButtonMap) {
 				case (GAMEPAD_MASK_DU):
@@ -1,5 +1,6 @@
 #include "addons/focus_mode.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "hardware/gpio.h"
 
 bool FocusModeAddon::available() {
@@ -13,14 +14,19 @@ void FocusModeAddon::setup() {
 	const FocusModeOptions& options = Storage::getInstance().getAddonOptions().focusModeOptions;
 	buttonLockMask = options.buttonLockMask;
 	focusModePin = options.pin;
-	gpio_init(focusModePin);             // Initialize pin
-	gpio_set_dir(focusModePin, GPIO_IN); // Set as INPUT
-	gpio_pull_up(focusModePin);          // Set as PULLUP
+	PinRegistry::getInstance().claimInput(focusModePin, FocusModeName);
+	focusModeActive = false;
 }
 
 void FocusModeAddon::process() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
-	if (!gpio_get(focusModePin)) {
+	const bool pressed = gamepad->pressedPin(focusModePin);
+	if (pressed != focusModeActive) {
+		focusModeActive = pressed;
+		Storage::getInstance().PushGamepadEvent({ GamepadEventType::FOCUS_MODE_CHANGE, pressed, 0 });
+	}
+
+	if (pressed) {
 			if (buttonLockMask & GAMEPAD_MASK_DU) {
 				gamepad->state.dpad &= ~GAMEPAD_MASK_UP;
 			}
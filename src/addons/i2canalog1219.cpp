@@ -1,5 +1,6 @@
 #include "addons/i2canalog1219.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "helper.h"
 #include "config.pb.h"
 
@@ -20,6 +21,9 @@ void I2CAnalog1219Input::setup() {
     uIntervalMS = 1;
     nextTimer = getMillis();
 
+    PinRegistry::getInstance().claim(options.i2cSDAPin, PIN_OWNER_I2C);
+    PinRegistry::getInstance().claim(options.i2cSCLPin, PIN_OWNER_I2C);
+
     // Init our ADS1219 library
     ads = new ADS1219(1,
         options.i2cSDAPin,
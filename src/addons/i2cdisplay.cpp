@@ -8,6 +8,7 @@
 #include "enums.h"
 #include "helper.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "pico/stdlib.h"
 #include "bitmaps.h"
 #include "ps4_driver.h"
@@ -23,6 +24,8 @@ bool I2CDisplayAddon::available() {
 
 void I2CDisplayAddon::setup() {
 	const DisplayOptions& options = Storage::getInstance().getDisplayOptions();
+	PinRegistry::getInstance().claim(options.i2cSDAPin, PIN_OWNER_I2C);
+	PinRegistry::getInstance().claim(options.i2cSCLPin, PIN_OWNER_I2C);
 
 	obdI2CInit(&obd,
 	    options.size,
@@ -97,6 +100,18 @@ void I2CDisplayAddon::setDisplayPower(uint8_t status)
 	}
 }
 
+void I2CDisplayAddon::handleEvent(const GamepadEvent& event) {
+	if (event.type == GamepadEventType::USB_SUSPEND) {
+		setDisplayPower(0);
+	} else if (event.type == GamepadEventType::USB_RESUME) {
+		// Restart the screen saver countdown, focus mode keeps the display off
+		displaySaverTimer = displaySaverTimeout;
+		prevMillis = getMillis();
+		if (!(isFocusModeEnabled && focusModePrevState))
+			setDisplayPower(1);
+	}
+}
+
 void I2CDisplayAddon::process() {
 	const FocusModeOptions& focusModeOptions = Storage::getInstance().getAddonOptions().focusModeOptions;
 	if (!configMode && isDisplayPowerOff()) return;
@@ -112,6 +127,12 @@ void I2CDisplayAddon::process() {
 			drawText(0, 5, "Preview:");
 			drawText(5, 6, "B1 > Button");
 			drawText(5, 7, "B2 > Splash");
+			if (PinRegistry::getInstance().getConflictMask() != 0)
+				drawText(0, 1, "Pin conflict: see web");
+			break;
+		case I2CDisplayAddon::DisplayMode::PIN_CONFLICT:
+			drawStatusBar(gamepad);
+			drawPinConflicts(2);
 			break;
 		case I2CDisplayAddon::DisplayMode::SPLASH:
 			if (getDisplayOptions().splashMode == static_cast<SplashMode>(SPLASH_MODE_NONE)) {
@@ -249,6 +270,10 @@ I2CDisplayAddon::DisplayMode I2CDisplayAddon::getDisplayMode() {
 		prevButtonState = buttonState;
 		return prevDisplayMode;
 	} else {
+		// A feature that lost one of its pins to another one is not set up, say so before anything else
+		if (PinRegistry::getInstance().getConflictMask() != 0 && getMillis() < PIN_CONFLICT_DURATION) {
+			return I2CDisplayAddon::DisplayMode::PIN_CONFLICT;
+		}
 		if (Storage::getInstance().getDisplayOptions().splashMode != static_cast<SplashMode>(SPLASH_MODE_NONE)) {
 			int splashDuration = getDisplayOptions().splashDuration;
 			if (splashDuration == 0 || getMillis() < splashDuration) {
@@ -974,6 +999,26 @@ void I2CDisplayAddon::drawStatusBar(Gamepad * gamepad)
 	drawText(0, 0, statusBar);
 }
 
+// One line per conflicting pin: the pin, its owner and the feature that was refused it
+void I2CDisplayAddon::drawPinConflicts(int startRow)
+{
+	const PinRegistry& pinRegistry = PinRegistry::getInstance();
+	const uint32_t conflictMask = pinRegistry.getConflictMask();
+
+	drawText(0, startRow, "[Pin Conflicts]");
+	int row = startRow + 1;
+	for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS && row < 8; pin++) {
+		if (!(conflictMask & (1u << pin)))
+			continue;
+
+		const char* owner = pinRegistry.getOwner(pin);
+		const char* conflictOwner = pinRegistry.getConflictOwner(pin);
+		std::string line = "GP" + std::to_string(pin) + " " + (owner ? owner : "?") + "/" + (conflictOwner ? conflictOwner : "?");
+		// Limit to 21 chars with 6x8 font
+		drawText(0, row++, line.substr(0, 21));
+	}
+}
+
 bool I2CDisplayAddon::pressedUp()
 {
 	switch (gamepad->getOptions().dpadMode)
@@ -1,6 +1,7 @@
 #include "addons/jslider.h"
 
 #include "storagemanager.h"
+#include "pinregistry.h"
 
 #include "GamepadEnums.h"
 #include "helper.h"
@@ -19,23 +20,20 @@ void JSliderInput::setup()
 {
     const SliderOptions& options = Storage::getInstance().getAddonOptions().sliderOptions;
     if ( isValidPin(options.pinLS)) {
-        gpio_init(options.pinLS);             // Initialize pin
-        gpio_set_dir(options.pinLS, GPIO_IN); // Set as INPUT
-        gpio_pull_up(options.pinLS);          // Set as PULLUP    
+        PinRegistry::getInstance().claimInput(options.pinLS, JSliderName);
     }
     if ( isValidPin(options.pinRS)) {
-        gpio_init(options.pinRS);
-        gpio_set_dir(options.pinRS, GPIO_IN); // Set as INPUT
-        gpio_pull_up(options.pinRS);          // Set as PULLUP
+        PinRegistry::getInstance().claimInput(options.pinRS, JSliderName);
     }
 }
 
 DpadMode JSliderInput::read() {
     const SliderOptions& options = Storage::getInstance().getAddonOptions().sliderOptions;
-    if ( isValidPin(options.pinLS) && !gpio_get(options.pinLS)) {
+    Gamepad * gamepad = Storage::getInstance().GetGamepad();
+    if ( isValidPin(options.pinLS) && gamepad->pressedPin(options.pinLS)) {
         return DPAD_MODE_LEFT_ANALOG;
     }
-    if ( isValidPin(options.pinRS) && !gpio_get(options.pinRS)) {
+    if ( isValidPin(options.pinRS) && gamepad->pressedPin(options.pinRS)) {
         return DPAD_MODE_RIGHT_ANALOG;
     }
     return  DPAD_MODE_DIGITAL;
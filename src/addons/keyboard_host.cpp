@@ -1,11 +1,55 @@
 #include "addons/keyboard_host.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
+
+#include "gamepad/HIDHostParser.h"
 
 #include "pio_usb.h"
 
+#include <algorithm>
+#include <iterator>
+
 static bool host_device_mounted = false;
 static GamepadState _keyboard_host_state;
 
+// Host gamepad sticks closer to the center than this only override the gamepad's own axes when they move
+static const uint16_t HOST_GAMEPAD_DEADZONE = 0x0800;
+
+enum HostGamepadAxis {
+  HOST_AXIS_LX,
+  HOST_AXIS_LY,
+  HOST_AXIS_RX,
+  HOST_AXIS_RY,
+  HOST_AXIS_COUNT
+};
+
+// Gamepads attached to the host port, one slot per HID interface
+struct HostGamepad {
+  bool mounted;
+  uint8_t dev_addr;
+  uint8_t instance;
+  HIDHostLayout layout;
+  GamepadState state;
+  uint16_t lastAxes[HOST_AXIS_COUNT]; // axis values seen by the previous preprocess()
+};
+static HostGamepad _host_gamepads[CFG_TUH_HID];
+static uint8_t _host_gamepads_mounted = 0;
+
+// A centered stick that doesn't move leaves the axis to the other inputs
+static void applyHostAxis(uint16_t value, uint16_t& lastValue, uint16_t& axis)
+{
+  const uint16_t offset = value > GAMEPAD_JOYSTICK_MID ? value - GAMEPAD_JOYSTICK_MID : GAMEPAD_JOYSTICK_MID - value;
+  if (offset > HOST_GAMEPAD_DEADZONE || value != lastValue)
+    axis = value;
+  lastValue = value;
+}
+
+// Switch Pro controllers only send full reports after this USB handshake
+static const uint8_t SWITCH_PRO_COMMAND_REPORT_ID = 0x80;
+static const uint8_t SWITCH_PRO_REPLY_REPORT_ID   = 0x81;
+static const uint8_t SWITCH_PRO_HANDSHAKE         = 0x02;
+static const uint8_t SWITCH_PRO_FORCE_USB         = 0x04;
+
 static KeyboardButtonMapping _keyboard_host_mapDpadUp    = KeyboardButtonMapping(GAMEPAD_MASK_UP);
 static KeyboardButtonMapping _keyboard_host_mapDpadDown  = KeyboardButtonMapping(GAMEPAD_MASK_DOWN);
 static KeyboardButtonMapping _keyboard_host_mapDpadLeft  = KeyboardButtonMapping(GAMEPAD_MASK_LEFT);
@@ -40,8 +84,12 @@ void KeyboardHostAddon::setup() {
   // board_init() should be doing what the two lines below are doing but doesn't work
   // needs tinyusb_board library linked
 
-  if (keyboardHostOptions.pin5V != -1) {
-    const int32_t pin5V = keyboardHostOptions.pin5V;
+  // PIO-USB uses D+ and the pin after it for D-
+  PinRegistry::getInstance().claim(keyboardHostOptions.pinDplus, KeyboardHostName);
+  PinRegistry::getInstance().claim(keyboardHostOptions.pinDplus + 1, KeyboardHostName);
+
+  const int32_t pin5V = keyboardHostOptions.pin5V;
+  if (pin5V != -1 && PinRegistry::getInstance().claim(pin5V, KeyboardHostName)) {
 	  gpio_init(pin5V);
 	  gpio_set_dir(pin5V, GPIO_OUT);
 	  gpio_pull_up(pin5V);
@@ -88,6 +136,24 @@ void KeyboardHostAddon::preprocess() {
   gamepad->state.lt       |= _keyboard_host_state.lt;
   gamepad->state.rt       |= _keyboard_host_state.rt;
 
+  // Host gamepads are merged before process() so SOCD, turbo and the output modes apply to them too
+  if (_host_gamepads_mounted > 0) {
+    for (HostGamepad& hostGamepad : _host_gamepads) {
+      if (!hostGamepad.mounted)
+        continue;
+
+      const GamepadState& state = hostGamepad.state;
+      gamepad->state.dpad    |= state.dpad;
+      gamepad->state.buttons |= state.buttons;
+      applyHostAxis(state.lx, hostGamepad.lastAxes[HOST_AXIS_LX], gamepad->state.lx);
+      applyHostAxis(state.ly, hostGamepad.lastAxes[HOST_AXIS_LY], gamepad->state.ly);
+      applyHostAxis(state.rx, hostGamepad.lastAxes[HOST_AXIS_RX], gamepad->state.rx);
+      applyHostAxis(state.ry, hostGamepad.lastAxes[HOST_AXIS_RY], gamepad->state.ry);
+      gamepad->state.lt       = std::max(gamepad->state.lt, state.lt);
+      gamepad->state.rt       = std::max(gamepad->state.rt, state.rt);
+    }
+  }
+
   tuh_task();
 }
 
@@ -96,11 +162,42 @@ void KeyboardHostAddon::preprocess() {
 // can be used to parse common/simple enough descriptor.
 // Note: if report descriptor length > CFG_TUH_ENUMERATION_BUFSIZE, it will be skipped
 // therefore report_desc = NULL, desc_len = 0
-void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len)
+static HostGamepad* findHostGamepad(uint8_t dev_addr, uint8_t instance)
 {
-  (void)desc_report;
-  (void)desc_len;
+  for (HostGamepad& hostGamepad : _host_gamepads) {
+    if (hostGamepad.mounted && hostGamepad.dev_addr == dev_addr && hostGamepad.instance == instance)
+      return &hostGamepad;
+  }
+  return nullptr;
+}
 
+static void mountHostGamepad(uint8_t dev_addr, uint8_t instance, uint16_t vid, uint16_t pid, uint8_t const* desc_report, uint16_t desc_len)
+{
+  HIDHostLayout layout = HIDHostParser::makeLayout(vid, pid, desc_report, desc_len);
+  if (layout.type == HIDHostDeviceType::NONE)
+    return;
+
+  for (HostGamepad& hostGamepad : _host_gamepads) {
+    if (!hostGamepad.mounted) {
+      hostGamepad.mounted = true;
+      hostGamepad.dev_addr = dev_addr;
+      hostGamepad.instance = instance;
+      hostGamepad.layout = layout;
+      hostGamepad.state = GamepadState();
+      std::fill(std::begin(hostGamepad.lastAxes), std::end(hostGamepad.lastAxes), GAMEPAD_JOYSTICK_MID);
+      _host_gamepads_mounted++;
+
+      if (layout.type == HIDHostDeviceType::SWITCH_PRO)
+        tuh_hid_send_report(dev_addr, instance, SWITCH_PRO_COMMAND_REPORT_ID, &SWITCH_PRO_HANDSHAKE, 1);
+
+      tuh_hid_receive_report(dev_addr, instance);
+      return;
+    }
+  }
+}
+
+void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len)
+{
   host_device_mounted = true;
 
   // Interface protocol (hid_interface_protocol_enum_t)
@@ -117,13 +214,21 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_re
       // Error: cannot request report
     }
   }
+  else
+  {
+    mountHostGamepad(dev_addr, instance, vid, pid, desc_report, desc_len);
+  }
 }
 
 // Invoked when device with hid interface is un-mounted
 void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance)
 {
-  (void) dev_addr;
-  (void) instance;
+  HostGamepad* hostGamepad = findHostGamepad(dev_addr, instance);
+  if (hostGamepad != nullptr) {
+    // Only this pad's inputs go away, the others keep theirs
+    hostGamepad->mounted = false;
+    _host_gamepads_mounted--;
+  }
 }
 
 uint8_t getKeycodeFromModifier(uint8_t modifier) {
@@ -199,7 +304,6 @@ void process_kbd_report(uint8_t dev_addr, hid_keyboard_report_t const *report)
 // Invoked when received report from device via interrupt endpoint
 void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len)
 {
-  (void) len;
   uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
 
   switch(itf_protocol)
@@ -208,7 +312,20 @@ void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t cons
       process_kbd_report(dev_addr, (hid_keyboard_report_t const*) report );
     break;
 
-    default: break;
+    default:
+      {
+        HostGamepad* hostGamepad = findHostGamepad(dev_addr, instance);
+        if (hostGamepad == nullptr) break;
+
+        // Reports that aren't the gamepad report (battery, IMU only, replies) are skipped by the decoder
+        if (hostGamepad->layout.type == HIDHostDeviceType::SWITCH_PRO && len >= 2 &&
+            report[0] == SWITCH_PRO_REPLY_REPORT_ID && report[1] == SWITCH_PRO_HANDSHAKE) {
+          tuh_hid_send_report(dev_addr, instance, SWITCH_PRO_COMMAND_REPORT_ID, &SWITCH_PRO_FORCE_USB, 1);
+        } else {
+          HIDHostParser::decodeReport(hostGamepad->layout, report, len, hostGamepad->state);
+        }
+      }
+    break;
   }
 
   // continue to request to receive report
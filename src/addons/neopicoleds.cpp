@@ -10,6 +10,7 @@
 #include "PlayerLEDs.h"
 #include "gp2040.h"
 #include "addons/neopicoleds.h"
+#include "pinregistry.h"
 #include "addons/pleds.h"
 #include "themes.h"
 
@@ -39,68 +40,6 @@ static std::vector<uint8_t> EMPTY_VECTOR;
 
 uint32_t rgbPLEDValues[4];
 
-// TODO: Make this a helper function
-// Animation Helper for Player LEDs
-PLEDAnimationState getXInputAnimationNEOPICO(uint8_t *data)
-{
-	PLEDAnimationState animationState =
-	{
-		.state = 0,
-		.animation = PLED_ANIM_NONE,
-		.speed = PLED_SPEED_OFF,
-	};
-
-	// Check first byte for LED payload
-	if (data[0] == 0x01)
-	{
-		switch (data[2])
-		{
-			case XINPUT_PLED_BLINKALL:
-			case XINPUT_PLED_ROTATE:
-			case XINPUT_PLED_BLINK:
-			case XINPUT_PLED_SLOWBLINK:
-			case XINPUT_PLED_ALTERNATE:
-				animationState.state = (PLED_STATE_LED1 | PLED_STATE_LED2 | PLED_STATE_LED3 | PLED_STATE_LED4);
-				animationState.animation = PLED_ANIM_BLINK;
-				animationState.speed = PLED_SPEED_FAST;
-				break;
-
-			case XINPUT_PLED_FLASH1:
-			case XINPUT_PLED_ON1:
-				animationState.state = PLED_STATE_LED1;
-				animationState.animation = PLED_ANIM_SOLID;
-				animationState.speed = PLED_SPEED_OFF;
-				break;
-
-			case XINPUT_PLED_FLASH2:
-			case XINPUT_PLED_ON2:
-				animationState.state = PLED_STATE_LED2;
-				animationState.animation = PLED_ANIM_SOLID;
-				animationState.speed = PLED_SPEED_OFF;
-				break;
-
-			case XINPUT_PLED_FLASH3:
-			case XINPUT_PLED_ON3:
-				animationState.state = PLED_STATE_LED3;
-				animationState.animation = PLED_ANIM_SOLID;
-				animationState.speed = PLED_SPEED_OFF;
-				break;
-
-			case XINPUT_PLED_FLASH4:
-			case XINPUT_PLED_ON4:
-				animationState.state = PLED_STATE_LED4;
-				animationState.animation = PLED_ANIM_SOLID;
-				animationState.speed = PLED_SPEED_OFF;
-				break;
-
-			default:
-				break;
-		}
-	}
-
-	return animationState;
-}
-
 bool NeoPicoLEDAddon::available() {
 	const LEDOptions& ledOptions = Storage::getInstance().getLedOptions();
 	return isValidPin(ledOptions.dataPin);
@@ -113,6 +52,7 @@ void NeoPicoLEDAddon::setup()
 
 	if ( ledOptions.pledType == PLED_TYPE_RGB ) {
 		neoPLEDs = new NeoPicoPlayerLEDs();
+		AddonServices::getInstance().publish<PlayerLEDSink>(this);
 	}
 
 	neopico = nullptr; // set neopico to null
@@ -121,31 +61,34 @@ void NeoPicoLEDAddon::setup()
 	neopico = new NeoPico(-1, 0);
 	configureLEDs();
 
-	nextRunTime = make_timeout_time_ms(0); // Reset timeout
 	const FocusModeOptions& focusModeOptions = Storage::getInstance().getAddonOptions().focusModeOptions;
 	isFocusModeEnabled = focusModeOptions.enabled && focusModeOptions.rgbLockEnabled &&
 		isValidPin(focusModeOptions.pin);
 }
 
+void NeoPicoLEDAddon::handleEvent(const GamepadEvent& event)
+{
+	// The next process() after resume draws the current frame again
+	if (event.type == GamepadEventType::USB_SUSPEND && neopico != nullptr)
+		neopico->Off();
+
+	// Profiles can carry their own animation settings
+	if (event.type == GamepadEventType::PROFILE_CHANGE && neopico != nullptr) {
+		AnimationOptions animationOptions = AnimationStore.getAnimationOptions();
+		addStaticThemes(Storage::getInstance().getLedOptions(), animationOptions);
+		as.SetOptions(animationOptions);
+		as.SetMode(as.options.baseAnimationIndex);
+	}
+}
+
 void NeoPicoLEDAddon::process()
 {
 	const LEDOptions& ledOptions = Storage::getInstance().getLedOptions();
-	if (!isValidPin(ledOptions.dataPin) || !time_reached(this->nextRunTime))
+	if (!isValidPin(ledOptions.dataPin))
 		return;
 
 	Gamepad * gamepad = Storage::getInstance().GetProcessedGamepad();
-	uint8_t * featureData = Storage::getInstance().GetFeatureData();
 	AnimationHotkey action = animationHotkeys(gamepad);
-	if (ledOptions.pledType == PLED_TYPE_RGB) {
-		inputMode = gamepad->getOptions().inputMode; // HACK
-		switch (gamepad->getOptions().inputMode) {
-			case INPUT_MODE_XINPUT:
-				animationState = getXInputAnimationNEOPICO(featureData);
-				if (neoPLEDs != nullptr && animationState.animation != PLED_ANIM_NONE)
-					neoPLEDs->animate(animationState);
-				break;
-		}
-	}
 
 	if ( action != HOTKEY_LEDS_NONE ) {
 		as.HandleEvent(action);
@@ -182,29 +125,39 @@ void NeoPicoLEDAddon::process()
 	}
 	as.ApplyBrightness(frame);
 
+	// Withdrawn or replaced as the sink, nobody hands us player LED states anymore
+	if (playerLEDsActive && AddonServices::getInstance().get<PlayerLEDSink>() != this)
+		playerLEDsActive = false;
+
 	// Apply the player LEDs to our first 4 leds if we're in NEOPIXEL mode
-	if (ledOptions.pledType == PLED_TYPE_RGB) {
-		switch (inputMode) { // HACK
-			case INPUT_MODE_XINPUT:
-				LEDOptions & ledOptions = Storage::getInstance().getLedOptions();
-				int32_t pledPins[] = { ledOptions.pledPin1, ledOptions.pledPin2, ledOptions.pledPin3, ledOptions.pledPin4 };
-				for (int i = 0; i < PLED_COUNT; i++) {
-					if (pledPins[i] < 0)
-						continue;
-
-					float level = (static_cast<float>(PLED_MAX_LEVEL - neoPLEDs->getLedLevels()[i]) / static_cast<float>(PLED_MAX_LEVEL));
-					float brightness = as.GetBrightnessX() * level;
-					rgbPLEDValues[i] = ((RGB)ledOptions.pledColor).value(neopico->GetFormat(), brightness);
-					frame[pledPins[i]] = rgbPLEDValues[i];
-				}
+	if (neoPLEDs != nullptr && playerLEDsActive) {
+		int32_t pledPins[] = { ledOptions.pledPin1, ledOptions.pledPin2, ledOptions.pledPin3, ledOptions.pledPin4 };
+		for (int i = 0; i < PLED_COUNT; i++) {
+			if (pledPins[i] < 0)
+				continue;
+
+			float level = (static_cast<float>(PLED_MAX_LEVEL - neoPLEDs->getLedLevels()[i]) / static_cast<float>(PLED_MAX_LEVEL));
+			float brightness = as.GetBrightnessX() * level;
+			rgbPLEDValues[i] = ((RGB)ledOptions.pledColor).value(neopico->GetFormat(), brightness);
+			frame[pledPins[i]] = rgbPLEDValues[i];
 		}
 	}
 
 	neopico->SetFrame(frame);
 	neopico->Show();
 	AnimationStore.save();
+}
 
-	this->nextRunTime = make_timeout_time_ms(NeoPicoLEDAddon::intervalMS);
+void NeoPicoLEDAddon::setPlayerLEDs(const PLEDAnimationState& animationState)
+{
+	playerLEDsActive = true;
+	if (neoPLEDs != nullptr && animationState.animation != PLED_ANIM_NONE)
+		neoPLEDs->animate(animationState);
+}
+
+void NeoPicoLEDAddon::releasePlayerLEDs()
+{
+	playerLEDsActive = false;
 }
 
 std::vector<uint8_t> * NeoPicoLEDAddon::getLEDPositions(string button, std::vector<std::vector<uint8_t>> *positions)
@@ -513,7 +466,11 @@ void NeoPicoLEDAddon::configureLEDs()
 
 	// Remove the old neopico (config can call this)
 	delete neopico;
-	neopico = new NeoPico(ledOptions.dataPin, ledCount, static_cast<LEDFormat>(ledOptions.ledFormat));
+	// Without its data pin the strip is driven like the dummy above, with no pixels
+	if (PinRegistry::getInstance().claim(ledOptions.dataPin, NeoPicoLEDName))
+		neopico = new NeoPico(ledOptions.dataPin, ledCount, static_cast<LEDFormat>(ledOptions.ledFormat));
+	else
+		neopico = new NeoPico(-1, 0, static_cast<LEDFormat>(ledOptions.ledFormat));
 	neopico->Off();
 
 	Animation::format = static_cast<LEDFormat>(ledOptions.ledFormat);
@@ -9,15 +9,16 @@
 #include "hardware/pwm.h"
 #include "GamepadEnums.h"
 #include "xinput_driver.h"
+#include "pinregistry.h"
 
 // GP2040 Includes
 #include "addons/pleds.h"
 #include "helper.h"
 #include "storagemanager.h"
+#include "addonservices.h"
 
-// TODO: make this a helper function
 // Animation Helper for Player LEDs
-PLEDAnimationState getXInputAnimationPWM(uint8_t *data)
+PLEDAnimationState getXInputAnimation(uint8_t *data)
 {
 	PLEDAnimationState animationState =
 	{
@@ -97,26 +98,61 @@ void PlayerLEDAddon::setup() {
 		pwmLEDs->setup();
 }
 
+void PlayerLEDAddon::handleEvent(const GamepadEvent& event)
+{
+	// NeoPixel player LEDs go dark with the strip, PWM ones are restored by the next display()
+	if (event.type == GamepadEventType::USB_SUSPEND && pwmLEDs != nullptr)
+		pwmLEDs->off();
+}
+
 void PlayerLEDAddon::process()
 {
 	Gamepad * gamepad = Storage::getInstance().GetProcessedGamepad();
 	const LEDOptions& ledOptions = Storage::getInstance().getLedOptions();
 
-	// Player LEDs can be PWM or driven by NeoPixel
-	uint8_t * featureData = Storage::getInstance().GetFeatureData();
-	if (ledOptions.pledType == PLED_TYPE_PWM) { // only process the feature queue if we're on PWM
-		if (pwmLEDs != nullptr)
+	const bool wasDriven = driven;
+	driven = updateAnimationState(gamepad->getOptions().inputMode);
+
+	// Player LEDs can be PWM or driven by whichever addon publishes a sink (NeoPixel)
+	if (ledOptions.pledType == PLED_TYPE_PWM) {
+		if (pwmLEDs != nullptr) {
 			pwmLEDs->display();
 
-		switch (gamepad->getOptions().inputMode)
-		{
-			case INPUT_MODE_XINPUT:
-				animationState = getXInputAnimationPWM(featureData);
-				break;
+			if (driven && animationState.animation != PLED_ANIM_NONE)
+				pwmLEDs->animate(animationState);
+			else if (wasDriven && !driven)
+				pwmLEDs->animate({ .state = 0, .animation = PLED_ANIM_OFF, .speed = PLED_SPEED_OFF });
 		}
-		if (pwmLEDs != nullptr && animationState.animation != PLED_ANIM_NONE)
-			pwmLEDs->animate(animationState);
+	} else {
+		// Hand the LEDs back when nothing drives them anymore or another sink took over
+		PlayerLEDSink * sink = AddonServices::getInstance().get<PlayerLEDSink>();
+		if (drivenSink != nullptr && (!driven || sink != drivenSink))
+			drivenSink->releasePlayerLEDs();
+
+		drivenSink = driven ? sink : nullptr;
+		if (drivenSink != nullptr)
+			drivenSink->setPlayerLEDs(animationState);
+	}
+}
+
+// Returns false if nothing decides what the player LEDs show in this input mode
+bool PlayerLEDAddon::updateAnimationState(uint8_t inputMode)
+{
+	if (inputMode == INPUT_MODE_XINPUT) {
+		animationState = getXInputAnimation(Storage::getInstance().GetFeatureData());
+		return true;
 	}
+
+	// Other hosts don't send a pattern, show the slot the player number addon ended up with
+	PlayerNumberProvider * provider = AddonServices::getInstance().get<PlayerNumberProvider>();
+	const uint8_t playerNumber = provider != nullptr ? provider->getPlayerNumber() : 0;
+	if (playerNumber < 1 || playerNumber > PLED_COUNT)
+		return false;
+
+	animationState.state = 1 << (playerNumber - 1);
+	animationState.animation = PLED_ANIM_SOLID;
+	animationState.speed = PLED_SPEED_OFF;
+	return true;
 }
 
 void PWMPlayerLEDs::setup()
@@ -131,8 +167,11 @@ void PWMPlayerLEDs::setup()
 
 	for (int i = 0; i < PLED_COUNT; i++)
 	{
-		if (pledPins[i] > -1)
+		// A pin another feature owns is left alone
+		pins[i] = -1;
+		if (pledPins[i] > -1 && PinRegistry::getInstance().claim(pledPins[i], PLEDName))
 		{
+			pins[i] = pledPins[i];
 			gpio_set_function(pledPins[i], GPIO_FUNC_PWM);
 			uint sliceNum = pwm_gpio_to_slice_num(pledPins[i]);
 			uint channelNum = pwm_gpio_to_channel(pledPins[i]);
@@ -147,11 +186,15 @@ void PWMPlayerLEDs::setup()
 
 void PWMPlayerLEDs::display()
 {
-	LEDOptions & ledOptions = Storage::getInstance().getLedOptions();
-	int32_t pledPins[] = { ledOptions.pledPin1, ledOptions.pledPin2, ledOptions.pledPin3, ledOptions.pledPin4 };
-
 	for (int i = 0; i < PLED_COUNT; i++)
-		if (pledPins[i] > -1)
-			pwm_set_gpio_level(pledPins[i], ledLevels[i]);
+		if (pins[i] > -1)
+			pwm_set_gpio_level(pins[i], ledLevels[i]);
 }
 
+// LEDs sink into the pin, the highest level turns them off
+void PWMPlayerLEDs::off()
+{
+	for (int i = 0; i < PLED_COUNT; i++)
+		if (pins[i] > -1)
+			pwm_set_gpio_level(pins[i], PLED_MAX_LEVEL);
+}
@@ -1,6 +1,7 @@
 #include "addons/playernum.h"
 #include "storagemanager.h"
-#include "system.h"
+#include "usb_driver.h"
+#include "xinput_driver.h"
 #include "helper.h"
 #include "config.pb.h"
 
@@ -10,47 +11,83 @@ bool PlayerNumAddon::available() {
 
 void PlayerNumAddon::setup() {
     const PlayerNumberOptions& options = Storage::getInstance().getAddonOptions().playerNumberOptions;
-    xinputIDs[0] = XINPUT_PLED_ON1;
-    xinputIDs[1] = XINPUT_PLED_ON2;
-    xinputIDs[2] = XINPUT_PLED_ON3;
-    xinputIDs[3] = XINPUT_PLED_ON4;
     playerNum = options.number;
     if ( playerNum < 1 || playerNum > 4 ) {
         playerNum = 1; // error checking, set to 1 if we're off
     }
     assigned = 0; // what player ID did we get assigned to
+    attempts = 0;
+    state = PlayerNumState::WAITING;
+    AddonServices::getInstance().publish<PlayerNumberProvider>(this);
 }
 
 void PlayerNumAddon::process()
 {
-    if ( assigned == 0 ) {
-        Gamepad * gamepad = Storage::getInstance().GetGamepad();
-        InputMode inputMode = static_cast<InputMode>(gamepad->getOptions().inputMode);
-        if ( inputMode == INPUT_MODE_XINPUT ) {
-            uint8_t * featureData = Storage::getInstance().GetFeatureData();
-            if (featureData[0] == 0x01) {
-                XInputPLEDPattern ledAction = (XInputPLEDPattern)featureData[2];
-                if ( ledAction == XINPUT_PLED_ON1 )
-                    handleLED(1);
-                else if ( ledAction == XINPUT_PLED_ON2 )
-                    handleLED(2);
-                else if ( ledAction == XINPUT_PLED_ON3 )
-                    handleLED(3);
-                else if ( ledAction == XINPUT_PLED_ON4 )
-                    handleLED(4);
+    switch (state) {
+        case PlayerNumState::WAITING:
+            handleSlot(readSlot());
+            break;
+
+        case PlayerNumState::RECONNECTING:
+            // The host assigns a new slot once we're mounted again
+            if (get_usb_mounted())
+                state = PlayerNumState::WAITING;
+            break;
+
+        case PlayerNumState::ASSIGNED:
+            break;
+    }
+}
+
+// Slot the host gave us, 0 while it hasn't told us yet
+uint8_t PlayerNumAddon::readSlot() {
+    Gamepad * gamepad = Storage::getInstance().GetGamepad();
+    InputMode inputMode = static_cast<InputMode>(gamepad->getOptions().inputMode);
+    if ( inputMode == INPUT_MODE_XINPUT ) {
+        uint8_t * featureData = Storage::getInstance().GetFeatureData();
+        if (featureData[0] == 0x01) {
+            switch ((XInputPLEDPattern)featureData[2]) {
+                case XINPUT_PLED_ON1: return 1;
+                case XINPUT_PLED_ON2: return 2;
+                case XINPUT_PLED_ON3: return 3;
+                case XINPUT_PLED_ON4: return 4;
+                default:              return 0;
             }
-        } else {
-            assigned = 1;
         }
+        return 0;
+    } else if ( inputMode == INPUT_MODE_PS4 ) {
+        // The console shows the player with the lightbar: blue, red, green, pink
+        uint8_t rgb[3];
+        if (!get_ps4_lightbar(rgb))
+            return 0;
+        bool red = rgb[0] != 0, green = rgb[1] != 0, blue = rgb[2] != 0;
+        if (blue && !red && !green) return 1;
+        if (red && !green && !blue) return 2;
+        if (green && !red && !blue) return 3;
+        if (red && blue && !green)  return 4;
+        return 0;
     }
+
+    // Other modes don't tell us a slot, keep the configured number
+    return playerNum;
 }
 
-void PlayerNumAddon::handleLED(int num) {
-    if ( playerNum != num ) {
-        tud_disconnect();
-        sleep_ms(2000 * playerNum);
-        System::reboot(System::BootMode::GAMEPAD);
-    } else {
-        assigned = 1;
+void PlayerNumAddon::handleSlot(uint8_t slot) {
+    if ( slot == 0 ) {
+        return;
+    }
+
+    if ( slot == playerNum || attempts >= PLAYERNUM_MAX_ATTEMPTS ) {
+        // Out of retries, the host probably has fewer controllers than our number, so keep its slot
+        assigned = slot;
+        state = PlayerNumState::ASSIGNED;
+        return;
     }
+
+    // Leave and come back later so lower numbered controllers can take their slots first.
+    // Higher numbers wait longer and every retry doubles the wait.
+    uint32_t backoff = attempts < PLAYERNUM_MAX_BACKOFF_SHIFT ? attempts : PLAYERNUM_MAX_BACKOFF_SHIFT;
+    reconnect_usb((PLAYERNUM_RECONNECT_DELAY_MS * playerNum) << backoff);
+    attempts++;
+    state = PlayerNumState::RECONNECTING;
 }
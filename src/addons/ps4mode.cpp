@@ -5,21 +5,16 @@
 
 #include "addons/ps4mode.h"
 #include "helper.h"
+#include "entropy.h"
 #include "config.pb.h"
 
 #include "ps4_driver.h"
 
+#include "mbedtls/bignum.h"
 #include "mbedtls/error.h"
 #include "mbedtls/rsa.h"
 #include "mbedtls/sha256.h"
 
-#define NEW_CONFIG_MPI(name, buf, size) \
-	mbedtls_mpi_uint *bytes ## name = new mbedtls_mpi_uint[size / sizeof(mbedtls_mpi_uint)]; \
-	mbedtls_mpi name = { .s=1, .n=size / sizeof(mbedtls_mpi_uint), .p=bytes ## name }; \
-	memcpy(bytes ## name, buf, size);
-
-#define DELETE_CONFIG_MPI(name) delete bytes ## name;
-
 bool PS4ModeAddon::available() {
   const PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
 	return options.enabled
@@ -35,22 +30,98 @@ void PS4ModeAddon::setup() {
 	const PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
 	ready = false;
 
-	NEW_CONFIG_MPI(N, options.rsaN.bytes, options.rsaN.size)
-	NEW_CONFIG_MPI(E, options.rsaE.bytes, options.rsaE.size)
-	NEW_CONFIG_MPI(P, options.rsaP.bytes, options.rsaP.size)
-	NEW_CONFIG_MPI(Q, options.rsaQ.bytes, options.rsaQ.size)
+	// Deriving D and the CRT values only has to happen once, later boots take them from the config
+	if (!importKey(options) || !loadKeyCache(options)) {
+		mbedtls_rsa_free(&rsa_context);
+		if (!importKey(options) || mbedtls_rsa_complete(&rsa_context) != 0) {
+			return;
+		}
+		saveKeyCache();
+	}
+
+	ready = precomputeMontgomery();
+}
 
+bool PS4ModeAddon::importKey(const PS4Options& options) {
 	mbedtls_rsa_init(&rsa_context, MBEDTLS_RSA_PKCS_V21, MBEDTLS_MD_SHA256);
+	return mbedtls_rsa_import_raw(&rsa_context,
+		options.rsaN.bytes, options.rsaN.size,
+		options.rsaP.bytes, options.rsaP.size,
+		options.rsaQ.bytes, options.rsaQ.size,
+		nullptr, 0,
+		options.rsaE.bytes, options.rsaE.size) == 0;
+}
 
-	if (mbedtls_rsa_import(&rsa_context, &N, &P, &Q, nullptr, &E) == 0 &&
-			mbedtls_rsa_complete(&rsa_context) == 0) {
-		ready = true;
+// The cached values are only used if they belong to the imported key
+bool PS4ModeAddon::loadKeyCache(const PS4Options& options) {
+	if (options.rsaD.size != sizeof(options.rsaD.bytes) || options.rsaDP.size != sizeof(options.rsaDP.bytes) ||
+			options.rsaDQ.size != sizeof(options.rsaDQ.bytes) || options.rsaQP.size != sizeof(options.rsaQP.bytes)) {
+		return false;
 	}
 
-	DELETE_CONFIG_MPI(N)
-	DELETE_CONFIG_MPI(E)
-	DELETE_CONFIG_MPI(P)
-	DELETE_CONFIG_MPI(Q)
+	int ret = 0;
+	bool valid = false;
+	mbedtls_mpi P1, Q1, T;
+	mbedtls_mpi_init(&P1);
+	mbedtls_mpi_init(&Q1);
+	mbedtls_mpi_init(&T);
+
+	MBEDTLS_MPI_CHK(mbedtls_rsa_import_raw(&rsa_context, nullptr, 0, nullptr, 0, nullptr, 0,
+		options.rsaD.bytes, options.rsaD.size, nullptr, 0));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&rsa_context.DP, options.rsaDP.bytes, options.rsaDP.size));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&rsa_context.DQ, options.rsaDQ.bytes, options.rsaDQ.size));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&rsa_context.QP, options.rsaQP.bytes, options.rsaQP.size));
+
+	// D * E = 1 mod (P - 1) and (Q - 1), DP = D mod (P - 1), DQ = D mod (Q - 1), QP * Q = 1 mod P
+	MBEDTLS_MPI_CHK(mbedtls_mpi_sub_int(&P1, &rsa_context.P, 1));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_sub_int(&Q1, &rsa_context.Q, 1));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&T, &rsa_context.D, &rsa_context.E));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &T, &P1));
+	if (mbedtls_mpi_cmp_int(&T, 1) != 0) goto cleanup;
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&T, &rsa_context.D, &rsa_context.E));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &T, &Q1));
+	if (mbedtls_mpi_cmp_int(&T, 1) != 0) goto cleanup;
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &rsa_context.D, &P1));
+	if (mbedtls_mpi_cmp_mpi(&T, &rsa_context.DP) != 0) goto cleanup;
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &rsa_context.D, &Q1));
+	if (mbedtls_mpi_cmp_mpi(&T, &rsa_context.DQ) != 0) goto cleanup;
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&T, &rsa_context.QP, &rsa_context.Q));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &T, &rsa_context.P));
+	valid = mbedtls_mpi_cmp_int(&T, 1) == 0;
+
+cleanup:
+	mbedtls_mpi_free(&P1);
+	mbedtls_mpi_free(&Q1);
+	mbedtls_mpi_free(&T);
+	return ret == 0 && valid;
+}
+
+// Saves go through core0, this only hands the values over
+void PS4ModeAddon::saveKeyCache() {
+	Storage::PS4KeyCache keyCache;
+	if (mbedtls_mpi_write_binary(&rsa_context.D, keyCache.rsaD, sizeof(keyCache.rsaD)) == 0 &&
+			mbedtls_mpi_write_binary(&rsa_context.DP, keyCache.rsaDP, sizeof(keyCache.rsaDP)) == 0 &&
+			mbedtls_mpi_write_binary(&rsa_context.DQ, keyCache.rsaDQ, sizeof(keyCache.rsaDQ)) == 0 &&
+			mbedtls_mpi_write_binary(&rsa_context.QP, keyCache.rsaQP, sizeof(keyCache.rsaQP)) == 0) {
+		Storage::getInstance().enqueuePS4KeyCacheSave(keyCache);
+	}
+}
+
+// R^2 mod M, the Montgomery constant mbedtls_mpi_exp_mod would otherwise compute on the first signature
+static int montgomeryRR(mbedtls_mpi* RR, const mbedtls_mpi* M) {
+	int ret;
+	MBEDTLS_MPI_CHK(mbedtls_mpi_lset(RR, 1));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_shift_l(RR, M->n * 2 * sizeof(mbedtls_mpi_uint) * 8));
+	MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(RR, RR, M));
+cleanup:
+	return ret;
+}
+
+// Fill the cached constants of N, P and Q so the nonce only costs the exponentiations
+bool PS4ModeAddon::precomputeMontgomery() {
+	return montgomeryRR(&rsa_context.RN, &rsa_context.N) == 0 &&
+		montgomeryRR(&rsa_context.RP, &rsa_context.P) == 0 &&
+		montgomeryRR(&rsa_context.RQ, &rsa_context.Q) == 0;
 }
 
 void PS4ModeAddon::process() {
@@ -65,14 +136,6 @@ void PS4ModeAddon::process() {
 	// Check to see if the PS4 Authentication needs work
 	if ( PS4Data::getInstance().ps4State == PS4State::nonce_ready ) {
 
-		// Generate some random for RNG
-		srand(getMillis());
-		auto rng = [](void*p_rng, unsigned char* p, size_t len) {
-			(void) p_rng;
-			p[0] = rand();
-			return 0;
-		};
-
 		uint8_t hashed_nonce[32];
 		uint8_t * nonce_buffer = PS4Data::getInstance().nonce_buffer;
 		uint8_t * ps4_auth_buffer = PS4Data::getInstance().ps4_auth_buffer;
@@ -83,7 +146,7 @@ void PS4ModeAddon::process() {
 			return;
 		}
 
-		rss_error = mbedtls_rsa_rsassa_pss_sign(&rsa_context, rng, nullptr,
+		rss_error = mbedtls_rsa_rsassa_pss_sign(&rsa_context, Entropy::mbedtlsRandom, nullptr,
 				MBEDTLS_RSA_PRIVATE, MBEDTLS_MD_SHA256,
 				32, hashed_nonce,
 				&ps4_auth_buffer[0]);
@@ -1,5 +1,6 @@
 #include "addons/reverse.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "GamepadEnums.h"
 #include "helper.h"
 #include "config.pb.h"
@@ -13,14 +14,12 @@ bool ReverseInput::available() {
 void ReverseInput::setup()
 {
     // Setup Reverse Input Button
-    gpio_init(pinButtonReverse);             // Initialize pin
-    gpio_set_dir(pinButtonReverse, GPIO_IN); // Set as INPUT
-    gpio_pull_up(pinButtonReverse);          // Set as PULLUP
+    PinRegistry::getInstance().claimInput(pinButtonReverse, ReverseName);
 
     // Setup Reverse LED if available
     const ReverseOptions& options = Storage::getInstance().getAddonOptions().reverseOptions;
     pinLED = 0xff;
-    if (isValidPin(options.ledPin)) {
+    if (isValidPin(options.ledPin) && PinRegistry::getInstance().claim(options.ledPin, ReverseName)) {
         pinLED = options.ledPin;
         gpio_init(pinLED);
         gpio_set_dir(pinLED, GPIO_OUT);
@@ -45,7 +44,8 @@ void ReverseInput::setup()
 }
 
 void ReverseInput::update() {
-    state = !gpio_get(pinButtonReverse);
+    Gamepad * gamepad = Storage::getInstance().GetGamepad();
+    state = gamepad->pressedPin(pinButtonReverse);
 }
 
 uint8_t ReverseInput::input(uint8_t valueMask, uint16_t buttonMask, uint16_t buttonMaskReverse, uint8_t action, bool invertAxis) {
@@ -61,8 +61,8 @@ void ReverseInput::process()
     // Update Reverse State
     update();
 
-    uint32_t values = ~gpio_get_all();
     Gamepad * gamepad = Storage::getInstance().GetGamepad();
+    uint32_t values = gamepad->debouncedPins;
 
     gamepad->state.dpad = 0
         | input(values & mapDpadUp->pinMask,    mapDpadUp->buttonMask,      mapDpadDown->buttonMask,    actionUp,       invertYAxis)
@@ -1,6 +1,7 @@
 #include "addons/slider_socd.h"
 
 #include "storagemanager.h"
+#include "pinregistry.h"
 
 #include "GamepadEnums.h"
 
@@ -22,19 +23,16 @@ void SliderSOCDInput::setup()
     pinSliderSOCDOne = options.pinOne;
     pinSliderSOCDTwo = options.pinTwo;
 
-    gpio_init(pinSliderSOCDOne);             // Initialize pin
-    gpio_set_dir(pinSliderSOCDOne, GPIO_IN); // Set as INPUT
-    gpio_pull_up(pinSliderSOCDOne);          // Set as PULLUP
-    gpio_init(pinSliderSOCDTwo);
-    gpio_set_dir(pinSliderSOCDTwo, GPIO_IN); // Set as INPUT
-    gpio_pull_up(pinSliderSOCDTwo);          // Set as PULLUP
+    PinRegistry::getInstance().claimInput(pinSliderSOCDOne, SliderSOCDName);
+    PinRegistry::getInstance().claimInput(pinSliderSOCDTwo, SliderSOCDName);
 }
 
 SOCDMode SliderSOCDInput::read() {
+    Gamepad * gamepad = Storage::getInstance().GetGamepad();
     if ( pinSliderSOCDOne != (uint8_t)-1 && pinSliderSOCDTwo != (uint8_t)-1) {
-        if ( !gpio_get(pinSliderSOCDOne)) {
+        if ( gamepad->pressedPin(pinSliderSOCDOne)) {
             return sliderSOCDModeOne;
-        } else if ( !gpio_get(pinSliderSOCDTwo)) {
+        } else if ( gamepad->pressedPin(pinSliderSOCDTwo)) {
             return sliderSOCDModeTwo;
         }
     }
@@ -1,24 +1,30 @@
 #include "addons/tilt.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "helper.h"
 #include "config.pb.h"
 
-// These constants define the adjustment factors for gamepad analog inputs under different tilt states.
-// Defines the behavior of the left analog stick when the Tilt1 and Tilt2 buttons are pressed.
+// The stick factors (TILT1_FACTOR_LEFT_X and friends, see tilt.h) define the adjustment of the analog
+// inputs under the different tilt states.
 // The main purpose of the left analog stick is to move the character.
 // Pressing it simultaneously with Tilt 1 will make the character walk.
 // Pressing it simultaneously with Tilt 2 will make the character walk more slowly.
-const double TILT1_FACTOR_LEFT_X = 0.35; // Adjustment factor for left analog stick X direction
-const double TILT1_FACTOR_LEFT_Y = 0.45; // Adjustment factor for left analog stick Y direction
-const double TILT2_FACTOR_LEFT_X = 0.65; // Adjustment factor for left analog stick X direction
-const double TILT2_FACTOR_LEFT_Y = 0.35; // Adjustment factor for left analog stick Y direction
-
 // The Right analog stick has 8 directions, which can be handled by pressing up, down, left, right, and simultaneously.
-// This function adds to that the ability to tilt it at an angle closer to horizontal than diagonal.
-const double TILT1_FACTOR_RIGHT_X = 0.3; // Adjustment factor for right analog stick X direction
-const double TILT1_FACTOR_RIGHT_Y = 1.7; // Adjustment factor for right analog stick Y direction
-const double TILT2_FACTOR_RIGHT_X = 0.3; // Adjustment factor for right analog stick X direction
-const double TILT2_FACTOR_RIGHT_Y = 0.3; // Adjustment factor for right analog stick Y direction
+// Tilt adds to that the ability to tilt it at an angle closer to horizontal than diagonal.
+
+// Moves an axis value towards the center by a Q15 factor
+static uint16_t tiltTowardCenter(uint16_t value, uint32_t factor)
+{
+	int64_t scaled = value + ((int64_t)(GAMEPAD_JOYSTICK_MID - value) * factor) / TILT_FACTOR_ONE;
+	return scaled < GAMEPAD_JOYSTICK_MIN ? GAMEPAD_JOYSTICK_MIN : (scaled > GAMEPAD_JOYSTICK_MAX ? GAMEPAD_JOYSTICK_MAX : scaled);
+}
+
+// Scales an axis value by a Q15 factor
+static uint16_t tiltScale(uint16_t value, uint32_t factor)
+{
+	uint64_t scaled = ((uint64_t)value * factor) / TILT_FACTOR_ONE;
+	return scaled > GAMEPAD_JOYSTICK_MAX ? GAMEPAD_JOYSTICK_MAX : scaled;
+}
 
 bool TiltInput::available() {
 	return Storage::getInstance().getAddonOptions().tiltOptions.enabled;
@@ -26,7 +32,9 @@ bool TiltInput::available() {
 
 void TiltInput::setup() {
 	const TiltOptions& options = Storage::getInstance().getAddonOptions().tiltOptions;	
+	activeOptions = &options;
 	tiltSOCDMode = options.tiltSOCDMode;
+	buildOutputTables(options);
 
 	pinTilt1 = options.tilt1Pin;
 	pinTilt2 = options.tilt2Pin;
@@ -55,14 +63,10 @@ void TiltInput::setup() {
 
 	for (int i = 0; i < 10; i++) {
 		if (pinTilt[i] != (uint8_t)-1) {
-			gpio_init(pinTilt[i]);             // Initialize pin
-			gpio_set_dir(pinTilt[i], GPIO_IN); // Set as INPUT
-			gpio_pull_up(pinTilt[i]);          // Set as PULLUP
+			PinRegistry::getInstance().claimInput(pinTilt[i], TiltName);
 		}
 	}
 
-	dDebLeftState = 0;
-	dDebRightState = 0;
 	tiltLeftState = 0;
 	tiltRightState = 0;
 
@@ -71,37 +75,6 @@ void TiltInput::setup() {
 
 	lastTiltUD = DIRECTION_NONE;
 	lastTiltLR = DIRECTION_NONE;
-
-	uint32_t now = getMillis();
-	for (int i = 0; i < 4; i++) {
-		dpadTime[i] = now;
-	}
-}
-
-void TiltInput::debounce()
-{
-	uint32_t now = getMillis();
-	Gamepad* gamepad = Storage::getInstance().GetGamepad();
-
-	for (int i = 0; i < 4; i++)
-	{
-		if ((dDebLeftState & dpadMasks[i]) != (tiltLeftState & dpadMasks[i]) && (now - dpadTime[i]) > gamepad->debounceMS)
-		{
-			dDebLeftState ^= dpadMasks[i];
-			dpadTime[i] = now;
-		}
-	}
-	tiltLeftState = dDebLeftState;
-
-	for (int i = 0; i < 4; i++)
-	{
-		if ((dDebRightState & dpadMasks[i]) != (tiltRightState & dpadMasks[i]) && (now - dpadTime[i]) > gamepad->debounceMS)
-		{
-			dDebRightState ^= dpadMasks[i];
-			dpadTime[i] = now;
-		}
-	}
-	tiltRightState = dDebRightState;
 }
 
 void TiltInput::preprocess()
@@ -111,44 +84,44 @@ void TiltInput::preprocess()
 	// Need to invert since we're using pullups
 	tiltLeftState = 0;
 	if (pinTiltLeftAnalogUp != (uint8_t)-1) {
-		tiltLeftState |= (!gpio_get(pinTiltLeftAnalogUp) ? gamepad->mapDpadUp->buttonMask : 0);
+		tiltLeftState |= (gamepad->pressedPin(pinTiltLeftAnalogUp) ? gamepad->mapDpadUp->buttonMask : 0);
 	}
 	if (pinTiltLeftAnalogDown != (uint8_t)-1) {
-		tiltLeftState |= (!gpio_get(pinTiltLeftAnalogDown) ? gamepad->mapDpadDown->buttonMask : 0);
+		tiltLeftState |= (gamepad->pressedPin(pinTiltLeftAnalogDown) ? gamepad->mapDpadDown->buttonMask : 0);
 	}
 	if (pinTiltLeftAnalogLeft != (uint8_t)-1) {
-		tiltLeftState |= (!gpio_get(pinTiltLeftAnalogLeft) ? gamepad->mapDpadLeft->buttonMask : 0);
+		tiltLeftState |= (gamepad->pressedPin(pinTiltLeftAnalogLeft) ? gamepad->mapDpadLeft->buttonMask : 0);
 	}
 	if (pinTiltLeftAnalogRight != (uint8_t)-1) {
-		tiltLeftState |= (!gpio_get(pinTiltLeftAnalogRight) ? gamepad->mapDpadRight->buttonMask : 0);
+		tiltLeftState |= (gamepad->pressedPin(pinTiltLeftAnalogRight) ? gamepad->mapDpadRight->buttonMask : 0);
 	}
 
 	tiltRightState = 0;
 	if (pinTiltRightAnalogUp != (uint8_t)-1) {
-		tiltRightState |= (!gpio_get(pinTiltRightAnalogUp) ? gamepad->mapDpadUp->buttonMask : 0);
+		tiltRightState |= (gamepad->pressedPin(pinTiltRightAnalogUp) ? gamepad->mapDpadUp->buttonMask : 0);
 	}
 	if (pinTiltRightAnalogDown != (uint8_t)-1) {
-		tiltRightState |= (!gpio_get(pinTiltRightAnalogDown) ? gamepad->mapDpadDown->buttonMask : 0);
+		tiltRightState |= (gamepad->pressedPin(pinTiltRightAnalogDown) ? gamepad->mapDpadDown->buttonMask : 0);
 	}
 	if (pinTiltRightAnalogLeft != (uint8_t)-1) {
-		tiltRightState |= (!gpio_get(pinTiltRightAnalogLeft) ? gamepad->mapDpadLeft->buttonMask : 0);
+		tiltRightState |= (gamepad->pressedPin(pinTiltRightAnalogLeft) ? gamepad->mapDpadLeft->buttonMask : 0);
 	}
 	if (pinTiltRightAnalogRight != (uint8_t)-1) {
-		tiltRightState |= (!gpio_get(pinTiltRightAnalogRight) ? gamepad->mapDpadRight->buttonMask : 0);
+		tiltRightState |= (gamepad->pressedPin(pinTiltRightAnalogRight) ? gamepad->mapDpadRight->buttonMask : 0);
 	}
-
-	// Debounce our directional pins
-	debounce();
-
-	// Convert gamepad from process() output to uint8 value
-	uint8_t gamepadState = gamepad->state.dpad;
-
-	gamepad->state.dpad = gamepadState;
 }
 
 void TiltInput::process()
 {
 	const AddonOptions& options = Storage::getInstance().getAddonOptions();
+
+	// A profile change swaps in another copy of the options, the pins stay the ones claimed at setup
+	if (&options.tiltOptions != activeOptions) {
+		activeOptions = &options.tiltOptions;
+		tiltSOCDMode = activeOptions->tiltSOCDMode;
+		buildOutputTables(*activeOptions);
+	}
+
 	SOCDTiltClean(tiltSOCDMode);
 
 	Gamepad* gamepad = Storage::getInstance().GetGamepad();
@@ -166,51 +139,56 @@ void TiltInput::process()
 //Since this is an auxiliary function for appeals and such,
 //pressing Tilt1 and Tilt2 at the same time will cause the light analog stick to correspond to each of the DPad methods.
 void TiltInput::OverrideGamepad(Gamepad* gamepad, uint8_t dpad1, uint8_t dpad2) {
-	bool pinTilt1Pressed = pinTilt1 != (uint8_t)-1 && !gpio_get(pinTilt1);
-	bool pinTilt2Pressed = pinTilt2 != (uint8_t)-1 && !gpio_get(pinTilt2);
+	bool pinTilt1Pressed = pinTilt1 != (uint8_t)-1 && gamepad->pressedPin(pinTilt1);
+	bool pinTilt2Pressed = pinTilt2 != (uint8_t)-1 && gamepad->pressedPin(pinTilt2);
 
-	if (pinTilt1Pressed) {
-		gamepad->state.lx = dpadToAnalogX(dpad1) + (GAMEPAD_JOYSTICK_MID - dpadToAnalogX(dpad1)) * TILT1_FACTOR_LEFT_X;
-		gamepad->state.ly = dpadToAnalogY(dpad1) + (GAMEPAD_JOYSTICK_MID - dpadToAnalogY(dpad1)) * TILT1_FACTOR_LEFT_Y;
-	}
-	else if (pinTilt2Pressed) {
-		gamepad->state.lx = dpadToAnalogX(dpad1) + (GAMEPAD_JOYSTICK_MID - dpadToAnalogX(dpad1)) * TILT2_FACTOR_LEFT_X;
-		gamepad->state.ly = dpadToAnalogY(dpad1) + (GAMEPAD_JOYSTICK_MID - dpadToAnalogY(dpad1)) * TILT2_FACTOR_LEFT_Y;
-	}
-	else {
-		gamepad->state.lx = dpadToAnalogX(dpad1);
-		gamepad->state.ly = dpadToAnalogY(dpad1);
-	}
+	TiltModifier modifier = pinTilt1Pressed ? TILT_MODIFIER_1 : (pinTilt2Pressed ? TILT_MODIFIER_2 : TILT_MODIFIER_NONE);
+	const TiltStickOutput& left = leftOutput[modifier][dpad1 & GAMEPAD_MASK_DPAD];
+	gamepad->state.lx = left.x;
+	gamepad->state.ly = left.y;
 
 	if (pinTilt1Pressed && pinTilt2Pressed) {
 		gamepad->state.dpad = dpad2; //Hold tilt1 + tilt2 turn on D-Pad
 	}
-	else if (pinTilt1Pressed) {
-		if (dpad2 & (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT)) {
-			gamepad->state.rx = dpadToAnalogX(dpad2) + (GAMEPAD_JOYSTICK_MID - dpadToAnalogX(dpad2)) * TILT1_FACTOR_RIGHT_X;
-			gamepad->state.ry = GAMEPAD_JOYSTICK_MID * TILT1_FACTOR_RIGHT_Y;
-		}
-		else {
-			gamepad->state.rx = dpadToAnalogX(dpad2);
-			gamepad->state.ry = dpadToAnalogY(dpad2);
-		}
-	}
-	else if (pinTilt2Pressed) {
-		if (dpad2 & (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT)) {
-			gamepad->state.rx = dpadToAnalogX(dpad2) + (GAMEPAD_JOYSTICK_MID - dpadToAnalogX(dpad2)) * TILT2_FACTOR_RIGHT_X;
-			gamepad->state.ry = GAMEPAD_JOYSTICK_MID * TILT2_FACTOR_RIGHT_Y;
-		}
-		else {
-			gamepad->state.rx = dpadToAnalogX(dpad2);
-			gamepad->state.ry = dpadToAnalogY(dpad2);
-		}
-	}
 	else {
-		gamepad->state.rx = dpadToAnalogX(dpad2);
-		gamepad->state.ry = dpadToAnalogY(dpad2);
+		const TiltStickOutput& right = rightOutput[modifier][dpad2 & GAMEPAD_MASK_DPAD];
+		gamepad->state.rx = right.x;
+		gamepad->state.ry = right.y;
 	}
 }
 
+// Resolves the stick output of every modifier and direction up front, so a poll is just a lookup
+void TiltInput::buildOutputTables(const TiltOptions& options) {
+	const uint32_t leftFactors[TILT_MODIFIER_COUNT][2] = {
+		{ 0, 0 },
+		{ options.tilt1FactorLeftX, options.tilt1FactorLeftY },
+		{ options.tilt2FactorLeftX, options.tilt2FactorLeftY },
+	};
+	const uint32_t rightFactors[TILT_MODIFIER_COUNT][2] = {
+		{ 0, 0 },
+		{ options.tilt1FactorRightX, options.tilt1FactorRightY },
+		{ options.tilt2FactorRightX, options.tilt2FactorRightY },
+	};
+
+	for (int modifier = 0; modifier < TILT_MODIFIER_COUNT; modifier++) {
+		for (uint8_t dpad = 0; dpad < TILT_DIRECTION_COUNT; dpad++) {
+			uint16_t x = dpadToAnalogX(dpad);
+			uint16_t y = dpadToAnalogY(dpad);
+
+			leftOutput[modifier][dpad].x = tiltTowardCenter(x, leftFactors[modifier][0]);
+			leftOutput[modifier][dpad].y = tiltTowardCenter(y, leftFactors[modifier][1]);
+
+			// Horizontal inputs are tilted, the vertical axis becomes a fixed offset from the center
+			if (modifier != TILT_MODIFIER_NONE && (dpad & (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT))) {
+				rightOutput[modifier][dpad].x = tiltTowardCenter(x, rightFactors[modifier][0]);
+				rightOutput[modifier][dpad].y = tiltScale(GAMEPAD_JOYSTICK_MID, rightFactors[modifier][1]);
+			} else {
+				rightOutput[modifier][dpad].x = x;
+				rightOutput[modifier][dpad].y = y;
+			}
+		}
+	}
+}
 
 void TiltInput::SOCDTiltClean(SOCDMode socdMode) {
 	// Tilt SOCD Last-Win Clean
@@ -3,6 +3,7 @@
 #include "hardware/adc.h"
 
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "helper.h"
 #include "config.pb.h"
 
@@ -18,19 +19,16 @@ bool TurboInput::available() {
 void TurboInput::setup()
 {
     const TurboOptions& options = Storage::getInstance().getAddonOptions().turboOptions;
-    Gamepad * gamepad = Storage::getInstance().GetGamepad();
-    uint32_t now = getMillis();
 
     // Setup TURBO Key GPIO
     if (  isValidPin(options.buttonPin) ) {
-        gpio_init( options.buttonPin);             // Initialize pin
-        gpio_set_dir( options.buttonPin, GPIO_IN); // Set as INPUT
-        gpio_pull_up( options.buttonPin);          // Set as PULLUP
+        PinRegistry::getInstance().claimInput(options.buttonPin, TurboName);
     }
 
     // Turbo Dial
     uint8_t shotCount = std::clamp<uint8_t>(options.shotCount, TURBO_SHOT_MIN, TURBO_SHOT_MAX);
-    if ( isValidPin(options.shmupDialPin) ) {
+    dialEnabled = isValidPin(options.shmupDialPin) && PinRegistry::getInstance().claim(options.shmupDialPin, TurboName);
+    if ( dialEnabled ) {
         adc_gpio_init(options.shmupDialPin);
         adcShmupDial = 26 - options.shmupDialPin;
         adc_select_input(adcShmupDial);
@@ -41,10 +39,12 @@ void TurboInput::setup()
     }
 
     // Setup Turbo LED if available
-    if ( isValidPin(options.ledPin) ) {
-        gpio_init(options.ledPin);
-        gpio_set_dir(options.ledPin, GPIO_OUT);
-        gpio_put(options.ledPin, 1);
+    pinLED = 0xff;
+    if ( isValidPin(options.ledPin) && PinRegistry::getInstance().claim(options.ledPin, TurboName) ) {
+        pinLED = options.ledPin;
+        gpio_init(pinLED);
+        gpio_set_dir(pinLED, GPIO_OUT);
+        gpio_put(pinLED, 1);
     }
 
     // SHMUP Mode
@@ -55,9 +55,7 @@ void TurboInput::setup()
         shmupBtnPin[3] = options.shmupBtn4Pin;
         for (uint8_t i = 0; i < 4; i++) {
             if ( isValidPin(shmupBtnPin[i]) ) {
-                gpio_init(shmupBtnPin[i]);
-                gpio_set_dir(shmupBtnPin[i], GPIO_IN);
-                gpio_pull_up(shmupBtnPin[i]);
+                PinRegistry::getInstance().claimInput(shmupBtnPin[i], TurboName);
             }
         }
         shmupBtnMask[0] = options.shmupBtnMask1; // Charge Buttons Assignment
@@ -73,18 +71,12 @@ void TurboInput::setup()
         turboButtonsPressed = 0;
     }
 
-    bDebState = false;
-    uDebTime = now;
-    debChargeState = 0;
-    for(uint8_t i = 0; i < 4; i++) {
-        debChargeTime[i] = now;
-    }
-    debounceMS = gamepad->debounceMS;
     turboDialIncrements = 0xFFF / (TURBO_SHOT_MAX - TURBO_SHOT_MIN); // 12-bit ADC
     incrementValue = 0;
     lastPressed = 0;
     lastDpad = 0;
     uIntervalMS = (uint32_t)(1000.0 / shotCount);
+    activeOptions = &options;
     bTurboState = false;
     bTurboFlicker = false;
     nextTimer = getMillis();
@@ -92,41 +84,20 @@ void TurboInput::setup()
 
 void TurboInput::read(const TurboOptions & options)
 {
+    Gamepad * gamepad = Storage::getInstance().GetGamepad();
+
     // Get Charge Buttons
     if ( options.shmupModeEnabled ) {
         chargeState = 0;
         for (uint8_t i = 0; i < 4; i++) {
             if ( shmupBtnPin[i] != (uint8_t)-1 ) { // if pin, get the GPIO
-                chargeState |= (!gpio_get(shmupBtnPin[i]) ? shmupBtnMask[i] : 0);
+                chargeState |= (gamepad->pressedPin(shmupBtnPin[i]) ? shmupBtnMask[i] : 0);
             }
         }
     }
 
     // Get TURBO Key State
-    bTurboState = !gpio_get(options.buttonPin);
-}
-
-void TurboInput::debounce()
-{
-    uint32_t uNowTime = getMillis();
-
-    // Debounce turbo button
-    if ((bDebState != bTurboState) && ((uNowTime - uDebTime) > debounceMS)) {
-        bDebState ^= true;
-        uDebTime = uNowTime;
-    }
-    bTurboState = bDebState;
-
-    // Debounce charge states
-	for (uint8_t i = 0; i < 4; i++)
-	{
-		if ((debChargeState & shmupBtnMask[i]) != (chargeState & shmupBtnMask[i]) && (uNowTime - debChargeTime[i]) > debounceMS)
-		{
-			debChargeState ^= shmupBtnMask[i];
-			debChargeTime[i] = uNowTime;
-		}
-	}
-    chargeState = debChargeState;
+    bTurboState = gamepad->pressedPin(options.buttonPin);
 }
 
 void TurboInput::process()
@@ -136,9 +107,16 @@ void TurboInput::process()
     uint16_t buttonsPressed = gamepad->state.buttons & TURBO_BUTTON_MASK;
     uint16_t dpadPressed = gamepad->state.dpad & GAMEPAD_MASK_DPAD;
 
+    // A profile change swaps in another copy of the options, the dial keeps setting the speed if there is one
+    if ( &options != activeOptions ) {
+        activeOptions = &options;
+        if ( !dialEnabled ) {
+            uIntervalMS = (uint32_t)(1000.0 / std::clamp<uint8_t>(options.shotCount, TURBO_SHOT_MIN, TURBO_SHOT_MAX));
+        }
+    }
+
     // Get Turbo Button States
     read(options);
-    debounce();
 
     // Set TURBO Enable Buttons
     if (bTurboState) {
@@ -168,7 +146,7 @@ void TurboInput::process()
     }
 
     // Use the dial to modify our turbo shot speed (don't save on dial modify)
-    if ( isValidPin(options.shmupDialPin) ) {
+    if ( dialEnabled ) {
         adc_select_input(adcShmupDial);
         uint16_t rawValue = adc_read();
         if ( rawValue != dialValue ) {
@@ -178,11 +156,11 @@ void TurboInput::process()
     }
 
     // Set TURBO LED if a button is going or turbo is too fast
-    if ( isValidPin(options.ledPin) ) {
+    if ( pinLED != 0xff ) {
         if ((gamepad->state.buttons & turboButtonsPressed) && !bTurboFlicker) {
-            gpio_put(options.ledPin, 0);
+            gpio_put(pinLED, 0);
         } else {
-            gpio_put(options.ledPin, 1);
+            gpio_put(pinLED, 1);
         }
     }
 
@@ -211,7 +189,12 @@ void TurboInput::process()
 void TurboInput::updateTurboShotCount(uint8_t shotCount)
 {
     TurboOptions& options = Storage::getInstance().getAddonOptions().turboOptions;
+    const uint8_t previousShotCount = options.shotCount;
     options.shotCount = std::clamp<uint8_t>(shotCount, TURBO_SHOT_MIN, TURBO_SHOT_MAX);
+    if (options.shotCount != previousShotCount) {
+        Storage::getInstance().PushGamepadEvent({ GamepadEventType::TURBO_RATE_CHANGE,
+            options.shotCount, options.shotCount > previousShotCount });
+    }
     Storage::getInstance().save();
     uIntervalMS = (uint32_t)(1000.0 / options.shotCount);
 }
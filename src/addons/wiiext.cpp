@@ -1,5 +1,6 @@
 #include "addons/wiiext.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "hardware/gpio.h"
 #include "helper.h"
 #include "config.pb.h"
@@ -20,6 +21,9 @@ void WiiExtensionInput::setup() {
 #endif
 
     uIntervalMS = 0;
+
+    PinRegistry::getInstance().claim(options.i2cSDAPin, PIN_OWNER_I2C);
+    PinRegistry::getInstance().claim(options.i2cSCLPin, PIN_OWNER_I2C);
     
     wii = new WiiExtension(
         options.i2cSDAPin,
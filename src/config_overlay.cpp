@@ -0,0 +1,98 @@
+#include "config_utils.h"
+
+#include "config.pb.h"
+#include "pb_encode.h"
+#include "pb_decode.h"
+#include "pb_common.h"
+
+#include <cassert>
+#include <cstring>
+
+// -----------------------------------------------------
+// Profile overlays
+// -----------------------------------------------------
+
+// Decoding without initialization merges the overlay into dest: set scalars are replaced, sub-messages are merged field
+// by field and everything the overlay does not carry keeps its value
+bool ConfigUtils::mergeOverlay(const pb_msgdesc_t* fields, void* dest, const uint8_t* data, size_t size)
+{
+    pb_istream_t inputStream = pb_istream_from_buffer(data, size);
+    return pb_decode_ex(&inputStream, fields, dest, PB_DECODE_NOINIT);
+}
+
+static bool fieldDiffers(const pb_field_iter_t& iter, const pb_field_iter_t& baseIter)
+{
+    switch (PB_LTYPE(iter.type))
+    {
+        case PB_LTYPE_BYTES:
+        {
+            // Only the used part of the buffer is compared
+            const pb_bytes_array_t* bytes = reinterpret_cast<const pb_bytes_array_t*>(iter.pData);
+            const pb_bytes_array_t* baseBytes = reinterpret_cast<const pb_bytes_array_t*>(baseIter.pData);
+            return bytes->size != baseBytes->size || memcmp(bytes->bytes, baseBytes->bytes, bytes->size) != 0;
+        }
+
+        case PB_LTYPE_STRING:
+            return strncmp(reinterpret_cast<const char*>(iter.pData), reinterpret_cast<const char*>(baseIter.pData), iter.data_size) != 0;
+
+        default:
+            return memcmp(iter.pData, baseIter.pData, iter.data_size) != 0;
+    }
+}
+
+// Sets the has_XXX flag of every field that differs from base and clears all others.
+// Returns true if any field differs.
+static bool setChangedFlags(const pb_msgdesc_t* fields, void* s, const void* base)
+{
+    pb_field_iter_t iter;
+    pb_field_iter_t baseIter;
+    if (!pb_field_iter_begin(&iter, fields, s) || !pb_field_iter_begin_const(&baseIter, fields, base))
+    {
+        return false;
+    }
+
+    bool changed = false;
+    do
+    {
+        // Repeated fields would be appended to on merge, overlays only support optional fields
+        assert(PB_HTYPE(iter.type) == PB_HTYPE_OPTIONAL);
+
+        const bool fieldChanged = PB_LTYPE(iter.type) == PB_LTYPE_SUBMESSAGE ?
+            setChangedFlags(iter.submsg_desc, iter.pData, baseIter.pData) :
+            fieldDiffers(iter, baseIter);
+
+        if (iter.pSize)
+        {
+            *reinterpret_cast<char*>(iter.pSize) = fieldChanged;
+        }
+        changed |= fieldChanged;
+    } while (pb_field_iter_next(&iter) && pb_field_iter_next(&baseIter));
+
+    return changed;
+}
+
+// value is reduced to the fields that differ from base. An overlay without differences is encoded as zero bytes.
+// If the differences don't fit, data is left as it was.
+bool ConfigUtils::encodeOverlay(const pb_msgdesc_t* fields, void* value, const void* base, uint8_t* data, pb_size_t& size, size_t maxSize)
+{
+    if (!setChangedFlags(fields, value, base))
+    {
+        size = 0;
+        return true;
+    }
+
+    size_t encodedSize = 0;
+    if (!pb_get_encoded_size(&encodedSize, fields, value) || encodedSize > maxSize)
+    {
+        return false;
+    }
+
+    pb_ostream_t outputStream = pb_ostream_from_buffer(data, maxSize);
+    if (!pb_encode(&outputStream, fields, value))
+    {
+        return false;
+    }
+
+    size = outputStream.bytes_written;
+    return true;
+}
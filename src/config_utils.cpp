@@ -8,6 +8,7 @@
 
 #include "BoardConfig.h"
 #include "GamepadConfig.h"
+#include "gamepad/HIDGenericDescriptor.h"
 #include "helper.h"
 #include "addons/analog.h"
 #include "addons/board_led.h"
@@ -82,6 +83,27 @@
 #ifndef DEFAULT_SOCD_MODE
     #define DEFAULT_SOCD_MODE SOCD_MODE_NEUTRAL
 #endif
+#ifndef DEFAULT_HID_CUSTOM_LAYOUT
+    #define DEFAULT_HID_CUSTOM_LAYOUT false
+#endif
+#ifndef DEFAULT_HID_COMPOSITE
+    #define DEFAULT_HID_COMPOSITE false
+#endif
+#ifndef DEFAULT_HID_KEYBOARD_ROUTE_MASK
+    #define DEFAULT_HID_KEYBOARD_ROUTE_MASK 0
+#endif
+#ifndef DEFAULT_INPUT_MODE_AUTO_DETECT
+    #define DEFAULT_INPUT_MODE_AUTO_DETECT false
+#endif
+#ifndef CLOCK_GOVERNOR_ENABLED
+    #define CLOCK_GOVERNOR_ENABLED 0
+#endif
+#ifndef CLOCK_GOVERNOR_IDLE_DIVIDER
+    #define CLOCK_GOVERNOR_IDLE_DIVIDER 4
+#endif
+#ifndef CLOCK_GOVERNOR_IDLE_TIMEOUT_MS
+    #define CLOCK_GOVERNOR_IDLE_TIMEOUT_MS 30000
+#endif
 
 void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
 {
@@ -98,6 +120,13 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.gamepadOptions, lockHotkeys, DEFAULT_LOCK_HOTKEYS);
     INIT_UNSET_PROPERTY(config.gamepadOptions, fourWayMode, false);
     INIT_UNSET_PROPERTY(config.gamepadOptions, profileNumber, 1);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, hidCustomLayout, DEFAULT_HID_CUSTOM_LAYOUT);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, hidButtonCount, HID_GENERIC_DEFAULT_BUTTONS);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, hidAxisCount, HID_GENERIC_DEFAULT_AXES);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, hidAxisResolution, HID_GENERIC_DEFAULT_AXIS_BITS);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, inputModeAutoDetect, DEFAULT_INPUT_MODE_AUTO_DETECT);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, hidComposite, DEFAULT_HID_COMPOSITE);
+    INIT_UNSET_PROPERTY(config.gamepadOptions, hidKeyboardRouteMask, DEFAULT_HID_KEYBOARD_ROUTE_MASK);
 
     // hotkeyOptions
     HotkeyOptions& hotkeyOptions = config.hotkeyOptions;
@@ -150,6 +179,11 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(hotkeyOptions.hotkey12, dpadMask, HOTKEY_12_DPAD_MASK);
     INIT_UNSET_PROPERTY(hotkeyOptions.hotkey12, action, GamepadHotkey(HOTKEY_12_ACTION));
 
+    // powerOptions
+    INIT_UNSET_PROPERTY(config.powerOptions, clockGovernorEnabled, !!CLOCK_GOVERNOR_ENABLED);
+    INIT_UNSET_PROPERTY(config.powerOptions, idleClockDivider, CLOCK_GOVERNOR_IDLE_DIVIDER);
+    INIT_UNSET_PROPERTY(config.powerOptions, idleTimeoutMs, CLOCK_GOVERNOR_IDLE_TIMEOUT_MS);
+
     // forcedSetupMode
     INIT_UNSET_PROPERTY(config.forcedSetupOptions, mode, DEFAULT_FORCED_SETUP_MODE);
 
@@ -195,7 +229,7 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.keyboardMapping, keyButtonA2, KEY_BUTTON_A2);
 
     // displayOptions
-    INIT_UNSET_PROPERTY(config.displayOptions, enabled, !!HAS_I2C_DISPLAY);
+    INIT_UNSET_PROPERTY(config.displayOptions, enabled, HAS_I2C_DISPLAY > 0);
     INIT_UNSET_PROPERTY(config.displayOptions, i2cBlock, (I2C_BLOCK == i2c0) ? 0 : 1);
     INIT_UNSET_PROPERTY(config.displayOptions, i2cSDAPin, I2C_SDA_PIN);
     INIT_UNSET_PROPERTY(config.displayOptions, i2cSCLPin, I2C_SCL_PIN);
@@ -442,11 +476,20 @@ void ConfigUtils::initUnsetPropertiesWithDefaults(Config& config)
     INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tiltRightAnalogLeftPin, PIN_TILT_RIGHT_ANALOG_LEFT);
     INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tiltRightAnalogRightPin, PIN_TILT_RIGHT_ANALOG_RIGHT);
     INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tiltSOCDMode, TILT_SOCD_MODE);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt1FactorLeftX, TILT1_FACTOR_LEFT_X);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt1FactorLeftY, TILT1_FACTOR_LEFT_Y);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt2FactorLeftX, TILT2_FACTOR_LEFT_X);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt2FactorLeftY, TILT2_FACTOR_LEFT_Y);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt1FactorRightX, TILT1_FACTOR_RIGHT_X);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt1FactorRightY, TILT1_FACTOR_RIGHT_Y);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt2FactorRightX, TILT2_FACTOR_RIGHT_X);
+    INIT_UNSET_PROPERTY(config.addonOptions.tiltOptions, tilt2FactorRightY, TILT2_FACTOR_RIGHT_Y);
 
     // addonOptions.buzzerOptions
     INIT_UNSET_PROPERTY(config.addonOptions.buzzerOptions, enabled, !!BUZZER_ENABLED);
     INIT_UNSET_PROPERTY(config.addonOptions.buzzerOptions, pin, BUZZER_PIN);
     INIT_UNSET_PROPERTY(config.addonOptions.buzzerOptions, volume, BUZZER_VOLUME);
+    INIT_UNSET_PROPERTY(config.addonOptions.buzzerOptions, cueMask, BUZZER_CUE_MASK);
 
     // addonOptions.extraOptions
     INIT_UNSET_PROPERTY(config.addonOptions.extraButtonOptions, enabled, !!EXTRA_BUTTON_ENABLED);
@@ -779,7 +822,7 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
 #define TO_JSON_BOOL(fieldname, submessageType) str.append((s.fieldname) ? "true" : "false");
 #define TO_JSON_STRING(fieldname, submessageType) str.push_back('"'); str.append(s.fieldname); str.push_back('"');
 #define TO_JSON_BYTES(fieldname, submessageType) str.push_back('"'); str.append(Base64::Encode(reinterpret_cast<const char*>(s.fieldname.bytes), s.fieldname.size)); str.push_back('"');
-#define TO_JSON_MESSAGE(fieldname, submessageType) PREPROCESSOR_JOIN(toJSON, submessageType)(str, s.fieldname, indentLevel + 1);
+#define TO_JSON_MESSAGE(fieldname, submessageType) PREPROCESSOR_JOIN(toJSON, submessageType)(str, s.fieldname, indentLevel + 1, onlySet);
 
 #define TO_JSON_REPEATED_RENUM(fieldname, submessageType) appendAsString(str, static_cast<int32_t>(s.fieldname[i]));
 #define TO_JSON_REPEATED_UENUM(fieldname, submessageType) appendAsString(str, static_cast<uint32_t>(s.fieldname[i]));
@@ -788,7 +831,7 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
 #define TO_JSON_REPEATED_BOOL(fieldname, submessageType) str.append((s.fieldname[i]) ? "true" : "false");
 #define TO_JSON_REPEATED_STRING(fieldname, submessageType) str.push_back('"'); str.append(s.fieldname[i]); str.push_back('"');
 #define TO_JSON_REPEATED_BYTES(fieldname, submessageType) static_assert(false, "not supported");
-#define TO_JSON_REPEATED_MESSAGE(fieldname, submessageType) PREPROCESSOR_JOIN(toJSON, submessageType)(str, s.fieldname[i], indentLevel + 1);
+#define TO_JSON_REPEATED_MESSAGE(fieldname, submessageType) PREPROCESSOR_JOIN(toJSON, submessageType)(str, s.fieldname[i], indentLevel + 1, onlySet);
 
 #define TO_JSON_REPEATED(ltype, fieldname, submessageType) \
     str.append("["); \
@@ -813,8 +856,20 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
 #define TO_JSON_POINTER(htype, ltype, fieldname, submessageType) static_assert(false, "not supported");
 #define TO_JSON_CALLBACK(htype, ltype, fieldname, submessageType) static_assert(false, "not supported");
 
+#define TO_JSON_IS_SET_REQUIRED(fieldname) true
+#define TO_JSON_IS_SET_OPTIONAL(fieldname) s.PREPROCESSOR_JOIN(has_, fieldname)
+#define TO_JSON_IS_SET_REPEATED(fieldname) (s.PREPROCESSOR_JOIN(fieldname, _count) > 0)
+#define TO_JSON_IS_SET_SINGULAR(fieldname) true
+#define TO_JSON_IS_SET_FIXARRAY(fieldname) true
+#define TO_JSON_IS_SET_ONEOF(fieldname) true
+
+#define TO_JSON_IS_SET_STATIC(htype, fieldname) PREPROCESSOR_JOIN(TO_JSON_IS_SET_, htype)(fieldname)
+#define TO_JSON_IS_SET_POINTER(htype, fieldname) true
+#define TO_JSON_IS_SET_CALLBACK(htype, fieldname) true
+
+// With onlySet, fields whose has_XXX flag is cleared are skipped
 #define TO_JSON_FIELD(parenttype, atype, htype, ltype, fieldname, tag, disallow_export) \
-    if (!disallow_export) \
+    if (!disallow_export && (!onlySet || PREPROCESSOR_JOIN(TO_JSON_IS_SET_, atype)(htype, fieldname))) \
     { \
         if (!firstField) str.append(",\n"); \
         firstField = false; \
@@ -823,10 +878,10 @@ static void __attribute__((noinline)) appendAsString(std::string& str, uint32_t
         PREPROCESSOR_JOIN(TO_JSON_, atype)(htype, ltype, fieldname, parenttype ## _ ## fieldname ## _MSGTYPE) \
     }
 
-#define GEN_TO_JSON_FUNCTION_DECL(structtype) static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel);
+#define GEN_TO_JSON_FUNCTION_DECL(structtype) static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel, bool onlySet);
 
 #define GEN_TO_JSON_FUNCTION(structtype) \
-    static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel) \
+    static void toJSON ## structtype(std::string& str, const structtype& s, int indentLevel, bool onlySet) \
     { \
         bool firstField = true; \
         str.append("{\n"); \
@@ -849,7 +904,7 @@ std::string ConfigUtils::toJSON(const Config& config)
 {
     std::string str;
     str.reserve(1024 * 4);
-    toJSONConfig(str, config, 1);
+    toJSONConfig(str, config, 1, false);
     str.push_back('\n');
 
     return str;
@@ -1051,6 +1106,7 @@ static bool fromJsonBytes(JsonObjectConst jsonObject, const char* fieldname, uin
         { \
             return false; \
         } \
+        configStruct.PREPROCESSOR_JOIN(has_, fieldname) = true; \
     }
 
 #define FROM_JSON_REPEATED_ENUM(fieldname, enumType) \
@@ -1206,3 +1262,139 @@ bool ConfigUtils::fromJSON(Config& config, const char* data, size_t dataLen)
 
     return true;
 }
+
+// -----------------------------------------------------
+// Profile settings
+// -----------------------------------------------------
+
+// The overlay is decoded into an empty message, so only the fields it overrides are written
+template <typename T, typename Bytes>
+static void overlayToJSON(std::string& str, const char* name, const pb_msgdesc_t* fields, const Bytes& overlay,
+                          void (*toJSONMessage)(std::string&, const T&, int, bool))
+{
+    // Store the message on the heap to avoid stack overflow
+    std::unique_ptr<T> message(new T());
+    if (!ConfigUtils::mergeOverlay(fields, message.get(), overlay.bytes, overlay.size))
+    {
+        // An overlay that can't be decoded is not applied either
+        *message = T();
+    }
+
+    writeIndentation(str, 3);
+    str.append("\"").append(name).append("\": ");
+    toJSONMessage(str, *message, 4, true);
+}
+
+template <typename T, typename Bytes>
+static bool overlayFromJSON(JsonObjectConst jsonObject, const char* name, const pb_msgdesc_t* fields, Bytes& overlay,
+                            bool (*fromJSONMessage)(JsonObjectConst, T&), void (*strip)(T&))
+{
+    overlay.size = 0;
+    if (!jsonObject.containsKey(name))
+    {
+        return true;
+    }
+
+    JsonVariantConst value = jsonObject[name];
+    std::unique_ptr<T> message(new T());
+    if (!value.is<JsonObjectConst>() || !fromJSONMessage(value.as<JsonObjectConst>(), *message))
+    {
+        return false;
+    }
+    strip(*message);
+
+    pb_ostream_t outputStream = pb_ostream_from_buffer(overlay.bytes, sizeof(overlay.bytes));
+    if (!pb_encode(&outputStream, fields, message.get()))
+    {
+        return false;
+    }
+
+    overlay.size = outputStream.bytes_written;
+    return true;
+}
+
+// The profile number and the PS4 key belong to the device, they are never part of a profile
+static void stripGamepadOptions(GamepadOptions& options) { options.has_profileNumber = false; }
+static void stripAddonOptions(AddonOptions& options) { options.has_ps4Options = false; }
+static void stripAnimationOptions(AnimationOptions_Proto&) {}
+static void stripHotkeyOptions(HotkeyOptions&) {}
+
+std::string ConfigUtils::profileSettingsToJSON(const ProfileOptions& profileOptions)
+{
+    std::string str;
+    str.reserve(1024);
+    str.append("{\n");
+    writeIndentation(str, 1);
+    str.append("\"profileSettings\": [");
+
+    for (pb_size_t i = 0; i < profileOptions.profileSettings_count; i++)
+    {
+        const ProfileSettings& settings = profileOptions.profileSettings[i];
+        if (i != 0) str.append(",");
+        str.append("\n");
+        writeIndentation(str, 2);
+        str.append("{\n");
+        overlayToJSON(str, "gamepadOptions", GamepadOptions_fields, settings.gamepadOptions, toJSONGamepadOptions);
+        str.append(",\n");
+        overlayToJSON(str, "addonOptions", AddonOptions_fields, settings.addonOptions, toJSONAddonOptions);
+        str.append(",\n");
+        overlayToJSON(str, "animationOptions", AnimationOptions_Proto_fields, settings.animationOptions, toJSONAnimationOptions_Proto);
+        str.append(",\n");
+        overlayToJSON(str, "hotkeyOptions", HotkeyOptions_fields, settings.hotkeyOptions, toJSONHotkeyOptions);
+        str.append("\n");
+        writeIndentation(str, 2);
+        str.append("}");
+    }
+
+    str.append("\n");
+    writeIndentation(str, 1);
+    str.append("]\n}\n");
+
+    return str;
+}
+
+// Every field present in the JSON becomes an override, even if it currently matches the base options
+bool ConfigUtils::profileSettingsFromJSON(ProfileOptions& profileOptions, const char* data, size_t dataLen)
+{
+    DynamicJsonDocument doc(1024 * 10);
+    if (deserializeJson(doc, data, dataLen) != DeserializationError::Ok || !doc.is<JsonObject>())
+    {
+        return false;
+    }
+
+    JsonArrayConst array = doc["profileSettings"].as<JsonArrayConst>();
+    const size_t maxCount = sizeof(profileOptions.profileSettings) / sizeof(profileOptions.profileSettings[0]);
+    if (array.isNull() || array.size() > maxCount)
+    {
+        return false;
+    }
+
+    // Decode into a copy so that a malformed request leaves the stored profiles untouched
+    std::unique_ptr<ProfileSettings[]> settings(new ProfileSettings[maxCount]());
+    for (size_t i = 0; i < array.size(); i++)
+    {
+        if (!array[i].is<JsonObjectConst>())
+        {
+            return false;
+        }
+
+        JsonObjectConst jsonObject = array[i].as<JsonObjectConst>();
+        ProfileSettings& profile = settings[i];
+        if (!overlayFromJSON(jsonObject, "gamepadOptions", GamepadOptions_fields, profile.gamepadOptions, fromJSONGamepadOptions, stripGamepadOptions) ||
+            !overlayFromJSON(jsonObject, "addonOptions", AddonOptions_fields, profile.addonOptions, fromJSONAddonOptions, stripAddonOptions) ||
+            !overlayFromJSON(jsonObject, "animationOptions", AnimationOptions_Proto_fields, profile.animationOptions, fromJSONAnimationOptions_Proto, stripAnimationOptions) ||
+            !overlayFromJSON(jsonObject, "hotkeyOptions", HotkeyOptions_fields, profile.hotkeyOptions, fromJSONHotkeyOptions, stripHotkeyOptions))
+        {
+            return false;
+        }
+        profile.has_gamepadOptions = true;
+        profile.has_addonOptions = true;
+        profile.has_animationOptions = true;
+        profile.has_hotkeyOptions = true;
+    }
+
+    memcpy(profileOptions.profileSettings, settings.get(), sizeof(profileOptions.profileSettings));
+    profileOptions.profileSettings_count = array.size();
+
+    return true;
+}
@@ -1,6 +1,5 @@
 #include "configmanager.h"
 
-#include "addonmanager.h"
 #include "configs/webconfig.h"
 #include "addons/neopicoleds.h"
 
@@ -3,9 +3,11 @@
 #include "configs/base64.h"
 
 #include "storagemanager.h"
+#include "pinregistry.h"
 #include "configmanager.h"
 #include "AnimationStorage.hpp"
 #include "system.h"
+#include "taskscheduler.h"
 #include "config_utils.h"
 
 #include <cstring>
@@ -386,10 +388,30 @@ std::string serialize_json(JsonDocument &doc)
 	return data;
 }
 
+// Pins two features tried to use, as recorded by the pin registry during setup
+void addPinConflictsArray(DynamicJsonDocument& doc)
+{
+	auto pinConflicts = doc.createNestedArray("pinConflicts");
+
+	const PinRegistry& pinRegistry = PinRegistry::getInstance();
+	const uint32_t conflictMask = pinRegistry.getConflictMask();
+	for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+	{
+		if (conflictMask & (1u << pin))
+		{
+			JsonObject conflict = pinConflicts.createNestedObject();
+			conflict["pin"] = pin;
+			conflict["owner"] = pinRegistry.getOwner(pin);
+			conflict["conflictOwner"] = pinRegistry.getConflictOwner(pin);
+		}
+	}
+}
+
 std::string getUsedPins()
 {
 	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
 	addUsedPinsArray(doc);
+	addPinConflictsArray(doc);
 	return serialize_json(doc);
 }
 
@@ -558,6 +580,26 @@ std::string getProfileOptions()
 	return serialize_json(doc);
 }
 
+std::string getProfileSettings()
+{
+	return ConfigUtils::profileSettingsToJSON(Storage::getInstance().getProfileOptions());
+}
+
+DataAndStatusCode setProfileSettings()
+{
+	if (!ConfigUtils::profileSettingsFromJSON(Storage::getInstance().getProfileOptions(), http_post_payload, http_post_payload_len))
+	{
+		return DataAndStatusCode("{ \"error\": \"invalid profile settings\" }", HttpStatusCode::_400);
+	}
+
+	if (!Storage::getInstance().save())
+	{
+		return DataAndStatusCode("{ \"error\": \"internal error while saving config\" }", HttpStatusCode::_500);
+	}
+
+	return DataAndStatusCode(getProfileSettings(), HttpStatusCode::_200);
+}
+
 std::string setGamepadOptions()
 {
 	DynamicJsonDocument doc = get_post_data();
@@ -570,6 +612,13 @@ std::string setGamepadOptions()
 	readDoc(gamepadOptions.lockHotkeys, doc, "lockHotkeys");
 	readDoc(gamepadOptions.fourWayMode, doc, "fourWayMode");
 	readDoc(gamepadOptions.profileNumber, doc, "profileNumber");
+	readDoc(gamepadOptions.hidCustomLayout, doc, "hidCustomLayout");
+	readDoc(gamepadOptions.hidButtonCount, doc, "hidButtonCount");
+	readDoc(gamepadOptions.hidAxisCount, doc, "hidAxisCount");
+	readDoc(gamepadOptions.hidAxisResolution, doc, "hidAxisResolution");
+	readDoc(gamepadOptions.inputModeAutoDetect, doc, "inputModeAutoDetect");
+	readDoc(gamepadOptions.hidComposite, doc, "hidComposite");
+	readDoc(gamepadOptions.hidKeyboardRouteMask, doc, "hidKeyboardRouteMask");
 
 	HotkeyOptions& hotkeyOptions = Storage::getInstance().getHotkeyOptions();
 	save_hotkey(&hotkeyOptions.hotkey01, doc, "hotkey01");
@@ -605,6 +654,13 @@ std::string getGamepadOptions()
 	writeDoc(doc, "lockHotkeys", gamepadOptions.lockHotkeys ? 1 : 0);
 	writeDoc(doc, "fourWayMode", gamepadOptions.fourWayMode ? 1 : 0);
 	writeDoc(doc, "profileNumber", gamepadOptions.profileNumber);
+	writeDoc(doc, "hidCustomLayout", gamepadOptions.hidCustomLayout ? 1 : 0);
+	writeDoc(doc, "hidButtonCount", gamepadOptions.hidButtonCount);
+	writeDoc(doc, "hidAxisCount", gamepadOptions.hidAxisCount);
+	writeDoc(doc, "hidAxisResolution", gamepadOptions.hidAxisResolution);
+	writeDoc(doc, "inputModeAutoDetect", gamepadOptions.inputModeAutoDetect ? 1 : 0);
+	writeDoc(doc, "hidComposite", gamepadOptions.hidComposite ? 1 : 0);
+	writeDoc(doc, "hidKeyboardRouteMask", gamepadOptions.hidKeyboardRouteMask);
 
 	const PinMappings& pinMappings = Storage::getInstance().getPinMappings();
 	writeDoc(doc, "fnButtonPin", pinMappings.pinButtonFn);
@@ -981,6 +1037,7 @@ std::string setAddonOptions()
 	BuzzerOptions& buzzerOptions = Storage::getInstance().getAddonOptions().buzzerOptions;
 	docToPin(buzzerOptions.pin, doc, "buzzerPin");
 	docToValue(buzzerOptions.volume, doc, "buzzerVolume");
+	docToValue(buzzerOptions.cueMask, doc, "buzzerCueMask");
 	docToValue(buzzerOptions.enabled, doc, "BuzzerSpeakerAddonEnabled");
 
     DualDirectionalOptions& dualDirectionalOptions = Storage::getInstance().getAddonOptions().dualDirectionalOptions;
@@ -1005,6 +1062,14 @@ std::string setAddonOptions()
 	docToPin(tiltOptions.tiltRightAnalogLeftPin, doc, "tiltRightAnalogLeftPin");
 	docToPin(tiltOptions.tiltRightAnalogRightPin, doc, "tiltRightAnalogRightPin");
 	docToValue(tiltOptions.tiltSOCDMode, doc, "tiltSOCDMode");
+	docToValue(tiltOptions.tilt1FactorLeftX, doc, "tilt1FactorLeftX");
+	docToValue(tiltOptions.tilt1FactorLeftY, doc, "tilt1FactorLeftY");
+	docToValue(tiltOptions.tilt2FactorLeftX, doc, "tilt2FactorLeftX");
+	docToValue(tiltOptions.tilt2FactorLeftY, doc, "tilt2FactorLeftY");
+	docToValue(tiltOptions.tilt1FactorRightX, doc, "tilt1FactorRightX");
+	docToValue(tiltOptions.tilt1FactorRightY, doc, "tilt1FactorRightY");
+	docToValue(tiltOptions.tilt2FactorRightX, doc, "tilt2FactorRightX");
+	docToValue(tiltOptions.tilt2FactorRightY, doc, "tilt2FactorRightY");
 	docToValue(tiltOptions.enabled, doc, "TiltInputEnabled");
 
     ExtraButtonOptions& extraButtonOptions = Storage::getInstance().getAddonOptions().extraButtonOptions;
@@ -1146,51 +1211,37 @@ std::string setPS4Options()
 		}
 	};
 
-	// RSA Context
-	if ( readEncoded("N") ) {
-		if ( Base64::Decode(encoded, decoded) && (decoded.length() == sizeof(ps4Options.rsaN.bytes)) ) {
-			memcpy(ps4Options.rsaN.bytes, decoded.data(), decoded.length());
-			ps4Options.rsaN.size = decoded.length();
-		}
-	}
-	if ( readEncoded("E") ) {
-		if ( Base64::Decode(encoded, decoded) && (decoded.length() == sizeof(ps4Options.rsaE.bytes)) ) {
-			memcpy(ps4Options.rsaE.bytes, decoded.data(), decoded.length());
-			ps4Options.rsaE.size = decoded.length();
-		}
-	}
-	if ( readEncoded("P") ) {
-		if ( Base64::Decode(encoded, decoded) && (decoded.length() == sizeof(ps4Options.rsaP.bytes)) ) {
-			memcpy(ps4Options.rsaP.bytes, decoded.data(), decoded.length());
-			ps4Options.rsaP.size = decoded.length();
-		}
-	}
-	if ( readEncoded("Q") ) {
-		if ( Base64::Decode(encoded, decoded) && (decoded.length() == sizeof(ps4Options.rsaQ.bytes)) ) {
-			memcpy(ps4Options.rsaQ.bytes, decoded.data(), decoded.length());
-			ps4Options.rsaQ.size = decoded.length();
+	// Stores a base64 field of the right length, returns true if the stored value changed
+	const auto readBytes = [&](const char* key, auto& field) -> bool
+	{
+		if ( !readEncoded(key) || !Base64::Decode(encoded, decoded) || (decoded.length() != sizeof(field.bytes)) ) {
+			return false;
 		}
-	}
+		const bool changed = field.size != decoded.length() || memcmp(field.bytes, decoded.data(), decoded.length()) != 0;
+		memcpy(field.bytes, decoded.data(), decoded.length());
+		field.size = decoded.length();
+		return changed;
+	};
+
+	// RSA Context
+	bool keyChanged = false;
+	keyChanged |= readBytes("N", ps4Options.rsaN);
+	keyChanged |= readBytes("E", ps4Options.rsaE);
+	keyChanged |= readBytes("P", ps4Options.rsaP);
+	keyChanged |= readBytes("Q", ps4Options.rsaQ);
 	// Serial & Signature
-	if ( readEncoded("serial") ) {
-		if ( Base64::Decode(encoded, decoded) && (decoded.length() == sizeof(ps4Options.serial.bytes)) ) {
-			memcpy(ps4Options.serial.bytes, decoded.data(), decoded.length());
-			ps4Options.serial.size = decoded.length();
-		}
+	readBytes("serial", ps4Options.serial);
+	readBytes("signature", ps4Options.signature);
+
+	// D and the CRT values are derived from the key and cached on the next boot, only a new key drops them
+	if (keyChanged) {
+		ps4Options.rsaD.size = 0;
+		ps4Options.rsaDP.size = 0;
+		ps4Options.rsaDQ.size = 0;
+		ps4Options.rsaQP.size = 0;
 	}
-	if ( readEncoded("signature") ) {
-		if ( Base64::Decode(encoded, decoded) && (decoded.length() == sizeof(ps4Options.signature.bytes)) ) {
-			memcpy(ps4Options.signature.bytes, decoded.data(), decoded.length());
-			ps4Options.signature.size = decoded.length();
-		}
-	}
-
-	// Zap deprecated fields
-	if (ps4Options.rsaD.size != 0) ps4Options.rsaD.size = 0;
-	if (ps4Options.rsaDP.size != 0) ps4Options.rsaDP.size = 0;
-	if (ps4Options.rsaDQ.size != 0) ps4Options.rsaDQ.size = 0;
-	if (ps4Options.rsaQP.size != 0) ps4Options.rsaQP.size = 0;
-	if (ps4Options.rsaRN.size != 0) ps4Options.rsaRN.size = 0;
+	// Deprecated, nothing reads it anymore
+	ps4Options.rsaRN.size = 0;
 
 	Storage::getInstance().save();
 
@@ -1222,6 +1273,7 @@ std::string getAddonOptions()
     const BuzzerOptions& buzzerOptions = Storage::getInstance().getAddonOptions().buzzerOptions;
 	writeDoc(doc, "buzzerPin", cleanPin(buzzerOptions.pin));
 	writeDoc(doc, "buzzerVolume", buzzerOptions.volume);
+	writeDoc(doc, "buzzerCueMask", buzzerOptions.cueMask);
 	writeDoc(doc, "BuzzerSpeakerAddonEnabled", buzzerOptions.enabled);
 
     const DualDirectionalOptions& dualDirectionalOptions = Storage::getInstance().getAddonOptions().dualDirectionalOptions;
@@ -1246,6 +1298,14 @@ std::string getAddonOptions()
 	writeDoc(doc, "tiltRightAnalogLeftPin", cleanPin(tiltOptions.tiltRightAnalogLeftPin));
 	writeDoc(doc, "tiltRightAnalogRightPin", cleanPin(tiltOptions.tiltRightAnalogRightPin));
 	writeDoc(doc, "tiltSOCDMode", tiltOptions.tiltSOCDMode);
+	writeDoc(doc, "tilt1FactorLeftX", tiltOptions.tilt1FactorLeftX);
+	writeDoc(doc, "tilt1FactorLeftY", tiltOptions.tilt1FactorLeftY);
+	writeDoc(doc, "tilt2FactorLeftX", tiltOptions.tilt2FactorLeftX);
+	writeDoc(doc, "tilt2FactorLeftY", tiltOptions.tilt2FactorLeftY);
+	writeDoc(doc, "tilt1FactorRightX", tiltOptions.tilt1FactorRightX);
+	writeDoc(doc, "tilt1FactorRightY", tiltOptions.tilt1FactorRightY);
+	writeDoc(doc, "tilt2FactorRightX", tiltOptions.tilt2FactorRightX);
+	writeDoc(doc, "tilt2FactorRightY", tiltOptions.tilt2FactorRightY);
 	writeDoc(doc, "TiltInputEnabled", tiltOptions.enabled);
 
     const ExtraButtonOptions& extraButtonOptions = Storage::getInstance().getAddonOptions().extraButtonOptions;
@@ -1377,6 +1437,49 @@ std::string getMemoryReport()
 	writeDoc(doc, "staticAllocs", System::getStaticAllocs());
 	writeDoc(doc, "totalHeap", System::getTotalHeap());
 	writeDoc(doc, "usedHeap", System::getUsedHeap());
+	writeDoc(doc, "core0StackSize", System::getStackSize(0));
+	writeDoc(doc, "core0StackUsed", System::getStackHighWaterMark(0));
+	writeDoc(doc, "core1StackSize", System::getStackSize(1));
+	writeDoc(doc, "core1StackUsed", System::getStackHighWaterMark(1));
+	return serialize_json(doc);
+}
+
+// Only served in web config mode, where core0 polls the network stack without ever idling, so its
+// load always reads close to 100%. Core1 runs its add-on tasks as usual and is measured as in gamepad mode.
+// The gamepad mode figures from before the reboot are added when there are any.
+std::string getCpuLoad()
+{
+	DynamicJsonDocument doc(LWIP_HTTPD_POST_MAX_PAYLOAD_LEN);
+	writeDoc(doc, "core0Load1s", System::getLoad1s(0));
+	writeDoc(doc, "core0Load10s", System::getLoad10s(0));
+	writeDoc(doc, "core1Load1s", System::getLoad1s(1));
+	writeDoc(doc, "core1Load10s", System::getLoad10s(1));
+
+	// Gamepad mode figures kept by the web config hotkey, missing after a power-up straight into this mode
+	uint32_t load1s, load10s;
+	if (System::getPreviousLoad(0, load1s, load10s))
+	{
+		writeDoc(doc, "gamepadMode", "core0Load1s", load1s);
+		writeDoc(doc, "gamepadMode", "core0Load10s", load10s);
+	}
+	if (System::getPreviousLoad(1, load1s, load10s))
+	{
+		writeDoc(doc, "gamepadMode", "core1Load1s", load1s);
+		writeDoc(doc, "gamepadMode", "core1Load10s", load10s);
+	}
+
+	// Core1 updates the counters while they are read, each one is a single word
+	auto tasks = doc.createNestedArray("tasks");
+	for (const ScheduledTask& scheduledTask : TaskScheduler::getInstance().GetTasks())
+	{
+		JsonObject task = tasks.createNestedObject();
+		task["name"] = scheduledTask.addon->name();
+		task["periodUs"] = scheduledTask.periodUs;
+		task["runs"] = scheduledTask.stats.runs;
+		task["overruns"] = scheduledTask.stats.overruns;
+		task["lastRunUs"] = scheduledTask.stats.lastRunUs;
+		task["maxRunUs"] = scheduledTask.stats.maxRunUs;
+	}
 	return serialize_json(doc);
 }
 
@@ -1472,12 +1575,14 @@ static const std::pair<const char*, HandlerFuncPtr> handlerFuncs[] =
 	{ "/api/getLedOptions", getLedOptions },
 	{ "/api/getPinMappings", getPinMappings },
 	{ "/api/getProfileOptions", getProfileOptions },
+	{ "/api/getProfileSettings", getProfileSettings },
 	{ "/api/getKeyMappings", getKeyMappings },
 	{ "/api/getAddonsOptions", getAddonOptions },
 	{ "/api/resetSettings", resetSettings },
 	{ "/api/getSplashImage", getSplashImage },
 	{ "/api/getFirmwareVersion", getFirmwareVersion },
 	{ "/api/getMemoryReport", getMemoryReport },
+	{ "/api/getCpuLoad", getCpuLoad },
 	{ "/api/getUsedPins", getUsedPins },
 	{ "/api/getConfig", getConfig },
 #if !defined(NDEBUG)
@@ -1489,6 +1594,7 @@ typedef DataAndStatusCode (*HandlerFuncStatusCodePtr)();
 static const std::pair<const char*, HandlerFuncStatusCodePtr> handlerFuncsWithStatusCode[] =
 {
 	{ "/api/setConfig", setConfig },
+	{ "/api/setProfileSettings", setProfileSettings },
 };
 
 int fs_open_custom(struct fs_file *file, const char *name)
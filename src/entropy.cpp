@@ -0,0 +1,132 @@
+#include "entropy.h"
+
+#include "hardware/structs/rosc.h"
+#include "mbedtls/sha256.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+// von Neumann extractor: 01 and 10 give one unbiased bit, equal pairs are dropped
+static inline bool whiten(uint8_t first, uint8_t second, uint8_t& bit) {
+    if (first == second)
+        return false;
+    bit = first;
+    return true;
+}
+
+Entropy::Entropy() :
+    pool{},
+    poolCount(0),
+    pendingByte(0),
+    pendingBits(0),
+    chain{},
+    ready{},
+    readyCount(0),
+    counter(0) {
+    critical_section_init(&lock);
+}
+
+void Entropy::process() {
+    if (poolCount >= ENTROPY_POOL_SIZE)
+        return;
+
+    critical_section_enter_blocking(&lock);
+    gather(ENTROPY_PAIRS_PER_PASS);
+    critical_section_exit(&lock);
+}
+
+// Must hold the lock
+void Entropy::gather(uint32_t pairs) {
+    for (uint32_t i = 0; i < pairs && poolCount < ENTROPY_POOL_SIZE; i++) {
+        const uint8_t first = rosc_hw->randombit & 1;
+        const uint8_t second = rosc_hw->randombit & 1;
+        uint8_t bit;
+        if (!whiten(first, second, bit))
+            continue;
+
+        pendingByte = (pendingByte << 1) | bit;
+        if (++pendingBits == 8) {
+            pool[poolCount++] = pendingByte;
+            pendingByte = 0;
+            pendingBits = 0;
+        }
+    }
+}
+
+void Entropy::getBytes(uint8_t* output, size_t length) {
+    while (length > 0) {
+        critical_section_enter_blocking(&lock);
+        const size_t count = takeReady(output, length);
+        output += count;
+        length -= count;
+        if (length == 0) {
+            critical_section_exit(&lock);
+            break;
+        }
+
+        // Claim pool bytes and a counter for the next block. The hash runs unlocked so core1's
+        // process() and the other core's requests don't wait on it.
+        uint8_t input[ENTROPY_BLOCK_SIZE];
+        uint8_t lastBlock[sizeof(chain)];
+        while (poolCount < ENTROPY_BLOCK_SIZE)
+            gather(ENTROPY_PAIRS_PER_PASS);
+        poolCount -= ENTROPY_BLOCK_SIZE;
+        memcpy(input, &pool[poolCount], ENTROPY_BLOCK_SIZE);
+        memset(&pool[poolCount], 0, ENTROPY_BLOCK_SIZE);
+        memcpy(lastBlock, chain, sizeof(lastBlock));
+        const uint32_t blockCounter = counter++;
+        critical_section_exit(&lock);
+
+        uint8_t block[sizeof(chain)];
+        hashBlock(lastBlock, input, blockCounter, block);
+        memset(input, 0, sizeof(input));
+
+        // Pool bytes and counters are never shared, so blocks hashed on both cores at once still differ
+        critical_section_enter_blocking(&lock);
+        memcpy(chain, block, sizeof(chain));
+        const size_t used = std::min<size_t>(length, sizeof(block));
+        memcpy(output, block, used);
+        if (readyCount == 0) {
+            memcpy(&ready[used], &block[used], sizeof(ready) - used);
+            readyCount = sizeof(ready) - used;
+        }
+        critical_section_exit(&lock);
+        memset(block, 0, sizeof(block));
+        output += used;
+        length -= used;
+    }
+}
+
+// Must hold the lock. Bytes are handed out once, small requests share a block.
+size_t Entropy::takeReady(uint8_t* output, size_t length) {
+    const size_t count = std::min<size_t>(length, readyCount);
+    uint8_t* bytes = &ready[sizeof(ready) - readyCount];
+    memcpy(output, bytes, count);
+    memset(bytes, 0, count);
+    readyCount -= count;
+    return count;
+}
+
+void Entropy::hashBlock(const uint8_t* lastBlock, const uint8_t* input, uint32_t blockCounter, uint8_t* block) {
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    mbedtls_sha256_update_ret(&sha, lastBlock, 32);
+    mbedtls_sha256_update_ret(&sha, input, ENTROPY_BLOCK_SIZE);
+    mbedtls_sha256_update_ret(&sha, reinterpret_cast<const uint8_t*>(&blockCounter), sizeof(blockCounter));
+    mbedtls_sha256_finish_ret(&sha, block);
+    mbedtls_sha256_free(&sha);
+}
+
+uint32_t Entropy::getRandom32() {
+    uint32_t value;
+    getBytes(reinterpret_cast<uint8_t*>(&value), sizeof(value));
+    return value;
+}
+
+int Entropy::mbedtlsRandom(void* context, unsigned char* output, size_t length) {
+    (void) context;
+    getInstance().getBytes(output, length);
+    return 0;
+}
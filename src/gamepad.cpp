@@ -7,6 +7,7 @@
 #include "gamepad.h"
 #include "enums.pb.h"
 #include "storagemanager.h"
+#include "pinregistry.h"
 
 #include "FlashPROM.h"
 #include "CRC32.h"
@@ -35,6 +36,8 @@ static HIDReport hidReport
 	.l1_axis = 0x00, .r1_axis = 0x00, .l2_axis = 0x00, .r2_axis = 0x00
 };
 
+static uint8_t hidGenericReport[HID_GENERIC_MAX_REPORT_SIZE] = { };
+
 static PS4Report ps4Report
 {
 	.report_id = 0x01,
@@ -84,11 +87,26 @@ static KeyboardReport keyboardReport
 	.multimedia = 0
 };
 
+static HIDCompositeKeys compositeKeys;
+
+// Order the input mode hotkey cycles through
+static InputMode nextInputMode(InputMode mode)
+{
+	switch (mode)
+	{
+		case INPUT_MODE_XINPUT:   return INPUT_MODE_SWITCH;
+		case INPUT_MODE_SWITCH:   return INPUT_MODE_HID;
+		case INPUT_MODE_HID:      return INPUT_MODE_PS4;
+		case INPUT_MODE_PS4:      return INPUT_MODE_KEYBOARD;
+		default:                  return INPUT_MODE_XINPUT;
+	}
+}
+
 Gamepad::Gamepad(int debounceMS) :
 	debounceMS(debounceMS)
 	, debouncer(debounceMS)
-	, options(Storage::getInstance().getGamepadOptions())
-	, hotkeyOptions(Storage::getInstance().getHotkeyOptions())
+	, options(&Storage::getInstance().getGamepadOptions())
+	, hotkeyOptions(&Storage::getInstance().getHotkeyOptions())
 {}
 
 void Gamepad::setup()
@@ -125,22 +143,31 @@ void Gamepad::setup()
 		mapButtonA1, mapButtonA2
 	};
 
+	PinRegistry& pinRegistry = PinRegistry::getInstance();
 	for (int i = 0; i < GAMEPAD_DIGITAL_INPUT_COUNT; i++)
 	{
 		if (gamepadMappings[i]->isAssigned())
 		{
-			gpio_init(gamepadMappings[i]->pin);             // Initialize pin
-			gpio_set_dir(gamepadMappings[i]->pin, GPIO_IN); // Set as INPUT
-			gpio_pull_up(gamepadMappings[i]->pin);          // Set as PULLUP
+			pinRegistry.claimInput(gamepadMappings[i]->pin, PIN_OWNER_GAMEPAD);
 		}
 	}
 
 	// initialize the Function pin button/switch if it is configured
 	if (isValidPin(pinMappings.pinButtonFn)) {
-		gpio_init(pinMappings.pinButtonFn);             // Initialize pin
-		gpio_set_dir(pinMappings.pinButtonFn, GPIO_IN); // Set as INPUT
-		gpio_pull_up(pinMappings.pinButtonFn);          // Set as PULLUP
+		pinRegistry.claimInput(pinMappings.pinButtonFn, PIN_OWNER_GAMEPAD);
 	}
+
+	// Buttons are read right away for boot actions, add-on inputs are set up after their own setup
+	pinRegistry.initInputs();
+}
+
+/**
+ * @brief Each profile can have its own options, Storage swaps them when the profile changes.
+ */
+void Gamepad::reloadOptions()
+{
+	options = &Storage::getInstance().getGamepadOptions();
+	hotkeyOptions = &Storage::getInstance().getHotkeyOptions();
 }
 
 /**
@@ -152,17 +179,19 @@ void Gamepad::teardown_and_reinit(const uint32_t profileNum)
 	// deinitialize the GPIO pins so we don't have orphans
 	for (int i = 0; i < GAMEPAD_DIGITAL_INPUT_COUNT; i++)
 	{
-		if (gamepadMappings[i]->isAssigned())
+		// Pins another feature owns stay as they are
+		if (gamepadMappings[i]->isAssigned() && PinRegistry::getInstance().release(gamepadMappings[i]->pin, PIN_OWNER_GAMEPAD))
 		{
 			gpio_deinit(gamepadMappings[i]->pin);
 		}
 	}
-	if (isValidPin(pinMappings.pinButtonFn)) {
+	if (isValidPin(pinMappings.pinButtonFn) && PinRegistry::getInstance().release(pinMappings.pinButtonFn, PIN_OWNER_GAMEPAD)) {
 		gpio_deinit(pinMappings.pinButtonFn);
 	}
 
 	// set to new profile
 	Storage::getInstance().setProfile(profileNum);
+	Storage::getInstance().PushGamepadEvent({ GamepadEventType::PROFILE_CHANGE, profileNum, 0 });
 
 	// reinitialize pin mappings
 	this->setup();
@@ -173,7 +202,7 @@ void Gamepad::process()
 	memcpy(&rawState, &state, sizeof(GamepadState));
 
 	// NOTE: Inverted X/Y-axis must run before SOCD and Dpad processing
-	if (options.invertXAxis) {
+	if (options->invertXAxis) {
 		bool left = (state.dpad & mapDpadLeft->buttonMask) != 0;
 		bool right = (state.dpad & mapDpadRight->buttonMask) != 0;
 		state.dpad &= ~(mapDpadLeft->buttonMask | mapDpadRight->buttonMask);
@@ -183,7 +212,7 @@ void Gamepad::process()
 			state.dpad |= mapDpadLeft->buttonMask;
 	}
 
-	if (options.invertYAxis) {
+	if (options->invertYAxis) {
 		bool up = (state.dpad & mapDpadUp->buttonMask) != 0;
 		bool down = (state.dpad & mapDpadDown->buttonMask) != 0;
 		state.dpad &= ~(mapDpadUp->buttonMask | mapDpadDown->buttonMask);
@@ -193,14 +222,14 @@ void Gamepad::process()
 			state.dpad |= mapDpadUp->buttonMask;
 	}
 
-	state.dpad = runSOCDCleaner(resolveSOCDMode(options), state.dpad);
+	state.dpad = runSOCDCleaner(resolveSOCDMode(*options), state.dpad);
 
 	// SOCD cleaning first, allows for control over which diagonal to take/filter
-	if (options.fourWayMode) {
+	if (options->fourWayMode) {
 		state.dpad = filterToFourWayMode(state.dpad);
 	}
 
-	switch (options.dpadMode)
+	switch (options->dpadMode)
 	{
 		case DpadMode::DPAD_MODE_LEFT_ANALOG:
 			if (!hasRightAnalogStick) {
@@ -237,12 +266,29 @@ void Gamepad::process()
 
 void Gamepad::read()
 {
-	const PinMappings& pinMappings = Storage::getInstance().getProfilePinMappings();
 	// Need to invert since we're using pullups
-	uint32_t values = ~gpio_get_all();
+	rawPins = ~gpio_get_all() & GAMEPAD_PIN_MASK;
+	debouncedPins = rawPins;
+	mapPins(rawPins);
 
-	state.aux = 0
-		| (values & (1 << pinMappings.pinButtonFn)) ? AUX_MASK_FUNCTION : 0;
+	state.lx = GAMEPAD_JOYSTICK_MID;
+	state.ly = GAMEPAD_JOYSTICK_MID;
+	state.rx = GAMEPAD_JOYSTICK_MID;
+	state.ry = GAMEPAD_JOYSTICK_MID;
+	state.lt = 0;
+	state.rt = 0;
+}
+
+void Gamepad::debounce() {
+	debouncedPins = debouncer.debounce(rawPins);
+	mapPins(debouncedPins);
+}
+
+void Gamepad::mapPins(uint32_t values)
+{
+	const PinMappings& pinMappings = Storage::getInstance().getProfilePinMappings();
+
+	state.aux = (isValidPin(pinMappings.pinButtonFn) && (values & (1u << pinMappings.pinButtonFn))) ? AUX_MASK_FUNCTION : 0;
 
 	state.dpad = 0
 		| ((values & mapDpadUp->pinMask)    ? mapDpadUp->buttonMask : 0)
@@ -267,17 +313,6 @@ void Gamepad::read()
 		| ((values & mapButtonA1->pinMask)  ? mapButtonA1->buttonMask  : 0)
 		| ((values & mapButtonA2->pinMask)  ? mapButtonA2->buttonMask  : 0)
 	;
-
-	state.lx = GAMEPAD_JOYSTICK_MID;
-	state.ly = GAMEPAD_JOYSTICK_MID;
-	state.rx = GAMEPAD_JOYSTICK_MID;
-	state.ry = GAMEPAD_JOYSTICK_MID;
-	state.lt = 0;
-	state.rt = 0;
-}
-
-void Gamepad::debounce() {
-	debouncer.debounce(&state);
 }
 
 void Gamepad::save()
@@ -287,26 +322,47 @@ void Gamepad::save()
 
 void Gamepad::hotkey()
 {
-	if (options.lockHotkeys) return;
+	if (options->lockHotkeys) return;
 
 	GamepadHotkey action = HOTKEY_NONE;
 
-	if (pressedHotkey(hotkeyOptions.hotkey01))	action = selectHotkey(hotkeyOptions.hotkey01);
-	else if (pressedHotkey(hotkeyOptions.hotkey02))	action = selectHotkey(hotkeyOptions.hotkey02);
-	else if (pressedHotkey(hotkeyOptions.hotkey03))	action = selectHotkey(hotkeyOptions.hotkey03);
-	else if (pressedHotkey(hotkeyOptions.hotkey04))	action = selectHotkey(hotkeyOptions.hotkey04);
-	else if (pressedHotkey(hotkeyOptions.hotkey05))	action = selectHotkey(hotkeyOptions.hotkey05);
-	else if (pressedHotkey(hotkeyOptions.hotkey06))	action = selectHotkey(hotkeyOptions.hotkey06);
-	else if (pressedHotkey(hotkeyOptions.hotkey07))	action = selectHotkey(hotkeyOptions.hotkey07);
-	else if (pressedHotkey(hotkeyOptions.hotkey08))	action = selectHotkey(hotkeyOptions.hotkey08);
-	else if (pressedHotkey(hotkeyOptions.hotkey09))	action = selectHotkey(hotkeyOptions.hotkey09);
-	else if (pressedHotkey(hotkeyOptions.hotkey10))	action = selectHotkey(hotkeyOptions.hotkey10);
-	else if (pressedHotkey(hotkeyOptions.hotkey11))	action = selectHotkey(hotkeyOptions.hotkey11);
-	else if (pressedHotkey(hotkeyOptions.hotkey12))	action = selectHotkey(hotkeyOptions.hotkey12);
+	if (pressedHotkey(hotkeyOptions->hotkey01))	action = selectHotkey(hotkeyOptions->hotkey01);
+	else if (pressedHotkey(hotkeyOptions->hotkey02))	action = selectHotkey(hotkeyOptions->hotkey02);
+	else if (pressedHotkey(hotkeyOptions->hotkey03))	action = selectHotkey(hotkeyOptions->hotkey03);
+	else if (pressedHotkey(hotkeyOptions->hotkey04))	action = selectHotkey(hotkeyOptions->hotkey04);
+	else if (pressedHotkey(hotkeyOptions->hotkey05))	action = selectHotkey(hotkeyOptions->hotkey05);
+	else if (pressedHotkey(hotkeyOptions->hotkey06))	action = selectHotkey(hotkeyOptions->hotkey06);
+	else if (pressedHotkey(hotkeyOptions->hotkey07))	action = selectHotkey(hotkeyOptions->hotkey07);
+	else if (pressedHotkey(hotkeyOptions->hotkey08))	action = selectHotkey(hotkeyOptions->hotkey08);
+	else if (pressedHotkey(hotkeyOptions->hotkey09))	action = selectHotkey(hotkeyOptions->hotkey09);
+	else if (pressedHotkey(hotkeyOptions->hotkey10))	action = selectHotkey(hotkeyOptions->hotkey10);
+	else if (pressedHotkey(hotkeyOptions->hotkey11))	action = selectHotkey(hotkeyOptions->hotkey11);
+	else if (pressedHotkey(hotkeyOptions->hotkey12))	action = selectHotkey(hotkeyOptions->hotkey12);
 	else                                        lastAction = HOTKEY_NONE;
 	processHotkeyIfNewAction(action);
 }
 
+// Value of the setting a hotkey action changed, sent along with the action so core1 doesn't read core0's options
+static uint32_t hotkeySetting(GamepadHotkey action, const GamepadOptions& options)
+{
+	switch (action) {
+		case HOTKEY_DPAD_DIGITAL:
+		case HOTKEY_DPAD_LEFT_ANALOG:
+		case HOTKEY_DPAD_RIGHT_ANALOG:     return options.dpadMode;
+		case HOTKEY_SOCD_UP_PRIORITY:
+		case HOTKEY_SOCD_NEUTRAL:
+		case HOTKEY_SOCD_LAST_INPUT:
+		case HOTKEY_SOCD_FIRST_INPUT:
+		case HOTKEY_SOCD_BYPASS:           return options.socdMode;
+		case HOTKEY_INVERT_X_AXIS:         return options.invertXAxis;
+		case HOTKEY_INVERT_Y_AXIS:         return options.invertYAxis;
+		case HOTKEY_TOGGLE_4_WAY_MODE:     return options.fourWayMode;
+		case HOTKEY_TOGGLE_DDI_4_WAY_MODE: return Storage::getInstance().getAddonOptions().dualDirectionalOptions.fourWayMode;
+		case HOTKEY_NEXT_INPUT_MODE:       return options.inputMode;
+		default:                           return 0;
+	}
+}
+
 /**
  * @brief Take a hotkey action if it hasn't already been taken, modifying state/options appropriately.
  */
@@ -315,26 +371,26 @@ void Gamepad::processHotkeyIfNewAction(GamepadHotkey action)
 	bool reqSave = false;
 	switch (action) {
 		case HOTKEY_NONE              : return;
-		case HOTKEY_DPAD_DIGITAL      : options.dpadMode = DPAD_MODE_DIGITAL; reqSave = true; break;
-		case HOTKEY_DPAD_LEFT_ANALOG  : options.dpadMode = DPAD_MODE_LEFT_ANALOG; reqSave = true; break;
-		case HOTKEY_DPAD_RIGHT_ANALOG : options.dpadMode = DPAD_MODE_RIGHT_ANALOG; reqSave = true; break;
+		case HOTKEY_DPAD_DIGITAL      : options->dpadMode = DPAD_MODE_DIGITAL; reqSave = true; break;
+		case HOTKEY_DPAD_LEFT_ANALOG  : options->dpadMode = DPAD_MODE_LEFT_ANALOG; reqSave = true; break;
+		case HOTKEY_DPAD_RIGHT_ANALOG : options->dpadMode = DPAD_MODE_RIGHT_ANALOG; reqSave = true; break;
 		case HOTKEY_HOME_BUTTON       : state.buttons |= GAMEPAD_MASK_A1; break; // Press the Home button
 		case HOTKEY_L3_BUTTON         : state.buttons |= GAMEPAD_MASK_L3; break; // Press the L3 button
 		case HOTKEY_R3_BUTTON         : state.buttons |= GAMEPAD_MASK_R3; break; // Press the R3 button
-		case HOTKEY_SOCD_UP_PRIORITY  : options.socdMode = SOCD_MODE_UP_PRIORITY; reqSave = true; break;
-		case HOTKEY_SOCD_NEUTRAL      : options.socdMode = SOCD_MODE_NEUTRAL; reqSave = true; break;
-		case HOTKEY_SOCD_LAST_INPUT   : options.socdMode = SOCD_MODE_SECOND_INPUT_PRIORITY; reqSave = true; break;
-		case HOTKEY_SOCD_FIRST_INPUT  : options.socdMode = SOCD_MODE_FIRST_INPUT_PRIORITY;  reqSave = true;break;
-		case HOTKEY_SOCD_BYPASS       : options.socdMode = SOCD_MODE_BYPASS; reqSave = true; break;
+		case HOTKEY_SOCD_UP_PRIORITY  : options->socdMode = SOCD_MODE_UP_PRIORITY; reqSave = true; break;
+		case HOTKEY_SOCD_NEUTRAL      : options->socdMode = SOCD_MODE_NEUTRAL; reqSave = true; break;
+		case HOTKEY_SOCD_LAST_INPUT   : options->socdMode = SOCD_MODE_SECOND_INPUT_PRIORITY; reqSave = true; break;
+		case HOTKEY_SOCD_FIRST_INPUT  : options->socdMode = SOCD_MODE_FIRST_INPUT_PRIORITY;  reqSave = true;break;
+		case HOTKEY_SOCD_BYPASS       : options->socdMode = SOCD_MODE_BYPASS; reqSave = true; break;
 		case HOTKEY_CAPTURE_BUTTON    :
-			if (options.inputMode == INPUT_MODE_PS4 && options.switchTpShareForDs4) {
+			if (options->inputMode == INPUT_MODE_PS4 && options->switchTpShareForDs4) {
 				state.buttons |= GAMEPAD_MASK_A2;
 			} else {
 				state.buttons |= GAMEPAD_MASK_S1;
 			}
 			break;
 		case HOTKEY_TOUCHPAD_BUTTON    :
-			if (options.inputMode == INPUT_MODE_PS4) {
+			if (options->inputMode == INPUT_MODE_PS4) {
 				state.buttons |= GAMEPAD_MASK_A2;
 			} else {
 				state.buttons |= GAMEPAD_MASK_S1;
@@ -342,19 +398,19 @@ void Gamepad::processHotkeyIfNewAction(GamepadHotkey action)
 			break;				
 		case HOTKEY_INVERT_X_AXIS     :
 			if (action != lastAction) {
-				options.invertXAxis = !options.invertXAxis;
+				options->invertXAxis = !options->invertXAxis;
 				reqSave = true;
 			}
 			break;
 		case HOTKEY_INVERT_Y_AXIS     :
 			if (action != lastAction) {
-				options.invertYAxis = !options.invertYAxis;
+				options->invertYAxis = !options->invertYAxis;
 				reqSave = true;
 			}
 			break;
 		case HOTKEY_TOGGLE_4_WAY_MODE :
 			if (action != lastAction) {
-				options.fourWayMode = !options.fourWayMode;
+				options->fourWayMode = !options->fourWayMode;
 				reqSave = true;
 			}
 			break;
@@ -365,6 +421,16 @@ void Gamepad::processHotkeyIfNewAction(GamepadHotkey action)
 				reqSave = true;
 			}
 			break;
+		case HOTKEY_NEXT_INPUT_MODE:
+			if (action != lastAction) {
+				const ForcedSetupOptions& forcedSetupOptions = Storage::getInstance().getForcedSetupOptions();
+				if (forcedSetupOptions.mode != FORCED_SETUP_MODE_LOCK_MODE_SWITCH &&
+					forcedSetupOptions.mode != FORCED_SETUP_MODE_LOCK_BOTH) {
+					options->inputMode = nextInputMode(options->inputMode);
+					reqSave = true;
+				}
+			}
+			break;
 		case HOTKEY_LOAD_PROFILE_1:
 			if (action != lastAction) {
 				this->teardown_and_reinit(1);
@@ -394,6 +460,7 @@ void Gamepad::processHotkeyIfNewAction(GamepadHotkey action)
 	// only save if we did something different (except NONE because NONE doesn't get here)
 	if (action != lastAction && reqSave) {
 		save();
+		Storage::getInstance().PushGamepadEvent({ GamepadEventType::HOTKEY_ACTION, action, hotkeySetting(action, *options) });
 	}
 
 	lastAction = action;
@@ -402,7 +469,7 @@ void Gamepad::processHotkeyIfNewAction(GamepadHotkey action)
 
 void * Gamepad::getReport()
 {
-	switch (options.inputMode)
+	switch (options->inputMode)
 	{
 		case INPUT_MODE_XINPUT:
 			return getXInputReport();
@@ -417,6 +484,8 @@ void * Gamepad::getReport()
 			return getKeyboardReport();
 
 		default:
+			if (HIDGeneric::isEnabled())
+				return getHIDGenericReport();
 			return getHIDReport();
 	}
 }
@@ -424,7 +493,7 @@ void * Gamepad::getReport()
 
 uint16_t Gamepad::getReportSize()
 {
-	switch (options.inputMode)
+	switch (options->inputMode)
 	{
 		case INPUT_MODE_XINPUT:
 			return sizeof(XInputReport);
@@ -439,6 +508,8 @@ uint16_t Gamepad::getReportSize()
 			return sizeof(KeyboardReport);
 
 		default:
+			if (HIDGeneric::isEnabled())
+				return HIDGeneric::getLayout().reportSize;
 			return sizeof(HIDReport);
 	}
 }
@@ -483,6 +554,13 @@ HIDReport *Gamepad::getHIDReport()
 }
 
 
+uint8_t *Gamepad::getHIDGenericReport()
+{
+	HIDGeneric::packReport(HIDGeneric::getLayout(), state, hidGenericReport);
+	return hidGenericReport;
+}
+
+
 SwitchReport *Gamepad::getSwitchReport()
 {
 	switch (state.dpad & GAMEPAD_MASK_DPAD)
@@ -590,12 +668,12 @@ PS4Report *Gamepad::getPS4Report()
 	ps4Report.button_r1       = pressedR1();
 	ps4Report.button_l2       = pressedL2();
 	ps4Report.button_r2       = pressedR2();
-	ps4Report.button_select   = options.switchTpShareForDs4 ? pressedA2() : pressedS1();
+	ps4Report.button_select   = options->switchTpShareForDs4 ? pressedA2() : pressedS1();
 	ps4Report.button_start    = pressedS2();
 	ps4Report.button_l3       = pressedL3();
 	ps4Report.button_r3       = pressedR3();
 	ps4Report.button_home     = pressedA1();
-	ps4Report.button_touchpad = options.switchTpShareForDs4 ? pressedS1() : pressedA2();
+	ps4Report.button_touchpad = options->switchTpShareForDs4 ? pressedS1() : pressedA2();
 
 	// report counter is 6 bits, but we circle 0-255
 	ps4Report.report_counter = last_report_counter++;
@@ -693,3 +771,50 @@ KeyboardReport *Gamepad::getKeyboardReport()
 	if(pressedA2()) 	{ pressKey(keyboardMapping.keyButtonA2); }
 	return &keyboardReport;
 }
+
+/**
+ * @brief Moves the buttons routed to the key interfaces of composite HID mode out of the gamepad state.
+ * Must run before getReport(), routed buttons use their key from the keyboard mapping.
+ */
+HIDCompositeKeys *Gamepad::getCompositeKeys()
+{
+	const KeyboardMapping& keyboardMapping = Storage::getInstance().getKeyboardMapping();
+	const uint32_t routeMask = options->hidKeyboardRouteMask;
+	const uint32_t routed = routeMask & (static_cast<uint32_t>(state.dpad) << 16 | state.buttons);
+
+	memset(&compositeKeys, 0, sizeof(compositeKeys));
+	if (routed != 0)
+	{
+		const struct { uint32_t mask; uint32_t key; } routes[] =
+		{
+			{ GAMEPAD_MASK_UP << 16,    keyboardMapping.keyDpadUp },
+			{ GAMEPAD_MASK_DOWN << 16,  keyboardMapping.keyDpadDown },
+			{ GAMEPAD_MASK_LEFT << 16,  keyboardMapping.keyDpadLeft },
+			{ GAMEPAD_MASK_RIGHT << 16, keyboardMapping.keyDpadRight },
+			{ GAMEPAD_MASK_B1, keyboardMapping.keyButtonB1 },
+			{ GAMEPAD_MASK_B2, keyboardMapping.keyButtonB2 },
+			{ GAMEPAD_MASK_B3, keyboardMapping.keyButtonB3 },
+			{ GAMEPAD_MASK_B4, keyboardMapping.keyButtonB4 },
+			{ GAMEPAD_MASK_L1, keyboardMapping.keyButtonL1 },
+			{ GAMEPAD_MASK_R1, keyboardMapping.keyButtonR1 },
+			{ GAMEPAD_MASK_L2, keyboardMapping.keyButtonL2 },
+			{ GAMEPAD_MASK_R2, keyboardMapping.keyButtonR2 },
+			{ GAMEPAD_MASK_S1, keyboardMapping.keyButtonS1 },
+			{ GAMEPAD_MASK_S2, keyboardMapping.keyButtonS2 },
+			{ GAMEPAD_MASK_L3, keyboardMapping.keyButtonL3 },
+			{ GAMEPAD_MASK_R3, keyboardMapping.keyButtonR3 },
+			{ GAMEPAD_MASK_A1, keyboardMapping.keyButtonA1 },
+			{ GAMEPAD_MASK_A2, keyboardMapping.keyButtonA2 },
+		};
+
+		for (const auto& route : routes)
+		{
+			if ((routed & route.mask) && route.key != 0)
+				HIDComposite::pressKey(compositeKeys, route.key);
+		}
+	}
+
+	state.dpad &= ~(routeMask >> 16);
+	state.buttons &= ~(routeMask & 0xffff);
+	return &compositeKeys;
+}
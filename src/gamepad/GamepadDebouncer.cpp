@@ -5,28 +5,19 @@
 
 #include "gamepad/GamepadDebouncer.h"
 
-void GamepadDebouncer::debounce(GamepadState *state)
+uint32_t GamepadDebouncer::debounce(uint32_t pins)
 {
-	uint32_t now = getMillis();
+	uint32_t now = getMicro();
+	uint32_t changed = debouncePins ^ pins;
 
-	for (int i = 0; i < 4; i++)
+	for (int i = 0; changed != 0; i++, changed >>= 1)
 	{
-		if ((debounceState.dpad & dpadMasks[i]) != (state->dpad & dpadMasks[i]) && (now - dpadTime[i]) > debounceMS)
+		if ((changed & 1) && (now - pinTime[i]) > debounceUs)
 		{
-			debounceState.dpad ^= dpadMasks[i];
-			dpadTime[i] = now;
+			debouncePins ^= (1u << i);
+			pinTime[i] = now;
 		}
 	}
 
-	for (int i = 0; i < GAMEPAD_BUTTON_COUNT; i++)
-	{
-		if ((debounceState.buttons & buttonMasks[i]) != (state->buttons & buttonMasks[i]) && (now - buttonTime[i]) > debounceMS)
-		{
-			debounceState.buttons ^= buttonMasks[i];
-			buttonTime[i] = now;
-		}
-	}
-
-	state->dpad = debounceState.dpad;
-	state->buttons = debounceState.buttons;
+	return debouncePins;
 }
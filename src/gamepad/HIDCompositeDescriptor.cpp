@@ -0,0 +1,132 @@
+#include "gamepad/HIDCompositeDescriptor.h"
+#include "gamepad/HIDGenericDescriptor.h"
+#include "gamepad/descriptors/HIDDescriptors.h"
+#include "gamepad/descriptors/KeyboardDescriptors.h"
+
+#include <string.h>
+
+// Gamepad configuration: config + interface + HID + endpoint descriptors
+#define HID_GAMEPAD_CONFIG_SIZE (9 + 9 + 9 + 7)
+#define HID_COMPOSITE_CONFIG_SIZE (HID_GAMEPAD_CONFIG_SIZE + 2 * TUD_HID_DESC_LEN)
+
+// Offsets in the configuration descriptor header
+#define CONFIG_TOTAL_LENGTH_OFFSET 2
+#define CONFIG_NUM_INTERFACES_OFFSET 4
+
+static const uint8_t keyboardReportDescriptor[] =
+{
+	0x05, 0x01,          // USAGE_PAGE (Generic Desktop)
+	0x09, 0x06,          // USAGE (Keyboard)
+	0xa1, 0x01,          // COLLECTION (Application)
+	0x05, 0x07,          //   USAGE_PAGE (Key Codes)
+	0x19, 0x00,          //   USAGE_MINIMUM (0)
+	0x2a, 0xff, 0x00,    //   USAGE_MAXIMUM (255)
+	0x15, 0x00,          //   LOGICAL_MINIMUM (0)
+	0x25, 0x01,          //   LOGICAL_MAXIMUM (1)
+	0x75, 0x01,          //   REPORT_SIZE (1)
+	0x96, 0x00, 0x01,    //   REPORT_COUNT (256)
+	0x81, 0x02,          //   INPUT (Data,Var,Abs)
+	0xc0,                // END_COLLECTION
+};
+
+// Same usages and bit order as the multimedia report of keyboard mode
+static const uint8_t consumerReportDescriptor[] =
+{
+	0x05, 0x0c,          // USAGE_PAGE (Consumer Devices)
+	0x09, 0x01,          // USAGE (Consumer Control)
+	0xa1, 0x01,          // COLLECTION (Application)
+	0x15, 0x00,          //   LOGICAL_MINIMUM (0)
+	0x25, 0x01,          //   LOGICAL_MAXIMUM (1)
+	0x75, 0x01,          //   REPORT_SIZE (1)
+	0x95, 0x07,          //   REPORT_COUNT (7)
+	0x09, 0xb5,          //   USAGE (Scan Next Track)
+	0x09, 0xb6,          //   USAGE (Scan Previous Track)
+	0x09, 0xb7,          //   USAGE (Stop)
+	0x09, 0xcd,          //   USAGE (Play/Pause)
+	0x09, 0xe2,          //   USAGE (Mute)
+	0x09, 0xe9,          //   USAGE (Volume Increment)
+	0x09, 0xea,          //   USAGE (Volume Decrement)
+	0x81, 0x02,          //   INPUT (Data,Var,Abs)
+	0x95, 0x01,          //   REPORT_COUNT (1)
+	0x81, 0x01,          //   INPUT (Cnst,Ary,Abs)
+	0xc0,                // END_COLLECTION
+};
+
+// Interfaces appended after the gamepad, no boot protocol since the keyboard report is a bitmap
+static const uint8_t keyInterfaces[] =
+{
+	TUD_HID_DESCRIPTOR(HID_COMPOSITE_KEYBOARD_INSTANCE, 0, HID_ITF_PROTOCOL_NONE, sizeof(keyboardReportDescriptor),
+		HID_COMPOSITE_KEYBOARD_ENDPOINT, HID_COMPOSITE_KEYBOARD_REPORT_SIZE, 1),
+	TUD_HID_DESCRIPTOR(HID_COMPOSITE_CONSUMER_INSTANCE, 0, HID_ITF_PROTOCOL_NONE, sizeof(consumerReportDescriptor),
+		HID_COMPOSITE_CONSUMER_ENDPOINT, 8, 1),
+};
+
+static_assert(sizeof(keyInterfaces) == 2 * TUD_HID_DESC_LEN, "Unexpected HID interface descriptor size");
+
+static bool enabled = false;
+static uint8_t configurationDescriptor[HID_COMPOSITE_CONFIG_SIZE];
+
+void HIDComposite::pressKey(HIDCompositeKeys& keys, uint8_t code)
+{
+	switch (code)
+	{
+		case KEYBOARD_MULTIMEDIA_NEXT_TRACK:  keys.consumer |= 0x01; break;
+		case KEYBOARD_MULTIMEDIA_PREV_TRACK:  keys.consumer |= 0x02; break;
+		case KEYBOARD_MULTIMEDIA_STOP:        keys.consumer |= 0x04; break;
+		case KEYBOARD_MULTIMEDIA_PLAY_PAUSE:  keys.consumer |= 0x08; break;
+		case KEYBOARD_MULTIMEDIA_MUTE:        keys.consumer |= 0x10; break;
+		case KEYBOARD_MULTIMEDIA_VOLUME_UP:   keys.consumer |= 0x20; break;
+		case KEYBOARD_MULTIMEDIA_VOLUME_DOWN: keys.consumer |= 0x40; break;
+		default:                              keys.keycode[code / 8] |= 1 << (code % 8); break;
+	}
+}
+
+void HIDComposite::configure()
+{
+	const uint8_t* gamepadConfiguration = HIDGeneric::isEnabled() ?
+		HIDGeneric::getConfigurationDescriptor() : hid_configuration_descriptor;
+
+	memcpy(configurationDescriptor, gamepadConfiguration, HID_GAMEPAD_CONFIG_SIZE);
+	memcpy(&configurationDescriptor[HID_GAMEPAD_CONFIG_SIZE], keyInterfaces, sizeof(keyInterfaces));
+	configurationDescriptor[CONFIG_TOTAL_LENGTH_OFFSET] = LSB(HID_COMPOSITE_CONFIG_SIZE);
+	configurationDescriptor[CONFIG_TOTAL_LENGTH_OFFSET + 1] = MSB(HID_COMPOSITE_CONFIG_SIZE);
+	configurationDescriptor[CONFIG_NUM_INTERFACES_OFFSET] = HID_COMPOSITE_INTERFACE_COUNT;
+
+	enabled = true;
+}
+
+void HIDComposite::disable()
+{
+	enabled = false;
+}
+
+bool HIDComposite::isEnabled()
+{
+	return enabled;
+}
+
+const uint8_t* HIDComposite::getReportDescriptor(uint8_t instance, uint16_t* size)
+{
+	switch (instance)
+	{
+		case HID_COMPOSITE_KEYBOARD_INSTANCE:
+			*size = sizeof(keyboardReportDescriptor);
+			return keyboardReportDescriptor;
+
+		case HID_COMPOSITE_CONSUMER_INSTANCE:
+			*size = sizeof(consumerReportDescriptor);
+			return consumerReportDescriptor;
+
+		default:
+			if (HIDGeneric::isEnabled())
+				return HIDGeneric::getReportDescriptor(size);
+			*size = sizeof(hid_report_descriptor);
+			return hid_report_descriptor;
+	}
+}
+
+const uint8_t* HIDComposite::getConfigurationDescriptor(uint16_t* size)
+{
+	*size = sizeof(configurationDescriptor);
+	return configurationDescriptor;
+}
@@ -0,0 +1,200 @@
+#include "gamepad/HIDGenericDescriptor.h"
+#include "gamepad/descriptors/HIDDescriptors.h"
+
+#include <string.h>
+#include <initializer_list>
+
+// Offset of wDescriptorLength in the HID configuration descriptor (config + interface + HID header)
+#define HID_CONFIG_REPORT_LENGTH_OFFSET (9 + 9 + 7)
+
+// DInput button order, buttons 1-14
+static const uint16_t buttonOrder[GAMEPAD_BUTTON_COUNT] =
+{
+	GAMEPAD_MASK_B3, GAMEPAD_MASK_B1, GAMEPAD_MASK_B2, GAMEPAD_MASK_B4,
+	GAMEPAD_MASK_L1, GAMEPAD_MASK_R1, GAMEPAD_MASK_L2, GAMEPAD_MASK_R2,
+	GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3,
+	GAMEPAD_MASK_A1, GAMEPAD_MASK_A2,
+};
+
+// X, Y, Z, Rz, Rx, Ry
+static const uint8_t axisUsages[HID_GENERIC_MAX_AXES] = { 0x30, 0x31, 0x32, 0x35, 0x33, 0x34 };
+
+static bool enabled = false;
+static HIDGenericLayout activeLayout;
+static uint8_t reportDescriptor[HID_GENERIC_MAX_DESCRIPTOR_SIZE];
+static uint16_t reportDescriptorSize = 0;
+static uint8_t configurationDescriptor[sizeof(hid_configuration_descriptor)];
+
+HIDGenericLayout HIDGeneric::makeLayout(uint32_t buttonCount, uint32_t axisCount, uint32_t axisBits)
+{
+	HIDGenericLayout layout;
+	layout.buttonCount = buttonCount > HID_GENERIC_MAX_BUTTONS ? HID_GENERIC_MAX_BUTTONS : buttonCount;
+	layout.axisCount = axisCount > HID_GENERIC_MAX_AXES ? HID_GENERIC_MAX_AXES : axisCount;
+	layout.axisBits = axisBits == 8 ? 8 : 16;
+	layout.hatOffset = (layout.buttonCount + 7) / 8;
+	layout.axisOffset = layout.hatOffset + 1;
+	layout.reportSize = layout.axisOffset + layout.axisCount * (layout.axisBits / 8);
+	return layout;
+}
+
+uint16_t HIDGeneric::buildReportDescriptor(const HIDGenericLayout& layout, uint8_t* descriptor, uint16_t maxSize)
+{
+	uint8_t buffer[HID_GENERIC_MAX_DESCRIPTOR_SIZE];
+	uint16_t length = 0;
+	const auto item = [&](std::initializer_list<uint8_t> bytes) {
+		for (uint8_t b : bytes)
+			buffer[length++] = b;
+	};
+
+	item({ 0x05, 0x01 });                   // USAGE_PAGE (Generic Desktop)
+	item({ 0x09, 0x05 });                   // USAGE (Gamepad)
+	item({ 0xa1, 0x01 });                   // COLLECTION (Application)
+
+	if (layout.buttonCount > 0)
+	{
+		item({ 0x05, 0x09 });               //   USAGE_PAGE (Button)
+		item({ 0x19, 0x01 });               //   USAGE_MINIMUM (Button 1)
+		item({ 0x29, layout.buttonCount }); //   USAGE_MAXIMUM (Button n)
+		item({ 0x15, 0x00 });               //   LOGICAL_MINIMUM (0)
+		item({ 0x25, 0x01 });               //   LOGICAL_MAXIMUM (1)
+		item({ 0x75, 0x01 });               //   REPORT_SIZE (1)
+		item({ 0x95, layout.buttonCount }); //   REPORT_COUNT (n)
+		item({ 0x81, 0x02 });               //   INPUT (Data,Var,Abs)
+	}
+
+	const uint8_t buttonPadding = layout.hatOffset * 8 - layout.buttonCount;
+	if (buttonPadding > 0)
+	{
+		item({ 0x75, 0x01 });               //   REPORT_SIZE (1)
+		item({ 0x95, buttonPadding });      //   REPORT_COUNT (padding)
+		item({ 0x81, 0x01 });               //   INPUT (Cnst,Ary,Abs)
+	}
+
+	item({ 0x05, 0x01 });                   //   USAGE_PAGE (Generic Desktop)
+	item({ 0x09, 0x39 });                   //   USAGE (Hat switch)
+	item({ 0x15, 0x00 });                   //   LOGICAL_MINIMUM (0)
+	item({ 0x25, 0x07 });                   //   LOGICAL_MAXIMUM (7)
+	item({ 0x35, 0x00 });                   //   PHYSICAL_MINIMUM (0)
+	item({ 0x46, 0x3b, 0x01 });             //   PHYSICAL_MAXIMUM (315)
+	item({ 0x65, 0x14 });                   //   UNIT (Eng Rot:Angular Pos)
+	item({ 0x75, 0x04 });                   //   REPORT_SIZE (4)
+	item({ 0x95, 0x01 });                   //   REPORT_COUNT (1)
+	item({ 0x81, 0x42 });                   //   INPUT (Data,Var,Abs,Null)
+	item({ 0x65, 0x00 });                   //   UNIT (None)
+	item({ 0x45, 0x00 });                   //   PHYSICAL_MAXIMUM (0), physical follows logical
+	item({ 0x81, 0x01 });                   //   INPUT (Cnst,Ary,Abs)
+
+	if (layout.axisCount > 0)
+	{
+		for (uint8_t i = 0; i < layout.axisCount; i++)
+			item({ 0x09, axisUsages[i] });  //   USAGE (axis)
+		item({ 0x15, 0x00 });               //   LOGICAL_MINIMUM (0)
+		if (layout.axisBits == 8)
+			item({ 0x26, 0xff, 0x00 });     //   LOGICAL_MAXIMUM (255)
+		else
+			item({ 0x27, 0xff, 0xff, 0x00, 0x00 }); // LOGICAL_MAXIMUM (65535)
+		item({ 0x75, layout.axisBits });    //   REPORT_SIZE (8/16)
+		item({ 0x95, layout.axisCount });   //   REPORT_COUNT (n)
+		item({ 0x81, 0x02 });               //   INPUT (Data,Var,Abs)
+	}
+
+	item({ 0xc0 });                         // END_COLLECTION
+
+	if (length > maxSize)
+		return 0;
+
+	memcpy(descriptor, buffer, length);
+	return length;
+}
+
+uint8_t HIDGeneric::packReport(const HIDGenericLayout& layout, const GamepadState& state, uint8_t* report)
+{
+	memset(report, 0, layout.reportSize);
+
+	uint32_t buttons = 0;
+	for (uint8_t i = 0; i < GAMEPAD_BUTTON_COUNT; i++)
+	{
+		if (state.buttons & buttonOrder[i])
+			buttons |= 1U << i;
+	}
+	buttons |= static_cast<uint32_t>(state.aux) << GAMEPAD_BUTTON_COUNT;
+	if (layout.buttonCount < 32)
+		buttons &= (1U << layout.buttonCount) - 1;
+
+	for (uint8_t i = 0; i < layout.hatOffset; i++)
+		report[i] = (buttons >> (i * 8)) & 0xff;
+
+	switch (state.dpad & GAMEPAD_MASK_DPAD)
+	{
+		case GAMEPAD_MASK_UP:                        report[layout.hatOffset] = HID_HAT_UP;        break;
+		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   report[layout.hatOffset] = HID_HAT_UPRIGHT;   break;
+		case GAMEPAD_MASK_RIGHT:                     report[layout.hatOffset] = HID_HAT_RIGHT;     break;
+		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: report[layout.hatOffset] = HID_HAT_DOWNRIGHT; break;
+		case GAMEPAD_MASK_DOWN:                      report[layout.hatOffset] = HID_HAT_DOWN;      break;
+		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  report[layout.hatOffset] = HID_HAT_DOWNLEFT;  break;
+		case GAMEPAD_MASK_LEFT:                      report[layout.hatOffset] = HID_HAT_LEFT;      break;
+		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    report[layout.hatOffset] = HID_HAT_UPLEFT;    break;
+		default:                                     report[layout.hatOffset] = HID_HAT_NOTHING;   break;
+	}
+
+	// Triggers are 8-bit in GamepadState, scale them to the full 16-bit range
+	const uint16_t axes[HID_GENERIC_MAX_AXES] =
+	{
+		state.lx, state.ly, state.rx, state.ry,
+		static_cast<uint16_t>(state.lt * 0x101), static_cast<uint16_t>(state.rt * 0x101),
+	};
+
+	uint8_t* axis = &report[layout.axisOffset];
+	for (uint8_t i = 0; i < layout.axisCount; i++)
+	{
+		if (layout.axisBits == 8)
+		{
+			*axis++ = axes[i] >> 8;
+		}
+		else
+		{
+			*axis++ = axes[i] & 0xff;
+			*axis++ = axes[i] >> 8;
+		}
+	}
+
+	return layout.reportSize;
+}
+
+void HIDGeneric::configure(uint32_t buttonCount, uint32_t axisCount, uint32_t axisBits)
+{
+	activeLayout = makeLayout(buttonCount, axisCount, axisBits);
+	reportDescriptorSize = buildReportDescriptor(activeLayout, reportDescriptor, sizeof(reportDescriptor));
+
+	memcpy(configurationDescriptor, hid_configuration_descriptor, sizeof(configurationDescriptor));
+	configurationDescriptor[HID_CONFIG_REPORT_LENGTH_OFFSET] = LSB(reportDescriptorSize);
+	configurationDescriptor[HID_CONFIG_REPORT_LENGTH_OFFSET + 1] = MSB(reportDescriptorSize);
+
+	enabled = reportDescriptorSize > 0;
+}
+
+void HIDGeneric::disable()
+{
+	enabled = false;
+}
+
+bool HIDGeneric::isEnabled()
+{
+	return enabled;
+}
+
+const HIDGenericLayout& HIDGeneric::getLayout()
+{
+	return activeLayout;
+}
+
+const uint8_t* HIDGeneric::getReportDescriptor(uint16_t* size)
+{
+	*size = reportDescriptorSize;
+	return reportDescriptor;
+}
+
+const uint8_t* HIDGeneric::getConfigurationDescriptor()
+{
+	return configurationDescriptor;
+}
@@ -0,0 +1,406 @@
+#include "gamepad/HIDHostParser.h"
+
+#include <string.h>
+
+#define SONY_VENDOR_ID 0x054C
+#define NINTENDO_VENDOR_ID 0x057E
+#define SWITCH_PRO_PRODUCT_ID 0x2009
+
+#define SWITCH_PRO_FULL_REPORT_ID 0x30
+
+// Short item prefix: tag in bits 7-4, type in bits 3-2, data size in bits 1-0
+#define HID_ITEM_TYPE_MAIN   0
+#define HID_ITEM_TYPE_GLOBAL 1
+#define HID_ITEM_TYPE_LOCAL  2
+#define HID_ITEM_LONG        0xFE
+
+#define HID_MAIN_INPUT          0x8
+#define HID_MAIN_COLLECTION     0xA
+#define HID_MAIN_END_COLLECTION 0xC
+
+#define HID_GLOBAL_USAGE_PAGE   0x0
+#define HID_GLOBAL_LOGICAL_MIN  0x1
+#define HID_GLOBAL_LOGICAL_MAX  0x2
+#define HID_GLOBAL_REPORT_SIZE  0x7
+#define HID_GLOBAL_REPORT_ID    0x8
+#define HID_GLOBAL_REPORT_COUNT 0x9
+
+#define HID_LOCAL_USAGE         0x0
+#define HID_LOCAL_USAGE_MIN     0x1
+#define HID_LOCAL_USAGE_MAX     0x2
+
+#define HID_INPUT_CONSTANT 0x01
+#define HID_INPUT_VARIABLE 0x02
+
+#define HID_USAGE_PAGE_DESKTOP 0x01
+#define HID_USAGE_PAGE_BUTTON  0x09
+#define HID_USAGE_JOYSTICK     0x04
+#define HID_USAGE_GAMEPAD      0x05
+#define HID_USAGE_HAT          0x39
+#define HID_USAGE_DPAD_UP      0x90
+
+#define MAX_LOCAL_USAGES 16
+#define MAX_REPORT_IDS 8
+
+// Index into the buttons of a layout for DInput buttons 1-14
+static const uint8_t dinputButtonIndex[HID_HOST_MAX_BUTTONS] = { 2, 0, 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13 };
+
+// Generic Desktop X, Y, Z, Rz, Rx, Ry in the order of the layout axes
+static const uint8_t axisUsages[HID_HOST_MAX_AXES] = { 0x30, 0x31, 0x32, 0x35, 0x33, 0x34 };
+
+static HIDHostField field(uint16_t bitOffset, uint8_t bitSize, int32_t logicalMin, int32_t logicalMax)
+{
+	return HIDHostField { bitOffset, bitSize, logicalMin, logicalMax };
+}
+
+// Sony controllers report 14 buttons in DInput order starting at buttonOffset, with the hat just before
+static void makeSonyLayout(HIDHostLayout& layout, HIDHostDeviceType type, uint16_t hatOffset, const uint16_t (&axisOffsets)[HID_HOST_MAX_AXES])
+{
+	layout.type = type;
+	layout.reportId = 0x01;
+	for (uint8_t i = 0; i < HID_HOST_MAX_BUTTONS; i++)
+		layout.buttons[dinputButtonIndex[i]] = field(hatOffset + 4 + i, 1, 0, 1);
+	layout.hat = field(hatOffset, 4, 0, 7);
+	for (uint8_t i = 0; i < HID_HOST_MAX_AXES; i++)
+		layout.axes[i] = field(axisOffsets[i], 8, 0, 255);
+}
+
+// Full input report, enabled by the USB handshake sent when the controller is mounted
+static void makeSwitchProLayout(HIDHostLayout& layout)
+{
+	// Bit offsets after the report ID: timer, battery, right buttons, shared buttons, left buttons, sticks
+	static const uint8_t buttonBits[HID_HOST_MAX_BUTTONS] =
+	{
+		18, 19, 16, 17, // B, A, Y, X
+		38, 22, 39, 23, // L, R, ZL, ZR
+		24, 25, 27, 26, // -, +, left stick, right stick
+		28, 29,         // home, capture
+	};
+
+	layout.type = HIDHostDeviceType::SWITCH_PRO;
+	layout.reportId = SWITCH_PRO_FULL_REPORT_ID;
+	for (uint8_t i = 0; i < HID_HOST_MAX_BUTTONS; i++)
+		layout.buttons[i] = field(buttonBits[i], 1, 0, 1);
+	layout.dpad[0] = field(33, 1, 0, 1);
+	layout.dpad[1] = field(32, 1, 0, 1);
+	layout.dpad[2] = field(35, 1, 0, 1);
+	layout.dpad[3] = field(34, 1, 0, 1);
+
+	// 12-bit sticks, up is the high end
+	layout.axes[0] = field(40, 12, 0, 4095);
+	layout.axes[1] = field(52, 12, 4095, 0);
+	layout.axes[2] = field(64, 12, 0, 4095);
+	layout.axes[3] = field(76, 12, 4095, 0);
+}
+
+HIDHostLayout HIDHostParser::makeLayout(uint16_t vid, uint16_t pid, const uint8_t* descriptor, uint16_t length)
+{
+	HIDHostLayout layout = {};
+
+	if (vid == SONY_VENDOR_ID && (pid == 0x05C4 || pid == 0x09CC))
+	{
+		// lx, ly, rx, ry, hat + buttons, L2 and R2 analog
+		static const uint16_t axes[HID_HOST_MAX_AXES] = { 0, 8, 16, 24, 56, 64 };
+		makeSonyLayout(layout, HIDHostDeviceType::DUALSHOCK4, 32, axes);
+		return layout;
+	}
+	else if (vid == SONY_VENDOR_ID && pid == 0x0CE6)
+	{
+		// lx, ly, rx, ry, L2 and R2 analog, counter, hat + buttons
+		static const uint16_t axes[HID_HOST_MAX_AXES] = { 0, 8, 16, 24, 32, 40 };
+		makeSonyLayout(layout, HIDHostDeviceType::DUALSENSE, 56, axes);
+		return layout;
+	}
+	else if (vid == NINTENDO_VENDOR_ID && pid == SWITCH_PRO_PRODUCT_ID)
+	{
+		makeSwitchProLayout(layout);
+		return layout;
+	}
+
+	return parseDescriptor(descriptor, length);
+}
+
+HIDHostLayout HIDHostParser::parseDescriptor(const uint8_t* descriptor, uint16_t length)
+{
+	HIDHostLayout layout = {};
+
+	uint16_t usagePage = 0;
+	int32_t logicalMin = 0;
+	int32_t logicalMax = 0;
+	uint32_t logicalMaxUnsigned = 0;
+	// Report size and count are full 32-bit items, a count of 256 or more is common in vendor blocks
+	uint32_t reportSize = 0;
+	uint32_t reportCount = 0;
+	uint8_t reportId = 0;
+
+	uint32_t usages[MAX_LOCAL_USAGES];
+	uint8_t usageCount = 0;
+	uint32_t usageMin = 0;
+	uint32_t usageMax = 0;
+
+	// Input bits seen so far for each report ID
+	uint8_t offsetIds[MAX_REPORT_IDS] = {};
+	uint32_t offsets[MAX_REPORT_IDS] = {};
+	uint8_t offsetCount = 1;
+
+	uint8_t depth = 0;
+	uint8_t gamepadDepth = 0; // depth of the gamepad application collection, 0 while outside
+	bool found = false;
+
+	uint16_t i = 0;
+	while (i < length)
+	{
+		const uint8_t prefix = descriptor[i++];
+		if (prefix == HID_ITEM_LONG)
+		{
+			if (i + 1 >= length)
+				break;
+			i += 2 + descriptor[i];
+			continue;
+		}
+
+		const uint8_t size = (prefix & 0x03) == 3 ? 4 : (prefix & 0x03);
+		const uint8_t type = (prefix >> 2) & 0x03;
+		const uint8_t tag = prefix >> 4;
+		if (i + size > length)
+			break;
+
+		uint32_t data = 0;
+		for (uint8_t b = 0; b < size; b++)
+			data |= static_cast<uint32_t>(descriptor[i + b]) << (b * 8);
+		int32_t signedData = static_cast<int32_t>(data);
+		if (size == 1)
+			signedData = static_cast<int8_t>(data);
+		else if (size == 2)
+			signedData = static_cast<int16_t>(data);
+		i += size;
+
+		if (type == HID_ITEM_TYPE_GLOBAL)
+		{
+			switch (tag)
+			{
+				case HID_GLOBAL_USAGE_PAGE:   usagePage = data; break;
+				case HID_GLOBAL_LOGICAL_MIN:  logicalMin = signedData; break;
+				case HID_GLOBAL_LOGICAL_MAX:  logicalMax = signedData; logicalMaxUnsigned = data; break;
+				case HID_GLOBAL_REPORT_SIZE:  reportSize = data; break;
+				case HID_GLOBAL_REPORT_COUNT: reportCount = data; break;
+				case HID_GLOBAL_REPORT_ID:    reportId = data; break;
+			}
+		}
+		else if (type == HID_ITEM_TYPE_LOCAL)
+		{
+			// Four byte usages carry their own usage page in the upper half
+			const uint32_t usage = size == 4 ? data : (static_cast<uint32_t>(usagePage) << 16 | data);
+			switch (tag)
+			{
+				case HID_LOCAL_USAGE:
+					if (usageCount < MAX_LOCAL_USAGES)
+						usages[usageCount++] = usage;
+					break;
+				case HID_LOCAL_USAGE_MIN: usageMin = usage; break;
+				case HID_LOCAL_USAGE_MAX: usageMax = usage; break;
+			}
+		}
+		else if (type == HID_ITEM_TYPE_MAIN)
+		{
+			if (tag == HID_MAIN_COLLECTION)
+			{
+				const uint32_t usage = usageCount > 0 ? usages[0] : usageMin;
+				if (!found && gamepadDepth == 0 && data == 0x01 &&
+					(usage == (HID_USAGE_PAGE_DESKTOP << 16 | HID_USAGE_JOYSTICK) || usage == (HID_USAGE_PAGE_DESKTOP << 16 | HID_USAGE_GAMEPAD)))
+				{
+					gamepadDepth = depth + 1;
+				}
+				depth++;
+			}
+			else if (tag == HID_MAIN_END_COLLECTION)
+			{
+				if (depth > 0 && depth-- == gamepadDepth)
+				{
+					gamepadDepth = 0;
+					if (found)
+						break;
+				}
+			}
+			else if (tag == HID_MAIN_INPUT)
+			{
+				uint8_t slot = 0;
+				while (slot < offsetCount && offsetIds[slot] != reportId)
+					slot++;
+				if (slot == offsetCount)
+				{
+					if (offsetCount == MAX_REPORT_IDS)
+						break;
+					offsetIds[offsetCount++] = reportId;
+				}
+
+				// Descriptors often write 0-255 as a one byte 0xFF
+				const int32_t fieldMax = (logicalMin >= 0 && logicalMax < logicalMin) ? static_cast<int32_t>(logicalMaxUnsigned) : logicalMax;
+				const bool usable = gamepadDepth != 0 && !(data & HID_INPUT_CONSTANT) && (data & HID_INPUT_VARIABLE) &&
+					(!found || reportId == layout.reportId);
+
+				for (uint32_t n = 0; usable && n < reportCount; n++)
+				{
+					// Fields past what a layout can address, or wider than readBits() handles, are never used
+					const uint64_t bitOffset = offsets[slot] + static_cast<uint64_t>(n) * reportSize;
+					if (reportSize == 0 || reportSize > 32 || bitOffset + reportSize > UINT16_MAX)
+						break;
+
+					uint32_t usage;
+					if (usageCount > 0)
+						usage = usages[n < usageCount ? n : usageCount - 1];
+					else if (usageMin + n <= usageMax)
+						usage = usageMin + n;
+					else
+						break;
+
+					const HIDHostField inputField = field(bitOffset, reportSize, logicalMin, fieldMax);
+					const uint16_t page = usage >> 16;
+					const uint16_t id = usage & 0xffff;
+					bool assigned = false;
+
+					if (page == HID_USAGE_PAGE_BUTTON && id >= 1 && id <= HID_HOST_MAX_BUTTONS)
+					{
+						layout.buttons[dinputButtonIndex[id - 1]] = inputField;
+						assigned = true;
+					}
+					else if (page == HID_USAGE_PAGE_DESKTOP && id == HID_USAGE_HAT)
+					{
+						layout.hat = inputField;
+						assigned = true;
+					}
+					else if (page == HID_USAGE_PAGE_DESKTOP && id >= HID_USAGE_DPAD_UP && id < HID_USAGE_DPAD_UP + 4)
+					{
+						// Usage order is up, down, right, left
+						static const uint8_t dpadIndex[4] = { 0, 1, 3, 2 };
+						layout.dpad[dpadIndex[id - HID_USAGE_DPAD_UP]] = inputField;
+						assigned = true;
+					}
+					else if (page == HID_USAGE_PAGE_DESKTOP)
+					{
+						for (uint8_t a = 0; a < HID_HOST_MAX_AXES; a++)
+						{
+							if (id == axisUsages[a])
+							{
+								layout.axes[a] = inputField;
+								assigned = true;
+							}
+						}
+					}
+
+					if (assigned && !found)
+					{
+						found = true;
+						layout.reportId = reportId;
+					}
+				}
+
+				const uint64_t end = offsets[slot] + static_cast<uint64_t>(reportCount) * reportSize;
+				offsets[slot] = end > UINT32_MAX ? UINT32_MAX : end;
+			}
+
+			// Local items only apply to the next main item
+			usageCount = 0;
+			usageMin = 0;
+			usageMax = 0;
+		}
+	}
+
+	layout.type = found ? HIDHostDeviceType::GENERIC : HIDHostDeviceType::NONE;
+	return layout;
+}
+
+static uint32_t readBits(const uint8_t* data, uint16_t length, const HIDHostField& inputField)
+{
+	if (inputField.bitSize == 0 || inputField.bitSize > 32 || inputField.bitOffset + inputField.bitSize > length * 8)
+		return 0;
+
+	uint32_t value = 0;
+	for (uint8_t b = 0; b < inputField.bitSize; b++)
+	{
+		const uint16_t bit = inputField.bitOffset + b;
+		if (data[bit / 8] & (1 << (bit % 8)))
+			value |= 1UL << b;
+	}
+
+	return value;
+}
+
+static uint16_t readAxis(const uint8_t* data, uint16_t length, const HIDHostField& inputField, uint16_t missing)
+{
+	if (inputField.bitSize == 0 || inputField.logicalMin == inputField.logicalMax)
+		return missing;
+
+	const bool inverted = inputField.logicalMin > inputField.logicalMax;
+	const int64_t low = inverted ? inputField.logicalMax : inputField.logicalMin;
+	const int64_t high = inverted ? inputField.logicalMin : inputField.logicalMax;
+
+	// Fields with a negative range are two's complement
+	int64_t value = readBits(data, length, inputField);
+	if (low < 0 && inputField.bitSize < 32 && (value & (1LL << (inputField.bitSize - 1))))
+		value -= 1LL << inputField.bitSize;
+	value = value < low ? low : (value > high ? high : value);
+
+	const uint16_t scaled = static_cast<uint16_t>(((value - low) * GAMEPAD_JOYSTICK_MAX) / (high - low));
+	return inverted ? GAMEPAD_JOYSTICK_MAX - scaled : scaled;
+}
+
+bool HIDHostParser::decodeReport(const HIDHostLayout& layout, const uint8_t* report, uint16_t length, GamepadState& state)
+{
+	if (layout.type == HIDHostDeviceType::NONE)
+		return false;
+
+	if (layout.reportId != 0)
+	{
+		if (length == 0 || report[0] != layout.reportId)
+			return false;
+		report++;
+		length--;
+	}
+
+	state.buttons = 0;
+	for (uint8_t i = 0; i < HID_HOST_MAX_BUTTONS; i++)
+	{
+		if (readBits(report, length, layout.buttons[i]))
+			state.buttons |= 1U << i;
+	}
+
+	state.dpad = 0;
+	if (layout.hat.bitSize > 0)
+	{
+		static const uint8_t hatToDpad[8] =
+		{
+			GAMEPAD_MASK_UP,
+			GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT,
+			GAMEPAD_MASK_RIGHT,
+			GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT,
+			GAMEPAD_MASK_DOWN,
+			GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT,
+			GAMEPAD_MASK_LEFT,
+			GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT,
+		};
+
+		// Anything outside the logical range is the hat's null state
+		const int32_t hat = static_cast<int32_t>(readBits(report, length, layout.hat)) - layout.hat.logicalMin;
+		if (hat >= 0 && hat < 8 && hat <= layout.hat.logicalMax - layout.hat.logicalMin)
+			state.dpad = hatToDpad[hat];
+	}
+	else
+	{
+		static const uint8_t dpadMasks[4] = { GAMEPAD_MASK_UP, GAMEPAD_MASK_DOWN, GAMEPAD_MASK_LEFT, GAMEPAD_MASK_RIGHT };
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			if (readBits(report, length, layout.dpad[i]))
+				state.dpad |= dpadMasks[i];
+		}
+	}
+
+	state.lx = readAxis(report, length, layout.axes[0], GAMEPAD_JOYSTICK_MID);
+	state.ly = readAxis(report, length, layout.axes[1], GAMEPAD_JOYSTICK_MID);
+	state.rx = readAxis(report, length, layout.axes[2], GAMEPAD_JOYSTICK_MID);
+	state.ry = readAxis(report, length, layout.axes[3], GAMEPAD_JOYSTICK_MID);
+	state.lt = readAxis(report, length, layout.axes[4], 0) >> 8;
+	state.rt = readAxis(report, length, layout.axes[5], 0) >> 8;
+
+	return true;
+}
@@ -7,23 +7,7 @@
 #include "build_info.h"
 #include "configmanager.h" // Global Managers
 #include "storagemanager.h"
-#include "addonmanager.h"
-
-#include "addons/analog.h" // Inputs for Core0
-#include "addons/bootsel_button.h"
-#include "addons/focus_mode.h"
-#include "addons/dualdirectional.h"
-#include "addons/tilt.h"
-#include "addons/extra_button.h"
-#include "addons/keyboard_host.h"
-#include "addons/i2canalog1219.h"
-#include "addons/jslider.h"
-#include "addons/playernum.h"
-#include "addons/reverse.h"
-#include "addons/turbo.h"
-#include "addons/slider_socd.h"
-#include "addons/wiiext.h"
-#include "addons/snes_input.h"
+#include "pinregistry.h"
 
 // Pico includes
 #include "pico/bootrom.h"
@@ -34,10 +18,24 @@
 #include "usb_driver.h"
 #include "tusb.h"
 
+#include <algorithm>
+
 #define GAMEPAD_DEBOUNCE_MILLIS 5 // make this a class object
 
 static const uint32_t REBOOT_HOTKEY_ACTIVATION_TIME_MS = 50;
 static const uint32_t REBOOT_HOTKEY_HOLD_TIME_MS = 4000;
+static const uint32_t USB_CLOCK_HZ = 48000000;
+// Poll period while the host is suspended, a button edge still ends the wait at once for remote wake-up
+static const uint32_t SUSPENDED_POLL_MICRO = 20000;
+
+// USB callbacks run inside tud_task() on core0, the same loop that updates the detector
+static InputModeDetector* hostEventDetector = nullptr;
+
+static void onUsbHostEvent(UsbHostEvent event) {
+	if (hostEventDetector != nullptr) {
+		hostEventDetector->onHostEvent(event, getMillis());
+	}
+}
 
 GP2040::GP2040() : nextRuntime(0) {
 	Storage::getInstance().SetGamepad(new Gamepad(GAMEPAD_DEBOUNCE_MILLIS));
@@ -94,6 +92,14 @@ void GP2040::setup() {
 					gamepad->save();
 				}
 
+				// A mode picked with a boot button is taken as is, otherwise probe the host starting with the saved mode
+				if (bootAction == BootAction::NONE && gamepad->getOptions().inputModeAutoDetect) {
+					hostEventDetector = &inputModeDetector;
+					set_usb_host_event_callback(onUsbHostEvent);
+					inputMode = inputModeDetector.start(inputMode, getMillis());
+				}
+
+				configureHIDDescriptor(inputMode, gamepad->getOptions());
 				initialize_driver(inputMode);
 				break;
 			}
@@ -102,30 +108,30 @@ void GP2040::setup() {
 	// Initialize our ADC (various add-ons)
 	adc_init();
 
-	// Setup Add-ons
-  	addons.LoadAddon(new KeyboardHostAddon(), CORE0_INPUT);
-	addons.LoadAddon(new AnalogInput(), CORE0_INPUT);
-	addons.LoadAddon(new BootselButtonAddon(), CORE0_INPUT);
-	addons.LoadAddon(new DualDirectionalInput(), CORE0_INPUT);
-  	addons.LoadAddon(new ExtraButtonAddon(), CORE0_INPUT);
-  	addons.LoadAddon(new FocusModeAddon(), CORE0_INPUT);
-	addons.LoadAddon(new I2CAnalog1219Input(), CORE0_INPUT);
-	addons.LoadAddon(new JSliderInput(), CORE0_INPUT);
-	addons.LoadAddon(new ReverseInput(), CORE0_INPUT);
-	addons.LoadAddon(new TurboInput(), CORE0_INPUT);
-	addons.LoadAddon(new WiiExtensionInput(), CORE0_INPUT);
-	addons.LoadAddon(new SNESpadInput(), CORE0_INPUT);
-	addons.LoadAddon(new PlayerNumAddon(), CORE0_USBREPORT);
-	addons.LoadAddon(new SliderSOCDInput(), CORE0_INPUT);
-	addons.LoadAddon(new TiltInput(), CORE0_INPUT);
+	// Setup Add-ons, PlayerNum comes after every input addon since it neither claims pins nor reads their services
+	inputAddons.setup();
+	usbReportAddons.setup();
+	PinRegistry::getInstance().initInputs();
+
+	if (!Storage::getInstance().GetConfigMode()) {
+		// Any edge on a button pin ends the idle wait between polls
+		uint32_t wakePinMask = 0;
+		for (int i = 0; i < GAMEPAD_DIGITAL_INPUT_COUNT; i++) {
+			wakePinMask |= gamepad->gamepadMappings[i]->pinMask;
+		}
+		System::setWakePins(wakePinMask);
+
+		clockGovernor.setup();
+	}
 }
 
 void GP2040::run() {
 	Gamepad * gamepad = Storage::getInstance().GetGamepad();
-	Gamepad * processedGamepad = Storage::getInstance().GetProcessedGamepad();
 	bool configMode = Storage::getInstance().GetConfigMode();
 	while (1) { // LOOP
 		Storage::getInstance().performEnqueuedSaves();
+		System::checkStack();
+		System::updateLoad();
 		// Config Loop (Web-Config does not require gamepad)
 		if (configMode == true) {
 			ConfigManager& configManager = ConfigManager::getInstance();
@@ -138,7 +144,10 @@ void GP2040::run() {
 		}
 
 		if (nextRuntime > getMicro()) { // fix for unsigned
-			sleep_us(50); // Give some time back to our CPU (lower power consumption)
+			// Give some time back to our CPU (lower power consumption), a button edge ends the wait early
+			if (System::idleUntil(nextRuntime)) {
+				nextRuntime = 0;
+			}
 			continue;
 		}
 
@@ -150,28 +159,75 @@ void GP2040::run() {
 		gamepad->hotkey(); 	// check for MPGS hotkeys
 		rebootHotkeys.process(gamepad, configMode);
 
+		if (inputModeDetector.isActive()) {
+			processInputModeDetection(gamepad);
+		} else {
+			// A hotkey or a profile change picked another input mode, re-enumerate with its descriptors instead of rebooting
+			const InputMode inputMode = gamepad->getOptions().inputMode;
+			if (inputMode != get_input_mode() && switch_input_mode(inputMode)) {
+				configureHIDDescriptor(inputMode, gamepad->getOptions());
+			}
+		}
+		clockGovernor.process(gamepad);
+
 		// Pre-Process add-ons for MPGS
-		addons.PreprocessAddons(ADDON_PROCESS::CORE0_INPUT);
+		inputAddons.preprocess();
 		
 		gamepad->process(); // process through MPGS
 
 		// (Post) Process for add-ons
-		addons.ProcessAddons(ADDON_PROCESS::CORE0_INPUT);
+		inputAddons.process();
 
-		// Copy Processed Gamepad for Core1 (race condition otherwise)
-		memcpy(&processedGamepad->state, &gamepad->state, sizeof(GamepadState));
+		// Publish the processed state for Core1
+		Storage::getInstance().PublishProcessedState(gamepad->state);
 
 		// USB FEATURES : Send/Get USB Features (including Player LEDs on X-Input)
+		if (HIDComposite::isEnabled()) {
+			send_composite_keys(gamepad->getCompositeKeys());
+		}
 		send_report(gamepad->getReport(), gamepad->getReportSize());
 		Storage::getInstance().ClearFeatureData();
 		receive_report(Storage::getInstance().GetFeatureData());
 
 		// Process USB Reports
-		addons.ProcessAddons(ADDON_PROCESS::CORE0_USBREPORT);
+		usbReportAddons.process();
 
 		tud_task(); // TinyUSB Task update
+		usb_reconnect_task();
+
+		// Let core1 blank its outputs while the host sleeps, the clock governor lowers the clock on its own
+		const bool suspended = usbSuspendMonitor.update(tud_suspended());
+
+		nextRuntime = getMicro() + (suspended ? SUSPENDED_POLL_MICRO : GAMEPAD_POLL_MICRO);
+	}
+}
+
+// Follow the detector through its candidates, then remember the mode the host accepted
+void GP2040::processInputModeDetection(Gamepad* gamepad) {
+	const InputMode inputMode = inputModeDetector.update(getMillis());
+	if (inputMode != get_input_mode() && switch_input_mode(inputMode)) {
+		configureHIDDescriptor(inputMode, gamepad->getOptions());
+	}
+
+	if (inputModeDetector.isLocked() && inputMode != gamepad->getOptions().inputMode) {
+		gamepad->setInputMode(inputMode);
+		gamepad->save();
+	}
+}
+
+// Build the configurable HID descriptor before the USB stack asks for it
+void GP2040::configureHIDDescriptor(InputMode inputMode, const GamepadOptions& options) {
+	if (inputMode == INPUT_MODE_HID && options.hidCustomLayout) {
+		HIDGeneric::configure(options.hidButtonCount, options.hidAxisCount, options.hidAxisResolution);
+	} else {
+		HIDGeneric::disable();
+	}
 
-		nextRuntime = getMicro() + GAMEPAD_POLL_MICRO;
+	// Wraps whichever gamepad interface was chosen above
+	if (inputMode == INPUT_MODE_HID && options.hidComposite) {
+		HIDComposite::configure();
+	} else {
+		HIDComposite::disable();
 	}
 }
 
@@ -250,7 +306,11 @@ void GP2040::RebootHotkeys::process(Gamepad* gamepad, bool configMode) {
 
 			if (time_reached(rebootHotkeysHoldTimeout)) {
 				if (gamepad->state.buttons == webConfigHotkeyMask) {
-					// If we are in webconfig mode we go to gamepad mode and vice versa
+					// If we are in webconfig mode we go to gamepad mode and vice versa.
+					// Web config mode keeps core0 busy, so it shows the gamepad mode load from before the reboot.
+					if (!configMode) {
+						System::keepLoadForReboot();
+					}
 					System::reboot(configMode ? System::BootMode::GAMEPAD : System::BootMode::WEBCONFIG);
 				} else if (gamepad->state.buttons == bootselHotkeyMask) {
 					System::reboot(System::BootMode::USB);
@@ -261,3 +321,61 @@ void GP2040::RebootHotkeys::process(Gamepad* gamepad, bool configMode) {
 		}
 	}
 }
+
+GP2040::ClockGovernor::ClockGovernor() :
+	enabled(false),
+	idleScalingAllowed(false),
+	idleDivider(1),
+	usbSafeDivider(1),
+	idleTimeoutMs(0),
+	idleTimeout(nil_time),
+	lastState() {
+}
+
+void GP2040::ClockGovernor::setup() {
+	const PowerOptions& powerOptions = Storage::getInstance().getPowerOptions();
+	const AddonOptions& addonOptions = Storage::getInstance().getAddonOptions();
+
+	// PIO-USB relies on its exact 120 MHz system clock
+	if (!powerOptions.clockGovernorEnabled || addonOptions.keyboardHostOptions.enabled || !System::initClockScaling()) {
+		return;
+	}
+
+	enabled = true;
+	idleDivider = std::max<uint32_t>(powerOptions.idleClockDivider, 1);
+	idleTimeoutMs = powerOptions.idleTimeoutMs;
+	idleTimeout = make_timeout_time_ms(idleTimeoutMs);
+
+	// Keep clk_sys at or above the USB clock while the host is awake
+	usbSafeDivider = std::max<uint32_t>(System::getFullClockHz() / USB_CLOCK_HZ, 1);
+
+	// NeoPixel PIO timing, buzzer PWM and the I2C baud rate are derived from clk_sys, with any of them in use
+	// we only scale while the host sleeps
+	const bool i2cInUse = Storage::getInstance().getDisplayOptions().enabled ||
+		addonOptions.analogADS1219Options.enabled || addonOptions.wiiOptions.enabled;
+	idleScalingAllowed = !isValidPin(Storage::getInstance().getLedOptions().dataPin) && !addonOptions.buzzerOptions.enabled &&
+		!i2cInUse;
+}
+
+void GP2040::ClockGovernor::process(Gamepad* gamepad) {
+	if (!enabled) {
+		return;
+	}
+
+	if (memcmp(&lastState, &gamepad->state, sizeof(GamepadState)) != 0) {
+		memcpy(&lastState, &gamepad->state, sizeof(GamepadState));
+		idleTimeout = make_timeout_time_ms(idleTimeoutMs);
+	}
+
+	// The wake pin interrupt already restored full speed on the first edge, this only decides when to slow down again
+	uint32_t divider = 1;
+	if (tud_suspended()) {
+		divider = idleDivider;
+	} else if (idleScalingAllowed && time_reached(idleTimeout)) {
+		divider = std::min(idleDivider, usbSafeDivider);
+	}
+
+	if (divider != System::getClockDivider()) {
+		System::setClockDivider(divider);
+	}
+}
@@ -3,7 +3,8 @@
 #include "gamepad.h"
 
 #include "storagemanager.h" // Global Managers
-#include "addonmanager.h"
+#include "system.h"
+#include "entropy.h"
 
 #include "addons/i2cdisplay.h" // Add-Ons
 #include "addons/neopicoleds.h"
@@ -12,30 +13,74 @@
 #include "addons/buzzerspeaker.h"
 #include "addons/ps4mode.h"
 
+#include <algorithm>
 #include <iterator>
 
-GP2040Aux::GP2040Aux() : nextRuntime(0) {
+// Core1 addon periods
+static const uint32_t DISPLAY_PERIOD_US = 33333;	// 30 Hz
+static const uint32_t NEOPICO_PERIOD_US = 10000;	// 100 Hz
+static const uint32_t PLAYER_LED_PERIOD_US = 10000;	// 100 Hz
+static const uint32_t BOARD_LED_PERIOD_US = 1000;	// 1 kHz
+static const uint32_t BUZZER_PERIOD_US = 1000;		// 1 kHz
+static const uint32_t PS4_AUTH_PERIOD_US = GAMEPAD_POLL_MICRO; // polls for a pending nonce
+
+// Upper bound on a single idle wait so the stack and load bookkeeping keep running
+static const uint32_t MAX_IDLE_US = 10000;
+// Event polling period while the host is suspended and no tasks run
+static const uint32_t SUSPENDED_IDLE_US = 20000;
+
+GP2040Aux::GP2040Aux() : nextRuntime(0), suspended(false) {
 }
 
 GP2040Aux::~GP2040Aux() {
 }
 
 void GP2040Aux::setup() {
-	addons.LoadAddon(new I2CDisplayAddon(), CORE1_LOOP);
-	addons.LoadAddon(new NeoPicoLEDAddon(), CORE1_LOOP);
-	addons.LoadAddon(new PlayerLEDAddon(), CORE1_LOOP);
-	addons.LoadAddon(new BoardLedAddon(), CORE1_LOOP);
-	addons.LoadAddon(new BuzzerSpeakerAddon(), CORE1_LOOP);
-	addons.LoadAddon(new PS4ModeAddon(), CORE1_LOOP);
+	loadTask(new I2CDisplayAddon(), DISPLAY_PERIOD_US);
+	loadTask(new NeoPicoLEDAddon(), NEOPICO_PERIOD_US);
+	loadTask(new PlayerLEDAddon(), PLAYER_LED_PERIOD_US);
+	loadTask(new BoardLedAddon(), BOARD_LED_PERIOD_US);
+	loadTask(new BuzzerSpeakerAddon(), BUZZER_PERIOD_US);
+	loadTask(new PS4ModeAddon(), PS4_AUTH_PERIOD_US);
+}
+
+void GP2040Aux::loadTask(GPAddon* addon, uint32_t periodUs) {
+	if (addon->available()) {
+		addon->setup();
+		TaskScheduler::getInstance().AddTask(addon, periodUs);
+	} else {
+		delete addon; // Don't use the memory if we don't have to
+	}
 }
 
 void GP2040Aux::run() {
 	while (1) {
+		System::checkStack();
+		System::updateLoad();
 		if (nextRuntime > getMicro()) { // fix for unsigned
-			sleep_us(50); // Give some time back to our CPU (lower power consumption)
+			System::idleUntil(nextRuntime); // Give some time back to our CPU (lower power consumption)
 			continue;
 		}
-		addons.ProcessAddons(CORE1_LOOP);
-		nextRuntime = getMicro() + GAMEPAD_POLL_MICRO;
+
+		// Every task in this pass sees the same consistent frame from core0
+		Storage::getInstance().RefreshProcessedGamepad();
+		GamepadEvent event;
+		while (Storage::getInstance().PopGamepadEvent(event)) {
+			if (event.type == GamepadEventType::USB_SUSPEND) {
+				suspended = true;
+			} else if (event.type == GamepadEventType::USB_RESUME) {
+				suspended = false;
+			}
+			TaskScheduler::getInstance().DispatchEvent(event);
+		}
+
+		// Tasks have blanked their outputs on suspend, only wake up to look for the resume
+		if (suspended) {
+			nextRuntime = getMicro() + SUSPENDED_IDLE_US;
+			continue;
+		}
+
+		Entropy::getInstance().process();
+		nextRuntime = std::min(TaskScheduler::getInstance().RunTasks(), getMicro() + MAX_IDLE_US);
 	}
 }
@@ -0,0 +1,136 @@
+#include "inputmodedetector.h"
+
+// Time the host gets to mount a candidate before the next one is tried
+#define INPUT_MODE_DETECT_MOUNT_TIMEOUT_MS 1500
+// Time after mounting a handshake mode for the host to start the handshake
+#define INPUT_MODE_DETECT_CONFIRM_TIMEOUT_MS 1000
+// Quiet time after mounting before a mode without handshake is accepted
+#define INPUT_MODE_DETECT_SETTLE_MS 500
+
+// Switch mode also works as a plain HID gamepad on PCs, so it is tried before generic HID.
+// Keyboard mode is never picked automatically.
+static const InputMode probeOrder[] = {
+    INPUT_MODE_XINPUT,
+    INPUT_MODE_PS4,
+    INPUT_MODE_SWITCH,
+    INPUT_MODE_HID,
+};
+
+InputModeDetector::InputModeDetector() :
+    state(State::IDLE),
+    lastGoodMode(INPUT_MODE_XINPUT),
+    currentMode(INPUT_MODE_XINPUT),
+    candidates{},
+    candidateCount(0),
+    candidateIndex(0),
+    attemptStartMs(0),
+    mountedMs(0),
+    mounted(false),
+    confirmed(false),
+    redirected(false),
+    redirectPending(false),
+    redirectMode(INPUT_MODE_XINPUT) {
+}
+
+InputMode InputModeDetector::start(InputMode lastGood, uint32_t nowMs) {
+    lastGoodMode = lastGood;
+
+    // Remembered mode first so a known host locks on the first attempt
+    candidateCount = 0;
+    if (lastGood != INPUT_MODE_KEYBOARD && lastGood != INPUT_MODE_CONFIG)
+        candidates[candidateCount++] = lastGood;
+    for (InputMode mode : probeOrder) {
+        if (mode != lastGood)
+            candidates[candidateCount++] = mode;
+    }
+
+    candidateIndex = 0;
+    redirected = false;
+    state = State::PROBING;
+    beginAttempt(candidates[0], nowMs);
+    return currentMode;
+}
+
+void InputModeDetector::onHostEvent(UsbHostEvent event, uint32_t nowMs) {
+    if (state != State::PROBING)
+        return;
+
+    InputMode hint;
+    switch (event) {
+        case USB_HOST_EVENT_MOUNTED:
+            mounted = true;
+            mountedMs = nowMs;
+            return;
+
+        case USB_HOST_EVENT_XINPUT_OUT_REPORT:    hint = INPUT_MODE_XINPUT; break;
+        case USB_HOST_EVENT_MS_OS_DESCRIPTOR:     hint = INPUT_MODE_XINPUT; break;
+        case USB_HOST_EVENT_PS4_AUTH_REQUEST:     hint = INPUT_MODE_PS4; break;
+        case USB_HOST_EVENT_PS3_FEATURE_REQUEST:  hint = INPUT_MODE_HID; break;
+        default:
+            return;
+    }
+
+    if (hint == currentMode) {
+        confirmed = true;
+    } else if (!redirected) {
+        // Only follow the first hint, a host that keeps pointing elsewhere can't make us bounce
+        redirectPending = true;
+        redirectMode = hint;
+    }
+}
+
+InputMode InputModeDetector::update(uint32_t nowMs) {
+    if (state != State::PROBING)
+        return currentMode;
+
+    if (confirmed) {
+        lock();
+        return currentMode;
+    }
+
+    if (redirectPending) {
+        redirected = true;
+        beginAttempt(redirectMode, nowMs);
+        return currentMode;
+    }
+
+    if (mounted) {
+        // Redirected attempts were asked for by the host, a mount is good enough for them
+        if ((redirected || !hasHandshake(currentMode)) && nowMs - mountedMs >= INPUT_MODE_DETECT_SETTLE_MS) {
+            lock();
+            return currentMode;
+        }
+        if (nowMs - mountedMs < INPUT_MODE_DETECT_CONFIRM_TIMEOUT_MS)
+            return currentMode;
+    } else if (nowMs - attemptStartMs < INPUT_MODE_DETECT_MOUNT_TIMEOUT_MS) {
+        return currentMode;
+    }
+
+    // This candidate didn't work out
+    if (redirected || ++candidateIndex >= candidateCount) {
+        state = State::FALLBACK;
+        currentMode = lastGoodMode;
+        return currentMode;
+    }
+
+    beginAttempt(candidates[candidateIndex], nowMs);
+    return currentMode;
+}
+
+void InputModeDetector::beginAttempt(InputMode mode, uint32_t nowMs) {
+    currentMode = mode;
+    attemptStartMs = nowMs;
+    mountedMs = 0;
+    mounted = false;
+    confirmed = false;
+    redirectPending = false;
+}
+
+void InputModeDetector::lock() {
+    state = State::LOCKED;
+    lastGoodMode = currentMode;
+}
+
+bool InputModeDetector::hasHandshake(InputMode mode) {
+    return mode == INPUT_MODE_XINPUT || mode == INPUT_MODE_PS4;
+}
@@ -9,6 +9,7 @@
 // GP2040 includes
 #include "gp2040.h"
 #include "gp2040aux.h"
+#include "system.h"
 
 #include <cstdlib>
 
@@ -31,6 +32,10 @@ void core1() {
 }
 
 int main() {
+	// Paint both stacks so their high-water marks can be reported
+	System::paintStack(0);
+	System::paintStack(1);
+
 	// Create GP2040 Main Core (core0), Core1 is dependent on Core0
 	GP2040 * gp2040 = new GP2040();
 	gp2040->setup();
@@ -0,0 +1,71 @@
+#include "pinregistry.h"
+
+#include <string.h>
+
+PinRegistry::PinRegistry() :
+    owners{},
+    conflictOwners{},
+    conflictMask(0),
+    pendingInputMask(0) {
+    critical_section_init(&lock);
+}
+
+bool PinRegistry::claim(int32_t pin, const char* owner) {
+    if (pin < 0 || pin >= NUM_BANK0_GPIOS)
+        return false;
+
+    bool claimed = true;
+    critical_section_enter_blocking(&lock);
+    if (owners[pin] == nullptr || strcmp(owners[pin], owner) == 0) {
+        // A feature may use its own pin more than once, e.g. two buttons on one switch
+        owners[pin] = owner;
+    } else {
+        if (!(conflictMask & (1u << pin)))
+            conflictOwners[pin] = owner;
+        conflictMask |= 1u << pin;
+        claimed = false;
+    }
+    critical_section_exit(&lock);
+    return claimed;
+}
+
+bool PinRegistry::claimInput(int32_t pin, const char* owner) {
+    if (!claim(pin, owner))
+        return false;
+
+    critical_section_enter_blocking(&lock);
+    pendingInputMask |= 1u << pin;
+    critical_section_exit(&lock);
+    return true;
+}
+
+bool PinRegistry::release(int32_t pin, const char* owner) {
+    if (pin < 0 || pin >= NUM_BANK0_GPIOS)
+        return false;
+
+    bool released = false;
+    critical_section_enter_blocking(&lock);
+    if (owners[pin] != nullptr && strcmp(owners[pin], owner) == 0) {
+        owners[pin] = nullptr;
+        conflictOwners[pin] = nullptr;
+        conflictMask &= ~(1u << pin);
+        pendingInputMask &= ~(1u << pin);
+        released = true;
+    }
+    critical_section_exit(&lock);
+    return released;
+}
+
+void PinRegistry::initInputs() {
+    critical_section_enter_blocking(&lock);
+    uint32_t mask = pendingInputMask;
+    pendingInputMask = 0;
+    critical_section_exit(&lock);
+
+    // Function select and direction for all pins at once, pulls live in per-pin pad registers
+    gpio_init_mask(mask);
+    for (uint8_t pin = 0; mask != 0; pin++, mask >>= 1) {
+        if (mask & 1)
+            gpio_pull_up(pin);
+    }
+}
@@ -40,16 +40,23 @@
 
 #include "helper.h"
 
+#include <memory>
+
 Storage::Storage()
 {
 	EEPROM.start();
-	critical_section_init(&animationOptionsCs);
 	ConfigUtils::load(config);
+	buildProfiles();
+	activateProfile(config.gamepadOptions.profileNumber);
 }
 
 bool Storage::save()
 {
-	return ConfigUtils::save(config);
+	// Changes made while a profile is active belong to that profile, the other profiles are derived again in case
+	// the base options changed. Changes that don't fit the profile's overlay stay live but are not stored.
+	const bool profileStored = storeActiveProfile();
+	buildProfiles();
+	return ConfigUtils::save(config) && profileStored;
 }
 
 static void updateAnimationOptionsProto(const AnimationOptions& options)
@@ -106,25 +113,49 @@ void Storage::performEnqueuedSaves()
 {
 	if (animationOptionsSavePending.load())
 	{
-		critical_section_enter_blocking(&animationOptionsCs);
-		updateAnimationOptionsProto(animationOptionsToSave);
-		save();
+		// Clear the flag before taking the snapshot, a newer enqueue will then set it again
 		animationOptionsSavePending.store(false);
-		critical_section_exit(&animationOptionsCs);
+		AnimationOptions options;
+		animationOptionsToSave.read(options);
+		updateAnimationOptionsProto(options);
+		save();
+	}
+
+	if (ps4KeyCacheSavePending.load())
+	{
+		ps4KeyCacheSavePending.store(false);
+		PS4KeyCache keyCache;
+		ps4KeyCacheToSave.read(keyCache);
+
+		PS4Options& ps4Options = config.addonOptions.ps4Options;
+		memcpy(ps4Options.rsaD.bytes, keyCache.rsaD, sizeof(keyCache.rsaD));
+		ps4Options.rsaD.size = sizeof(keyCache.rsaD);
+		memcpy(ps4Options.rsaDP.bytes, keyCache.rsaDP, sizeof(keyCache.rsaDP));
+		ps4Options.rsaDP.size = sizeof(keyCache.rsaDP);
+		memcpy(ps4Options.rsaDQ.bytes, keyCache.rsaDQ, sizeof(keyCache.rsaDQ));
+		ps4Options.rsaDQ.size = sizeof(keyCache.rsaDQ);
+		memcpy(ps4Options.rsaQP.bytes, keyCache.rsaQP, sizeof(keyCache.rsaQP));
+		ps4Options.rsaQP.size = sizeof(keyCache.rsaQP);
+		addonOptions->ps4Options = ps4Options;
+		save();
 	}
 }
 
 void Storage::enqueueAnimationOptionsSave(const AnimationOptions& animationOptions)
 {
 	const uint32_t crc = CRC32::calculate(&animationOptions);
-	critical_section_enter_blocking(&animationOptionsCs);
 	if (crc != animationOptionsCrc)
 	{
-		animationOptionsToSave = animationOptions;
+		animationOptionsToSave.write(animationOptions);
 		animationOptionsCrc = crc;
 		animationOptionsSavePending.store(true);
 	}
-	critical_section_exit(&animationOptionsCs);
+}
+
+void Storage::enqueuePS4KeyCacheSave(const PS4KeyCache& keyCache)
+{
+	ps4KeyCacheToSave.write(keyCache);
+	ps4KeyCacheSavePending.store(true);
 }
 
 void Storage::ResetSettings()
@@ -143,7 +174,92 @@ PinMappings& Storage::getProfilePinMappings() {
 
 void Storage::setProfile(const uint32_t profileNum)
 {
+	// Saves enqueued by core1 still belong to the profile that is left
+	performEnqueuedSaves();
 	setFunctionalPinMappings(profileNum);
+	activateProfile(profileNum);
+}
+
+void Storage::activateProfile(const uint32_t profileNum)
+{
+	const bool alternative = profileNum >= 2 && profileNum < 2 + PROFILE_SETTINGS_COUNT;
+	const uint32_t index = alternative ? profileNum - 2 : 0;
+
+	gamepadOptions = alternative && profileGamepadOptions[index] ? profileGamepadOptions[index] : &config.gamepadOptions;
+	addonOptions = alternative && profileAddonOptions[index] ? profileAddonOptions[index] : &config.addonOptions;
+	animationOptions = alternative && profileAnimationOptions[index] ? profileAnimationOptions[index] : &config.animationOptions;
+	hotkeyOptions = alternative && profileHotkeyOptions[index] ? profileHotkeyOptions[index] : &config.hotkeyOptions;
+	activeProfile = profileNum;
+
+	if (gamepad != nullptr) gamepad->reloadOptions();
+	if (processedGamepad != nullptr) processedGamepad->reloadOptions();
+}
+
+// A profile's options are a copy of the base options with its overlay merged in. Memory is only allocated once a
+// profile overrides something and is kept from then on, so pointers handed out stay valid.
+template <typename T, typename Bytes>
+static void deriveOptions(T*& derived, const T& base, const pb_msgdesc_t* fields, const Bytes& overlay)
+{
+	if (derived == nullptr)
+	{
+		if (overlay.size == 0)
+			return;
+		derived = new T;
+	}
+
+	*derived = base;
+	if (!ConfigUtils::mergeOverlay(fields, derived, overlay.bytes, overlay.size))
+		*derived = base;
+}
+
+// Returns false if the changes don't fit the overlay, it then keeps what was stored before
+template <typename T, typename Bytes>
+static bool storeOptions(const T* options, const T& base, const pb_msgdesc_t* fields, Bytes& overlay)
+{
+	if (options == &base)
+		return true;
+
+	// The copy is reduced to the changed fields, keep it off the stack
+	std::unique_ptr<T> diff(new T(*options));
+	return ConfigUtils::encodeOverlay(fields, diff.get(), &base, overlay.bytes, overlay.size, sizeof(overlay.bytes));
+}
+
+static_assert(sizeof(ProfileSettings_gamepadOptions_t::bytes) >= GamepadOptions_size, "A gamepad options overlay must always fit");
+static_assert(sizeof(ProfileSettings_animationOptions_t::bytes) >= AnimationOptions_Proto_size, "An animation options overlay must always fit");
+
+void Storage::buildProfiles()
+{
+	static const ProfileSettings emptySettings = ProfileSettings_init_zero;
+	const ProfileOptions& profileOptions = config.profileOptions;
+
+	for (size_t i = 0; i < PROFILE_SETTINGS_COUNT; i++)
+	{
+		const ProfileSettings& settings = i < profileOptions.profileSettings_count ? profileOptions.profileSettings[i] : emptySettings;
+
+		// The active options are live, they were stored to their overlay before
+		if (profileGamepadOptions[i] != gamepadOptions)
+			deriveOptions(profileGamepadOptions[i], config.gamepadOptions, GamepadOptions_fields, settings.gamepadOptions);
+		if (profileAddonOptions[i] != addonOptions)
+			deriveOptions(profileAddonOptions[i], config.addonOptions, AddonOptions_fields, settings.addonOptions);
+		if (profileAnimationOptions[i] != animationOptions)
+			deriveOptions(profileAnimationOptions[i], config.animationOptions, AnimationOptions_Proto_fields, settings.animationOptions);
+		if (profileHotkeyOptions[i] != hotkeyOptions)
+			deriveOptions(profileHotkeyOptions[i], config.hotkeyOptions, HotkeyOptions_fields, settings.hotkeyOptions);
+	}
+}
+
+bool Storage::storeActiveProfile()
+{
+	if (activeProfile < 2 || activeProfile >= 2 + PROFILE_SETTINGS_COUNT)
+		return true;
+
+	// Options are only derived for profiles that have an overlay, so the entry is within profileSettings_count
+	ProfileSettings& settings = config.profileOptions.profileSettings[activeProfile - 2];
+	bool stored = storeOptions(gamepadOptions, config.gamepadOptions, GamepadOptions_fields, settings.gamepadOptions);
+	stored &= storeOptions(addonOptions, config.addonOptions, AddonOptions_fields, settings.addonOptions);
+	stored &= storeOptions(animationOptions, config.animationOptions, AnimationOptions_Proto_fields, settings.animationOptions);
+	stored &= storeOptions(hotkeyOptions, config.hotkeyOptions, HotkeyOptions_fields, settings.hotkeyOptions);
+	return stored;
 }
 
 void Storage::setFunctionalPinMappings(const uint32_t profileNum)
@@ -169,6 +285,10 @@ void Storage::setFunctionalPinMappings(const uint32_t profileNum)
 void Storage::SetConfigMode(bool mode) { // hack for config mode
 	CONFIG_MODE = mode;
 	previewDisplayOptions = config.displayOptions;
+
+	// Web config edits the base options, profiles are edited through their own page
+	if (mode)
+		activateProfile(1);
 }
 
 bool Storage::GetConfigMode()
@@ -196,6 +316,26 @@ Gamepad * Storage::GetProcessedGamepad()
 	return processedGamepad;
 }
 
+void Storage::PublishProcessedState(const GamepadState& state)
+{
+	processedGamepadState.write(state);
+}
+
+void Storage::RefreshProcessedGamepad()
+{
+	processedGamepadState.read(processedGamepad->state);
+}
+
+bool Storage::PushGamepadEvent(const GamepadEvent& event)
+{
+	return gamepadEvents.push(event);
+}
+
+bool Storage::PopGamepadEvent(GamepadEvent& event)
+{
+	return gamepadEvents.pop(event);
+}
+
 void Storage::SetFeatureData(uint8_t * newData)
 {
 	memcpy(newData, featureData, sizeof(uint8_t)*sizeof(featureData));
@@ -1,10 +1,15 @@
 #include "system.h"
 
+#include <hardware/clocks.h>
 #include <hardware/flash.h>
+#include <hardware/gpio.h>
 #include <hardware/sync.h>
 #include <hardware/watchdog.h>
 #include <pico/multicore.h>
+#include <pico/platform.h>
+#include <pico/time.h>
 
+#include <algorithm>
 #include <malloc.h>
 
 extern char __flash_binary_start;
@@ -12,6 +17,72 @@ extern char __flash_binary_end;
 extern char __bss_end__;
 extern char __StackLimit;
 extern char __StackTop;
+extern char __StackBottom;
+extern char __StackOneTop;
+extern char __StackOneBottom;
+
+#ifndef STACK_PANIC_MARGIN
+#define STACK_PANIC_MARGIN 0
+#endif
+
+static const uint32_t STACK_PAINT_PATTERN = 0xc5c5c5c5;
+static const uint32_t STACK_CHECK_INTERVAL_MS = 1000;
+
+// The SDK places a 32 byte no-access MPU region at the bottom of each stack when stack guards are enabled
+#if PICO_USE_STACK_GUARDS
+static const uint32_t STACK_GUARD_SIZE = 32;
+#else
+static const uint32_t STACK_GUARD_SIZE = 0;
+#endif
+
+static absolute_time_t nextStackCheck[NUM_CORES] = {};
+
+// Load is sampled in 100 ms slices, ten slices make up the 1 s window and ten 1 s samples the 10 s window
+static const uint32_t LOAD_SLICE_US = 100000;
+static const uint32_t LOAD_SAMPLES = 10;
+
+struct CoreLoad {
+    uint64_t sliceStart;
+    uint32_t sliceIdleUs;
+    uint16_t shortSamples[LOAD_SAMPLES];
+    uint16_t longSamples[LOAD_SAMPLES];
+    uint8_t shortIndex;
+    uint8_t longIndex;
+    uint8_t shortCount;     // samples collected so far, until a window is full
+    uint8_t longCount;
+};
+
+static CoreLoad coreLoads[NUM_CORES] = {};
+
+// Scratch registers 0-3 survive a watchdog reboot and are not used by the SDK or the bootrom
+static const uint32_t LOAD_SCRATCH_FIRST = 0;   // one register per core, load1s << 16 | load10s
+static const uint32_t LOAD_SCRATCH_CHECK = 2;   // LOAD_SCRATCH_MAGIC ^ the figures if they are valid
+static const uint32_t LOAD_SCRATCH_MAGIC = 0x10adf00d;
+
+// Set for both cores so each idleUntil sees the edge, whichever core it is sleeping on
+static volatile bool wakePinEdge[NUM_CORES] = {};
+static volatile uint32_t clockDivider = 1;
+static uint32_t fullClockHz = 0;
+
+static uint16_t averageLoad(const uint16_t* samples, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    return sum / count;
+}
+
+static uint32_t* getStackBottom(uint32_t core) {
+    char* bottom = (core == 0) ? &__StackBottom : &__StackOneBottom;
+    return reinterpret_cast<uint32_t*>(bottom + STACK_GUARD_SIZE);
+}
+
+static uint32_t* getStackTop(uint32_t core) {
+    return reinterpret_cast<uint32_t*>((core == 0) ? &__StackTop : &__StackOneTop);
+}
 
 uint32_t System::getTotalFlash() {
 #if defined(PICO_FLASH_SIZE_BYTES)
@@ -40,6 +111,192 @@ uint32_t System::getUsedHeap() {
     return mallinfo().uordblks;
 }
 
+void __attribute__((noinline)) System::paintStack(uint32_t core) {
+    uint32_t* end = getStackTop(core);
+    if (core == get_core_num()) {
+        uint32_t sp;
+        __asm volatile ("mov %0, sp" : "=r" (sp));
+        // Leave a few words of headroom for this function's own frame
+        end = reinterpret_cast<uint32_t*>(sp) - 8;
+    }
+
+    for (uint32_t* p = getStackBottom(core); p < end; p++) {
+        *p = STACK_PAINT_PATTERN;
+    }
+}
+
+uint32_t System::getStackSize(uint32_t core) {
+    return (getStackTop(core) - getStackBottom(core)) * sizeof(uint32_t);
+}
+
+uint32_t System::getStackHighWaterMark(uint32_t core) {
+    const uint32_t* top = getStackTop(core);
+    const uint32_t* p = getStackBottom(core);
+    while (p < top && *p == STACK_PAINT_PATTERN) {
+        p++;
+    }
+    return (top - p) * sizeof(uint32_t);
+}
+
+void System::checkStack() {
+    const uint32_t core = get_core_num();
+    if (!time_reached(nextStackCheck[core])) {
+        return;
+    }
+    nextStackCheck[core] = make_timeout_time_ms(STACK_CHECK_INTERVAL_MS);
+
+    if (STACK_PANIC_MARGIN > 0) {
+        const uint32_t used = getStackHighWaterMark(core);
+        const uint32_t size = getStackSize(core);
+        if (used + STACK_PANIC_MARGIN > size) {
+            panic("Core %u stack near overflow: %u of %u bytes used", core, used, size);
+        }
+    }
+}
+
+bool System::idleUntil(uint64_t us) {
+    const uint64_t start = time_us_64();
+    absolute_time_t deadline;
+    update_us_since_boot(&deadline, us);
+
+    // The alarm armed by best_effort_wfe_or_timeout and the wake pin interrupt both end the WFE,
+    // any other event (e.g. a SEV from the other core) simply puts us back to sleep
+    const uint32_t core = get_core_num();
+    bool woken = false;
+    do {
+        if (wakePinEdge[core]) {
+            wakePinEdge[core] = false;
+            woken = true;
+            break;
+        }
+    } while (!best_effort_wfe_or_timeout(deadline));
+
+    coreLoads[core].sliceIdleUs += time_us_64() - start;
+    return woken;
+}
+
+static void wakePinCallback(uint gpio, uint32_t events) {
+    if (clockDivider != 1) {
+        System::setClockDivider(1);
+    }
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        wakePinEdge[core] = true;
+    }
+    // The interrupt only ends the WFE of the core it was taken on, wake the other one as well
+    __sev();
+}
+
+void System::setWakePins(uint32_t pinMask) {
+    for (uint32_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (pinMask & (1 << pin)) {
+            gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &wakePinCallback);
+        }
+    }
+}
+
+void System::updateLoad() {
+    CoreLoad& load = coreLoads[get_core_num()];
+    const uint64_t now = time_us_64();
+    if (load.sliceStart == 0) {
+        load.sliceStart = now;
+        return;
+    }
+
+    const uint32_t elapsed = now - load.sliceStart;
+    if (elapsed < LOAD_SLICE_US) {
+        return;
+    }
+
+    const uint32_t idleUs = std::min(load.sliceIdleUs, elapsed);
+    load.shortSamples[load.shortIndex] = 1000 - (uint64_t)idleUs * 1000 / elapsed;
+    load.shortIndex = (load.shortIndex + 1) % LOAD_SAMPLES;
+    load.shortCount = std::min<uint32_t>(load.shortCount + 1, LOAD_SAMPLES);
+    if (load.shortIndex == 0) {
+        load.longSamples[load.longIndex] = averageLoad(load.shortSamples, LOAD_SAMPLES);
+        load.longIndex = (load.longIndex + 1) % LOAD_SAMPLES;
+        load.longCount = std::min<uint32_t>(load.longCount + 1, LOAD_SAMPLES);
+    }
+
+    load.sliceStart = now;
+    load.sliceIdleUs = 0;
+}
+
+uint32_t System::getLoad1s(uint32_t core) {
+    return averageLoad(coreLoads[core].shortSamples, coreLoads[core].shortCount);
+}
+
+uint32_t System::getLoad10s(uint32_t core) {
+    return averageLoad(coreLoads[core].longSamples, coreLoads[core].longCount);
+}
+
+bool System::initClockScaling() {
+    const uint32_t ctrl = clocks_hw->clk[clk_sys].ctrl;
+    const bool fromPllSys =
+        ((ctrl & CLOCKS_CLK_SYS_CTRL_SRC_BITS) >> CLOCKS_CLK_SYS_CTRL_SRC_LSB) == CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX &&
+        ((ctrl & CLOCKS_CLK_SYS_CTRL_AUXSRC_BITS) >> CLOCKS_CLK_SYS_CTRL_AUXSRC_LSB) == CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS;
+    if (!fromPllSys || clocks_hw->clk[clk_sys].div != (1 << CLOCKS_CLK_SYS_DIV_INT_LSB)) {
+        return false;
+    }
+
+    fullClockHz = clock_get_hz(clk_sys);
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, fullClockHz, fullClockHz);
+    return true;
+}
+
+void System::setClockDivider(uint32_t divider) {
+    if (fullClockHz == 0 || divider == 0) {
+        return;
+    }
+
+    // The clk_sys integer divider can be changed on the fly without glitches
+    clocks_hw->clk[clk_sys].div = divider << CLOCKS_CLK_SYS_DIV_INT_LSB;
+    clock_set_reported_hz(clk_sys, fullClockHz / divider);
+    clockDivider = divider;
+}
+
+uint32_t System::getClockDivider() {
+    return clockDivider;
+}
+
+uint32_t System::getFullClockHz() {
+    return fullClockHz != 0 ? fullClockHz : clock_get_hz(clk_sys);
+}
+
+void System::keepLoadForReboot() {
+    uint32_t check = LOAD_SCRATCH_MAGIC;
+    for (uint32_t core = 0; core < NUM_CORES; core++) {
+        const uint32_t figures = getLoad1s(core) << 16 | getLoad10s(core);
+        watchdog_hw->scratch[LOAD_SCRATCH_FIRST + core] = figures;
+        check ^= figures;
+    }
+    watchdog_hw->scratch[LOAD_SCRATCH_CHECK] = check;
+}
+
+bool System::getPreviousLoad(uint32_t core, uint32_t& load1s, uint32_t& load10s) {
+    static bool taken = false;
+    static bool valid = false;
+    static uint32_t previous[NUM_CORES] = {};
+
+    if (!taken) {
+        taken = true;
+        uint32_t check = LOAD_SCRATCH_MAGIC;
+        for (uint32_t i = 0; i < NUM_CORES; i++) {
+            previous[i] = watchdog_hw->scratch[LOAD_SCRATCH_FIRST + i];
+            check ^= previous[i];
+        }
+        // Power-on resets clear the registers, only a watchdog reboot can leave valid figures behind
+        valid = watchdog_caused_reboot() && watchdog_hw->scratch[LOAD_SCRATCH_CHECK] == check;
+        watchdog_hw->scratch[LOAD_SCRATCH_CHECK] = 0;
+    }
+
+    if (!valid || core >= NUM_CORES) {
+        return false;
+    }
+    load1s = previous[core] >> 16;
+    load10s = previous[core] & 0xffff;
+    return true;
+}
+
 void System::reboot(BootMode bootMode) {
     // Make sure that the other core is halted
     // We do not want it to be talking to devices (e.g. OLED display) while we reboot
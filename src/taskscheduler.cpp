@@ -0,0 +1,57 @@
+#include "taskscheduler.h"
+
+#include "pico/time.h"
+
+void TaskScheduler::AddTask(GPAddon* addon, uint32_t periodUs) {
+    ScheduledTask task = {};
+    task.addon = addon;
+    task.periodUs = periodUs;
+    task.deadline = time_us_64();
+    tasks.push_back(task);
+}
+
+uint64_t TaskScheduler::RunTasks() {
+    // Only tasks that are due when the call starts run. A task that ran has its next deadline after
+    // its run ended, so each task runs at most once per call and a slow task can't starve the others.
+    const uint64_t start = time_us_64();
+    for (size_t i = 0; i < tasks.size(); i++) {
+        ScheduledTask * next = nullptr;
+        for (ScheduledTask& task : tasks) {
+            if (task.deadline <= start && (next == nullptr || task.deadline < next->deadline))
+                next = &task;
+        }
+        if (next == nullptr)
+            break;
+
+        const uint64_t now = time_us_64();
+
+        next->addon->process();
+
+        const uint64_t end = time_us_64();
+        TaskStats& stats = next->stats;
+        stats.runs++;
+        stats.lastRunUs = end - now;
+        if (stats.lastRunUs > stats.maxRunUs)
+            stats.maxRunUs = stats.lastRunUs;
+
+        // Keep the original cadence unless we fell a full period behind, then resync instead of bursting
+        next->deadline += next->periodUs;
+        if (next->deadline <= end) {
+            stats.overruns++;
+            next->deadline = end + next->periodUs;
+        }
+    }
+
+    uint64_t nextDeadline = UINT64_MAX;
+    for (const ScheduledTask& task : tasks) {
+        if (task.deadline < nextDeadline)
+            nextDeadline = task.deadline;
+    }
+    return nextDeadline;
+}
+
+void TaskScheduler::DispatchEvent(const GamepadEvent& event) {
+    for (ScheduledTask& task : tasks) {
+        task.addon->handleEvent(event);
+    }
+}
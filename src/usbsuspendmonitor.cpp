@@ -0,0 +1,10 @@
+#include "usbsuspendmonitor.h"
+#include "storagemanager.h"
+
+bool UsbSuspendMonitor::update(bool busSuspended) {
+    if (busSuspended != suspended && Storage::getInstance().PushGamepadEvent({
+            busSuspended ? GamepadEventType::USB_SUSPEND : GamepadEventType::USB_RESUME, 0, 0 })) {
+        suspended = busSuspended;
+    }
+    return suspended;
+}
@@ -0,0 +1,118 @@
+// Cost of one core0 add-on pass, pre-process and process, through AddonPipeline compared with calling
+// the same add-ons virtually from a list as core1's tasks are. The add-ons mirror core0's: fourteen of
+// them, five with a pre-process step, and a board only enables a few.
+//
+// Usage: addon_dispatch_bench [passes]
+
+#include "addonpipeline.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+// Each add-on does a token amount of work, enough that the calls can't be dropped
+static uint32_t work = 0;
+
+template <int N>
+class BenchAddon : public GPAddon
+{
+public:
+	static bool enabled;
+	virtual bool available() { return enabled; }
+	virtual void setup() {}
+	virtual void process() { work += N; }
+	virtual std::string name() { return "Bench"; }
+};
+
+template <int N>
+bool BenchAddon<N>::enabled = false;
+
+template <int N>
+class BenchInputAddon : public BenchAddon<N>
+{
+public:
+	virtual void preprocess() { work ^= N; }
+};
+
+typedef AddonPipeline<
+	BenchInputAddon<0>, BenchAddon<1>, BenchInputAddon<2>, BenchAddon<3>, BenchInputAddon<4>,
+	BenchAddon<5>, BenchAddon<6>, BenchAddon<7>, BenchAddon<8>, BenchAddon<9>,
+	BenchAddon<10>, BenchAddon<11>, BenchInputAddon<12>, BenchInputAddon<13>
+> BenchPipeline;
+
+template <typename T>
+static void enable(std::vector<GPAddon*>& list, bool enabled)
+{
+	T::enabled = enabled;
+	if (enabled)
+		list.push_back(new T());
+}
+
+// Enables every add-on whose bit is set in mask, for both the pipeline and the list
+static std::vector<GPAddon*> enableAddons(uint32_t mask)
+{
+	std::vector<GPAddon*> list;
+	enable<BenchInputAddon<0>>(list, mask & (1 << 0));
+	enable<BenchAddon<1>>(list, mask & (1 << 1));
+	enable<BenchInputAddon<2>>(list, mask & (1 << 2));
+	enable<BenchAddon<3>>(list, mask & (1 << 3));
+	enable<BenchInputAddon<4>>(list, mask & (1 << 4));
+	enable<BenchAddon<5>>(list, mask & (1 << 5));
+	enable<BenchAddon<6>>(list, mask & (1 << 6));
+	enable<BenchAddon<7>>(list, mask & (1 << 7));
+	enable<BenchAddon<8>>(list, mask & (1 << 8));
+	enable<BenchAddon<9>>(list, mask & (1 << 9));
+	enable<BenchAddon<10>>(list, mask & (1 << 10));
+	enable<BenchAddon<11>>(list, mask & (1 << 11));
+	enable<BenchInputAddon<12>>(list, mask & (1 << 12));
+	enable<BenchInputAddon<13>>(list, mask & (1 << 13));
+	return list;
+}
+
+template <typename Pass>
+static void bench(const char* name, uint32_t passes, Pass pass)
+{
+	// Warm up so the first measurement doesn't pay for the clock ramping up
+	for (uint32_t i = 0; i < passes / 10; i++)
+		pass();
+
+	work = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < passes; i++)
+		pass();
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%-24s %8.2f ns/pass (%08x)\n", name, elapsed / passes, work);
+}
+
+static void benchAddons(const char* name, uint32_t mask, uint32_t passes)
+{
+	std::vector<GPAddon*> list = enableAddons(mask);
+	BenchPipeline pipeline;
+	pipeline.setup();
+
+	printf("%s, %zu of 14 add-ons\n", name, list.size());
+	bench("  pipeline", passes, [&] { pipeline.preprocess(); pipeline.process(); });
+	bench("  virtual list", passes, [&]
+	{
+		for (GPAddon* addon : list)
+			addon->preprocess();
+		for (GPAddon* addon : list)
+			addon->process();
+	});
+
+	for (GPAddon* addon : list)
+		delete addon;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t passes = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20000000;
+
+	benchAddons("none", 0, passes);
+	benchAddons("typical board", (1 << 0) | (1 << 2) | (1 << 9), passes);
+	benchAddons("all", 0x3fff, passes);
+
+	return 0;
+}
@@ -0,0 +1,232 @@
+// Claims the default pins of one board through PinRegistry the way the gamepad and the add-ons enabled by
+// its BoardConfig.h do at boot, and expects no conflicts. Built once per configs/*/BoardConfig.h, with
+// BOARD_NAME set to the folder name.
+//
+// Usage: board_pins_test_<board>
+
+#include "BoardConfig.h"
+#include "pinregistry.h"
+#include "helper.h"
+
+// Defaults for what the board leaves out come from the add-on headers
+#include "addons/analog.h"
+#include "addons/board_led.h"
+#include "addons/buzzerspeaker.h"
+#include "addons/dualdirectional.h"
+#include "addons/extra_button.h"
+#include "addons/focus_mode.h"
+#include "addons/jslider.h"
+#include "addons/reverse.h"
+#include "addons/slider_socd.h"
+#include "addons/tilt.h"
+#include "addons/turbo.h"
+
+#include <stdio.h>
+
+// The display, NeoPixel, player LED, keyboard host, ADS1219 and Wii headers need the hardware or TinyUSB
+// libraries, these are their defaults
+#ifndef HAS_I2C_DISPLAY
+#define HAS_I2C_DISPLAY -1
+#endif
+#ifndef I2C_SDA_PIN
+#define I2C_SDA_PIN -1
+#endif
+#ifndef I2C_SCL_PIN
+#define I2C_SCL_PIN -1
+#endif
+#ifndef BOARD_LEDS_PIN
+#define BOARD_LEDS_PIN -1
+#endif
+#ifndef PLED_TYPE
+#define PLED_TYPE PLED_TYPE_NONE
+#endif
+#ifndef PLED1_PIN
+#define PLED1_PIN -1
+#endif
+#ifndef PLED2_PIN
+#define PLED2_PIN -1
+#endif
+#ifndef PLED3_PIN
+#define PLED3_PIN -1
+#endif
+#ifndef PLED4_PIN
+#define PLED4_PIN -1
+#endif
+#ifndef KEYBOARD_HOST_ENABLED
+#define KEYBOARD_HOST_ENABLED 0
+#endif
+#ifndef KEYBOARD_HOST_PIN_DPLUS
+#define KEYBOARD_HOST_PIN_DPLUS -1
+#endif
+#ifndef KEYBOARD_HOST_PIN_5V
+#define KEYBOARD_HOST_PIN_5V -1
+#endif
+#ifndef I2C_ANALOG1219_ENABLED
+#define I2C_ANALOG1219_ENABLED 0
+#endif
+#ifndef I2C_ANALOG1219_SDA_PIN
+#define I2C_ANALOG1219_SDA_PIN -1
+#endif
+#ifndef I2C_ANALOG1219_SCL_PIN
+#define I2C_ANALOG1219_SCL_PIN -1
+#endif
+#ifndef WII_EXTENSION_ENABLED
+#define WII_EXTENSION_ENABLED 0
+#endif
+#ifndef WII_EXTENSION_I2C_SDA_PIN
+#define WII_EXTENSION_I2C_SDA_PIN -1
+#endif
+#ifndef WII_EXTENSION_I2C_SCL_PIN
+#define WII_EXTENSION_I2C_SCL_PIN -1
+#endif
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+// -1 is a pin the board doesn't wire, the firmware skips those as well
+static void claim(int32_t pin, const char* owner)
+{
+	if (isValidPin(pin))
+		PinRegistry::getInstance().claim(pin, owner);
+}
+
+static void claimInput(int32_t pin, const char* owner)
+{
+	if (isValidPin(pin))
+		PinRegistry::getInstance().claimInput(pin, owner);
+}
+
+// Mirrors Gamepad::setup() and each add-on's available() and setup() with the defaults ConfigUtils
+// fills in from BoardConfig.h
+static void claimBoardPins()
+{
+	const int32_t gamepadPins[] =
+	{
+		PIN_DPAD_UP, PIN_DPAD_DOWN, PIN_DPAD_LEFT, PIN_DPAD_RIGHT,
+		PIN_BUTTON_B1, PIN_BUTTON_B2, PIN_BUTTON_B3, PIN_BUTTON_B4,
+		PIN_BUTTON_L1, PIN_BUTTON_R1, PIN_BUTTON_L2, PIN_BUTTON_R2,
+		PIN_BUTTON_S1, PIN_BUTTON_S2, PIN_BUTTON_L3, PIN_BUTTON_R3,
+		PIN_BUTTON_A1, PIN_BUTTON_A2, PIN_BUTTON_FN,
+	};
+	for (int32_t pin : gamepadPins)
+		claimInput(pin, PIN_OWNER_GAMEPAD);
+
+	// Core1: display, NeoPixels, player LEDs, board LED, buzzer. -1 disables the display like 0 does
+	const bool displayEnabled = HAS_I2C_DISPLAY > 0 && isValidPin(I2C_SDA_PIN) && isValidPin(I2C_SCL_PIN);
+	if (displayEnabled)
+	{
+		claim(I2C_SDA_PIN, PIN_OWNER_I2C);
+		claim(I2C_SCL_PIN, PIN_OWNER_I2C);
+	}
+	claim(BOARD_LEDS_PIN, "NeoPicoLED");
+	if (PLED_TYPE == PLED_TYPE_PWM)
+	{
+		const int32_t pledPins[] = { PLED1_PIN, PLED2_PIN, PLED3_PIN, PLED4_PIN };
+		for (int32_t pin : pledPins)
+			claim(pin, "PLED");
+	}
+	if (BOARD_LED_ENABLED && BOARD_LED_TYPE != ON_BOARD_LED_MODE_OFF)
+		claim(BOARD_LED_PIN, OnBoardLedName);
+	if (BUZZER_ENABLED)
+		claim(BUZZER_PIN, BuzzerSpeakerName);
+
+	// Core0 input add-ons
+	if (ANALOG_INPUT_ENABLED)
+	{
+		const int32_t adcPins[] = { ANALOG_ADC_1_VRX, ANALOG_ADC_1_VRY, ANALOG_ADC_2_VRX, ANALOG_ADC_2_VRY };
+		for (int32_t pin : adcPins)
+			claim(pin, AnalogName);
+	}
+	if (TURBO_ENABLED)
+	{
+		claimInput(PIN_BUTTON_TURBO, TurboName);
+		claim(PIN_SHMUP_DIAL, TurboName);
+		claim(TURBO_LED_PIN, TurboName);
+		if (TURBO_SHMUP_MODE)
+		{
+			const int32_t shmupPins[] = { PIN_SHMUP_BUTTON1, PIN_SHMUP_BUTTON2, PIN_SHMUP_BUTTON3, PIN_SHMUP_BUTTON4 };
+			for (int32_t pin : shmupPins)
+				claimInput(pin, TurboName);
+		}
+	}
+	if (REVERSE_ENABLED && isValidPin(PIN_REVERSE))
+	{
+		claimInput(PIN_REVERSE, ReverseName);
+		claim(REVERSE_LED_PIN, ReverseName);
+	}
+	if (JSLIDER_ENABLED)
+	{
+		claimInput(PIN_SLIDER_LS, JSliderName);
+		claimInput(PIN_SLIDER_RS, JSliderName);
+	}
+	if (SLIDER_SOCD_ENABLED && isValidPin(PIN_SLIDER_SOCD_ONE) && isValidPin(PIN_SLIDER_SOCD_TWO))
+	{
+		claimInput(PIN_SLIDER_SOCD_ONE, SliderSOCDName);
+		claimInput(PIN_SLIDER_SOCD_TWO, SliderSOCDName);
+	}
+	if (DUAL_DIRECTIONAL_ENABLED)
+	{
+		const int32_t dualPins[] = { PIN_DUAL_DIRECTIONAL_UP, PIN_DUAL_DIRECTIONAL_DOWN, PIN_DUAL_DIRECTIONAL_LEFT, PIN_DUAL_DIRECTIONAL_RIGHT };
+		for (int32_t pin : dualPins)
+			claimInput(pin, DualDirectionalName);
+	}
+	if (TILT_ENABLED)
+	{
+		const int32_t tiltPins[] =
+		{
+			PIN_TILT_1, PIN_TILT_2,
+			PIN_TILT_LEFT_ANALOG_DOWN, PIN_TILT_LEFT_ANALOG_UP, PIN_TILT_LEFT_ANALOG_LEFT, PIN_TILT_LEFT_ANALOG_RIGHT,
+			PIN_TILT_RIGHT_ANALOG_DOWN, PIN_TILT_RIGHT_ANALOG_UP, PIN_TILT_RIGHT_ANALOG_LEFT, PIN_TILT_RIGHT_ANALOG_RIGHT,
+		};
+		for (int32_t pin : tiltPins)
+			claimInput(pin, TiltName);
+	}
+	if (EXTRA_BUTTON_ENABLED && EXTRA_BUTTON_MASK != 0)
+		claimInput(EXTRA_BUTTON_PIN, ExtraButtonName);
+	if (FOCUS_MODE_ENABLED && FOCUS_MODE_BUTTON_MASK != 0)
+		claimInput(FOCUS_MODE_PIN, FocusModeName);
+	if (KEYBOARD_HOST_ENABLED && isValidPin(KEYBOARD_HOST_PIN_DPLUS))
+	{
+		claim(KEYBOARD_HOST_PIN_DPLUS, "KeyboardHost");
+		claim(KEYBOARD_HOST_PIN_DPLUS + 1, "KeyboardHost");
+		claim(KEYBOARD_HOST_PIN_5V, "KeyboardHost");
+	}
+	if (I2C_ANALOG1219_ENABLED && isValidPin(I2C_ANALOG1219_SDA_PIN) && isValidPin(I2C_ANALOG1219_SCL_PIN))
+	{
+		claim(I2C_ANALOG1219_SDA_PIN, PIN_OWNER_I2C);
+		claim(I2C_ANALOG1219_SCL_PIN, PIN_OWNER_I2C);
+	}
+	if (!displayEnabled && WII_EXTENSION_ENABLED && isValidPin(WII_EXTENSION_I2C_SDA_PIN) && isValidPin(WII_EXTENSION_I2C_SCL_PIN))
+	{
+		claim(WII_EXTENSION_I2C_SDA_PIN, PIN_OWNER_I2C);
+		claim(WII_EXTENSION_I2C_SCL_PIN, PIN_OWNER_I2C);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	claimBoardPins();
+
+	const PinRegistry& pinRegistry = PinRegistry::getInstance();
+	for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+	{
+		if (pinRegistry.getConflictMask() & (1u << pin))
+			printf("%s: GPIO %u is used by %s and %s\n", BOARD_NAME, pin, pinRegistry.getOwner(pin), pinRegistry.getConflictOwner(pin));
+	}
+	CHECK(pinRegistry.getConflictMask() == 0);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("%s: default pins claimed without conflicts\n", BOARD_NAME);
+	return 0;
+}
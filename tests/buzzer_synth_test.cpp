@@ -0,0 +1,287 @@
+// Renders notes and songs with the buzzer synthesizer the way the buzzer add-on does, in buffers of the
+// DMA size at the firmware's sample rate. Pitches are checked by counting the rising edges of the square
+// wave, levels against the PWM wrap. The intro song can be written to a WAV file to listen to it.
+//
+// Usage: buzzer_synth_test [wav file]
+
+#include "BuzzerSynth.h"
+#include "songs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#define SAMPLE_RATE 24000
+#define BUFFER_SAMPLES 256
+#define MAX_LEVEL 255
+#define ENVELOPE { 5, 40, 180, 30 }
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ < e_ - (tolerance) || a_ > e_ + (tolerance)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+static void initSynth(BuzzerSynth& synth)
+{
+	synth.init(SAMPLE_RATE, MAX_LEVEL, ENVELOPE);
+}
+
+// Renders whole buffers until at least count samples are out
+static void render(BuzzerSynth& synth, std::vector<uint16_t>& output, uint32_t count)
+{
+	uint16_t buffer[BUFFER_SAMPLES];
+	const size_t end = output.size() + count;
+	while (output.size() < end)
+	{
+		synth.render(buffer, BUFFER_SAMPLES);
+		output.insert(output.end(), buffer, buffer + BUFFER_SAMPLES);
+	}
+}
+
+static uint32_t msToSamples(uint32_t ms)
+{
+	return ms * SAMPLE_RATE / 1000;
+}
+
+static uint32_t risingEdges(const std::vector<uint16_t>& samples, size_t start, size_t end)
+{
+	uint32_t edges = 0;
+	for (size_t i = start + 1; i < end; i++)
+	{
+		if (samples[i - 1] == 0 && samples[i] > 0)
+			edges++;
+	}
+	return edges;
+}
+
+static uint16_t peak(const std::vector<uint16_t>& samples)
+{
+	uint16_t level = 0;
+	for (uint16_t sample : samples)
+		level = std::max(level, sample);
+	return level;
+}
+
+static uint32_t testPitch(uint16_t frequency, uint32_t ms)
+{
+	BuzzerSynth synth;
+	initSynth(synth);
+	CHECK(synth.queue({ frequency, (uint16_t)(ms + 100), (uint16_t)(ms + 100), 0xFF }));
+
+	std::vector<uint16_t> samples;
+	render(synth, samples, msToSamples(ms));
+	const uint32_t edges = risingEdges(samples, 0, msToSamples(ms));
+	CHECK_NEAR(edges, frequency * ms / 1000, 1);
+	return edges;
+}
+
+static void testLevels()
+{
+	BuzzerSynth synth;
+	initSynth(synth);
+	CHECK(synth.isIdle());
+
+	// A full chord peaks at the maximum level and never goes past it
+	CHECK(synth.queue({ C5, 200, 0, 0xFF }));
+	CHECK(synth.queue({ E5, 200, 0, 0xFF }));
+	CHECK(synth.queue({ G5, 200, 200, 0xFF }));
+	CHECK(!synth.isIdle());
+
+	std::vector<uint16_t> samples;
+	render(synth, samples, msToSamples(300));
+	CHECK(peak(samples) <= MAX_LEVEL);
+	CHECK(peak(samples) > MAX_LEVEL * 9 / 10);
+
+	// Released and silent well after the gate closed
+	CHECK(synth.isIdle());
+	for (size_t i = msToSamples(250); i < samples.size(); i++)
+		CHECK_EQ(samples[i], 0);
+
+	// A single voice gets a third of the range, scaled by the velocity
+	samples.clear();
+	CHECK(synth.queue({ A5, 100, 100, 0x80 }));
+	render(synth, samples, msToSamples(100));
+	CHECK(peak(samples) <= MAX_LEVEL / BUZZER_SYNTH_VOICES / 2);
+	CHECK(peak(samples) > MAX_LEVEL / BUZZER_SYNTH_VOICES / 3);
+}
+
+static void testRest()
+{
+	BuzzerSynth synth;
+	initSynth(synth);
+	CHECK(synth.queue({ PAUSE, 50, 50, 0xFF }));
+	CHECK(synth.queue({ A4, 50, 50, 0xFF }));
+
+	// Nothing plays until the rest is over
+	std::vector<uint16_t> samples;
+	render(synth, samples, msToSamples(100));
+	CHECK_EQ(peak(std::vector<uint16_t>(samples.begin(), samples.begin() + msToSamples(50))), 0);
+	CHECK(peak(samples) > 0);
+}
+
+static void testQueue()
+{
+	BuzzerSynth synth;
+	initSynth(synth);
+	for (uint32_t i = 0; i < BUZZER_SYNTH_QUEUE_SIZE; i++)
+		CHECK(synth.queue({ A4, 10, 10, 0xFF }));
+	CHECK(!synth.queue({ A4, 10, 10, 0xFF }));
+
+	// The renderer frees a slot as soon as it starts a note
+	std::vector<uint16_t> samples;
+	render(synth, samples, 1);
+	CHECK(synth.queue({ A4, 10, 10, 0xFF }));
+}
+
+static void testStop()
+{
+	BuzzerSynth synth;
+	initSynth(synth);
+	for (uint32_t i = 0; i < 8; i++)
+		CHECK(synth.queue({ A5, 100, 100, 0xFF }));
+
+	std::vector<uint16_t> samples;
+	render(synth, samples, msToSamples(50));
+
+	// The queued notes are dropped and the playing one fades out within the release
+	synth.stop();
+	CHECK(!synth.isIdle());
+	samples.clear();
+	render(synth, samples, msToSamples(100));
+	CHECK(synth.isIdle());
+	for (size_t i = msToSamples(40); i < samples.size(); i++)
+		CHECK_EQ(samples[i], 0);
+
+	// Notes queued after stop() still play
+	synth.stop();
+	CHECK(synth.queue({ A5, 50, 50, 0xFF }));
+	samples.clear();
+	render(synth, samples, msToSamples(20));
+	CHECK(peak(samples) > 0);
+}
+
+// Queues a song the way BuzzerSpeakerAddon::processBuzzer() does, topping up the queue between buffers
+static std::vector<uint16_t> renderSong(const Song& song)
+{
+	BuzzerSynth synth;
+	initSynth(synth);
+
+	std::vector<uint16_t> samples;
+	uint32_t position = 0;
+	while (position < song.length || !synth.isIdle())
+	{
+		while (position < song.length &&
+			synth.queue({ song.tones[position], song.toneDuration, song.toneDuration, 0xFF }))
+			position++;
+		render(synth, samples, BUFFER_SAMPLES);
+	}
+	return samples;
+}
+
+static void testSong(const Song& song)
+{
+	const std::vector<uint16_t> samples = renderSong(song);
+	const uint32_t toneSamples = msToSamples(song.toneDuration);
+
+	// Plays for the length of the song plus the last release
+	CHECK(samples.size() >= song.length * toneSamples);
+	CHECK(samples.size() <= song.length * toneSamples + msToSamples(100));
+	CHECK(peak(samples) <= MAX_LEVEL);
+
+	// Every tone keeps its pitch, the release of the previous one overlaps its start
+	for (uint32_t i = 0; i < song.length; i++)
+	{
+		const size_t start = i * toneSamples + msToSamples(40);
+		const size_t end = (i + 1) * toneSamples;
+		if (song.tones[i] != PAUSE)
+			CHECK_NEAR(risingEdges(samples, start, end), song.tones[i] * (song.toneDuration - 40) / 1000, 2);
+	}
+}
+
+static void putLE(FILE* file, uint32_t value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		fputc((value >> (8 * i)) & 0xff, file);
+}
+
+// 16-bit mono PCM, the PWM level centered around zero
+static bool writeWav(const char* path, const std::vector<uint16_t>& samples)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	const uint32_t dataSize = samples.size() * 2;
+	fwrite("RIFF", 1, 4, file);
+	putLE(file, 36 + dataSize, 4);
+	fwrite("WAVEfmt ", 1, 8, file);
+	putLE(file, 16, 4);
+	putLE(file, 1, 2);
+	putLE(file, 1, 2);
+	putLE(file, SAMPLE_RATE, 4);
+	putLE(file, SAMPLE_RATE * 2, 4);
+	putLE(file, 2, 2);
+	putLE(file, 16, 2);
+	fwrite("data", 1, 4, file);
+	putLE(file, dataSize, 4);
+	for (uint16_t sample : samples)
+		putLE(file, (uint16_t)(((int32_t)sample - MAX_LEVEL / 2) * 32767 / MAX_LEVEL), 2);
+
+	return fclose(file) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	CHECK_EQ(testPitch(A4, 100), 44);
+	testPitch(A4, 1000);
+	testPitch(C5, 1000);
+	testPitch(B6, 1000);
+	testPitch(DS8, 1000);
+	testLevels();
+	testRest();
+	testQueue();
+	testStop();
+	testSong(introSong);
+	testSong(configModeSong);
+	testSong(cueInputModeSong);
+
+	if (argc > 1)
+	{
+		const std::vector<uint16_t> samples = renderSong(introSong);
+		CHECK(writeWav(argv[1], samples));
+		printf("wrote %s, %.2f s\n", argv[1], samples.size() / (double)SAMPLE_RATE);
+	}
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("buzzer synth: all checks passed\n");
+	return 0;
+}
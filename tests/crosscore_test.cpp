@@ -0,0 +1,186 @@
+// Hammers the cross-core primitives from two threads, standing in for core0 and core1. Every SeqLock
+// read that succeeds has to be a whole snapshot from a single write, and versions only move forward.
+// Every queued item has to come out exactly once and in order, whatever the queue's fill level.
+//
+// Usage: crosscore_test [iterations] [seed]
+
+#include "crosscore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <random>
+#include <thread>
+
+static std::atomic<int> failures(0);
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+// Large enough for the reader to be preempted in the middle of a copy, so a torn copy mixes two writes.
+// Every field holds the number of its write.
+struct Snapshot
+{
+	uint32_t fields[1024];
+};
+
+static bool isWhole(const Snapshot& snapshot)
+{
+	for (uint32_t field : snapshot.fields)
+	{
+		if (field != snapshot.fields[0])
+			return false;
+	}
+	return true;
+}
+
+static void testSeqLock(uint32_t iterations)
+{
+	SeqLock<Snapshot> lock;
+	std::atomic<bool> done(false);
+
+	std::thread writer([&]()
+	{
+		Snapshot snapshot;
+		for (uint32_t i = 1; i <= iterations; i++)
+		{
+			for (uint32_t& field : snapshot.fields)
+				field = i;
+			lock.write(snapshot);
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	uint32_t lastSeen = 0;
+	uint32_t lastVersion = 0;
+	uint32_t reads = 0;
+	uint32_t retries = 0;
+	while (!done.load(std::memory_order_acquire) || reads == 0)
+	{
+		const uint32_t version = lock.version();
+		CHECK(version >= lastVersion);
+		lastVersion = version;
+
+		Snapshot snapshot;
+		if (!lock.tryRead(snapshot))
+		{
+			retries++;
+			std::this_thread::yield();
+			continue;
+		}
+		reads++;
+		CHECK(isWhole(snapshot));
+		CHECK(snapshot.fields[0] >= lastSeen);
+		lastSeen = snapshot.fields[0];
+	}
+	writer.join();
+
+	// The blocking read sees the last write once the writer is done
+	Snapshot snapshot;
+	lock.read(snapshot);
+	CHECK(isWhole(snapshot));
+	CHECK_EQ(snapshot.fields[0], iterations);
+	CHECK_EQ(lock.version(), iterations * 2);
+	printf("seqlock: %u reads, %u retries\n", reads, retries);
+}
+
+struct Item
+{
+	uint32_t number;
+	uint32_t check;
+};
+
+// Both sides yield now and then so the queue runs both empty and full. A side that can't make progress
+// yields as well, the test may run on a single CPU.
+static void testQueue(uint32_t iterations, uint32_t seed)
+{
+	SPSCQueue<Item, 32> queue;
+
+	std::thread producer([&]()
+	{
+		std::mt19937 rng(seed);
+		for (uint32_t i = 0; i < iterations;)
+		{
+			if (queue.push({ i, ~i }))
+				i++;
+			else
+				std::this_thread::yield();
+			if ((rng() & 1023) == 0)
+				std::this_thread::yield();
+		}
+	});
+
+	std::mt19937 rng(seed + 1);
+	uint32_t expected = 0;
+	uint32_t emptyPolls = 0;
+	while (expected < iterations)
+	{
+		Item item;
+		if (!queue.pop(item))
+		{
+			emptyPolls++;
+			std::this_thread::yield();
+			continue;
+		}
+		CHECK_EQ(item.number, expected);
+		CHECK_EQ(item.check, ~expected);
+		expected = item.number + 1;
+		if ((rng() & 1023) == 0)
+			std::this_thread::yield();
+	}
+	producer.join();
+
+	Item item;
+	CHECK(queue.empty());
+	CHECK(!queue.pop(item));
+	printf("queue: %u items, %u empty polls\n", iterations, emptyPolls);
+}
+
+// A full queue drops new items and leaves the queued ones alone
+static void testFullQueue()
+{
+	SPSCQueue<Item, 4> queue;
+	for (uint32_t i = 0; i < 4; i++)
+		CHECK(queue.push({ i, ~i }));
+	CHECK(!queue.push({ 4, ~4u }));
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		Item item;
+		CHECK(queue.pop(item));
+		CHECK_EQ(item.number, i);
+	}
+	CHECK(queue.empty());
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1000000;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+
+	testFullQueue();
+	testSeqLock(iterations);
+	testQueue(iterations, seed);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures.load(), seed);
+		return 1;
+	}
+	printf("crosscore: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
@@ -0,0 +1,341 @@
+// Feeds Entropy biased and correlated ROSC bits and follows every read with a model of the pool: bit
+// pairs through the von Neumann extractor, bytes into the pool in passes of ENTROPY_PAIRS_PER_PASS pairs,
+// each output block the SHA-256 of the previous block, the last ENTROPY_BLOCK_SIZE pool bytes and a
+// counter. Output has to match the model byte for byte, so no byte is handed out twice and every block is
+// made of pool bytes no other block used.
+//
+// Usage: entropy_test [iterations] [seed]
+
+#include "entropy.h"
+#include "hardware/structs/rosc.h"
+#include "mbedtls/sha256.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <deque>
+#include <functional>
+#include <random>
+#include <set>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+static std::mt19937 rng;
+static std::function<uint8_t()> roscSource;
+static std::deque<uint8_t> roscBits;    // read by Entropy, not yet taken by the model
+static uint64_t roscReads = 0;
+
+// Only bit 0 of the register is the random bit, the rest is noise Entropy has to mask off
+uint32_t host_rosc_randombit(void)
+{
+	const uint8_t bit = roscSource() & 1;
+	roscBits.push_back(bit);
+	roscReads++;
+	return (rng() & ~1u) | bit;
+}
+
+static void sha256(const uint8_t* lastBlock, const uint8_t* input, uint32_t counter, uint8_t* block)
+{
+	mbedtls_sha256_context sha;
+	mbedtls_sha256_init(&sha);
+	mbedtls_sha256_starts_ret(&sha, 0);
+	mbedtls_sha256_update_ret(&sha, lastBlock, 32);
+	mbedtls_sha256_update_ret(&sha, input, ENTROPY_BLOCK_SIZE);
+	mbedtls_sha256_update_ret(&sha, reinterpret_cast<const uint8_t*>(&counter), sizeof(counter));
+	mbedtls_sha256_finish_ret(&sha, block);
+	mbedtls_sha256_free(&sha);
+}
+
+// What Entropy should hold, built from the bits it read
+struct Model
+{
+	std::vector<uint8_t> pool;
+	uint8_t pendingByte = 0;
+	uint8_t pendingBits = 0;
+	uint8_t chain[32] = { };
+	uint32_t counter = 0;
+	std::deque<uint8_t> ready;
+	std::vector<uint8_t> whitened;   // every bit that went into the pool
+
+	// False if Entropy read fewer bits than this pass takes
+	bool gather()
+	{
+		for (uint32_t i = 0; i < ENTROPY_PAIRS_PER_PASS && pool.size() < ENTROPY_POOL_SIZE; i++)
+		{
+			if (roscBits.size() < 2)
+			{
+				CHECK(roscBits.size() >= 2);
+				return false;
+			}
+			const uint8_t first = roscBits.front();
+			roscBits.pop_front();
+			const uint8_t second = roscBits.front();
+			roscBits.pop_front();
+			if (first == second)
+				continue;
+
+			whitened.push_back(first);
+			pendingByte = (pendingByte << 1) | first;
+			if (++pendingBits == 8)
+			{
+				pool.push_back(pendingByte);
+				pendingByte = 0;
+				pendingBits = 0;
+			}
+		}
+		return true;
+	}
+
+	void process()
+	{
+		if (pool.size() < ENTROPY_POOL_SIZE)
+			gather();
+	}
+
+	std::vector<uint8_t> getBytes(size_t length)
+	{
+		std::vector<uint8_t> output;
+		while (output.size() < length)
+		{
+			if (ready.empty())
+			{
+				while (pool.size() < ENTROPY_BLOCK_SIZE)
+				{
+					if (!gather())
+						return output;
+				}
+				const std::vector<uint8_t> input(pool.end() - ENTROPY_BLOCK_SIZE, pool.end());
+				pool.resize(pool.size() - ENTROPY_BLOCK_SIZE);
+				sha256(chain, input.data(), counter++, chain);
+				ready.assign(chain, chain + sizeof(chain));
+			}
+			output.push_back(ready.front());
+			ready.pop_front();
+		}
+		return output;
+	}
+};
+
+static Model model;
+
+// Every bit Entropy read has to be accounted for by the model
+static void checkAllBitsTaken()
+{
+	CHECK_EQ(roscBits.size(), 0);
+	roscBits.clear();
+}
+
+static void process()
+{
+	const uint64_t reads = roscReads;
+	Entropy::getInstance().process();
+	CHECK(roscReads - reads <= ENTROPY_PAIRS_PER_PASS * 2);
+	model.process();
+	checkAllBitsTaken();
+}
+
+static std::vector<uint8_t> getBytes(size_t length)
+{
+	std::vector<uint8_t> output(length + 1, 0xa5);
+	Entropy::getInstance().getBytes(output.data(), length);
+	CHECK_EQ(output[length], 0xa5);
+	output.resize(length);
+
+	const std::vector<uint8_t> expected = model.getBytes(length);
+	CHECK(output == expected);
+	checkAllBitsTaken();
+	return output;
+}
+
+// The host SHA-256 stand-in against the FIPS 180-2 "abc" and two block vectors
+static void testSha256()
+{
+	static const uint8_t abc[32] =
+	{
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+	};
+	static const uint8_t twoBlocks[32] =
+	{
+		0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+		0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1,
+	};
+	uint8_t digest[32];
+	CHECK_EQ(mbedtls_sha256_ret(reinterpret_cast<const uint8_t*>("abc"), 3, digest, 0), 0);
+	CHECK(memcmp(digest, abc, sizeof(digest)) == 0);
+	const char* message = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	CHECK_EQ(mbedtls_sha256_ret(reinterpret_cast<const uint8_t*>(message), strlen(message), digest, 0), 0);
+	CHECK(memcmp(digest, twoBlocks, sizeof(digest)) == 0);
+}
+
+// Known bytes, each bit sent as 10 or 01 behind a few 00 and 11 pairs the extractor has to drop. Runs on a
+// fresh Entropy, so the first block is checked against the SHA-256 of exactly those bytes.
+static void testWhitening()
+{
+	uint8_t bytes[ENTROPY_POOL_SIZE];
+	for (uint8_t& byte : bytes)
+		byte = rng();
+
+	std::deque<uint8_t> bits;
+	for (uint8_t byte : bytes)
+	{
+		for (int i = 7; i >= 0; i--)
+		{
+			for (uint32_t dropped = rng() % 4; dropped > 0; dropped--)
+			{
+				const uint8_t same = rng() & 1;
+				bits.push_back(same);
+				bits.push_back(same);
+			}
+			const uint8_t bit = (byte >> i) & 1;
+			bits.push_back(bit);
+			bits.push_back(!bit);
+		}
+	}
+	roscSource = [&bits]()
+	{
+		if (bits.empty())
+			return static_cast<uint8_t>(0);
+		const uint8_t bit = bits.front();
+		bits.pop_front();
+		return bit;
+	};
+
+	// Topped up a pass at a time until full, then the ROSC is left alone
+	uint32_t passes = 0;
+	while (model.pool.size() < ENTROPY_POOL_SIZE && passes++ < 100)
+		process();
+	CHECK(passes > 1);
+	CHECK(bits.empty());
+	CHECK(std::vector<uint8_t>(bytes, bytes + sizeof(bytes)) == model.pool);
+	const uint64_t reads = roscReads;
+	process();
+	CHECK_EQ(roscReads, reads);
+
+	// Blocks come from the end of the pool
+	uint8_t zero[32] = { };
+	uint8_t first[32];
+	uint8_t second[32];
+	sha256(zero, &bytes[ENTROPY_POOL_SIZE - ENTROPY_BLOCK_SIZE], 0, first);
+	sha256(first, &bytes[ENTROPY_POOL_SIZE - 2 * ENTROPY_BLOCK_SIZE], 1, second);
+	CHECK(getBytes(32) == std::vector<uint8_t>(first, first + 32));
+	CHECK(getBytes(32) == std::vector<uint8_t>(second, second + 32));
+	CHECK_EQ(roscReads, reads);
+}
+
+// Independent bits with a strong bias come out of the extractor with none
+static void testBias(uint32_t iterations)
+{
+	roscSource = []() { return static_cast<uint8_t>(rng() % 10 < 9); };
+	model.whitened.clear();
+	for (uint32_t i = 0; i < iterations; i++)
+		getBytes(1 + rng() % 64);
+
+	size_t ones = 0;
+	for (uint8_t bit : model.whitened)
+		ones += bit;
+	CHECK(model.whitened.size() > 10000);
+	const double ratio = static_cast<double>(ones) / model.whitened.size();
+	CHECK(ratio > 0.49 && ratio < 0.51);
+}
+
+// Correlated bits, random top ups and requests of every size across block boundaries, through every entry
+// point. No 32 byte block may repeat.
+static void testStream(uint32_t iterations)
+{
+	uint8_t previous = 0;
+	roscSource = [&previous]()
+	{
+		if (rng() % 10 >= 7)
+			previous = rng() % 4 == 0;
+		return previous;
+	};
+
+	// Start on a block boundary
+	getBytes(model.ready.size());
+	std::vector<uint8_t> stream;
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		for (uint32_t passes = rng() % 3; passes > 0; passes--)
+			process();
+
+		std::vector<uint8_t> output;
+		switch (rng() % 4)
+		{
+			case 0:
+				output = getBytes(rng() % 100);
+				break;
+			case 1:
+			{
+				const uint32_t value = Entropy::getInstance().getRandom32();
+				uint8_t bytes[sizeof(value)];
+				memcpy(bytes, &value, sizeof(bytes));
+				output.assign(bytes, bytes + sizeof(bytes));
+				CHECK(output == model.getBytes(sizeof(bytes)));
+				checkAllBitsTaken();
+				break;
+			}
+			case 2:
+			{
+				std::vector<uint8_t> bytes(1 + rng() % 300);
+				CHECK_EQ(Entropy::mbedtlsRandom(nullptr, bytes.data(), bytes.size()), 0);
+				output = bytes;
+				CHECK(output == model.getBytes(bytes.size()));
+				checkAllBitsTaken();
+				break;
+			}
+			default:
+				output = getBytes(0);
+				CHECK(output.empty());
+				break;
+		}
+		stream.insert(stream.end(), output.begin(), output.end());
+	}
+
+	// Finish the last block so the stream is made of whole blocks
+	const std::vector<uint8_t> rest = getBytes(model.ready.size());
+	stream.insert(stream.end(), rest.begin(), rest.end());
+	CHECK_EQ(stream.size() % 32, 0);
+
+	std::set<std::vector<uint8_t>> blocks;
+	for (size_t offset = 0; offset + 32 <= stream.size(); offset += 32)
+		blocks.insert(std::vector<uint8_t>(stream.begin() + offset, stream.begin() + offset + 32));
+	CHECK_EQ(blocks.size(), stream.size() / 32);
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 2000;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	rng.seed(seed);
+
+	testSha256();
+	testWhitening();
+	testBias(iterations);
+	testStream(iterations);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("entropy: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
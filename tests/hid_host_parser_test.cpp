@@ -0,0 +1,344 @@
+// Feeds report descriptors and input reports of USB host gamepads through HIDHostParser and checks the
+// decoded GamepadState: a DragonRise style DInput pad, a gamepad with 16-bit axes behind a 256 bit vendor
+// block, a mouse and gamepad composite with a 256 bit wide padding item, and the fixed DualShock 4,
+// DualSense and Switch Pro layouts. Random descriptors and reports are parsed and decoded afterwards, they
+// only have to stay inside their buffers and finish.
+//
+// Usage: hid_host_parser_test [iterations] [seed]
+
+#include "gamepad/HIDHostParser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+// What readAxis() makes of a value in low..high
+static uint16_t scale(int64_t value, int64_t low, int64_t high)
+{
+	return ((value - low) * GAMEPAD_JOYSTICK_MAX) / (high - low);
+}
+
+static bool decode(const HIDHostLayout& layout, const std::vector<uint8_t>& report, GamepadState& state)
+{
+	return HIDHostParser::decodeReport(layout, report.data(), report.size(), state);
+}
+
+// DragonRise USB pad: X, Y, Z, Z, Rz bytes, a 4-bit hat, 12 buttons and a vendor byte, no report IDs
+static const std::vector<uint8_t> dragonRiseDescriptor =
+{
+	0x05, 0x01, 0x09, 0x04, 0xA1, 0x01,             // Joystick application
+	0xA1, 0x02,                                     //   Logical collection
+	0x75, 0x08, 0x95, 0x05, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00,
+	0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x32, 0x09, 0x35, 0x81, 0x02,
+	0x75, 0x04, 0x95, 0x01, 0x25, 0x07, 0x46, 0x3B, 0x01, 0x65, 0x14, 0x09, 0x39, 0x81, 0x42,
+	0x65, 0x00, 0x75, 0x01, 0x95, 0x0C, 0x25, 0x01, 0x45, 0x01, 0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x81, 0x02,
+	0x06, 0x00, 0xFF, 0x75, 0x01, 0x95, 0x08, 0x25, 0x01, 0x45, 0x01, 0x09, 0x01, 0x81, 0x02,
+	0xC0,
+	0xA1, 0x02,                                     //   Output collection
+	0x75, 0x08, 0x95, 0x07, 0x46, 0xFF, 0x00, 0x26, 0xFF, 0x00, 0x09, 0x02, 0x91, 0x02,
+	0xC0,
+	0xC0,
+};
+
+static void testDragonRise()
+{
+	const HIDHostLayout layout = HIDHostParser::makeLayout(0x0079, 0x0006, dragonRiseDescriptor.data(), dragonRiseDescriptor.size());
+	CHECK(layout.type == HIDHostDeviceType::GENERIC);
+	CHECK_EQ(layout.reportId, 0);
+	CHECK_EQ(layout.hat.bitOffset, 40);
+	CHECK_EQ(layout.buttons[2].bitOffset, 44); // DInput button 1 is B3
+
+	// Idle, hat in its null state
+	GamepadState state;
+	CHECK(decode(layout, { 0x80, 0x80, 0x80, 0x80, 0x80, 0x0F, 0x00, 0x00 }, state));
+	CHECK_EQ(state.buttons, 0);
+	CHECK_EQ(state.dpad, 0);
+	CHECK_EQ(state.lx, scale(0x80, 0, 255));
+	CHECK_EQ(state.ry, scale(0x80, 0, 255));
+
+	// Left stick up and left, right stick from the second Z byte, hat down-left, buttons 1, 2 and 12
+	CHECK(decode(layout, { 0x00, 0x00, 0x12, 0xFF, 0x40, 0x35, 0x80, 0xAA }, state));
+	CHECK_EQ(state.lx, 0);
+	CHECK_EQ(state.ly, 0);
+	CHECK_EQ(state.rx, GAMEPAD_JOYSTICK_MAX);
+	CHECK_EQ(state.ry, scale(0x40, 0, 255));
+	CHECK_EQ(state.dpad, GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT);
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B3 | GAMEPAD_MASK_B1 | GAMEPAD_MASK_R3);
+
+	// A short report leaves out what it doesn't cover
+	CHECK(decode(layout, { 0x00, 0x00 }, state));
+	CHECK_EQ(state.buttons, 0);
+	CHECK_EQ(state.lx, 0);
+	CHECK_EQ(state.rx, 0);
+}
+
+// Report ID 2: 256 vendor bits, 16 buttons, signed 16-bit X, Y, Z, Rz and the D-pad usages
+static const std::vector<uint8_t> vendorBlockDescriptor =
+{
+	0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,             // Gamepad application
+	0x85, 0x02,
+	0x06, 0x00, 0xFF, 0x09, 0x20, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x01, 0x96, 0x00, 0x01, 0x81, 0x02,
+	0x05, 0x09, 0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x10, 0x81, 0x02,
+	0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x16, 0x00, 0x80, 0x26, 0xFF, 0x7F,
+	0x75, 0x10, 0x95, 0x04, 0x81, 0x02,
+	0x09, 0x90, 0x09, 0x91, 0x09, 0x92, 0x09, 0x93, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x04, 0x81, 0x02,
+	0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+	0xC0,
+};
+
+static void testVendorBlock()
+{
+	const HIDHostLayout layout = HIDHostParser::parseDescriptor(vendorBlockDescriptor.data(), vendorBlockDescriptor.size());
+	CHECK(layout.type == HIDHostDeviceType::GENERIC);
+	CHECK_EQ(layout.reportId, 2);
+	CHECK_EQ(layout.buttons[2].bitOffset, 256);
+	CHECK_EQ(layout.axes[0].bitOffset, 272);
+	CHECK_EQ(layout.axes[0].bitSize, 16);
+	CHECK_EQ(layout.dpad[0].bitOffset, 336);
+
+	std::vector<uint8_t> report(44);
+	report[0] = 0x02;
+	for (size_t i = 1; i <= 32; i++)
+		report[i] = 0xFF;           // vendor bits, none of them is a button
+	report[33] = 0x12;              // buttons 2 and 5
+	report[34] = 0xC0;              // buttons 15 and 16, beyond what a layout holds
+	report[35] = 0x00; report[36] = 0x80; // X -32768
+	report[37] = 0xFF; report[38] = 0x7F; // Y 32767
+	report[39] = 0x00; report[40] = 0x00; // Z 0
+	report[41] = 0x00; report[42] = 0xC0; // Rz -16384
+	report[43] = 0x05;              // up and right
+
+	GamepadState state;
+	CHECK(decode(layout, report, state));
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_L1);
+	CHECK_EQ(state.dpad, GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT);
+	CHECK_EQ(state.lx, 0);
+	CHECK_EQ(state.ly, GAMEPAD_JOYSTICK_MAX);
+	CHECK_EQ(state.rx, scale(0, -32768, 32767));
+	CHECK_EQ(state.ry, scale(-16384, -32768, 32767));
+
+	// Reports with another ID, or only an ID, aren't gamepad reports
+	report[0] = 0x01;
+	CHECK(!decode(layout, report, state));
+	CHECK(!decode(layout, { }, state));
+	CHECK(decode(layout, { 0x02 }, state));
+	CHECK_EQ(state.buttons, 0);
+}
+
+// Report ID 1 is a mouse, report ID 3 a gamepad starting with one 256 bit wide padding field, a hat
+// numbered 1-8, four buttons and Rx, Ry triggers
+static const std::vector<uint8_t> compositeDescriptor =
+{
+	0x05, 0x01, 0x09, 0x02, 0xA1, 0x01,             // Mouse application
+	0x85, 0x01, 0x09, 0x01, 0xA1, 0x00,
+	0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+	0x75, 0x05, 0x95, 0x01, 0x81, 0x03,
+	0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02, 0x81, 0x06,
+	0xC0, 0xC0,
+	0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,             // Gamepad application
+	0x85, 0x03,
+	0x76, 0x00, 0x01, 0x95, 0x01, 0x81, 0x03,
+	0x09, 0x39, 0x15, 0x01, 0x25, 0x08, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+	0x05, 0x09, 0x19, 0x01, 0x29, 0x04, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x04, 0x81, 0x02,
+	0x05, 0x01, 0x09, 0x33, 0x09, 0x34, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+	0xC0,
+};
+
+static void testComposite()
+{
+	const HIDHostLayout layout = HIDHostParser::parseDescriptor(compositeDescriptor.data(), compositeDescriptor.size());
+	CHECK(layout.type == HIDHostDeviceType::GENERIC);
+	CHECK_EQ(layout.reportId, 3);
+	CHECK_EQ(layout.hat.bitOffset, 256);
+	CHECK_EQ(layout.axes[4].bitOffset, 264);
+
+	std::vector<uint8_t> report(36);
+	report[0] = 0x03;
+	report[33] = 0x81;              // hat up, button 4
+	report[34] = 0xFF;              // Rx
+	report[35] = 0x80;              // Ry
+
+	GamepadState state;
+	CHECK(decode(layout, report, state));
+	CHECK_EQ(state.dpad, GAMEPAD_MASK_UP);
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B4);
+	CHECK_EQ(state.lt, 0xFF);
+	CHECK_EQ(state.rt, scale(0x80, 0, 255) >> 8);
+	CHECK_EQ(state.lx, GAMEPAD_JOYSTICK_MID); // no X, Y, Z or Rz
+	CHECK_EQ(state.rx, GAMEPAD_JOYSTICK_MID);
+
+	// 0 is below the hat's logical range, its null state
+	report[33] = 0x00;
+	CHECK(decode(layout, report, state));
+	CHECK_EQ(state.dpad, 0);
+
+	// A mouse report is ignored
+	CHECK(!decode(layout, { 0x01, 0x01, 0x10, 0xF0 }, state));
+}
+
+// Sony controllers over USB, report ID 1
+static void testSony()
+{
+	const HIDHostLayout ds4 = HIDHostParser::makeLayout(0x054C, 0x09CC, nullptr, 0);
+	CHECK(ds4.type == HIDHostDeviceType::DUALSHOCK4);
+
+	// lx, ly, rx, ry, hat 8 (centered) + cross, L1 + L2, PS + counter, L2 and R2 analog
+	std::vector<uint8_t> report(64);
+	const uint8_t ds4Bytes[] = { 0x01, 0x80, 0x7F, 0xFF, 0x00, 0x28, 0x05, 0x11, 0xFF, 0x00 };
+	std::copy(ds4Bytes, ds4Bytes + sizeof(ds4Bytes), report.begin());
+
+	GamepadState state;
+	CHECK(decode(ds4, report, state));
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B1 | GAMEPAD_MASK_L1 | GAMEPAD_MASK_L2 | GAMEPAD_MASK_A1);
+	CHECK_EQ(state.dpad, 0);
+	CHECK_EQ(state.lx, scale(0x80, 0, 255));
+	CHECK_EQ(state.ly, scale(0x7F, 0, 255));
+	CHECK_EQ(state.rx, GAMEPAD_JOYSTICK_MAX);
+	CHECK_EQ(state.ry, 0);
+	CHECK_EQ(state.lt, 0xFF);
+	CHECK_EQ(state.rt, 0);
+
+	// Square, triangle, share and hat right on the other DualShock 4 revision
+	report[5] = 0x92;
+	report[6] = 0x10;
+	report[7] = 0x00;
+	CHECK(decode(HIDHostParser::makeLayout(0x054C, 0x05C4, nullptr, 0), report, state));
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B3 | GAMEPAD_MASK_B4 | GAMEPAD_MASK_S1);
+	CHECK_EQ(state.dpad, GAMEPAD_MASK_RIGHT);
+
+	// DualSense: lx, ly, rx, ry, L2, R2, counter, hat right + triangle, R1, touchpad
+	const HIDHostLayout dualSense = HIDHostParser::makeLayout(0x054C, 0x0CE6, nullptr, 0);
+	CHECK(dualSense.type == HIDHostDeviceType::DUALSENSE);
+	const uint8_t dualSenseBytes[] = { 0x01, 0x80, 0x80, 0x80, 0x80, 0x40, 0x00, 0x2A, 0x82, 0x02, 0x02 };
+	std::fill(report.begin(), report.end(), 0);
+	std::copy(dualSenseBytes, dualSenseBytes + sizeof(dualSenseBytes), report.begin());
+	CHECK(decode(dualSense, report, state));
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B4 | GAMEPAD_MASK_R1 | GAMEPAD_MASK_A2);
+	CHECK_EQ(state.dpad, GAMEPAD_MASK_RIGHT);
+	CHECK_EQ(state.lt, scale(0x40, 0, 255) >> 8);
+	CHECK_EQ(state.rt, 0);
+}
+
+// Switch Pro full report 0x30 with A, home, ZL and up, the left stick right and down, the right one centered
+static void testSwitchPro()
+{
+	const HIDHostLayout layout = HIDHostParser::makeLayout(0x057E, 0x2009, nullptr, 0);
+	CHECK(layout.type == HIDHostDeviceType::SWITCH_PRO);
+
+	std::vector<uint8_t> report(64);
+	const uint8_t bytes[] = { 0x30, 0x5C, 0x91, 0x08, 0x10, 0x82, 0xFF, 0x0F, 0x00, 0x00, 0x08, 0x80 };
+	std::copy(bytes, bytes + sizeof(bytes), report.begin());
+
+	GamepadState state;
+	CHECK(decode(layout, report, state));
+	CHECK_EQ(state.buttons, GAMEPAD_MASK_B2 | GAMEPAD_MASK_A1 | GAMEPAD_MASK_L2);
+	CHECK_EQ(state.dpad, GAMEPAD_MASK_UP);
+	CHECK_EQ(state.lx, GAMEPAD_JOYSTICK_MAX);
+	CHECK_EQ(state.ly, GAMEPAD_JOYSTICK_MAX);
+	CHECK_EQ(state.rx, scale(0x800, 0, 4095));
+	CHECK_EQ(state.ry, GAMEPAD_JOYSTICK_MAX - scale(0x800, 0, 4095));
+
+	// The simple report sent before the handshake isn't decoded
+	report[0] = 0x3F;
+	CHECK(!decode(layout, report, state));
+}
+
+// Counts and sizes up to 32 bits can't run the parser past the bit offsets a layout holds
+static void testHugeItems()
+{
+	const std::vector<uint8_t> descriptor =
+	{
+		0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+		0x05, 0x09, 0x19, 0x01, 0x29, 0x0E, 0x75, 0x01, 0x97, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x02,
+		0x05, 0x01, 0x09, 0x30, 0x77, 0xFF, 0xFF, 0xFF, 0xFF, 0x95, 0x01, 0x81, 0x02,
+		0x09, 0x31, 0x75, 0x08, 0x97, 0x00, 0x00, 0x01, 0x00, 0x81, 0x02,
+		0xC0,
+	};
+	const HIDHostLayout layout = HIDHostParser::parseDescriptor(descriptor.data(), descriptor.size());
+	CHECK(layout.type == HIDHostDeviceType::GENERIC);
+	CHECK_EQ(layout.buttons[2].bitOffset, 0);
+	CHECK_EQ(layout.axes[0].bitSize, 0);
+	CHECK_EQ(layout.axes[1].bitSize, 0);
+}
+
+static void testRandom(std::mt19937& rng, uint32_t iterations)
+{
+	// Items the parser acts on, with a random data size
+	static const uint8_t prefixes[] = { 0x04, 0x14, 0x24, 0x74, 0x84, 0x94, 0x08, 0x18, 0x28, 0x80, 0xA0, 0xC0 };
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		std::vector<uint8_t> descriptor = { 0x05, 0x01, 0x09, 0x05, 0xA1, 0x01 };
+		const uint32_t items = rng() % 64;
+		for (uint32_t item = 0; item < items; item++)
+		{
+			const uint8_t size = rng() % 4;
+			descriptor.push_back((rng() & 7) == 0 ? rng() : prefixes[rng() % sizeof(prefixes)] | size);
+			for (uint8_t b = 0; b < (size == 3 ? 4 : size); b++)
+				descriptor.push_back((rng() & 3) == 0 ? 0xFF : rng() % 24);
+		}
+		// Sometimes cut off in the middle of an item
+		descriptor.resize(descriptor.size() - rng() % 3);
+
+		// Exactly as long as the data so a sanitizer sees any read past it
+		std::vector<uint8_t> copy(descriptor);
+		const HIDHostLayout layout = HIDHostParser::parseDescriptor(copy.data(), copy.size());
+
+		std::vector<uint8_t> report(rng() % 65);
+		for (uint8_t& byte : report)
+			byte = rng();
+		if (!report.empty() && (rng() & 1))
+			report[0] = layout.reportId;
+
+		GamepadState state;
+		const bool decoded = decode(layout, report, state);
+		CHECK(decoded == (layout.type != HIDHostDeviceType::NONE &&
+			(layout.reportId == 0 || (!report.empty() && report[0] == layout.reportId))));
+		CHECK_EQ(state.dpad & ~GAMEPAD_MASK_DPAD, 0);
+		CHECK_EQ(state.buttons >> HID_HOST_MAX_BUTTONS, 0);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	std::mt19937 rng(seed);
+
+	testDragonRise();
+	testVendorBlock();
+	testComposite();
+	testSony();
+	testSwitchPro();
+	testHugeItems();
+	testRandom(rng, iterations);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("hid host parser: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
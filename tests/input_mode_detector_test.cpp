@@ -0,0 +1,249 @@
+// Replays how different hosts enumerate each input mode through the input mode detector, one millisecond
+// at a time, the way GP2040 calls it. Each host lists what it does after the device attaches in a mode,
+// modes it has no entry for are never mounted. The replay checks the order of the attempts, the mode the
+// detector settles on and how long that takes. Every host is replayed from boot and again with the
+// millisecond counter about to wrap.
+//
+// Usage: input_mode_detector_test
+
+#include "inputmodedetector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// The firmware reattaches 100 ms after switching, hosts mount a little after that
+#define REATTACH_MS 100
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+// An event the host sends, in milliseconds after the device attached in that mode
+struct HostStep
+{
+	uint32_t afterMs;
+	UsbHostEvent event;
+};
+
+struct HostReaction
+{
+	InputMode mode;
+	std::vector<HostStep> steps;
+};
+
+struct HostCapture
+{
+	const char* name;
+	InputMode lastGoodMode;
+	std::vector<HostReaction> reactions;
+	std::vector<InputMode> expectedAttempts;
+	InputMode expectedMode;
+	bool expectLocked;
+	uint32_t maxMs;             // the detector has to be done by then
+};
+
+static const std::vector<HostStep>* findSteps(const HostCapture& capture, InputMode mode)
+{
+	for (const HostReaction& reaction : capture.reactions)
+	{
+		if (reaction.mode == mode)
+			return &reaction.steps;
+	}
+	return nullptr;
+}
+
+static void replay(const HostCapture& capture, uint32_t bootMs)
+{
+	InputModeDetector detector;
+	uint32_t nowMs = bootMs;
+	InputMode mode = detector.start(capture.lastGoodMode, nowMs);
+	CHECK(detector.isActive());
+
+	std::vector<InputMode> attempts = { mode };
+	uint32_t attemptStartMs = nowMs;
+	size_t nextStep = 0;
+
+	uint32_t elapsedMs = 0;
+	for (; elapsedMs < 20000 && detector.isActive(); elapsedMs++)
+	{
+		nowMs = bootMs + elapsedMs;
+
+		// The host reacts to the mode the device currently presents
+		const std::vector<HostStep>* steps = findSteps(capture, mode);
+		while (steps != nullptr && nextStep < steps->size() &&
+			nowMs - attemptStartMs >= REATTACH_MS + (*steps)[nextStep].afterMs)
+		{
+			detector.onHostEvent((*steps)[nextStep].event, nowMs);
+			nextStep++;
+		}
+
+		const InputMode updated = detector.update(nowMs);
+		if (updated != mode && detector.isActive())
+		{
+			mode = updated;
+			attempts.push_back(mode);
+			attemptStartMs = nowMs;
+			nextStep = 0;
+		}
+		else
+		{
+			mode = updated;
+		}
+	}
+
+	const bool attemptsMatch = attempts == capture.expectedAttempts;
+	if (!attemptsMatch && failures < 20)
+	{
+		printf("%s (boot at %u ms): attempted", capture.name, bootMs);
+		for (InputMode attempt : attempts)
+			printf(" %d", attempt);
+		printf("\n");
+	}
+	CHECK(attemptsMatch);
+	CHECK(!detector.isActive());
+	CHECK_EQ(detector.isLocked(), capture.expectLocked);
+	CHECK_EQ(mode, capture.expectedMode);
+	CHECK_EQ(detector.getDetectedMode(), capture.expectedMode);
+	CHECK(elapsedMs <= capture.maxMs);
+
+	// Once decided, nothing the host does changes the mode
+	detector.onHostEvent(USB_HOST_EVENT_PS4_AUTH_REQUEST, nowMs + 1);
+	detector.onHostEvent(USB_HOST_EVENT_XINPUT_OUT_REPORT, nowMs + 2);
+	CHECK_EQ(detector.update(nowMs + 5000), capture.expectedMode);
+	CHECK(!detector.isActive());
+}
+
+static const std::vector<HostCapture> captures =
+{
+	{
+		"Windows, XInput remembered", INPUT_MODE_XINPUT,
+		{
+			{ INPUT_MODE_XINPUT, { { 40, USB_HOST_EVENT_MOUNTED }, { 45, USB_HOST_EVENT_MS_OS_DESCRIPTOR }, { 180, USB_HOST_EVENT_XINPUT_OUT_REPORT } } },
+		},
+		{ INPUT_MODE_XINPUT }, INPUT_MODE_XINPUT, true, 400,
+	},
+	{
+		// Windows asks any new device for the MS OS descriptor, which points at XInput
+		"Windows, Switch remembered", INPUT_MODE_SWITCH,
+		{
+			{ INPUT_MODE_SWITCH, { { 30, USB_HOST_EVENT_MS_OS_DESCRIPTOR }, { 40, USB_HOST_EVENT_MOUNTED } } },
+			{ INPUT_MODE_XINPUT, { { 40, USB_HOST_EVENT_MOUNTED }, { 45, USB_HOST_EVENT_MS_OS_DESCRIPTOR }, { 180, USB_HOST_EVENT_XINPUT_OUT_REPORT } } },
+		},
+		{ INPUT_MODE_SWITCH, INPUT_MODE_XINPUT }, INPUT_MODE_XINPUT, true, 600,
+	},
+	{
+		// Linux xpad drives XInput and sets the player LEDs, but never asks for the MS OS descriptor
+		"Linux, nothing remembered", INPUT_MODE_XINPUT,
+		{
+			{ INPUT_MODE_XINPUT, { { 20, USB_HOST_EVENT_MOUNTED }, { 60, USB_HOST_EVENT_XINPUT_OUT_REPORT } } },
+			{ INPUT_MODE_HID, { { 20, USB_HOST_EVENT_MOUNTED } } },
+		},
+		{ INPUT_MODE_XINPUT }, INPUT_MODE_XINPUT, true, 300,
+	},
+	{
+		// Doesn't configure an XInput device, authenticates a PS4 controller
+		"PS4, XInput remembered", INPUT_MODE_XINPUT,
+		{
+			{ INPUT_MODE_PS4, { { 150, USB_HOST_EVENT_MOUNTED }, { 420, USB_HOST_EVENT_PS4_AUTH_REQUEST } } },
+		},
+		{ INPUT_MODE_XINPUT, INPUT_MODE_PS4 }, INPUT_MODE_PS4, true, 2200,
+	},
+	{
+		"PS4, PS4 remembered", INPUT_MODE_PS4,
+		{
+			{ INPUT_MODE_PS4, { { 150, USB_HOST_EVENT_MOUNTED }, { 420, USB_HOST_EVENT_PS4_AUTH_REQUEST } } },
+		},
+		{ INPUT_MODE_PS4 }, INPUT_MODE_PS4, true, 600,
+	},
+	{
+		// Mounts the PS4 controller and asks for the PS button bytes, which redirects to HID
+		"PS3, XInput remembered", INPUT_MODE_XINPUT,
+		{
+			{ INPUT_MODE_PS4, { { 80, USB_HOST_EVENT_MOUNTED }, { 120, USB_HOST_EVENT_PS3_FEATURE_REQUEST } } },
+			{ INPUT_MODE_HID, { { 80, USB_HOST_EVENT_MOUNTED }, { 120, USB_HOST_EVENT_PS3_FEATURE_REQUEST } } },
+		},
+		{ INPUT_MODE_XINPUT, INPUT_MODE_PS4, INPUT_MODE_HID }, INPUT_MODE_HID, true, 2400,
+	},
+	{
+		// Mounts the PS4 controller without authenticating it, then takes the Switch controller
+		"Switch, XInput remembered", INPUT_MODE_XINPUT,
+		{
+			{ INPUT_MODE_PS4, { { 60, USB_HOST_EVENT_MOUNTED } } },
+			{ INPUT_MODE_SWITCH, { { 60, USB_HOST_EVENT_MOUNTED } } },
+		},
+		{ INPUT_MODE_XINPUT, INPUT_MODE_PS4, INPUT_MODE_SWITCH }, INPUT_MODE_SWITCH, true, 3500,
+	},
+	{
+		// Mounts everything but never talks to XInput or PS4 devices, the Switch descriptor works as HID
+		"macOS, nothing remembered", INPUT_MODE_XINPUT,
+		{
+			{ INPUT_MODE_XINPUT, { { 30, USB_HOST_EVENT_MOUNTED } } },
+			{ INPUT_MODE_PS4, { { 30, USB_HOST_EVENT_MOUNTED } } },
+			{ INPUT_MODE_SWITCH, { { 30, USB_HOST_EVENT_MOUNTED } } },
+			{ INPUT_MODE_HID, { { 30, USB_HOST_EVENT_MOUNTED } } },
+		},
+		{ INPUT_MODE_XINPUT, INPUT_MODE_PS4, INPUT_MODE_SWITCH }, INPUT_MODE_SWITCH, true, 3200,
+	},
+	{
+		// Hints only redirect once, a host that keeps pointing elsewhere can't make the detector bounce
+		"Conflicting hints", INPUT_MODE_HID,
+		{
+			{ INPUT_MODE_HID, { { 30, USB_HOST_EVENT_MOUNTED }, { 40, USB_HOST_EVENT_PS4_AUTH_REQUEST } } },
+			{ INPUT_MODE_PS4, { { 30, USB_HOST_EVENT_MOUNTED }, { 40, USB_HOST_EVENT_XINPUT_OUT_REPORT } } },
+		},
+		{ INPUT_MODE_HID, INPUT_MODE_PS4 }, INPUT_MODE_PS4, true, 1000,
+	},
+	{
+		// A charger or a powered hub without a host, every candidate times out
+		"No host, PS4 remembered", INPUT_MODE_PS4,
+		{ },
+		{ INPUT_MODE_PS4, INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID }, INPUT_MODE_PS4, false, 6100,
+	},
+	{
+		// Keyboard mode is never probed but is kept when nothing else works
+		"No host, keyboard remembered", INPUT_MODE_KEYBOARD,
+		{ },
+		{ INPUT_MODE_XINPUT, INPUT_MODE_PS4, INPUT_MODE_SWITCH, INPUT_MODE_HID }, INPUT_MODE_KEYBOARD, false, 6100,
+	},
+	{
+		// Mounts but the redirected mode never comes back, the remembered mode is kept
+		"Redirect that never mounts", INPUT_MODE_SWITCH,
+		{
+			{ INPUT_MODE_SWITCH, { { 30, USB_HOST_EVENT_MOUNTED }, { 35, USB_HOST_EVENT_PS4_AUTH_REQUEST } } },
+		},
+		{ INPUT_MODE_SWITCH, INPUT_MODE_PS4 }, INPUT_MODE_SWITCH, false, 1700,
+	},
+};
+
+int main(int argc, char** argv)
+{
+	for (const HostCapture& capture : captures)
+	{
+		replay(capture, 0);
+		replay(capture, 0xffffffff - 700);
+	}
+
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("input mode detector: %zu hosts passed\n", captures.size());
+	return 0;
+}
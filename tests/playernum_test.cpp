@@ -0,0 +1,310 @@
+// Simulates a console handing out player slots to PlayerNumAddon, one millisecond of the core0 loop at a
+// time. The host mounts the controller a while after it attaches, gives it the lowest free slot and only
+// reports that slot a while later, through the XInput LEDs or the PS4 lightbar. Other controllers plug in
+// along the way. reconnect_usb() and get_usb_mounted() are stubbed here and, like the driver, a reconnect
+// forgets the slot the host reported before.
+//
+// A wrong slot has to be answered with a reconnect whose wait is the player number times 500 ms, doubling
+// up to 8x. After PLAYERNUM_MAX_ATTEMPTS reconnects the addon keeps what it gets. It may only act on a slot
+// the host reported since the last mount, never on the one from before the reconnect.
+//
+// Usage: playernum_test [iterations] [seed]
+
+#include "addons/playernum.h"
+#include "storagemanager.h"
+#include "usb_driver.h"
+#include "xinput_driver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Minimum time the driver stays detached
+#define REATTACH_MS 100
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+// The console and the bus as the add-on sees them through the driver
+struct SimHost
+{
+	InputMode mode = INPUT_MODE_XINPUT;
+	uint8_t playerNum = 1;
+	uint32_t mountLatencyMs = 0;    // from attaching to the host mounting the controller
+	uint32_t slotLatencyMs = 0;     // from mounting to the host reporting the slot
+	std::vector<uint32_t> joins;    // when other controllers plug in, in order
+	size_t nextJoin = 0;
+
+	uint8_t taken = 0;              // slots of the other controllers, bit 0 is slot 1
+	uint32_t attachedAtMs = 0;
+	bool mounted = false;
+	uint32_t mountedAtMs = 0;
+	uint8_t slot = 0;               // ours while mounted
+	bool slotReported = false;
+
+	std::vector<uint32_t> reconnectDelays;
+};
+
+static SimHost host;
+static uint32_t nowMs = 0;
+
+static uint8_t lowestFreeSlot(uint8_t taken)
+{
+	for (uint8_t slot = 1; slot <= 4; slot++)
+	{
+		if (!(taken & (1 << (slot - 1))))
+			return slot;
+	}
+	return 0;
+}
+
+static void stepHost()
+{
+	while (host.nextJoin < host.joins.size() && host.joins[host.nextJoin] <= nowMs)
+	{
+		host.taken |= 1 << (lowestFreeSlot(host.taken | (host.mounted ? 1 << (host.slot - 1) : 0)) - 1);
+		host.nextJoin++;
+	}
+
+	if (!host.mounted && nowMs >= host.attachedAtMs + host.mountLatencyMs)
+	{
+		host.mounted = true;
+		host.mountedAtMs = nowMs;
+		host.slot = lowestFreeSlot(host.taken);
+	}
+
+	if (host.mounted && !host.slotReported && nowMs >= host.mountedAtMs + host.slotLatencyMs)
+		host.slotReported = true;
+}
+
+// What receive_report() leaves in the feature data, the XInput LED command from the OUT endpoint
+static void receiveFeatureData()
+{
+	Storage::getInstance().ClearFeatureData();
+	if (host.mode == INPUT_MODE_XINPUT && host.slotReported)
+	{
+		uint8_t* featureData = Storage::getInstance().GetFeatureData();
+		featureData[0] = 0x01;
+		featureData[1] = 0x03;
+		featureData[2] = XINPUT_PLED_ON1 + host.slot - 1;
+	}
+}
+
+bool get_usb_mounted(void)
+{
+	return host.mounted;
+}
+
+// The add-on may only leave a slot the host has just reported, and only a wrong one
+void reconnect_usb(uint32_t delay_ms)
+{
+	CHECK(host.mounted);
+	CHECK(host.slotReported);
+	CHECK(host.slot != host.playerNum);
+
+	host.reconnectDelays.push_back(delay_ms);
+	host.mounted = false;
+	host.slot = 0;
+	host.slotReported = false;
+	host.attachedAtMs = nowMs + (delay_ms > REATTACH_MS ? delay_ms : REATTACH_MS);
+}
+
+bool get_ps4_lightbar(uint8_t *rgb)
+{
+	// Blue, red, green and pink like the console
+	static const uint8_t colors[4][3] = { { 0, 0, 0x40 }, { 0x40, 0, 0 }, { 0, 0x40, 0 }, { 0x20, 0, 0x20 } };
+	if (host.mode != INPUT_MODE_PS4 || !host.slotReported)
+		return false;
+	memcpy(rgb, colors[host.slot - 1], 3);
+	return true;
+}
+
+struct Outcome
+{
+	uint8_t assigned;
+	uint32_t assignedAtMs;
+	std::vector<uint32_t> reconnectDelays;
+};
+
+// Runs the add-on until it has a slot, and for a while after to see that it keeps it
+static Outcome run(const SimHost& setup, uint32_t limitMs)
+{
+	host = setup;
+	nowMs = 0;
+	Storage::getInstance().getGamepadOptions().inputMode = host.mode;
+	PlayerNumberOptions& options = Storage::getInstance().getAddonOptions().playerNumberOptions;
+	options.enabled = true;
+	options.number = host.playerNum;
+
+	PlayerNumAddon addon;
+	CHECK(addon.available());
+	addon.setup();
+	CHECK(AddonServices::getInstance().get<PlayerNumberProvider>() == &addon);
+	CHECK_EQ(addon.getPlayerNumber(), 0);
+
+	Outcome outcome = { 0, 0, { } };
+	size_t reconnectsWhenAssigned = 0;
+	for (; nowMs < limitMs; nowMs++)
+	{
+		stepHost();
+		receiveFeatureData();
+		addon.process();
+
+		const uint8_t number = addon.getPlayerNumber();
+		if (outcome.assigned == 0 && number != 0)
+		{
+			outcome.assigned = number;
+			outcome.assignedAtMs = nowMs;
+			limitMs = nowMs + 30000;
+			reconnectsWhenAssigned = host.reconnectDelays.size();
+
+			// Only a slot reported since the last mount counts, HID mode has no slot to wait for
+			if (host.mode != INPUT_MODE_HID)
+			{
+				CHECK(host.slotReported);
+				CHECK_EQ(number, host.slot);
+			}
+		}
+		CHECK_EQ(number, outcome.assigned);
+	}
+
+	CHECK(outcome.assigned != 0);
+	CHECK_EQ(host.reconnectDelays.size(), reconnectsWhenAssigned);
+
+	AddonServices::getInstance().withdraw<PlayerNumberProvider>(&addon);
+	outcome.reconnectDelays = host.reconnectDelays;
+	return outcome;
+}
+
+static void checkBackoff(const Outcome& outcome, uint8_t playerNum)
+{
+	CHECK(outcome.reconnectDelays.size() <= PLAYERNUM_MAX_ATTEMPTS);
+	for (size_t i = 0; i < outcome.reconnectDelays.size(); i++)
+	{
+		const uint32_t shift = i < PLAYERNUM_MAX_BACKOFF_SHIFT ? i : PLAYERNUM_MAX_BACKOFF_SHIFT;
+		CHECK_EQ(outcome.reconnectDelays[i], (PLAYERNUM_RECONNECT_DELAY_MS * playerNum) << shift);
+	}
+}
+
+static SimHost makeHost(InputMode mode, uint8_t playerNum, uint32_t mountLatencyMs, uint32_t slotLatencyMs, std::vector<uint32_t> joins)
+{
+	SimHost setup;
+	setup.mode = mode;
+	setup.playerNum = playerNum;
+	setup.mountLatencyMs = mountLatencyMs;
+	setup.slotLatencyMs = slotLatencyMs;
+	setup.joins = joins;
+	return setup;
+}
+
+static void testScenarios(InputMode mode)
+{
+	// Alone on the console as player 3: six retries at 1.5, 3, 6, 12, 12 and 12 seconds, then slot 1
+	Outcome outcome = run(makeHost(mode, 3, 50, 200, { }), 120000);
+	CHECK_EQ(outcome.assigned, 1);
+	CHECK_EQ(outcome.reconnectDelays.size(), PLAYERNUM_MAX_ATTEMPTS);
+	checkBackoff(outcome, 3);
+
+	// Players 1 and 2 are already there
+	outcome = run(makeHost(mode, 3, 50, 200, { 0, 0 }), 120000);
+	CHECK_EQ(outcome.assigned, 3);
+	CHECK_EQ(outcome.reconnectDelays.size(), 0);
+	CHECK_EQ(outcome.assignedAtMs, 250);
+
+	// Plugged in before player 1, who takes slot 1 while player 2 is away
+	outcome = run(makeHost(mode, 2, 50, 200, { 400 }), 120000);
+	CHECK_EQ(outcome.assigned, 2);
+	CHECK_EQ(outcome.reconnectDelays.size(), 1);
+	checkBackoff(outcome, 2);
+
+	// Player 4 while players 1-3 trickle in, each retry waits longer
+	outcome = run(makeHost(mode, 4, 50, 200, { 1000, 5000, 20000 }), 120000);
+	CHECK_EQ(outcome.assigned, 4);
+	checkBackoff(outcome, 4);
+	CHECK(outcome.reconnectDelays.size() >= 3);
+
+	// A host that takes seconds to report the slot after mounting again, the old slot is gone by then
+	outcome = run(makeHost(mode, 2, 50, 3000, { 4000 }), 120000);
+	CHECK_EQ(outcome.assigned, 2);
+	CHECK_EQ(outcome.reconnectDelays.size(), 1);
+	CHECK(outcome.assignedAtMs >= 3050 + 1000 + 50 + 3000);
+
+	// Player 1 never reconnects
+	outcome = run(makeHost(mode, 1, 50, 200, { 100, 200 }), 120000);
+	CHECK_EQ(outcome.assigned, 1);
+	CHECK_EQ(outcome.reconnectDelays.size(), 0);
+}
+
+// HID hosts don't assign slots, the configured number is kept without waiting for the host
+static void testHID()
+{
+	const Outcome outcome = run(makeHost(INPUT_MODE_HID, 3, 50, 200, { }), 1000);
+	CHECK_EQ(outcome.assigned, 3);
+	CHECK_EQ(outcome.assignedAtMs, 0);
+	CHECK_EQ(outcome.reconnectDelays.size(), 0);
+}
+
+static void testRandom(std::mt19937& rng, uint32_t iterations)
+{
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		const InputMode mode = rng() & 1 ? INPUT_MODE_XINPUT : INPUT_MODE_PS4;
+		const uint8_t playerNum = 1 + rng() % 4;
+
+		// Up to three other controllers, so there's always a slot left
+		std::vector<uint32_t> joins(rng() % 4);
+		for (uint32_t& join : joins)
+			join = rng() % 40000;
+		std::sort(joins.begin(), joins.end());
+
+		const Outcome outcome = run(makeHost(mode, playerNum, rng() % 500, rng() % 2000, joins), 200000);
+		checkBackoff(outcome, playerNum);
+
+		// Either the wanted slot or out of retries
+		CHECK(outcome.assigned != 0);
+		if (outcome.assigned != playerNum)
+			CHECK_EQ(outcome.reconnectDelays.size(), PLAYERNUM_MAX_ATTEMPTS);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 200;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	std::mt19937 rng(seed);
+
+	// Lives as long as in the firmware
+	static Gamepad gamepad;
+	Storage::getInstance().SetGamepad(&gamepad);
+
+	testScenarios(INPUT_MODE_XINPUT);
+	testScenarios(INPUT_MODE_PS4);
+	testHID();
+	testRandom(rng, iterations);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("player number: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
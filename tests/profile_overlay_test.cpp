@@ -0,0 +1,278 @@
+// Resolves profile overlays the way Storage does: random changes to the base options are reduced to an overlay
+// with ConfigUtils::encodeOverlay and merged back onto the base with ConfigUtils::mergeOverlay. The result has to
+// match the changed options, and overlays that don't fit have to be refused without touching the stored one.
+//
+// Usage: profile_overlay_test [iterations] [seed]
+
+#include "config_utils.h"
+#include "pb_common.h"
+#include "pb_encode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+struct ScalarField
+{
+	void* data;
+	size_t size;
+	pb_type_t type;
+	bool* has;
+};
+
+// Collects the optional scalar fields of a message and its sub-messages, marking the sub-messages present
+static void collectScalars(const pb_msgdesc_t* fields, void* message, std::vector<ScalarField>& scalars)
+{
+	pb_field_iter_t iter;
+	if (!pb_field_iter_begin(&iter, fields, message))
+		return;
+
+	do
+	{
+		if (PB_HTYPE(iter.type) != PB_HTYPE_OPTIONAL)
+			continue;
+
+		if (PB_LTYPE(iter.type) == PB_LTYPE_SUBMESSAGE)
+		{
+			if (iter.pSize)
+				*reinterpret_cast<bool*>(iter.pSize) = true;
+			collectScalars(iter.submsg_desc, iter.pData, scalars);
+		}
+		else if (PB_LTYPE(iter.type) <= PB_LTYPE_FIXED64)
+		{
+			scalars.push_back({ iter.pData, iter.data_size, iter.type, reinterpret_cast<bool*>(iter.pSize) });
+		}
+	} while (pb_field_iter_next(&iter));
+}
+
+// Always changes the value, the has_XXX flag is set like the firmware does when it changes an option
+static void mutate(const ScalarField& field, std::mt19937& rng)
+{
+	if (PB_LTYPE(field.type) == PB_LTYPE_BOOL)
+	{
+		*reinterpret_cast<bool*>(field.data) = !*reinterpret_cast<bool*>(field.data);
+	}
+	else
+	{
+		uint64_t value = 0;
+		memcpy(&value, field.data, field.size);
+		value += (uint64_t)(1 + rng() % 255) << (8 * (rng() % field.size));
+		memcpy(field.data, &value, field.size);
+	}
+
+	if (field.has)
+		*field.has = true;
+}
+
+// Encodes every field, so two messages compare equal exactly when their values do
+template <typename T>
+static std::vector<uint8_t> encodeAll(const pb_msgdesc_t* fields, const T& message)
+{
+	std::unique_ptr<T> copy(new T(message));
+	std::vector<ScalarField> scalars;
+	collectScalars(fields, copy.get(), scalars);
+	for (const ScalarField& field : scalars)
+	{
+		if (field.has)
+			*field.has = true;
+	}
+
+	size_t size = 0;
+	CHECK(pb_get_encoded_size(&size, fields, copy.get()));
+	std::vector<uint8_t> data(size);
+	pb_ostream_t stream = pb_ostream_from_buffer(data.data(), data.size());
+	CHECK(pb_encode(&stream, fields, copy.get()));
+	return data;
+}
+
+template <typename T>
+static std::unique_ptr<T> randomBase(const pb_msgdesc_t* fields, std::mt19937& rng)
+{
+	std::unique_ptr<T> base(new T());
+	std::vector<ScalarField> scalars;
+	collectScalars(fields, base.get(), scalars);
+	for (const ScalarField& field : scalars)
+	{
+		if (field.has)
+			*field.has = true;
+		if (rng() & 1)
+			mutate(field, rng);
+	}
+	return base;
+}
+
+// Overlay is the ProfileSettings field the options are stored in, so its capacity is the firmware's
+template <typename T, typename Overlay>
+static void testRoundTrip(const char* name, const pb_msgdesc_t* fields, std::mt19937& rng, uint32_t iterations, size_t maxChanges)
+{
+	uint32_t stored = 0;
+	uint32_t refused = 0;
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		std::unique_ptr<T> base = randomBase<T>(fields, rng);
+		std::unique_ptr<T> options(new T(*base));
+
+		std::vector<ScalarField> scalars;
+		collectScalars(fields, options.get(), scalars);
+		const size_t changes = 1 + rng() % maxChanges;
+		for (size_t j = 0; j < changes; j++)
+			mutate(scalars[rng() % scalars.size()], rng);
+		// Changes can cancel each other out
+		const std::vector<uint8_t> expected = encodeAll(fields, *options);
+		const bool changed = expected != encodeAll(fields, *base);
+
+		Overlay overlay;
+		memset(overlay.bytes, 0xa5, sizeof(overlay.bytes));
+		overlay.size = 7;
+
+		if (!ConfigUtils::encodeOverlay(fields, options.get(), base.get(), overlay.bytes, overlay.size, sizeof(overlay.bytes)))
+		{
+			// Only the changes are left in options, they really don't fit
+			size_t size = 0;
+			CHECK(pb_get_encoded_size(&size, fields, options.get()));
+			CHECK(size > sizeof(overlay.bytes));
+			CHECK_EQ(overlay.size, 7);
+			for (size_t j = 0; j < sizeof(overlay.bytes); j++)
+				CHECK_EQ(overlay.bytes[j], 0xa5);
+			refused++;
+			continue;
+		}
+
+		CHECK_EQ(overlay.size > 0, changed);
+		std::unique_ptr<T> merged(new T(*base));
+		CHECK(ConfigUtils::mergeOverlay(fields, merged.get(), overlay.bytes, overlay.size));
+		CHECK(encodeAll(fields, *merged) == expected);
+		stored++;
+	}
+
+	printf("%-10s %u overlays stored, %u refused\n", name, stored, refused);
+	CHECK(stored > 0);
+}
+
+template <typename T, typename Overlay>
+static void testUnchanged(const pb_msgdesc_t* fields, std::mt19937& rng)
+{
+	std::unique_ptr<T> base = randomBase<T>(fields, rng);
+	std::unique_ptr<T> options(new T(*base));
+
+	Overlay overlay;
+	overlay.size = 7;
+	CHECK(ConfigUtils::encodeOverlay(fields, options.get(), base.get(), overlay.bytes, overlay.size, sizeof(overlay.bytes)));
+	CHECK_EQ(overlay.size, 0);
+
+	std::unique_ptr<T> merged(new T(*base));
+	CHECK(ConfigUtils::mergeOverlay(fields, merged.get(), overlay.bytes, overlay.size));
+	CHECK(encodeAll(fields, *merged) == encodeAll(fields, *base));
+}
+
+// An overlay only carries the changed field of a sub-message, the others keep the base values
+static void testSubMessageMerge()
+{
+	std::unique_ptr<AddonOptions> base(new AddonOptions());
+	base->has_turboOptions = true;
+	base->turboOptions.has_enabled = true;
+	base->turboOptions.enabled = true;
+	base->turboOptions.has_buttonPin = true;
+	base->turboOptions.buttonPin = 5;
+	base->turboOptions.has_shotCount = true;
+	base->turboOptions.shotCount = 10;
+
+	std::unique_ptr<AddonOptions> options(new AddonOptions(*base));
+	options->turboOptions.shotCount = 20;
+
+	ProfileSettings_addonOptions_t overlay;
+	CHECK(ConfigUtils::encodeOverlay(AddonOptions_fields, options.get(), base.get(), overlay.bytes, overlay.size, sizeof(overlay.bytes)));
+	CHECK(overlay.size > 0 && overlay.size <= 6);
+
+	std::unique_ptr<AddonOptions> merged(new AddonOptions());
+	merged->turboOptions.enabled = true;
+	merged->turboOptions.buttonPin = 7;
+	merged->turboOptions.shotCount = 10;
+	CHECK(ConfigUtils::mergeOverlay(AddonOptions_fields, merged.get(), overlay.bytes, overlay.size));
+	CHECK(merged->turboOptions.enabled);
+	CHECK_EQ(merged->turboOptions.buttonPin, 7);
+	CHECK_EQ(merged->turboOptions.shotCount, 20);
+}
+
+static void testHotkeyOverlay()
+{
+	std::unique_ptr<HotkeyOptions> base(new HotkeyOptions());
+	base->has_hotkey05 = true;
+	base->hotkey05.has_action = true;
+	base->hotkey05.action = HOTKEY_SOCD_UP_PRIORITY;
+	base->hotkey05.has_dpadMask = true;
+	base->hotkey05.dpadMask = 1;
+
+	std::unique_ptr<HotkeyOptions> options(new HotkeyOptions(*base));
+	options->hotkey05.action = HOTKEY_SOCD_NEUTRAL;
+	options->hotkey12.has_action = true;
+	options->hotkey12.action = HOTKEY_INVERT_Y_AXIS;
+
+	ProfileSettings_hotkeyOptions_t overlay;
+	CHECK(ConfigUtils::encodeOverlay(HotkeyOptions_fields, options.get(), base.get(), overlay.bytes, overlay.size, sizeof(overlay.bytes)));
+
+	std::unique_ptr<HotkeyOptions> merged(new HotkeyOptions(*base));
+	CHECK(ConfigUtils::mergeOverlay(HotkeyOptions_fields, merged.get(), overlay.bytes, overlay.size));
+	CHECK_EQ(merged->hotkey05.action, HOTKEY_SOCD_NEUTRAL);
+	CHECK_EQ(merged->hotkey05.dpadMask, 1);
+	CHECK_EQ(merged->hotkey12.action, HOTKEY_INVERT_Y_AXIS);
+}
+
+static void testMalformedOverlay()
+{
+	std::unique_ptr<GamepadOptions> merged(new GamepadOptions());
+	const uint8_t truncated[] = { 0x08 };
+	CHECK(!ConfigUtils::mergeOverlay(GamepadOptions_fields, merged.get(), truncated, sizeof(truncated)));
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 2000;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	std::mt19937 rng(seed);
+
+	testUnchanged<GamepadOptions, ProfileSettings_gamepadOptions_t>(GamepadOptions_fields, rng);
+	testUnchanged<AddonOptions, ProfileSettings_addonOptions_t>(AddonOptions_fields, rng);
+	testUnchanged<AnimationOptions_Proto, ProfileSettings_animationOptions_t>(AnimationOptions_Proto_fields, rng);
+	testUnchanged<HotkeyOptions, ProfileSettings_hotkeyOptions_t>(HotkeyOptions_fields, rng);
+
+	testRoundTrip<GamepadOptions, ProfileSettings_gamepadOptions_t>("gamepad", GamepadOptions_fields, rng, iterations, 16);
+	testRoundTrip<AddonOptions, ProfileSettings_addonOptions_t>("addon", AddonOptions_fields, rng, iterations, 200);
+	testRoundTrip<AnimationOptions_Proto, ProfileSettings_animationOptions_t>("animation", AnimationOptions_Proto_fields, rng, iterations, 48);
+	testRoundTrip<HotkeyOptions, ProfileSettings_hotkeyOptions_t>("hotkey", HotkeyOptions_fields, rng, iterations, 48);
+
+	testSubMessageMerge();
+	testHotkeyOverlay();
+	testMalformedOverlay();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("profile overlays: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
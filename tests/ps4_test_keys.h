@@ -0,0 +1,106 @@
+#pragma once
+
+// Two 2048-bit RSA keys made for the host tests with `openssl genrsa 2048`, in the layout PS4Options keeps
+// them. E is 65537 for both.
+
+#include <stdint.h>
+
+struct PS4TestKey
+{
+	const uint8_t* n;
+	const uint8_t* p;
+	const uint8_t* q;
+};
+
+static const uint8_t ps4TestKeyE[4] = { 0x00, 0x01, 0x00, 0x01 };
+
+static const uint8_t ps4TestKeyAN[256] =
+{
+	0xde, 0xa5, 0x7a, 0x00, 0xaa, 0x08, 0x13, 0x47, 0x47, 0x9f, 0x4b, 0x6f, 0xac, 0x6d, 0x3c, 0x6d,
+	0x19, 0x00, 0xbf, 0x0b, 0x90, 0xad, 0x34, 0x6a, 0x36, 0x42, 0x44, 0xe5, 0xf1, 0xf8, 0xf2, 0x8e,
+	0xc3, 0xe2, 0x6c, 0xa0, 0xda, 0x8c, 0xaa, 0x3a, 0x43, 0x1e, 0x9c, 0x20, 0x1f, 0xd4, 0xc0, 0xeb,
+	0x36, 0x2d, 0x3e, 0x90, 0x79, 0x0a, 0x06, 0xe0, 0x9f, 0x30, 0x15, 0x79, 0xaa, 0x58, 0xd7, 0x40,
+	0x07, 0x65, 0xed, 0xe1, 0x97, 0x08, 0xf9, 0x3d, 0xdf, 0xe6, 0x8b, 0xe4, 0x5c, 0xf7, 0x5b, 0xba,
+	0xc8, 0x9a, 0x1e, 0x65, 0xe8, 0x4b, 0xae, 0xa0, 0xa2, 0xe5, 0x18, 0x97, 0x42, 0xe3, 0xe0, 0x42,
+	0x18, 0x6a, 0xdb, 0xb5, 0x80, 0xcc, 0x74, 0x4a, 0x68, 0xe1, 0x75, 0x7a, 0x11, 0xdc, 0x1c, 0x31,
+	0x5a, 0xe0, 0xd6, 0x13, 0xba, 0x2d, 0x0c, 0xe6, 0x59, 0xbf, 0x11, 0xce, 0xd4, 0xba, 0x59, 0x5c,
+	0x76, 0xd1, 0x3a, 0x07, 0xbf, 0xfd, 0x6f, 0x02, 0xb9, 0x28, 0x7b, 0xe9, 0xfd, 0x38, 0xea, 0x3f,
+	0x6c, 0x99, 0x0a, 0x28, 0x64, 0xc0, 0x8f, 0x92, 0xc4, 0x5e, 0xe3, 0x09, 0x9d, 0xc1, 0x7c, 0x9e,
+	0xae, 0x59, 0xd2, 0x4d, 0x9b, 0xeb, 0xaa, 0xe7, 0xfc, 0x5d, 0xd6, 0x59, 0x86, 0xdd, 0x5a, 0x53,
+	0xaf, 0x2f, 0xc8, 0xa7, 0x17, 0xe8, 0xbc, 0x24, 0xa9, 0x79, 0xf6, 0x77, 0x0b, 0x9b, 0xf2, 0xd9,
+	0x98, 0x63, 0xba, 0xb0, 0x1d, 0x52, 0xf2, 0xab, 0x36, 0x48, 0x71, 0xec, 0x5e, 0x61, 0x89, 0xcc,
+	0x83, 0xbd, 0x22, 0x91, 0x00, 0x94, 0x87, 0x5d, 0x46, 0x1c, 0x60, 0x71, 0x17, 0x6f, 0x33, 0x65,
+	0xd3, 0xf7, 0x80, 0xe4, 0xff, 0xf1, 0xd8, 0x27, 0xee, 0x43, 0xba, 0x43, 0xfc, 0x63, 0x30, 0x07,
+	0x3c, 0x28, 0xd4, 0xbe, 0x2a, 0x7e, 0x68, 0x8f, 0x1c, 0x2a, 0xfb, 0x0f, 0xac, 0x6b, 0x17, 0x1f,
+};
+
+static const uint8_t ps4TestKeyAP[128] =
+{
+	0xf8, 0x98, 0x4f, 0x59, 0xf2, 0x8d, 0x99, 0x81, 0x29, 0x3d, 0xdd, 0x23, 0x0d, 0xde, 0x0b, 0xb9,
+	0xb8, 0x86, 0x77, 0x93, 0x76, 0x65, 0x98, 0xbf, 0x4e, 0x3c, 0x97, 0x4b, 0xb8, 0xc5, 0x6c, 0x07,
+	0x00, 0x7d, 0x0d, 0xe4, 0x6d, 0x91, 0x82, 0x43, 0x40, 0x3e, 0xff, 0xb4, 0x66, 0x07, 0x0a, 0xc2,
+	0x3d, 0x85, 0xe9, 0x1c, 0x03, 0x30, 0x07, 0xf1, 0x1b, 0x17, 0x42, 0xff, 0x3b, 0x39, 0xef, 0x56,
+	0x69, 0x5a, 0x66, 0x85, 0xf7, 0xfa, 0xde, 0x32, 0xa1, 0x37, 0x14, 0xfc, 0x0a, 0x74, 0x31, 0x3a,
+	0xff, 0x31, 0xad, 0x93, 0x93, 0x7d, 0x7f, 0xac, 0x19, 0xa8, 0xb8, 0x3f, 0xef, 0x55, 0x12, 0x5c,
+	0xb2, 0x5a, 0xc0, 0xf0, 0x70, 0xc8, 0x8d, 0x25, 0x98, 0x37, 0xa8, 0xe7, 0x86, 0x1c, 0x2b, 0x5d,
+	0x92, 0xf2, 0x6b, 0xa2, 0x24, 0x87, 0xa4, 0x2c, 0x93, 0x8d, 0x04, 0x15, 0xe1, 0xd9, 0x43, 0x7f,
+};
+
+static const uint8_t ps4TestKeyAQ[128] =
+{
+	0xe5, 0x47, 0x4a, 0xf2, 0x2c, 0x7b, 0x85, 0x98, 0xa5, 0xe9, 0xf2, 0xdc, 0xca, 0xaf, 0x8a, 0x39,
+	0x99, 0x39, 0xb2, 0x78, 0x37, 0x2f, 0x26, 0x06, 0xd3, 0xbc, 0x79, 0x5a, 0x8f, 0xcc, 0xe0, 0xa7,
+	0x4e, 0xa3, 0x44, 0x86, 0xf4, 0x20, 0x65, 0xd0, 0x83, 0x0f, 0xef, 0x7d, 0xb9, 0x35, 0x06, 0x8d,
+	0x4c, 0xf4, 0xb6, 0xee, 0xfe, 0xa4, 0x06, 0x86, 0x55, 0x78, 0x0c, 0x28, 0x3b, 0x8b, 0xb7, 0x8d,
+	0xf5, 0xfd, 0x2e, 0x69, 0x37, 0x50, 0x9b, 0x78, 0xba, 0x43, 0x8c, 0x77, 0x2b, 0x09, 0xfa, 0x12,
+	0xa2, 0xe9, 0x25, 0xe2, 0xe3, 0x4e, 0x25, 0xa7, 0xad, 0xda, 0x23, 0xed, 0x9c, 0xa3, 0x70, 0x37,
+	0x95, 0x79, 0x39, 0xfe, 0x1a, 0x61, 0xf3, 0x95, 0x0e, 0xca, 0xbb, 0x3f, 0x50, 0x32, 0xc4, 0x47,
+	0x9f, 0x0f, 0x57, 0xb3, 0x07, 0xc2, 0x56, 0x9b, 0x0d, 0x27, 0x30, 0x66, 0x3b, 0x19, 0x7c, 0x61,
+};
+
+static const uint8_t ps4TestKeyBN[256] =
+{
+	0xc8, 0xc5, 0xc4, 0x6f, 0x11, 0x19, 0xa7, 0x69, 0xc5, 0x43, 0x3b, 0x45, 0xb7, 0x08, 0x65, 0x01,
+	0x7b, 0x22, 0xbe, 0x8c, 0xeb, 0x0e, 0x4d, 0x3a, 0x1a, 0xb9, 0xc6, 0x74, 0xd0, 0x28, 0x0f, 0x83,
+	0x69, 0xa4, 0xc9, 0x23, 0x87, 0xb3, 0xaf, 0xe6, 0x63, 0xad, 0x34, 0xe5, 0x29, 0x48, 0x9d, 0xba,
+	0xbb, 0x14, 0xea, 0xbe, 0x22, 0xa1, 0x6d, 0xb0, 0x97, 0x7e, 0x49, 0x6f, 0xca, 0x72, 0xcf, 0x37,
+	0xb1, 0xbf, 0x52, 0x4c, 0xa3, 0xdd, 0x96, 0x6d, 0xaa, 0xa4, 0x86, 0xc6, 0x3d, 0x7a, 0x8e, 0x70,
+	0xa8, 0x5c, 0x6b, 0x50, 0x84, 0x44, 0x1c, 0x0c, 0x2c, 0x31, 0x82, 0x02, 0xd4, 0xf8, 0x9e, 0xd0,
+	0x0c, 0xce, 0x2e, 0x80, 0x63, 0xa9, 0x17, 0x9e, 0xe0, 0x6c, 0xd3, 0x7e, 0x0f, 0xac, 0x5a, 0x8a,
+	0x91, 0x67, 0x14, 0x77, 0x99, 0xc1, 0x7b, 0xba, 0x0c, 0x5d, 0xb1, 0x10, 0xc8, 0x7f, 0x79, 0x6d,
+	0x36, 0x8c, 0xd0, 0xfd, 0x41, 0xe3, 0x81, 0x6f, 0x4d, 0xc3, 0xef, 0x95, 0xfb, 0x6b, 0x64, 0xd3,
+	0x97, 0x67, 0x0d, 0x4a, 0x81, 0xa6, 0x3a, 0x8d, 0x91, 0x22, 0x59, 0x2d, 0x19, 0x2e, 0xad, 0x09,
+	0x3d, 0x7d, 0xdc, 0x81, 0xc3, 0xbd, 0xc8, 0x8a, 0x6a, 0xd5, 0xbc, 0x58, 0x4f, 0x8d, 0xa4, 0xb0,
+	0xf9, 0x6c, 0x8a, 0x9f, 0xe5, 0x67, 0x96, 0xc7, 0xb5, 0x6e, 0x13, 0x55, 0xc6, 0xb1, 0x9e, 0x53,
+	0xc5, 0x4e, 0x24, 0xcf, 0x86, 0x42, 0xd3, 0xca, 0x24, 0x72, 0x42, 0xec, 0x56, 0xda, 0x85, 0x09,
+	0xd2, 0xb2, 0x32, 0x5a, 0x93, 0x97, 0x6e, 0xe7, 0x4b, 0x8c, 0x23, 0x23, 0xde, 0xfe, 0x67, 0x60,
+	0x0d, 0x01, 0x0c, 0xe9, 0xb2, 0x89, 0xda, 0xa6, 0x1a, 0x16, 0x45, 0x04, 0x0f, 0x4a, 0x71, 0xe9,
+	0x7f, 0xde, 0x78, 0x02, 0x12, 0xce, 0xb3, 0x68, 0x23, 0x6a, 0xa2, 0xbd, 0x87, 0x4a, 0x32, 0xa9,
+};
+
+static const uint8_t ps4TestKeyBP[128] =
+{
+	0xfe, 0x2e, 0x7a, 0x67, 0x31, 0x19, 0x39, 0x0c, 0x62, 0x6a, 0x6f, 0x87, 0xeb, 0xca, 0x2c, 0xb3,
+	0x7e, 0xd1, 0x5b, 0xc7, 0x4e, 0xa2, 0xed, 0x1d, 0x79, 0x5d, 0x6f, 0xef, 0x7e, 0x84, 0x9c, 0x0c,
+	0x6a, 0x4a, 0xe4, 0x72, 0xe8, 0xe4, 0x84, 0xc4, 0x8d, 0xbf, 0x2c, 0xc5, 0x4e, 0x74, 0xb1, 0x92,
+	0x6c, 0xf9, 0xa1, 0x90, 0xe3, 0x64, 0xfe, 0x07, 0x6c, 0x7a, 0x51, 0x6e, 0x68, 0x46, 0x6e, 0x41,
+	0x92, 0x3c, 0xfc, 0xe6, 0xa7, 0xf2, 0x0e, 0x80, 0x32, 0xe3, 0xf7, 0xfd, 0xb8, 0xa8, 0xe4, 0x13,
+	0x43, 0xb6, 0xf9, 0x1d, 0xa3, 0x4b, 0xf9, 0xfa, 0xbf, 0xa1, 0x5d, 0x04, 0xf7, 0x97, 0x52, 0xbc,
+	0xff, 0x7a, 0xdb, 0x84, 0x83, 0xde, 0x84, 0xb6, 0xe9, 0x3b, 0x51, 0xfe, 0xc4, 0x40, 0xdd, 0x9b,
+	0xa6, 0x75, 0xea, 0x34, 0x59, 0x27, 0x8e, 0xfc, 0xdf, 0x69, 0x00, 0x48, 0x60, 0xa5, 0xbf, 0xe9,
+};
+
+static const uint8_t ps4TestKeyBQ[128] =
+{
+	0xca, 0x35, 0x79, 0x16, 0x7e, 0x0a, 0x7d, 0xef, 0x7b, 0x6e, 0x93, 0x8a, 0x3f, 0xd5, 0x4e, 0xc7,
+	0x44, 0x5f, 0xcb, 0x78, 0x42, 0x07, 0x1e, 0x30, 0x54, 0xbd, 0xe7, 0xb3, 0x77, 0xcc, 0x88, 0xae,
+	0x72, 0x3b, 0x36, 0x26, 0x0f, 0xb1, 0x99, 0xcd, 0x35, 0x33, 0xe4, 0x62, 0x95, 0xde, 0xf4, 0x21,
+	0xff, 0xd0, 0x08, 0x72, 0x08, 0x55, 0x18, 0x2f, 0xb9, 0x1f, 0x91, 0x13, 0xe3, 0x33, 0xca, 0xf6,
+	0xe5, 0x10, 0x33, 0x0f, 0x56, 0x63, 0x03, 0xdf, 0x6e, 0x3c, 0x5e, 0x72, 0x30, 0x0f, 0xc2, 0x8f,
+	0x2b, 0x93, 0x7a, 0xcc, 0x8c, 0xa3, 0x84, 0x33, 0x80, 0x2b, 0x5b, 0x14, 0x30, 0x24, 0x72, 0xc1,
+	0x86, 0x60, 0xfe, 0x69, 0x7e, 0x24, 0x2e, 0x29, 0x71, 0xbe, 0x23, 0x63, 0x45, 0xe7, 0x96, 0x1b,
+	0x61, 0x62, 0x91, 0x84, 0x5d, 0x7f, 0x07, 0xd8, 0x0b, 0xa4, 0x9e, 0xf1, 0x3f, 0x81, 0xe4, 0xc1,
+};
+
+static const PS4TestKey ps4TestKeyA = { ps4TestKeyAN, ps4TestKeyAP, ps4TestKeyAQ };
+static const PS4TestKey ps4TestKeyB = { ps4TestKeyBN, ps4TestKeyBP, ps4TestKeyBQ };
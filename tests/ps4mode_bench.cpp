@@ -0,0 +1,135 @@
+// Cost of PS4 authentication with a test key and host mbedtls: setting the key up on the first boot, when D
+// and the CRT values are derived, and on later boots that take them from the config, then signing the
+// console's nonce right after boot and after that.
+//
+// Usage: ps4mode_bench [boots] [signatures]
+
+#include "addons/ps4mode.h"
+#include "ps4_driver.h"
+#include "ps4_test_keys.h"
+#include "storagemanager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+static std::mt19937 rng(2040);
+
+uint32_t host_rosc_randombit(void)
+{
+	return rng() & 1;
+}
+
+static void setKey(const PS4TestKey& key)
+{
+	PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+	options = PS4Options_init_default;
+	options.enabled = true;
+	options.serial.size = sizeof(options.serial.bytes);
+	options.signature.size = sizeof(options.signature.bytes);
+	options.rsaN.size = sizeof(options.rsaN.bytes);
+	memcpy(options.rsaN.bytes, key.n, options.rsaN.size);
+	options.rsaE.size = sizeof(options.rsaE.bytes);
+	memcpy(options.rsaE.bytes, ps4TestKeyE, options.rsaE.size);
+	options.rsaP.size = sizeof(options.rsaP.bytes);
+	memcpy(options.rsaP.bytes, key.p, options.rsaP.size);
+	options.rsaQ.size = sizeof(options.rsaQ.bytes);
+	memcpy(options.rsaQ.bytes, key.q, options.rsaQ.size);
+}
+
+static void setCache(const Storage::PS4KeyCache& keyCache)
+{
+	PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+	options.rsaD.size = sizeof(keyCache.rsaD);
+	memcpy(options.rsaD.bytes, keyCache.rsaD, sizeof(keyCache.rsaD));
+	options.rsaDP.size = sizeof(keyCache.rsaDP);
+	memcpy(options.rsaDP.bytes, keyCache.rsaDP, sizeof(keyCache.rsaDP));
+	options.rsaDQ.size = sizeof(keyCache.rsaDQ);
+	memcpy(options.rsaDQ.bytes, keyCache.rsaDQ, sizeof(keyCache.rsaDQ));
+	options.rsaQP.size = sizeof(keyCache.rsaQP);
+	memcpy(options.rsaQP.bytes, keyCache.rsaQP, sizeof(keyCache.rsaQP));
+}
+
+// Returns false if the addon didn't sign
+static bool sign(PS4ModeAddon& addon)
+{
+	PS4Data& ps4Data = PS4Data::getInstance();
+	for (uint8_t& byte : ps4Data.nonce_buffer)
+		byte = rng();
+	ps4Data.ps4State = PS4State::nonce_ready;
+	addon.process();
+	return ps4Data.ps4State == PS4State::signed_nonce_ready;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print(const char* name, double totalMs, uint32_t count)
+{
+	printf("%-18s %9.3f ms\n", name, totalMs / count);
+}
+
+// Boots with or without a cache, timing setup() and the first signature
+static bool bootBench(const char* setupName, const Storage::PS4KeyCache* keyCache, uint32_t boots,
+	std::vector<PS4ModeAddon*>& addons)
+{
+	double setupMs = 0;
+	double firstSignMs = 0;
+	for (uint32_t i = 0; i < boots; i++)
+	{
+		setKey(ps4TestKeyA);
+		if (keyCache != nullptr)
+			setCache(*keyCache);
+
+		PS4ModeAddon* addon = new PS4ModeAddon();
+		addons.push_back(addon);
+		auto start = std::chrono::steady_clock::now();
+		addon->setup();
+		setupMs += elapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		if (!sign(*addon))
+			return false;
+		firstSignMs += elapsedMs(start);
+	}
+	print(setupName, setupMs, boots);
+	print("first signature", firstSignMs, boots);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t boots = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20;
+	const uint32_t signatures = argc > 2 ? strtoul(argv[2], nullptr, 0) : 100;
+
+	// The add-ons are never freed, like in the firmware
+	std::vector<PS4ModeAddon*> addons;
+	if (!bootBench("setup, first boot", nullptr, boots, addons))
+	{
+		printf("signing failed\n");
+		return 1;
+	}
+	const Storage::PS4KeyCache keyCache = Storage::getInstance().lastPS4KeyCache;
+	if (!bootBench("setup, cached", &keyCache, boots, addons))
+	{
+		printf("signing failed\n");
+		return 1;
+	}
+
+	PS4ModeAddon& addon = *addons.back();
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < signatures; i++)
+	{
+		if (!sign(addon))
+		{
+			printf("signing failed\n");
+			return 1;
+		}
+	}
+	print("signature", elapsedMs(start), signatures);
+	return 0;
+}
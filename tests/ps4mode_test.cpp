@@ -0,0 +1,226 @@
+// Boots PS4ModeAddon with two fixed test keys and host mbedtls. The first boot derives D and the CRT values
+// and hands them to Storage. A boot with that cache has to take it as is, so nothing is handed over again.
+// A cache that doesn't belong to the key has to be thrown away and derived again: one from the other key,
+// one with a flipped byte, one cut short. Every nonce the addon signs has to verify against the public key
+// and come back in the layout the console reads.
+//
+// Usage: ps4mode_test [iterations] [seed]
+
+#include "addons/ps4mode.h"
+#include "ps4_driver.h"
+#include "ps4_test_keys.h"
+#include "storagemanager.h"
+
+#include "mbedtls/rsa.h"
+#include "mbedtls/sha256.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+static std::mt19937 rng;
+
+uint32_t host_rosc_randombit(void)
+{
+	return rng() & 1;
+}
+
+// Like in the firmware, add-ons live until the device is unplugged. The list isn't destroyed at exit either,
+// so the leak checker still sees the keys they hold.
+static std::vector<PS4ModeAddon*>& addons = *new std::vector<PS4ModeAddon*>();
+
+static void setKey(const PS4TestKey& key)
+{
+	PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+	options = PS4Options_init_default;
+	options.enabled = true;
+	options.serial.size = sizeof(options.serial.bytes);
+	for (uint8_t& byte : options.serial.bytes)
+		byte = rng();
+	options.signature.size = sizeof(options.signature.bytes);
+	for (uint8_t& byte : options.signature.bytes)
+		byte = rng();
+	options.rsaN.size = sizeof(options.rsaN.bytes);
+	memcpy(options.rsaN.bytes, key.n, options.rsaN.size);
+	options.rsaE.size = sizeof(options.rsaE.bytes);
+	memcpy(options.rsaE.bytes, ps4TestKeyE, options.rsaE.size);
+	options.rsaP.size = sizeof(options.rsaP.bytes);
+	memcpy(options.rsaP.bytes, key.p, options.rsaP.size);
+	options.rsaQ.size = sizeof(options.rsaQ.bytes);
+	memcpy(options.rsaQ.bytes, key.q, options.rsaQ.size);
+}
+
+// What Storage writes into the config once core0 gets to the save
+static void setCache(const Storage::PS4KeyCache& keyCache)
+{
+	PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+	options.rsaD.size = sizeof(keyCache.rsaD);
+	memcpy(options.rsaD.bytes, keyCache.rsaD, sizeof(keyCache.rsaD));
+	options.rsaDP.size = sizeof(keyCache.rsaDP);
+	memcpy(options.rsaDP.bytes, keyCache.rsaDP, sizeof(keyCache.rsaDP));
+	options.rsaDQ.size = sizeof(keyCache.rsaDQ);
+	memcpy(options.rsaDQ.bytes, keyCache.rsaDQ, sizeof(keyCache.rsaDQ));
+	options.rsaQP.size = sizeof(keyCache.rsaQP);
+	memcpy(options.rsaQP.bytes, keyCache.rsaQP, sizeof(keyCache.rsaQP));
+}
+
+static bool sameCache(const Storage::PS4KeyCache& a, const Storage::PS4KeyCache& b)
+{
+	return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Signs a random nonce and checks the auth buffer against the public half of the key
+static void checkSigning(PS4ModeAddon& addon, const PS4TestKey& key)
+{
+	const PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+	PS4Data& ps4Data = PS4Data::getInstance();
+	for (uint8_t& byte : ps4Data.nonce_buffer)
+		byte = rng();
+	memset(ps4Data.ps4_auth_buffer, 0xa5, sizeof(ps4Data.ps4_auth_buffer));
+	ps4Data.ps4State = PS4State::nonce_ready;
+	addon.process();
+	CHECK_EQ(ps4Data.ps4State, PS4State::signed_nonce_ready);
+
+	mbedtls_rsa_context publicKey;
+	mbedtls_rsa_init(&publicKey, MBEDTLS_RSA_PKCS_V21, MBEDTLS_MD_SHA256);
+	CHECK_EQ(mbedtls_rsa_import_raw(&publicKey, key.n, 256, nullptr, 0, nullptr, 0, nullptr, 0, ps4TestKeyE, sizeof(ps4TestKeyE)), 0);
+	CHECK_EQ(mbedtls_rsa_complete(&publicKey), 0);
+	uint8_t hashedNonce[32];
+	CHECK_EQ(mbedtls_sha256_ret(ps4Data.nonce_buffer, sizeof(ps4Data.nonce_buffer), hashedNonce, 0), 0);
+	CHECK_EQ(mbedtls_rsa_rsassa_pss_verify(&publicKey, nullptr, nullptr, MBEDTLS_RSA_PUBLIC, MBEDTLS_MD_SHA256,
+		sizeof(hashedNonce), hashedNonce, ps4Data.ps4_auth_buffer), 0);
+	mbedtls_rsa_free(&publicKey);
+
+	// Signature, serial, N, E padded to 256 bytes, the console's signature and zeros
+	const uint8_t* buffer = ps4Data.ps4_auth_buffer;
+	CHECK(memcmp(&buffer[256], options.serial.bytes, 16) == 0);
+	CHECK(memcmp(&buffer[272], key.n, 256) == 0);
+	uint8_t paddedE[256] = { };
+	memcpy(&paddedE[256 - sizeof(ps4TestKeyE)], ps4TestKeyE, sizeof(ps4TestKeyE));
+	CHECK(memcmp(&buffer[528], paddedE, sizeof(paddedE)) == 0);
+	CHECK(memcmp(&buffer[784], options.signature.bytes, 256) == 0);
+	const uint8_t zeros[24] = { };
+	CHECK(memcmp(&buffer[1040], zeros, sizeof(zeros)) == 0);
+}
+
+// A boot with whatever the config holds. Returns whether the addon derived the values and handed them over.
+static bool boot(const PS4TestKey& key)
+{
+	Storage& storage = Storage::getInstance();
+	const uint32_t saves = storage.ps4KeyCacheSaves;
+
+	PS4ModeAddon* addon = new PS4ModeAddon();
+	addons.push_back(addon);
+	CHECK(addon->available());
+	addon->setup();
+	checkSigning(*addon, key);
+
+	CHECK(storage.ps4KeyCacheSaves - saves <= 1);
+	return storage.ps4KeyCacheSaves != saves;
+}
+
+// Derives the cache of a key the way the first boot does
+static Storage::PS4KeyCache firstBoot(const PS4TestKey& key)
+{
+	setKey(key);
+	CHECK(boot(key));
+	const Storage::PS4KeyCache keyCache = Storage::getInstance().lastPS4KeyCache;
+
+	// The next boot takes it without deriving
+	setCache(keyCache);
+	CHECK(!boot(key));
+	CHECK(!boot(key));
+	return keyCache;
+}
+
+static void testStaleCache(const PS4TestKey& key, const Storage::PS4KeyCache& keyCache, const Storage::PS4KeyCache& otherCache)
+{
+	// Left over from the other key
+	setKey(key);
+	setCache(otherCache);
+	CHECK(boot(key));
+	CHECK(sameCache(Storage::getInstance().lastPS4KeyCache, keyCache));
+
+	// A mix of both keys' values
+	Storage::PS4KeyCache mixed = keyCache;
+	memcpy(mixed.rsaQP, otherCache.rsaQP, sizeof(mixed.rsaQP));
+	setKey(key);
+	setCache(mixed);
+	CHECK(boot(key));
+	CHECK(sameCache(Storage::getInstance().lastPS4KeyCache, keyCache));
+
+	// Cut short, from a config written before the fields were full size
+	PS4Options& options = Storage::getInstance().getAddonOptions().ps4Options;
+	pb_size_t* sizes[] = { &options.rsaD.size, &options.rsaDP.size, &options.rsaDQ.size, &options.rsaQP.size };
+	for (pb_size_t* size : sizes)
+	{
+		setKey(key);
+		setCache(keyCache);
+		(*size)--;
+		CHECK(boot(key));
+		CHECK(sameCache(Storage::getInstance().lastPS4KeyCache, keyCache));
+	}
+}
+
+// A byte of the cache flipped anywhere, like a worn flash sector would
+static void testCorruptCache(const PS4TestKey& key, const Storage::PS4KeyCache& keyCache, uint32_t iterations)
+{
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		Storage::PS4KeyCache corrupt = keyCache;
+		uint8_t* bytes = reinterpret_cast<uint8_t*>(&corrupt);
+		bytes[rng() % sizeof(corrupt)] ^= 1 << (rng() % 8);
+
+		setKey(key);
+		setCache(corrupt);
+		CHECK(boot(key));
+		CHECK(sameCache(Storage::getInstance().lastPS4KeyCache, keyCache));
+
+		// And the value handed over is taken on the boot after
+		setCache(Storage::getInstance().lastPS4KeyCache);
+		CHECK(!boot(key));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	rng.seed(seed);
+
+	const Storage::PS4KeyCache keyCacheA = firstBoot(ps4TestKeyA);
+	const Storage::PS4KeyCache keyCacheB = firstBoot(ps4TestKeyB);
+	CHECK(!sameCache(keyCacheA, keyCacheB));
+
+	testStaleCache(ps4TestKeyA, keyCacheA, keyCacheB);
+	testStaleCache(ps4TestKeyB, keyCacheB, keyCacheA);
+	testCorruptCache(ps4TestKeyA, keyCacheA, iterations);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("ps4 mode: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
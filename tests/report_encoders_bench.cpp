@@ -0,0 +1,63 @@
+// Cost of building each USB report from a gamepad state, the work done on core0 once per poll.
+//
+// Usage: report_encoders_bench [reports per encoder]
+
+#include "gamepad.h"
+#include "storagemanager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+
+#define STATE_COUNT 1024
+
+static GamepadState states[STATE_COUNT];
+
+// Runs an encoder over the prepared states and folds every report into a sum the compiler can't drop
+template <typename Encoder>
+static void bench(const char* name, Gamepad& gamepad, uint32_t reports, Encoder encode)
+{
+	uint32_t sum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < reports; i++)
+	{
+		gamepad.state = states[i % STATE_COUNT];
+		sum += encode();
+	}
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%-10s %8.1f ns/report %12.0f reports/s (%08x)\n", name, elapsed / reports, reports * 1e9 / elapsed, sum);
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t reports = argc > 1 ? strtoul(argv[1], nullptr, 0) : 5000000;
+
+	std::mt19937 rng(2040);
+	for (GamepadState& state : states)
+	{
+		state.dpad = rng() & 0x0f;
+		state.buttons = rng() & 0x3fff;
+		state.lx = rng();
+		state.ly = rng();
+		state.rx = rng();
+		state.ry = rng();
+		state.lt = rng();
+		state.rt = rng();
+	}
+
+	Gamepad gamepad;
+	gamepad.hasAnalogTriggers = true;
+
+	bench("xinput", gamepad, reports, [&] { return gamepad.getXInputReport()->buttons1; });
+	bench("switch", gamepad, reports, [&] { return gamepad.getSwitchReport()->hat; });
+	bench("hid", gamepad, reports, [&] { return gamepad.getHIDReport()->direction; });
+	bench("ps4", gamepad, reports, [&] { return gamepad.getPS4Report()->dpad; });
+	bench("keyboard", gamepad, reports, [&] { return gamepad.getKeyboardReport()->keycode[0]; });
+
+	HIDGeneric::configure(HID_GENERIC_DEFAULT_BUTTONS, HID_GENERIC_DEFAULT_AXES, HID_GENERIC_DEFAULT_AXIS_BITS);
+	bench("generic", gamepad, reports, [&] { return gamepad.getHIDGenericReport()[0]; });
+
+	return 0;
+}
@@ -0,0 +1,642 @@
+// Drives random gamepad states and host requests through the USB report encoders in gamepad.cpp and
+// the report callbacks in tusb_driver.cpp. Reports are checked against their HID report descriptors and
+// against the state they were built from. Buffers handed to the callbacks are exactly as large as the
+// host asked for, so out of bounds writes show up under the sanitizers.
+//
+// The input add-ons that run on core0 are polled the same way, with the GPIOs changing between every step
+// of a poll. All of them have to see the one debounced snapshot Gamepad::read took.
+//
+// Usage: report_encoders_test [iterations] [seed]
+
+#include "gamepad.h"
+#include "addons/extra_button.h"
+#include "addons/focus_mode.h"
+#include "addons/reverse.h"
+#include "storagemanager.h"
+#include "usb_driver.h"
+#include "xinput_driver.h"
+#include "ps4_driver.h"
+#include "host_usb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+// Input report sizes in bits per report ID, 0 for a descriptor without report IDs
+struct InputSizes
+{
+	uint32_t bits[256] = { };
+	bool hasReportIds = false;
+};
+
+static InputSizes parseInputSizes(const uint8_t* descriptor, uint16_t length)
+{
+	InputSizes sizes;
+	uint32_t reportSize = 0;
+	uint32_t reportCount = 0;
+	uint8_t reportId = 0;
+
+	for (uint16_t i = 0; i < length;)
+	{
+		const uint8_t prefix = descriptor[i];
+		if (prefix == 0xfe) // long item
+		{
+			CHECK(i + 1 < length);
+			i += 3 + descriptor[i + 1];
+			continue;
+		}
+
+		const uint8_t size = (prefix & 0x03) == 3 ? 4 : (prefix & 0x03);
+		CHECK(i + size < length);
+		uint32_t value = 0;
+		for (uint8_t b = 0; b < size && i + 1 + b < length; b++)
+			value |= static_cast<uint32_t>(descriptor[i + 1 + b]) << (8 * b);
+
+		switch (prefix & 0xfc)
+		{
+			case 0x74: reportSize = value; break;
+			case 0x94: reportCount = value; break;
+			case 0x84:
+				reportId = value;
+				sizes.hasReportIds = true;
+				break;
+			case 0x80: sizes.bits[reportId] += reportSize * reportCount; break; // Input
+		}
+		i += 1 + size;
+	}
+	return sizes;
+}
+
+static uint8_t expectedHat(uint8_t dpad)
+{
+	switch (dpad & GAMEPAD_MASK_DPAD)
+	{
+		case GAMEPAD_MASK_UP:                        return 0;
+		case GAMEPAD_MASK_UP | GAMEPAD_MASK_RIGHT:   return 1;
+		case GAMEPAD_MASK_RIGHT:                     return 2;
+		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_RIGHT: return 3;
+		case GAMEPAD_MASK_DOWN:                      return 4;
+		case GAMEPAD_MASK_DOWN | GAMEPAD_MASK_LEFT:  return 5;
+		case GAMEPAD_MASK_LEFT:                      return 6;
+		case GAMEPAD_MASK_UP | GAMEPAD_MASK_LEFT:    return 7;
+		default:                                     return 8;
+	}
+}
+
+// Extremes and centre show up far more often than a uniform pick would give them
+static uint16_t randomAxis(std::mt19937& rng)
+{
+	static const uint16_t edges[] = { GAMEPAD_JOYSTICK_MIN, GAMEPAD_JOYSTICK_MID, GAMEPAD_JOYSTICK_MID + 1, GAMEPAD_JOYSTICK_MAX };
+	const uint32_t r = rng();
+	return (r & 3) == 0 ? edges[(r >> 2) & 3] : static_cast<uint16_t>(r >> 16);
+}
+
+static GamepadState randomState(std::mt19937& rng)
+{
+	GamepadState state;
+	state.dpad = rng() & 0x0f;
+	state.buttons = rng();
+	state.aux = rng();
+	state.lx = randomAxis(rng);
+	state.ly = randomAxis(rng);
+	state.rx = randomAxis(rng);
+	state.ry = randomAxis(rng);
+	state.lt = rng();
+	state.rt = rng();
+	return state;
+}
+
+static void randomKeyboardMapping(std::mt19937& rng)
+{
+	KeyboardMapping& mapping = Storage::getInstance().getKeyboardMapping();
+	uint32_t* keys[] =
+	{
+		&mapping.keyDpadUp, &mapping.keyDpadDown, &mapping.keyDpadLeft, &mapping.keyDpadRight,
+		&mapping.keyButtonB1, &mapping.keyButtonB2, &mapping.keyButtonB3, &mapping.keyButtonB4,
+		&mapping.keyButtonL1, &mapping.keyButtonR1, &mapping.keyButtonL2, &mapping.keyButtonR2,
+		&mapping.keyButtonS1, &mapping.keyButtonS2, &mapping.keyButtonL3, &mapping.keyButtonR3,
+		&mapping.keyButtonA1, &mapping.keyButtonA2,
+	};
+	for (uint32_t* key : keys)
+		*key = rng() & 0xff;
+}
+
+static void setInputMode(InputMode mode)
+{
+	Storage::getInstance().getGamepadOptions().inputMode = mode;
+	initialize_driver(mode);
+}
+
+static void testDescriptors(Gamepad& gamepad)
+{
+	InputSizes hid = parseInputSizes(hid_report_descriptor, sizeof(hid_report_descriptor));
+	CHECK(!hid.hasReportIds);
+	CHECK_EQ(hid.bits[0], sizeof(HIDReport) * 8);
+
+	InputSizes sw = parseInputSizes(switch_report_descriptor, sizeof(switch_report_descriptor));
+	CHECK(!sw.hasReportIds);
+	CHECK_EQ(sw.bits[0], sizeof(SwitchReport) * 8);
+
+	// The report ID is the first byte of PS4Report
+	InputSizes ps4 = parseInputSizes(ps4_report_descriptor, sizeof(ps4_report_descriptor));
+	CHECK(ps4.hasReportIds);
+	CHECK_EQ(ps4.bits[0x01] + 8, sizeof(PS4Report) * 8);
+
+	InputSizes keyboard = parseInputSizes(keyboard_report_descriptor, sizeof(keyboard_report_descriptor));
+	CHECK_EQ(keyboard.bits[KEYBOARD_KEY_REPORT_ID], sizeof(KeyboardReport::keycode) * 8);
+	CHECK_EQ(keyboard.bits[KEYBOARD_MULTIMEDIA_REPORT_ID], sizeof(KeyboardReport::multimedia) * 8);
+
+	// XInput has no HID descriptor, the report carries its own length
+	CHECK_EQ(gamepad.getXInputReport()->report_size, sizeof(XInputReport));
+
+	uint16_t size;
+	const uint8_t* descriptor = HIDComposite::getReportDescriptor(HID_COMPOSITE_KEYBOARD_INSTANCE, &size);
+	CHECK_EQ(parseInputSizes(descriptor, size).bits[0], HID_COMPOSITE_KEYBOARD_REPORT_SIZE * 8);
+	descriptor = HIDComposite::getReportDescriptor(HID_COMPOSITE_CONSUMER_INSTANCE, &size);
+	CHECK_EQ(parseInputSizes(descriptor, size).bits[0], HID_COMPOSITE_CONSUMER_REPORT_SIZE * 8);
+
+	// Every layout the web config can ask for, plus out of range requests that get clamped
+	for (uint32_t buttons = 0; buttons <= HID_GENERIC_MAX_BUTTONS + 2; buttons++)
+	{
+		for (uint32_t axes = 0; axes <= HID_GENERIC_MAX_AXES + 1; axes++)
+		{
+			for (uint32_t axisBits : { 8, 16, 12 })
+			{
+				const HIDGenericLayout layout = HIDGeneric::makeLayout(buttons, axes, axisBits);
+				uint8_t genericDescriptor[HID_GENERIC_MAX_DESCRIPTOR_SIZE];
+				const uint16_t length = HIDGeneric::buildReportDescriptor(layout, genericDescriptor, sizeof(genericDescriptor));
+				CHECK(length > 0);
+				CHECK(layout.reportSize <= HID_GENERIC_MAX_REPORT_SIZE);
+				CHECK_EQ(parseInputSizes(genericDescriptor, length).bits[0], layout.reportSize * 8);
+			}
+		}
+	}
+
+	const InputMode modes[] = { INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD };
+	for (InputMode mode : modes)
+	{
+		setInputMode(mode);
+		CHECK(gamepad.getReportSize() <= CFG_TUD_ENDPOINT0_SIZE);
+	}
+	HIDGeneric::configure(HID_GENERIC_MAX_BUTTONS, HID_GENERIC_MAX_AXES, 16);
+	setInputMode(INPUT_MODE_HID);
+	CHECK_EQ(gamepad.getReportSize(), HIDGeneric::getLayout().reportSize);
+	HIDGeneric::disable();
+}
+
+static void checkEncoders(Gamepad& gamepad, std::mt19937& rng)
+{
+	const GamepadState state = gamepad.state;
+	const uint8_t hat = expectedHat(state.dpad);
+	const auto pressed = [&](uint16_t mask) { return (state.buttons & mask) != 0; };
+	const auto pressedDpad = [&](uint8_t mask) { return (state.dpad & mask) != 0; };
+
+	HIDReport* hid = gamepad.getHIDReport();
+	CHECK_EQ(hid->direction, hat);
+	CHECK_EQ(hid->cross_btn, pressed(GAMEPAD_MASK_B1));
+	CHECK_EQ(hid->tp_btn, pressed(GAMEPAD_MASK_A2));
+	CHECK_EQ(hid->l_x_axis, state.lx >> 8);
+	CHECK_EQ(hid->l_y_axis, state.ly >> 8);
+	CHECK_EQ(hid->r_x_axis, state.rx >> 8);
+	CHECK_EQ(hid->r_y_axis, state.ry >> 8);
+
+	SwitchReport* sw = gamepad.getSwitchReport();
+	CHECK_EQ(sw->hat, hat);
+	CHECK_EQ(sw->buttons & ~0x3fff, 0);
+	CHECK_EQ((sw->buttons & SWITCH_MASK_B) != 0, pressed(GAMEPAD_MASK_B1));
+	CHECK_EQ((sw->buttons & SWITCH_MASK_CAPTURE) != 0, pressed(GAMEPAD_MASK_A2));
+	CHECK_EQ(sw->lx, state.lx >> 8);
+	CHECK_EQ(sw->ry, state.ry >> 8);
+
+	XInputReport* xinput = gamepad.getXInputReport();
+	CHECK_EQ(xinput->report_size, sizeof(XInputReport));
+	CHECK_EQ((xinput->buttons1 & XBOX_MASK_UP) != 0, pressedDpad(GAMEPAD_MASK_UP));
+	CHECK_EQ((xinput->buttons1 & XBOX_MASK_LEFT) != 0, pressedDpad(GAMEPAD_MASK_LEFT));
+	CHECK_EQ((xinput->buttons2 & XBOX_MASK_A) != 0, pressed(GAMEPAD_MASK_B1));
+	CHECK_EQ((xinput->buttons2 & XBOX_MASK_HOME) != 0, pressed(GAMEPAD_MASK_A1));
+	CHECK_EQ(xinput->buttons2 & 0x08, 0);
+	// Full range, Y points up
+	CHECK_EQ(xinput->lx, state.lx - 32768);
+	CHECK_EQ(xinput->ly, 32767 - state.ly);
+	CHECK_EQ(xinput->rx, state.rx - 32768);
+	CHECK_EQ(xinput->ry, 32767 - state.ry);
+	CHECK_EQ(xinput->lt, gamepad.hasAnalogTriggers ? state.lt : (pressed(GAMEPAD_MASK_L2) ? 0xff : 0));
+
+	const uint8_t counter = gamepad.getPS4Report()->report_counter;
+	PS4Report* ps4 = gamepad.getPS4Report();
+	CHECK_EQ(ps4->report_id, 0x01);
+	CHECK_EQ(ps4->report_counter, (counter + 1) & 0x3f);
+	CHECK_EQ(ps4->dpad, hat == 8 ? PS4_HAT_NOTHING : hat);
+	CHECK_EQ(ps4->button_south, pressed(GAMEPAD_MASK_B1));
+	CHECK_EQ(ps4->left_stick_x, state.lx >> 8);
+	CHECK_EQ(ps4->right_stick_y, state.ry >> 8);
+	CHECK_EQ(ps4->right_trigger, gamepad.hasAnalogTriggers ? state.rt : (pressed(GAMEPAD_MASK_R2) ? 0xff : 0));
+
+	randomKeyboardMapping(rng);
+	const KeyboardMapping& mapping = Storage::getInstance().getKeyboardMapping();
+	const struct { bool pressed; uint32_t key; } keys[] =
+	{
+		{ pressedDpad(GAMEPAD_MASK_UP), mapping.keyDpadUp }, { pressedDpad(GAMEPAD_MASK_DOWN), mapping.keyDpadDown },
+		{ pressedDpad(GAMEPAD_MASK_LEFT), mapping.keyDpadLeft }, { pressedDpad(GAMEPAD_MASK_RIGHT), mapping.keyDpadRight },
+		{ pressed(GAMEPAD_MASK_B1), mapping.keyButtonB1 }, { pressed(GAMEPAD_MASK_B2), mapping.keyButtonB2 },
+		{ pressed(GAMEPAD_MASK_B3), mapping.keyButtonB3 }, { pressed(GAMEPAD_MASK_B4), mapping.keyButtonB4 },
+		{ pressed(GAMEPAD_MASK_L1), mapping.keyButtonL1 }, { pressed(GAMEPAD_MASK_R1), mapping.keyButtonR1 },
+		{ pressed(GAMEPAD_MASK_L2), mapping.keyButtonL2 }, { pressed(GAMEPAD_MASK_R2), mapping.keyButtonR2 },
+		{ pressed(GAMEPAD_MASK_S1), mapping.keyButtonS1 }, { pressed(GAMEPAD_MASK_S2), mapping.keyButtonS2 },
+		{ pressed(GAMEPAD_MASK_L3), mapping.keyButtonL3 }, { pressed(GAMEPAD_MASK_R3), mapping.keyButtonR3 },
+		{ pressed(GAMEPAD_MASK_A1), mapping.keyButtonA1 }, { pressed(GAMEPAD_MASK_A2), mapping.keyButtonA2 },
+	};
+	uint8_t expectedKeys[sizeof(KeyboardReport::keycode)] = { };
+	for (const auto& key : keys)
+	{
+		if (key.pressed && key.key <= HID_KEY_GUI_RIGHT)
+			expectedKeys[key.key / 8] |= 1 << (key.key % 8);
+	}
+	KeyboardReport* keyboard = gamepad.getKeyboardReport();
+	CHECK(keyboard->reportId == KEYBOARD_KEY_REPORT_ID || keyboard->reportId == KEYBOARD_MULTIMEDIA_REPORT_ID);
+	CHECK(memcmp(keyboard->keycode, expectedKeys, sizeof(expectedKeys)) == 0);
+	CHECK_EQ(keyboard->multimedia & 0x80, 0);
+}
+
+static void testEncoders(Gamepad& gamepad, std::mt19937& rng, uint32_t iterations)
+{
+	GamepadOptions& options = Storage::getInstance().getGamepadOptions();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		gamepad.state = randomState(rng);
+		gamepad.hasAnalogTriggers = rng() & 1;
+		options.switchTpShareForDs4 = rng() & 1;
+		checkEncoders(gamepad, rng);
+	}
+
+	// The same encoders fed from GPIO, including unassigned pins
+	PinMappings& pins = Storage::getInstance().getProfilePinMappings();
+	for (uint32_t i = 0; i < iterations / 16; i++)
+	{
+		pins.pinButtonFn = (rng() % (NUM_BANK0_GPIOS + 2)) - 1;
+		host_gpio_pins = rng();
+		gamepad.read();
+		CHECK_EQ(gamepad.state.aux & ~AUX_MASK_FUNCTION, 0);
+		checkEncoders(gamepad, rng);
+	}
+	pins.pinButtonFn = -1;
+}
+
+// Pins of the input add-ons, past the gamepad's 0-17
+#define TEST_PIN_EXTRA_BUTTON 20
+#define TEST_PIN_REVERSE 21
+#define TEST_PIN_FOCUS_MODE 22
+
+static bool pinSet(uint32_t pins, uint32_t pin)
+{
+	return pins & (1u << pin);
+}
+
+// One core0 poll, the way gp2040.cpp runs it, with the switches bouncing between every read
+static void testSharedPinSnapshot(Gamepad& gamepad, std::mt19937& rng, uint32_t iterations)
+{
+	Storage& storage = Storage::getInstance();
+	storage.SetGamepad(&gamepad);
+	AddonOptions& addonOptions = storage.getAddonOptions();
+	addonOptions.extraButtonOptions.enabled = true;
+	addonOptions.extraButtonOptions.pin = TEST_PIN_EXTRA_BUTTON;
+	addonOptions.extraButtonOptions.buttonMap = GAMEPAD_MASK_A1;
+	addonOptions.reverseOptions.enabled = true;
+	addonOptions.reverseOptions.buttonPin = TEST_PIN_REVERSE;
+	addonOptions.reverseOptions.ledPin = -1;
+	addonOptions.reverseOptions.actionUp = 1;       // reversed
+	addonOptions.reverseOptions.actionDown = 1;
+	addonOptions.reverseOptions.actionLeft = 2;     // released
+	addonOptions.reverseOptions.actionRight = 0;    // left alone
+	addonOptions.focusModeOptions.enabled = true;
+	addonOptions.focusModeOptions.pin = TEST_PIN_FOCUS_MODE;
+	addonOptions.focusModeOptions.buttonLockMask = GAMEPAD_MASK_B1 | GAMEPAD_MASK_S2;
+
+	ExtraButtonAddon extraButton;
+	ReverseInput reverse;
+	FocusModeAddon focusMode;
+	CHECK(extraButton.available());
+	CHECK(reverse.available());
+	CHECK(focusMode.available());
+	extraButton.setup();
+	reverse.setup();
+	focusMode.setup();
+
+	static const uint16_t buttonMasks[] =
+	{
+		GAMEPAD_MASK_B1, GAMEPAD_MASK_B2, GAMEPAD_MASK_B3, GAMEPAD_MASK_B4,
+		GAMEPAD_MASK_L1, GAMEPAD_MASK_R1, GAMEPAD_MASK_L2, GAMEPAD_MASK_R2,
+		GAMEPAD_MASK_S1, GAMEPAD_MASK_S2, GAMEPAD_MASK_L3, GAMEPAD_MASK_R3,
+		GAMEPAD_MASK_A1, GAMEPAD_MASK_A2,
+	};
+
+	bool focusModeActive = false;
+	uint32_t heldBack = 0;  // polls where the debouncer kept a pin from changing
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		host_time_us += 1000 * (1 + rng() % 4);
+		host_gpio_pins = rng();
+		gamepad.read();
+		CHECK_EQ(gamepad.rawPins, ~host_gpio_pins & GAMEPAD_PIN_MASK);
+		gamepad.debounce();
+		const uint32_t pins = gamepad.debouncedPins;
+		heldBack += pins != gamepad.rawPins;
+
+		host_gpio_pins = rng();
+		extraButton.preprocess();
+		host_gpio_pins = rng();
+		reverse.process();
+		host_gpio_pins = rng();
+		const uint32_t events = storage.events;
+		focusMode.process();
+		host_gpio_pins = rng();
+
+		// Every add-on went by the snapshot, not by what the GPIOs read later
+		uint16_t buttons = 0;
+		for (size_t button = 0; button < sizeof(buttonMasks) / sizeof(buttonMasks[0]); button++)
+			buttons |= pinSet(pins, 4 + button) ? buttonMasks[button] : 0;
+		if (pinSet(pins, TEST_PIN_EXTRA_BUTTON))
+			buttons |= GAMEPAD_MASK_A1;
+		if (pinSet(pins, TEST_PIN_FOCUS_MODE))
+			buttons &= ~(GAMEPAD_MASK_B1 | GAMEPAD_MASK_S2);
+		CHECK_EQ(gamepad.state.buttons, buttons);
+
+		const bool reversed = pinSet(pins, TEST_PIN_REVERSE);
+		uint8_t dpad = 0;
+		dpad |= pinSet(pins, 0) ? (reversed ? GAMEPAD_MASK_DOWN : GAMEPAD_MASK_UP) : 0;
+		dpad |= pinSet(pins, 1) ? (reversed ? GAMEPAD_MASK_UP : GAMEPAD_MASK_DOWN) : 0;
+		dpad |= pinSet(pins, 2) && !reversed ? GAMEPAD_MASK_LEFT : 0;
+		dpad |= pinSet(pins, 3) ? GAMEPAD_MASK_RIGHT : 0;
+		CHECK_EQ(gamepad.state.dpad, dpad);
+
+		const bool focused = pinSet(pins, TEST_PIN_FOCUS_MODE);
+		CHECK_EQ(storage.events - events, focused != focusModeActive ? 1 : 0);
+		focusModeActive = focused;
+
+		for (uint8_t pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+			CHECK_EQ(gamepad.pressedPin(pin), pinSet(pins, pin));
+		CHECK_EQ(gamepad.debouncedPins, pins);
+	}
+	CHECK(heldBack > 0);
+
+	storage.SetGamepad(nullptr);
+	addonOptions.extraButtonOptions.enabled = false;
+	addonOptions.reverseOptions.enabled = false;
+	addonOptions.focusModeOptions.enabled = false;
+}
+
+static void testGenericReports(std::mt19937& rng, uint32_t iterations)
+{
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		const HIDGenericLayout layout = HIDGeneric::makeLayout(rng() % (HID_GENERIC_MAX_BUTTONS + 1),
+			rng() % (HID_GENERIC_MAX_AXES + 1), rng() & 1 ? 16 : 8);
+		const GamepadState state = randomState(rng);
+		std::vector<uint8_t> report(layout.reportSize);
+
+		CHECK_EQ(HIDGeneric::packReport(layout, state, report.data()), layout.reportSize);
+		CHECK_EQ(report[layout.hatOffset], expectedHat(state.dpad));
+
+		// Padding after the last button stays clear
+		if (layout.buttonCount % 8)
+			CHECK_EQ(report[layout.hatOffset - 1] >> (layout.buttonCount % 8), 0);
+
+		const uint16_t axes[] = { state.lx, state.ly, state.rx, state.ry,
+			static_cast<uint16_t>(state.lt * 0x101), static_cast<uint16_t>(state.rt * 0x101) };
+		for (uint8_t a = 0; a < layout.axisCount; a++)
+		{
+			if (layout.axisBits == 8)
+				CHECK_EQ(report[layout.axisOffset + a], axes[a] >> 8);
+			else
+				CHECK_EQ(report[layout.axisOffset + a * 2] | report[layout.axisOffset + a * 2 + 1] << 8, axes[a]);
+		}
+	}
+}
+
+static void testGetReport(std::mt19937& rng, uint32_t iterations)
+{
+	const InputMode modes[] = { INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD };
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		setInputMode(modes[rng() % 5]);
+		if (rng() & 1)
+			HIDGeneric::configure(rng() % (HID_GENERIC_MAX_BUTTONS + 1), rng() % (HID_GENERIC_MAX_AXES + 1), rng() & 1 ? 16 : 8);
+		else
+			HIDGeneric::disable();
+		if (rng() & 1)
+			HIDComposite::configure();
+		else
+			HIDComposite::disable();
+
+		// TinyUSB never asks for more than its control buffer
+		const uint16_t reqlen = rng() % (CFG_TUD_HID_EP_BUFSIZE + 1);
+		const uint8_t reportId = rng() & 1 ? rng() : PS4AuthReport::PS4_GET_SIGNATURE_NONCE;
+		const hid_report_type_t type = static_cast<hid_report_type_t>(rng() % 4);
+		uint8_t* buffer = new uint8_t[reqlen];
+
+		const uint16_t size = tud_hid_get_report_cb(rng() % HID_COMPOSITE_INTERFACE_COUNT, reportId, type, buffer, reqlen);
+		CHECK(size <= reqlen);
+
+		delete[] buffer;
+	}
+	HIDGeneric::disable();
+	HIDComposite::disable();
+}
+
+static void testSetReport(std::mt19937& rng, uint32_t iterations)
+{
+	setInputMode(INPUT_MODE_PS4);
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		// Forget the previous colour
+		reconnect_usb(0);
+		host_time_us += 1000000;
+		usb_reconnect_task();
+
+		const uint16_t bufsize = rng() % (CFG_TUD_HID_EP_BUFSIZE + 1);
+		std::vector<uint8_t> data(bufsize);
+		for (uint8_t& b : data)
+			b = rng();
+		uint8_t reportId = 0;
+		switch (rng() % 3)
+		{
+			case 0: reportId = 0x05; break;
+			case 1: if (bufsize > 0) data[0] = 0x05; break;
+			default: reportId = rng(); break;
+		}
+		const hid_report_type_t type = static_cast<hid_report_type_t>(rng() % 4);
+
+		// Heap copy of exactly bufsize bytes, the vector may have spare capacity
+		uint8_t* buffer = new uint8_t[bufsize];
+		if (bufsize > 0)
+			memcpy(buffer, data.data(), bufsize);
+		const uint32_t sent = hostUsb.reportsSent;
+		tud_hid_set_report_cb(0, reportId, type, buffer, bufsize);
+		delete[] buffer;
+
+		CHECK_EQ(hostUsb.reportsSent, sent + 1);
+		CHECK_EQ(hostUsb.lastReportSize, bufsize);
+
+		const uint8_t* payload = data.data();
+		uint16_t payloadSize = bufsize;
+		bool output = type != HID_REPORT_TYPE_FEATURE;
+		if (reportId == 0 && bufsize > 0 && data[0] == 0x05)
+		{
+			payload++;
+			payloadSize--;
+		}
+		else if (reportId != 0x05)
+		{
+			output = false;
+		}
+
+		uint8_t rgb[3];
+		if (output && payloadSize >= 5 + sizeof(rgb))
+		{
+			CHECK(get_ps4_lightbar(rgb));
+			CHECK(memcmp(rgb, &payload[5], sizeof(rgb)) == 0);
+		}
+		else
+		{
+			CHECK(!get_ps4_lightbar(rgb));
+		}
+	}
+}
+
+static void testXInputOut(std::mt19937& rng, uint32_t iterations)
+{
+	setInputMode(INPUT_MODE_XINPUT);
+	const tusb_desc_interface_t* itf = reinterpret_cast<const tusb_desc_interface_t*>(&xinput_configuration_descriptor[9]);
+	CHECK(xinput_driver.open(0, itf, sizeof(xinput_configuration_descriptor) - 9) > 0);
+	CHECK(endpoint_out != 0);
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		uint8_t* report = new uint8_t[XINPUT_OUT_SIZE];
+		receive_report(report);
+
+		// Hosts may send anything up to the endpoint size, the driver only queued XINPUT_OUT_SIZE
+		uint8_t data[64];
+		for (uint8_t& b : data)
+			b = rng();
+		const uint16_t transferred = hostUsb.completeOut(data, rng() % (sizeof(data) + 1));
+		CHECK(transferred <= XINPUT_OUT_SIZE);
+		xinput_driver.xfer_cb(0, endpoint_out, XFER_RESULT_SUCCESS, transferred);
+
+		receive_report(report);
+		CHECK(memcmp(report, data, transferred) == 0);
+		delete[] report;
+	}
+
+	xinput_driver.reset(0);
+	uint8_t report[XINPUT_OUT_SIZE];
+	receive_report(report);
+	for (uint8_t b : report)
+		CHECK_EQ(b, 0);
+}
+
+static void testSendReport(Gamepad& gamepad, std::mt19937& rng, uint32_t iterations)
+{
+	const InputMode modes[] = { INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD };
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		setInputMode(modes[rng() % 5]);
+		if (rng() & 1)
+			HIDGeneric::configure(rng() % (HID_GENERIC_MAX_BUTTONS + 1), rng() % (HID_GENERIC_MAX_AXES + 1), rng() & 1 ? 16 : 8);
+		else
+			HIDGeneric::disable();
+
+		gamepad.state = randomState(rng);
+		randomKeyboardMapping(rng);
+		void* report = gamepad.getReport();
+		const uint16_t size = gamepad.getReportSize();
+
+		const uint32_t sent = hostUsb.reportsSent;
+		send_report(report, size);
+		if (hostUsb.reportsSent != sent)
+		{
+			if (Storage::getInstance().getGamepadOptions().inputMode == INPUT_MODE_KEYBOARD)
+			{
+				const uint8_t id = static_cast<KeyboardReport*>(report)->reportId;
+				CHECK_EQ(hostUsb.lastReportSize, id == KEYBOARD_KEY_REPORT_ID ? sizeof(KeyboardReport::keycode) : sizeof(KeyboardReport::multimedia));
+			}
+			else
+			{
+				CHECK_EQ(hostUsb.lastReportSize, size);
+			}
+		}
+
+		// Unchanged reports are not sent again
+		const uint32_t resent = hostUsb.reportsSent;
+		send_report(report, size);
+		CHECK_EQ(hostUsb.reportsSent, resent);
+	}
+	HIDGeneric::disable();
+
+	// Larger than any descriptor allows
+	uint8_t oversized[CFG_TUD_ENDPOINT0_SIZE + 1] = { 1 };
+	const uint32_t sent = hostUsb.reportsSent;
+	send_report(oversized, sizeof(oversized));
+	CHECK_EQ(hostUsb.reportsSent, sent);
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20000;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	std::mt19937 rng(seed);
+
+	PinMappings& pins = Storage::getInstance().getPinMappings();
+	int32_t* gamepadPins[] =
+	{
+		&pins.pinDpadUp, &pins.pinDpadDown, &pins.pinDpadLeft, &pins.pinDpadRight,
+		&pins.pinButtonB1, &pins.pinButtonB2, &pins.pinButtonB3, &pins.pinButtonB4,
+		&pins.pinButtonL1, &pins.pinButtonR1, &pins.pinButtonL2, &pins.pinButtonR2,
+		&pins.pinButtonS1, &pins.pinButtonS2, &pins.pinButtonL3, &pins.pinButtonR3,
+		&pins.pinButtonA1, &pins.pinButtonA2,
+	};
+	for (size_t i = 0; i < sizeof(gamepadPins) / sizeof(gamepadPins[0]); i++)
+		*gamepadPins[i] = i;
+	pins.pinButtonFn = -1;
+
+	// Lives as long as in the firmware, its pin mappings are never freed
+	static Gamepad gamepad;
+	gamepad.setup();
+
+	testDescriptors(gamepad);
+	testEncoders(gamepad, rng, iterations);
+	testSharedPinSnapshot(gamepad, rng, iterations / 16);
+	testGenericReports(rng, iterations);
+	testGetReport(rng, iterations);
+	testSetReport(rng, iterations);
+	testXInputOut(rng, iterations);
+	testSendReport(gamepad, rng, iterations);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("report encoders: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
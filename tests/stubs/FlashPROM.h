@@ -0,0 +1,6 @@
+#ifndef FLASHPROM_H_
+#define FLASHPROM_H_
+
+// Nothing on the host writes to flash
+
+#endif
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "tusb.h"
+
+// Class drivers the application adds to the stack, read once by tud_init()
+const usbd_class_driver_t* usbd_app_driver_get_cb(uint8_t* driver_count);
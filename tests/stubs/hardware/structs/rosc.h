@@ -0,0 +1,21 @@
+#pragma once
+
+// Host stand-in for the ring oscillator. Every read of randombit takes the next bit from
+// host_rosc_randombit(), which the test provides.
+
+#include <stdint.h>
+
+uint32_t host_rosc_randombit(void);
+
+struct host_rosc_randombit_reg
+{
+	operator uint32_t() const { return host_rosc_randombit(); }
+};
+
+typedef struct
+{
+	host_rosc_randombit_reg randombit;
+} rosc_hw_t;
+
+static rosc_hw_t host_rosc_hw;
+#define rosc_hw (&host_rosc_hw)
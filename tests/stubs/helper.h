@@ -0,0 +1,11 @@
+#ifndef _HELPER_H_
+#define _HELPER_H_
+
+// Only the pin helper, the real header drags in the LED and animation libraries
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+static inline bool isValidPin(int32_t pin) { return pin >= 0 && pin < NUM_BANK0_GPIOS; }
+
+#endif
@@ -0,0 +1,5 @@
+#include "pico/stdlib.h"
+
+uint64_t host_time_us = 0;
+// Pulled up, nothing pressed
+uint32_t host_gpio_pins = 0xffffffff;
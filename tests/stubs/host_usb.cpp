@@ -0,0 +1,103 @@
+#include "host_usb.h"
+
+#include "tusb.h"
+#include "gamepad/GamepadDescriptors.h"
+#include "hid_driver.h"
+#include "net_driver.h"
+#include "ps4_driver.h"
+
+HostUsb hostUsb;
+
+uint16_t HostUsb::completeOut(const uint8_t* data, uint16_t size)
+{
+	if (outBuffer == nullptr)
+		return 0;
+
+	const uint16_t transferred = size < outSize ? size : outSize;
+	memcpy(outBuffer, data, transferred);
+	outBuffer = nullptr;
+	return transferred;
+}
+
+/* TinyUSB */
+
+bool tud_init(uint8_t) { return true; }
+bool tud_ready(void) { return hostUsb.ready && !hostUsb.suspended; }
+bool tud_suspended(void) { return hostUsb.suspended; }
+bool tud_remote_wakeup(void) { hostUsb.remoteWakeups++; return hostUsb.suspended; }
+bool tud_connect(void) { hostUsb.connected = true; hostUsb.connects++; return true; }
+bool tud_disconnect(void) { hostUsb.connected = false; hostUsb.disconnects++; return true; }
+
+bool tud_hid_report(uint8_t report_id, void const*, uint16_t len)
+{
+	hostUsb.reportsSent++;
+	hostUsb.lastReportId = report_id;
+	hostUsb.lastReportSize = len;
+	return true;
+}
+
+bool usbd_edpt_open(uint8_t, tusb_desc_endpoint_t const*) { hostUsb.endpointsOpened++; return true; }
+bool usbd_edpt_busy(uint8_t, uint8_t ep_addr) { return ep_addr == hostUsb.outEndpoint && hostUsb.outBuffer != nullptr; }
+bool usbd_edpt_claim(uint8_t, uint8_t) { return true; }
+bool usbd_edpt_release(uint8_t, uint8_t) { return true; }
+
+bool usbd_edpt_xfer(uint8_t, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes)
+{
+	if (tu_edpt_dir(ep_addr) == TUSB_DIR_IN)
+		return tud_hid_report(0, buffer, total_bytes);
+
+	hostUsb.outEndpoint = ep_addr;
+	hostUsb.outBuffer = buffer;
+	hostUsb.outSize = total_bytes;
+	return true;
+}
+
+/* Class drivers other than XInput, only their report entry points are exercised */
+
+static void driver_init(void) {}
+template <const usbd_class_driver_t* driver>
+static void driver_reset(uint8_t) { hostUsb.lastDriver = driver; }
+template <const usbd_class_driver_t* driver>
+static uint16_t driver_open(uint8_t, tusb_desc_interface_t const*, uint16_t) { hostUsb.lastDriver = driver; return 0; }
+static bool driver_control_xfer_cb(uint8_t, uint8_t, tusb_control_request_t const*) { return true; }
+static bool driver_xfer_cb(uint8_t, uint8_t, xfer_result_t, uint32_t) { return true; }
+
+#define HOST_CLASS_DRIVER(_driver) \
+	{ driver_init, driver_reset<&_driver>, driver_open<&_driver>, driver_control_xfer_cb, driver_xfer_cb, NULL }
+
+const usbd_class_driver_t hid_driver = HOST_CLASS_DRIVER(hid_driver);
+const usbd_class_driver_t ps4_driver = HOST_CLASS_DRIVER(ps4_driver);
+const usbd_class_driver_t net_driver = HOST_CLASS_DRIVER(net_driver);
+
+const uint8_t tud_network_mac_address[6] = { 0x02, 0x02, 0x84, 0x6a, 0x96, 0x00 };
+
+bool send_hid_report(uint8_t report_id, void *report, uint8_t report_size)
+{
+	return tud_hid_report(report_id, report, report_size);
+}
+
+bool send_keyboard_report(void *report)
+{
+	KeyboardReport *keyboard_report = ((KeyboardReport *)report);
+	if (keyboard_report->reportId == KEYBOARD_KEY_REPORT_ID)
+		return tud_hid_report(keyboard_report->reportId, keyboard_report->keycode, sizeof(KeyboardReport::keycode));
+	return tud_hid_report(keyboard_report->reportId, &keyboard_report->multimedia, sizeof(KeyboardReport::multimedia));
+}
+
+bool send_hid_instance_report(uint8_t, void *report, uint8_t report_size)
+{
+	return tud_hid_report(0, report, report_size);
+}
+
+// The auth replies are the PS4 driver's business, answer with the largest page it sends
+ssize_t get_ps4_report(uint8_t report_id, uint8_t * buf, uint16_t reqlen)
+{
+	if (report_id != PS4AuthReport::PS4_GET_SIGNATURE_NONCE)
+		return -1;
+
+	const uint16_t size = reqlen < 63 ? reqlen : 63;
+	memset(buf, report_id, size);
+	return 63;
+}
+
+void set_ps4_report(uint8_t, uint8_t const *, uint16_t) {}
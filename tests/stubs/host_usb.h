@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "device/usbd_pvt.h"
+
+// What the gamepad drivers handed to the stand-in USB stack
+
+struct HostUsb
+{
+	bool ready = true;
+	bool suspended = false;
+
+	// Pull-up state, tud_disconnect() and tud_connect() detach from and reattach to the bus
+	bool connected = true;
+	uint32_t disconnects = 0;
+	uint32_t connects = 0;
+
+	// Stand-in class driver last reset or opened, XInput is the real driver and opens its endpoints instead
+	const usbd_class_driver_t* lastDriver = nullptr;
+	uint32_t endpointsOpened = 0;
+
+	// Resume signalling requested by the device, the bus stays suspended until the host resumes it
+	uint32_t remoteWakeups = 0;
+
+	// Last IN report, from send_report or the SET_REPORT echo
+	uint32_t reportsSent = 0;
+	uint8_t lastReportId = 0;
+	uint16_t lastReportSize = 0;
+
+	// OUT transfer queued by a driver, completeOut() fills it like the host would
+	uint8_t outEndpoint = 0;
+	uint8_t* outBuffer = nullptr;
+	uint16_t outSize = 0;
+
+	// Copies up to the queued size and returns the number of bytes transferred
+	uint16_t completeOut(const uint8_t* data, uint16_t size);
+};
+
+extern HostUsb hostUsb;
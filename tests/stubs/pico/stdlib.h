@@ -0,0 +1,33 @@
+#pragma once
+
+// Host stand-in for the parts of the pico-sdk the tested sources use.
+// Time comes from a counter the tests advance themselves.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define NUM_BANK0_GPIOS 30
+
+typedef uint64_t absolute_time_t;
+
+extern uint64_t host_time_us;
+extern uint32_t host_gpio_pins;
+
+static inline absolute_time_t get_absolute_time(void) { return host_time_us; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return static_cast<uint32_t>(t / 1000); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return host_time_us + ms * 1000ull; }
+static inline bool time_reached(absolute_time_t t) { return host_time_us >= t; }
+
+#define GPIO_IN 0
+#define GPIO_OUT 1
+
+static inline uint32_t gpio_get_all(void) { return host_gpio_pins; }
+static inline bool gpio_get(uint32_t gpio) { return host_gpio_pins & (1u << gpio); }
+static inline void gpio_put(uint32_t, bool) {}
+static inline void gpio_init(uint32_t) {}
+static inline void gpio_deinit(uint32_t) {}
+static inline void gpio_set_dir(uint32_t, bool) {}
+static inline void gpio_pull_up(uint32_t) {}
+static inline void gpio_init_mask(uint32_t) {}
@@ -0,0 +1,73 @@
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+// Host stand-in for Storage: the config lives in memory and events are only counted, the last one is kept
+
+#include <stdint.h>
+#include <string.h>
+
+#include "helper.h"
+#include "gamepad.h"
+#include "crosscore.h"
+
+#include "config.pb.h"
+
+class Storage {
+public:
+	Storage(Storage const&) = delete;
+	void operator=(Storage const&)  = delete;
+	static Storage& getInstance()
+	{
+		static Storage instance;
+		return instance;
+	}
+
+	Config& getConfig() { return config; }
+	GamepadOptions& getGamepadOptions() { return config.gamepadOptions; }
+	HotkeyOptions& getHotkeyOptions() { return config.hotkeyOptions; }
+	ForcedSetupOptions& getForcedSetupOptions() { return config.forcedSetupOptions; }
+	PinMappings& getPinMappings() { return config.pinMappings; }
+	PinMappings& getProfilePinMappings() { return config.pinMappings; }
+	KeyboardMapping& getKeyboardMapping() { return config.keyboardMapping; }
+	AddonOptions& getAddonOptions() { return config.addonOptions; }
+
+	bool save() { return true; }
+	void setProfile(const uint32_t) {}
+	bool PushGamepadEvent(const GamepadEvent& event)
+	{
+		if (eventQueueFull)
+			return false;
+		events++;
+		lastEvent = event;
+		return true;
+	}
+	void SetGamepad(Gamepad* gamepad) { this->gamepad = gamepad; }
+	Gamepad* GetGamepad() { return gamepad; }
+	struct PS4KeyCache
+	{
+		uint8_t rsaD[256];
+		uint8_t rsaDP[128];
+		uint8_t rsaDQ[128];
+		uint8_t rsaQP[128];
+	};
+	void enqueuePS4KeyCacheSave(const PS4KeyCache& keyCache)
+	{
+		ps4KeyCacheSaves++;
+		lastPS4KeyCache = keyCache;
+	}
+	void ClearFeatureData() { memset(featureData, 0, sizeof(featureData)); }
+	uint8_t* GetFeatureData() { return featureData; }
+
+	uint32_t events = 0;
+	GamepadEvent lastEvent = { };
+	bool eventQueueFull = false;
+	uint32_t ps4KeyCacheSaves = 0;
+	PS4KeyCache lastPS4KeyCache = { };
+private:
+	Storage() {}
+	Config config = Config_init_default;
+	Gamepad* gamepad = nullptr;
+	uint8_t featureData[32] = { };
+};
+
+#endif
@@ -0,0 +1,222 @@
+#pragma once
+
+// Host stand-in for the TinyUSB device API used by the gamepad drivers.
+// Calls into the stack are recorded so tests can check what would have gone out.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "tusb_config.h"
+#include "pico/stdlib.h"
+
+#define TUD_OPT_RHPORT 0
+#define TU_MIN(_a, _b) ((_a) < (_b) ? (_a) : (_b))
+#define TU_VERIFY(_cond, _ret) do { if (!(_cond)) return _ret; } while (0)
+#define TU_ASSERT(_cond) TU_VERIFY(_cond, 0)
+#define TU_ARRAY_SIZE(_arr) (sizeof(_arr) / sizeof(_arr[0]))
+
+#define TUSB_DESC_DEVICE        0x01
+#define TUSB_DESC_CONFIGURATION 0x02
+#define TUSB_DESC_STRING        0x03
+#define TUSB_DESC_INTERFACE     0x04
+#define TUSB_DESC_ENDPOINT      0x05
+#define TUSB_DESC_INTERFACE_ASSOCIATION 0x0B
+#define TUSB_DESC_CS_INTERFACE  0x24
+#define TUSB_DIR_IN 1
+
+#define TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP 0x20
+
+#define HID_ITF_PROTOCOL_NONE     0
+#define HID_ITF_PROTOCOL_KEYBOARD 1
+
+#define HID_KEY_CONTROL_LEFT  0xE0
+#define HID_KEY_SHIFT_LEFT    0xE1
+#define HID_KEY_ALT_LEFT      0xE2
+#define HID_KEY_GUI_LEFT      0xE3
+#define HID_KEY_CONTROL_RIGHT 0xE4
+#define HID_KEY_SHIFT_RIGHT   0xE5
+#define HID_KEY_ALT_RIGHT     0xE6
+#define HID_KEY_GUI_RIGHT     0xE7
+
+#define KEYBOARD_MODIFIER_LEFTCTRL   (1 << 0)
+#define KEYBOARD_MODIFIER_LEFTSHIFT  (1 << 1)
+#define KEYBOARD_MODIFIER_LEFTALT    (1 << 2)
+#define KEYBOARD_MODIFIER_LEFTGUI    (1 << 3)
+#define KEYBOARD_MODIFIER_RIGHTCTRL  (1 << 4)
+#define KEYBOARD_MODIFIER_RIGHTSHIFT (1 << 5)
+#define KEYBOARD_MODIFIER_RIGHTALT   (1 << 6)
+#define KEYBOARD_MODIFIER_RIGHTGUI   (1 << 7)
+
+#define U16_TO_U8S_LE(_u16) (uint8_t) ((_u16) & 0xff), (uint8_t) (((_u16) >> 8) & 0xff)
+
+#define TUD_CONFIG_DESC_LEN 9
+#define TUD_HID_DESC_LEN    (9 + 9 + 7)
+
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+	9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, 0x80 | (_attribute), (_power_ma) / 2
+
+#define TUD_HID_DESCRIPTOR(_itfnum, _stridx, _boot_protocol, _report_desc_len, _epin, _epsize, _ep_interval) \
+	9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, 0x03, (uint8_t) ((_boot_protocol) ? 1 : 0), _boot_protocol, _stridx, \
+	9, 0x21, U16_TO_U8S_LE(0x0111), 0, 1, 0x22, U16_TO_U8S_LE(_report_desc_len), \
+	7, TUSB_DESC_ENDPOINT, _epin, 0x03, U16_TO_U8S_LE(_epsize), _ep_interval
+
+// Network interfaces of the web config mode, laid out like TinyUSB's
+#define TUSB_CLASS_CDC                  0x02
+#define TUSB_CLASS_CDC_DATA             0x0A
+#define TUSB_CLASS_WIRELESS_CONTROLLER  0xE0
+#define TUSB_CLASS_MISC                 0xEF
+#define MISC_SUBCLASS_COMMON            0x02
+#define MISC_PROTOCOL_IAD               0x01
+#define TUSB_XFER_BULK                  0x02
+#define TUSB_XFER_INTERRUPT             0x03
+
+#define TUD_RNDIS_DESC_LEN   (8 + 9 + 5 + 5 + 4 + 5 + 7 + 9 + 7 + 7)
+#define TUD_CDC_ECM_DESC_LEN (8 + 9 + 5 + 5 + 13 + 7 + 9 + 9 + 7 + 7)
+
+#define TUD_RNDIS_DESCRIPTOR(_itfnum, _stridx, _ep_notif, _ep_notif_size, _epout, _epin, _epsize) \
+	8, TUSB_DESC_INTERFACE_ASSOCIATION, _itfnum, 2, TUSB_CLASS_WIRELESS_CONTROLLER, 0x01, 0x03, 0, \
+	9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_WIRELESS_CONTROLLER, 0x01, 0x03, _stridx, \
+	5, TUSB_DESC_CS_INTERFACE, 0x00, U16_TO_U8S_LE(0x0110), \
+	5, TUSB_DESC_CS_INTERFACE, 0x01, 0, (uint8_t) ((_itfnum) + 1), \
+	4, TUSB_DESC_CS_INTERFACE, 0x02, 0, \
+	5, TUSB_DESC_CS_INTERFACE, 0x06, _itfnum, (uint8_t) ((_itfnum) + 1), \
+	7, TUSB_DESC_ENDPOINT, _ep_notif, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_ep_notif_size), 1, \
+	9, TUSB_DESC_INTERFACE, (uint8_t) ((_itfnum) + 1), 0, 2, TUSB_CLASS_CDC_DATA, 0, 0, 0, \
+	7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0, \
+	7, TUSB_DESC_ENDPOINT, _epout, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0
+
+#define TUD_CDC_ECM_DESCRIPTOR(_itfnum, _desc_stridx, _mac_stridx, _ep_notif, _ep_notif_size, _epout, _epin, _epsize, _maxsegmentsize) \
+	8, TUSB_DESC_INTERFACE_ASSOCIATION, _itfnum, 2, TUSB_CLASS_CDC, 0x06, 0, 0, \
+	9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_CDC, 0x06, 0, _desc_stridx, \
+	5, TUSB_DESC_CS_INTERFACE, 0x00, U16_TO_U8S_LE(0x0120), \
+	5, TUSB_DESC_CS_INTERFACE, 0x06, _itfnum, (uint8_t) ((_itfnum) + 1), \
+	13, TUSB_DESC_CS_INTERFACE, 0x0F, _mac_stridx, 0, 0, 0, 0, U16_TO_U8S_LE(_maxsegmentsize), U16_TO_U8S_LE(0), 0, \
+	7, TUSB_DESC_ENDPOINT, _ep_notif, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_ep_notif_size), 1, \
+	9, TUSB_DESC_INTERFACE, (uint8_t) ((_itfnum) + 1), 0, 0, TUSB_CLASS_CDC_DATA, 0, 0, 0, \
+	9, TUSB_DESC_INTERFACE, (uint8_t) ((_itfnum) + 1), 1, 2, TUSB_CLASS_CDC_DATA, 0, 0, 0, \
+	7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0, \
+	7, TUSB_DESC_ENDPOINT, _epout, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0
+
+typedef enum
+{
+	XFER_RESULT_SUCCESS,
+	XFER_RESULT_FAILED,
+	XFER_RESULT_STALLED,
+	XFER_RESULT_TIMEOUT,
+	XFER_RESULT_INVALID,
+} xfer_result_t;
+
+typedef enum
+{
+	HID_REPORT_TYPE_INVALID,
+	HID_REPORT_TYPE_INPUT,
+	HID_REPORT_TYPE_OUTPUT,
+	HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+typedef struct
+{
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bInterfaceNumber;
+	uint8_t bAlternateSetting;
+	uint8_t bNumEndpoints;
+	uint8_t bInterfaceClass;
+	uint8_t bInterfaceSubClass;
+	uint8_t bInterfaceProtocol;
+	uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint16_t bcdUSB;
+	uint8_t bDeviceClass;
+	uint8_t bDeviceSubClass;
+	uint8_t bDeviceProtocol;
+	uint8_t bMaxPacketSize0;
+	uint16_t idVendor;
+	uint16_t idProduct;
+	uint16_t bcdDevice;
+	uint8_t iManufacturer;
+	uint8_t iProduct;
+	uint8_t iSerialNumber;
+	uint8_t bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bEndpointAddress;
+	uint8_t bmAttributes;
+	uint16_t wMaxPacketSize;
+	uint8_t bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct
+{
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	uint16_t wValue;
+	uint16_t wIndex;
+	uint16_t wLength;
+} tusb_control_request_t;
+
+typedef struct
+{
+#if CFG_TUSB_DEBUG >= 2
+	char const* name;
+#endif
+	void     (* init             ) (void);
+	void     (* reset            ) (uint8_t rhport);
+	uint16_t (* open             ) (uint8_t rhport, tusb_desc_interface_t const * desc_intf, uint16_t max_len);
+	bool     (* control_xfer_cb  ) (uint8_t rhport, uint8_t stage, tusb_control_request_t const * request);
+	bool     (* xfer_cb          ) (uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes);
+	void     (* sof              ) (uint8_t rhport, uint32_t frame_count);
+} usbd_class_driver_t;
+
+bool tud_init(uint8_t rhport);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+bool tud_connect(void);
+bool tud_disconnect(void);
+bool tud_hid_report(uint8_t report_id, void const* report, uint16_t len);
+bool tud_ready(void);
+
+// Device callbacks, implemented in tusb_driver.cpp
+void tud_mount_cb(void);
+void tud_umount_cb(void);
+void tud_suspend_cb(bool remote_wakeup_en);
+void tud_resume_cb(void);
+
+bool usbd_edpt_open(uint8_t rhport, tusb_desc_endpoint_t const* desc_ep);
+bool usbd_edpt_busy(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_claim(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_release(uint8_t rhport, uint8_t ep_addr);
+bool usbd_edpt_xfer(uint8_t rhport, uint8_t ep_addr, uint8_t* buffer, uint16_t total_bytes);
+
+static inline uint8_t const* tu_desc_next(void const* desc)
+{
+	uint8_t const* desc8 = (uint8_t const*) desc;
+	return desc8 + desc8[0];
+}
+
+static inline uint8_t tu_desc_type(void const* desc) { return ((uint8_t const*) desc)[1]; }
+static inline uint8_t tu_edpt_dir(uint8_t addr) { return (addr >> 7) & 1; }
+
+// MAC address of the web config network interface, TinyUSB leaves it to the application
+extern const uint8_t tud_network_mac_address[6];
+
+// Descriptor callbacks, implemented in usb_descriptors.cpp
+uint8_t const* tud_descriptor_device_cb(void);
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index);
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid);
+uint8_t const* tud_hid_descriptor_report_cb(uint8_t itf);
+
+// Application callbacks the HID class driver invokes
+uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen);
+void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t const* buffer, uint16_t bufsize);
@@ -0,0 +1,19 @@
+#ifndef _TUSB_CONFIG_H_
+#define _TUSB_CONFIG_H_
+
+#define CFG_TUSB_DEBUG         0
+#define CFG_TUD_ENDPOINT0_SIZE 64
+#define CFG_TUD_HID_EP_BUFSIZE 64
+
+// Same classes as the firmware, the web config mode runs RNDIS and CDC-ECM
+#define CFG_TUD_CDC               0
+#define CFG_TUD_MSC               0
+#define CFG_TUD_HID               3
+#define CFG_TUD_MIDI              0
+#define CFG_TUD_VENDOR            0
+#define CFG_TUD_ECM_RNDIS         1
+#define CFG_TUD_NCM               0
+#define CFG_TUD_NET_ENDPOINT_SIZE 64
+#define CFG_TUD_NET_MTU           1514
+
+#endif
@@ -0,0 +1,241 @@
+// Drives the tilt add-on through random stick factors, tilt buttons and directions and compares the stick
+// output from its precomputed tables against the double precision formula it replaced. Integer and double
+// rounding may differ by one step.
+//
+// Usage: tilt_test [iterations] [seed]
+
+#include "addons/tilt.h"
+#include "storagemanager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+
+#define PIN_TILT1 18
+#define PIN_TILT2 19
+#define PIN_LEFT_STICK 20  // up, down, left, right
+#define PIN_RIGHT_STICK 24 // up, down, left, right
+
+// Left and right sticks are left alone when both tilt buttons are held
+#define UNTOUCHED 0x1234
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ < e_ - (tolerance) || a_ > e_ + (tolerance)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+struct Factors
+{
+	double leftX[2], leftY[2];
+	double rightX[2], rightY[2];
+};
+
+// The conversion the old code did implicitly, limited to the axis range where it was defined
+static uint16_t toAxis(double value)
+{
+	return value < GAMEPAD_JOYSTICK_MIN ? GAMEPAD_JOYSTICK_MIN : (value > GAMEPAD_JOYSTICK_MAX ? GAMEPAD_JOYSTICK_MAX : (uint16_t)value);
+}
+
+static double towardCenter(uint16_t value, double factor)
+{
+	return value + (GAMEPAD_JOYSTICK_MID - value) * factor;
+}
+
+// TiltInput::OverrideGamepad() before the tables, tilt is 0 without a tilt button, 1 or 2 otherwise
+static void expectedOutput(const Factors& factors, int tilt, bool bothTilts, uint8_t dpad1, uint8_t dpad2, GamepadState& state)
+{
+	if (tilt > 0) {
+		state.lx = toAxis(towardCenter(dpadToAnalogX(dpad1), factors.leftX[tilt - 1]));
+		state.ly = toAxis(towardCenter(dpadToAnalogY(dpad1), factors.leftY[tilt - 1]));
+	}
+	else {
+		state.lx = dpadToAnalogX(dpad1);
+		state.ly = dpadToAnalogY(dpad1);
+	}
+
+	if (bothTilts) {
+		state.dpad = dpad2;
+	}
+	else if (tilt > 0 && (dpad2 & (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT))) {
+		state.rx = toAxis(towardCenter(dpadToAnalogX(dpad2), factors.rightX[tilt - 1]));
+		state.ry = toAxis(GAMEPAD_JOYSTICK_MID * factors.rightY[tilt - 1]);
+	}
+	else {
+		state.rx = dpadToAnalogX(dpad2);
+		state.ry = dpadToAnalogY(dpad2);
+	}
+}
+
+// Neutral SOCD, the mode the tests set up
+static uint8_t cleanNeutral(uint8_t dpad)
+{
+	if ((dpad & (GAMEPAD_MASK_UP | GAMEPAD_MASK_DOWN)) == (GAMEPAD_MASK_UP | GAMEPAD_MASK_DOWN))
+		dpad &= ~(GAMEPAD_MASK_UP | GAMEPAD_MASK_DOWN);
+	if ((dpad & (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT)) == (GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT))
+		dpad &= ~(GAMEPAD_MASK_LEFT | GAMEPAD_MASK_RIGHT);
+	return dpad;
+}
+
+static uint32_t stickPins(uint32_t firstPin, uint8_t dpad)
+{
+	const uint8_t masks[] = { GAMEPAD_MASK_UP, GAMEPAD_MASK_DOWN, GAMEPAD_MASK_LEFT, GAMEPAD_MASK_RIGHT };
+	uint32_t pins = 0;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		if (dpad & masks[i])
+			pins |= 1u << (firstPin + i);
+	}
+	return pins;
+}
+
+// Runs every tilt button and direction combination through a freshly set up add-on
+static void testFactors(Gamepad& gamepad, const uint32_t (&q15)[8], const Factors& factors)
+{
+	TiltOptions& options = Storage::getInstance().getAddonOptions().tiltOptions;
+	options.tilt1FactorLeftX = q15[0];
+	options.tilt1FactorLeftY = q15[1];
+	options.tilt2FactorLeftX = q15[2];
+	options.tilt2FactorLeftY = q15[3];
+	options.tilt1FactorRightX = q15[4];
+	options.tilt1FactorRightY = q15[5];
+	options.tilt2FactorRightX = q15[6];
+	options.tilt2FactorRightY = q15[7];
+
+	TiltInput tilt;
+	tilt.setup();
+
+	for (uint32_t buttons = 0; buttons < 4; buttons++)
+	{
+		const bool tilt1 = buttons & 1;
+		const bool tilt2 = buttons & 2;
+		for (uint8_t left = 0; left < TILT_DIRECTION_COUNT; left++)
+		{
+			for (uint8_t right = 0; right < TILT_DIRECTION_COUNT; right++)
+			{
+				gamepad.debouncedPins = (tilt1 ? 1u << PIN_TILT1 : 0) | (tilt2 ? 1u << PIN_TILT2 : 0) |
+					stickPins(PIN_LEFT_STICK, left) | stickPins(PIN_RIGHT_STICK, right);
+				gamepad.state = GamepadState();
+				gamepad.state.rx = UNTOUCHED;
+				gamepad.state.ry = UNTOUCHED;
+
+				GamepadState expected = gamepad.state;
+				expectedOutput(factors, tilt1 ? 1 : (tilt2 ? 2 : 0), tilt1 && tilt2, cleanNeutral(left), right, expected);
+
+				tilt.preprocess();
+				tilt.process();
+
+				CHECK_NEAR(gamepad.state.lx, expected.lx, 1);
+				CHECK_NEAR(gamepad.state.ly, expected.ly, 1);
+				CHECK_NEAR(gamepad.state.rx, expected.rx, 1);
+				CHECK_NEAR(gamepad.state.ry, expected.ry, 1);
+				CHECK_EQ(gamepad.state.dpad, expected.dpad);
+			}
+		}
+	}
+}
+
+// The defaults are the old constants rounded to Q15
+static void testDefaults(Gamepad& gamepad)
+{
+	const uint32_t q15[8] = {
+		TILT1_FACTOR_LEFT_X, TILT1_FACTOR_LEFT_Y, TILT2_FACTOR_LEFT_X, TILT2_FACTOR_LEFT_Y,
+		TILT1_FACTOR_RIGHT_X, TILT1_FACTOR_RIGHT_Y, TILT2_FACTOR_RIGHT_X, TILT2_FACTOR_RIGHT_Y,
+	};
+	const Factors factors = {
+		{ 0.35, 0.65 }, { 0.45, 0.35 },
+		{ 0.3, 0.3 }, { 1.7, 0.3 },
+	};
+	testFactors(gamepad, q15, factors);
+}
+
+// Anything the web config accepts, 0 up to just under 2.0
+static void testRandomFactors(Gamepad& gamepad, std::mt19937& rng, uint32_t iterations)
+{
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		uint32_t q15[8];
+		for (uint32_t& factor : q15)
+			factor = (rng() & 3) == 0 ? (rng() & 1) * TILT_FACTOR_ONE : rng() % 65536;
+
+		const Factors factors = {
+			{ q15[0] / (double)TILT_FACTOR_ONE, q15[2] / (double)TILT_FACTOR_ONE },
+			{ q15[1] / (double)TILT_FACTOR_ONE, q15[3] / (double)TILT_FACTOR_ONE },
+			{ q15[4] / (double)TILT_FACTOR_ONE, q15[6] / (double)TILT_FACTOR_ONE },
+			{ q15[5] / (double)TILT_FACTOR_ONE, q15[7] / (double)TILT_FACTOR_ONE },
+		};
+		testFactors(gamepad, q15, factors);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 200;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	std::mt19937 rng(seed);
+
+	PinMappings& pins = Storage::getInstance().getPinMappings();
+	int32_t* gamepadPins[] =
+	{
+		&pins.pinDpadUp, &pins.pinDpadDown, &pins.pinDpadLeft, &pins.pinDpadRight,
+		&pins.pinButtonB1, &pins.pinButtonB2, &pins.pinButtonB3, &pins.pinButtonB4,
+		&pins.pinButtonL1, &pins.pinButtonR1, &pins.pinButtonL2, &pins.pinButtonR2,
+		&pins.pinButtonS1, &pins.pinButtonS2, &pins.pinButtonL3, &pins.pinButtonR3,
+		&pins.pinButtonA1, &pins.pinButtonA2,
+	};
+	for (size_t i = 0; i < sizeof(gamepadPins) / sizeof(gamepadPins[0]); i++)
+		*gamepadPins[i] = i;
+	pins.pinButtonFn = -1;
+
+	TiltOptions& options = Storage::getInstance().getAddonOptions().tiltOptions;
+	options.enabled = true;
+	options.tiltSOCDMode = SOCD_MODE_NEUTRAL;
+	options.tilt1Pin = PIN_TILT1;
+	options.tilt2Pin = PIN_TILT2;
+	options.tiltLeftAnalogUpPin = PIN_LEFT_STICK;
+	options.tiltLeftAnalogDownPin = PIN_LEFT_STICK + 1;
+	options.tiltLeftAnalogLeftPin = PIN_LEFT_STICK + 2;
+	options.tiltLeftAnalogRightPin = PIN_LEFT_STICK + 3;
+	options.tiltRightAnalogUpPin = PIN_RIGHT_STICK;
+	options.tiltRightAnalogDownPin = PIN_RIGHT_STICK + 1;
+	options.tiltRightAnalogLeftPin = PIN_RIGHT_STICK + 2;
+	options.tiltRightAnalogRightPin = PIN_RIGHT_STICK + 3;
+
+	// Lives as long as in the firmware, its pin mappings are never freed
+	static Gamepad gamepad;
+	gamepad.setup();
+	Storage::getInstance().SetGamepad(&gamepad);
+
+	testDefaults(gamepad);
+	testRandomFactors(gamepad, rng, iterations);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("tilt tables: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
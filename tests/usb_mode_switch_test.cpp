@@ -0,0 +1,324 @@
+// Switches the input mode at runtime through switch_input_mode() and reconnect_usb() the way a hotkey, a
+// profile change, the input mode detector and the player number add-on do. Each switch has to detach,
+// reset the class driver of the old mode and only reattach once the host had time to notice. From then on
+// the device, configuration and HID report descriptors and the class driver behind the gamepad proxy all
+// have to be the ones of the new mode. A switch to the mode already running, or to web config, is refused
+// without touching the bus, and web config itself never switches or reconnects.
+//
+// Usage: usb_mode_switch_test [iterations] [seed]
+
+#include "usb_driver.h"
+#include "hid_driver.h"
+#include "net_driver.h"
+#include "ps4_driver.h"
+#include "xinput_driver.h"
+#include "host_usb.h"
+#include "GamepadDescriptors.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+
+// Minimum time the driver stays detached
+#define REATTACH_MS 100
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+// Output report with the lightbar colour, as a PS4 sends it
+#define PS4_OUTPUT_REPORT_ID 0x05
+#define PS4_OUTPUT_REPORT_SIZE 31
+
+static const InputMode gamepadModes[] =
+{
+	INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD,
+};
+
+static std::mt19937 rng;
+
+static void advanceMs(uint32_t ms)
+{
+	host_time_us += ms * 1000ull;
+	usb_reconnect_task();
+}
+
+// Which driver the proxy handed a call to: the XInput driver opens its endpoints or forgets its last LED
+// command, the stand-ins record themselves
+static const usbd_class_driver_t* expectedDriver(InputMode mode)
+{
+	switch (mode)
+	{
+		case INPUT_MODE_XINPUT:
+			return &xinput_driver;
+
+		case INPUT_MODE_PS4:
+			return &ps4_driver;
+
+		default:
+			return &hid_driver;
+	}
+}
+
+static void checkReset(InputMode mode)
+{
+	if (mode == INPUT_MODE_XINPUT)
+	{
+		CHECK(hostUsb.lastDriver == nullptr);
+		CHECK_EQ(xinput_out_buffer[0], 0);
+	}
+	else
+	{
+		CHECK(hostUsb.lastDriver == expectedDriver(mode));
+		CHECK_EQ(xinput_out_buffer[0], 0xff);
+	}
+}
+
+static void prepareReset()
+{
+	hostUsb.lastDriver = nullptr;
+	xinput_out_buffer[0] = 0xff;
+}
+
+// Everything the host reads while enumerating, and the driver it ends up talking to
+static void checkMode(InputMode mode)
+{
+	CHECK_EQ(get_input_mode(), mode);
+
+	// The descriptor tables are static in the header, so each source file has its own copy
+	uint16_t size = 0;
+	const uint8_t* expected = getDeviceDescriptor(&size, mode);
+	CHECK(memcmp(tud_descriptor_device_cb(), expected, size) == 0);
+	if (mode != INPUT_MODE_XINPUT)
+	{
+		expected = getHIDReport(&size, mode);
+		CHECK(memcmp(tud_hid_descriptor_report_cb(0), expected, size) == 0);
+	}
+	const uint8_t* configuration = tud_descriptor_configuration_cb(0);
+	expected = getConfigurationDescriptor(&size, mode);
+	CHECK(memcmp(configuration, expected, size) == 0);
+
+	uint8_t driverCount = 0;
+	const usbd_class_driver_t* driver = usbd_app_driver_get_cb(&driverCount);
+	CHECK_EQ(driverCount, 1);
+	CHECK(driver != &net_driver);
+
+	// The first interface of the configuration, like the stack opens it after SET_CONFIGURATION
+	hostUsb.lastDriver = nullptr;
+	hostUsb.endpointsOpened = 0;
+	const tusb_desc_interface_t* itf = reinterpret_cast<const tusb_desc_interface_t*>(&configuration[9]);
+	const uint16_t opened = driver->open(0, itf, size - 9);
+	if (mode == INPUT_MODE_XINPUT)
+	{
+		CHECK(opened > 0);
+		CHECK(hostUsb.lastDriver == nullptr);
+		CHECK(hostUsb.endpointsOpened > 0);
+	}
+	else
+	{
+		CHECK(hostUsb.lastDriver == expectedDriver(mode));
+		CHECK_EQ(hostUsb.endpointsOpened, 0);
+	}
+
+	prepareReset();
+	driver->reset(0);
+	checkReset(mode);
+}
+
+// A PS4 sets the lightbar once it has the controller, nothing else does
+static void setLightbar()
+{
+	uint8_t report[PS4_OUTPUT_REPORT_SIZE] = { PS4_OUTPUT_REPORT_ID };
+	report[6] = 0x40;
+	tud_hid_set_report_cb(0, 0, HID_REPORT_TYPE_OUTPUT, report, sizeof(report));
+
+	uint8_t rgb[3];
+	CHECK_EQ(get_ps4_lightbar(rgb), get_input_mode() == INPUT_MODE_PS4);
+}
+
+// The host mounts the controller and starts talking to it
+static void mount()
+{
+	tud_mount_cb();
+	CHECK(get_usb_mounted());
+	setLightbar();
+}
+
+// Detached until the wait is over, and no report may go out in the meantime
+static void checkReattach(uint32_t waitMs)
+{
+	const uint32_t connects = hostUsb.connects;
+	CHECK(!hostUsb.connected);
+	CHECK(!get_usb_mounted());
+	uint8_t rgb[3];
+	CHECK(!get_ps4_lightbar(rgb));
+
+	uint32_t waitedMs = 0;
+	while (waitedMs + 1 < waitMs)
+	{
+		const uint32_t stepMs = 1 + rng() % (waitMs - waitedMs - 1);
+		advanceMs(stepMs);
+		waitedMs += stepMs;
+		CHECK(!hostUsb.connected);
+
+		uint8_t report[CFG_TUD_ENDPOINT0_SIZE];
+		for (uint8_t& byte : report)
+			byte = rng();
+		const uint32_t reportsSent = hostUsb.reportsSent;
+		send_report(report, sizeof(report));
+		CHECK_EQ(hostUsb.reportsSent, reportsSent);
+	}
+
+	advanceMs(waitMs - waitedMs);
+	CHECK(hostUsb.connected);
+	CHECK_EQ(hostUsb.connects, connects + 1);
+}
+
+// Refused switches leave the bus and the mode alone
+static void checkRefused(InputMode mode)
+{
+	const InputMode current = get_input_mode();
+	const uint32_t disconnects = hostUsb.disconnects;
+	prepareReset();
+	CHECK(!switch_input_mode(mode));
+	CHECK_EQ(hostUsb.disconnects, disconnects);
+	CHECK(hostUsb.connected);
+	CHECK(get_usb_mounted());
+	CHECK(hostUsb.lastDriver == nullptr);
+	CHECK_EQ(xinput_out_buffer[0], 0xff);
+	checkMode(current);
+}
+
+// Optionally switched again to another mode before the host noticed, which starts the wait over
+static void testSwitch(InputMode mode, InputMode interruptMode = INPUT_MODE_CONFIG)
+{
+	const InputMode previous = get_input_mode();
+	const uint32_t disconnects = hostUsb.disconnects;
+	prepareReset();
+	CHECK(switch_input_mode(mode));
+	CHECK_EQ(hostUsb.disconnects, disconnects + 1);
+	checkReset(previous);
+
+	if (interruptMode != INPUT_MODE_CONFIG && interruptMode != mode)
+	{
+		advanceMs(rng() % REATTACH_MS);
+		prepareReset();
+		CHECK(switch_input_mode(interruptMode));
+		checkReset(mode);
+		mode = interruptMode;
+	}
+
+	checkReattach(REATTACH_MS);
+	checkMode(mode);
+	mount();
+}
+
+static void testReconnect(uint32_t delayMs)
+{
+	const InputMode mode = get_input_mode();
+	const uint32_t disconnects = hostUsb.disconnects;
+	prepareReset();
+	reconnect_usb(delayMs);
+	CHECK_EQ(hostUsb.disconnects, disconnects + 1);
+	checkReset(mode);
+
+	checkReattach(delayMs > REATTACH_MS ? delayMs : REATTACH_MS);
+	checkMode(mode);
+	mount();
+}
+
+static void testRandom(uint32_t iterations)
+{
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		const InputMode mode = gamepadModes[rng() % (sizeof(gamepadModes) / sizeof(gamepadModes[0]))];
+		switch (rng() % 4)
+		{
+			case 0:
+				checkRefused(INPUT_MODE_CONFIG);
+				break;
+			case 1:
+				testReconnect(rng() % 2 == 0 ? rng() % REATTACH_MS : rng() % 8000);
+				break;
+			default:
+				if (mode == get_input_mode())
+					checkRefused(mode);
+				else if (rng() % 4 == 0)
+					testSwitch(mode, gamepadModes[rng() % (sizeof(gamepadModes) / sizeof(gamepadModes[0]))]);
+				else
+					testSwitch(mode);
+				break;
+		}
+	}
+}
+
+// Booted into web config, the network driver and descriptors stay no matter what is asked for
+static void testWebConfig()
+{
+	initialize_driver(INPUT_MODE_CONFIG);
+	tud_mount_cb();
+
+	for (InputMode mode : gamepadModes)
+	{
+		const uint32_t disconnects = hostUsb.disconnects;
+		CHECK(!switch_input_mode(mode));
+		reconnect_usb(0);
+		CHECK_EQ(hostUsb.disconnects, disconnects);
+		CHECK_EQ(get_input_mode(), INPUT_MODE_CONFIG);
+
+		uint8_t driverCount = 0;
+		CHECK(usbd_app_driver_get_cb(&driverCount) == &net_driver);
+		const tusb_desc_device_t* device = reinterpret_cast<const tusb_desc_device_t*>(tud_descriptor_device_cb());
+		CHECK_EQ(device->bDeviceClass, TUSB_CLASS_MISC);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 500;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	rng.seed(seed);
+
+	initialize_driver(INPUT_MODE_XINPUT);
+	checkMode(INPUT_MODE_XINPUT);
+	mount();
+
+	// Every mode to every other one
+	for (InputMode from : gamepadModes)
+	{
+		for (InputMode to : gamepadModes)
+		{
+			if (from == to)
+				continue;
+			if (get_input_mode() != from)
+				testSwitch(from);
+			testSwitch(to);
+		}
+	}
+
+	testRandom(iterations);
+	testWebConfig();
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("usb mode switch: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
@@ -0,0 +1,272 @@
+// Replays random sequences of host suspends, resumes and button changes through send_report(), the
+// TinyUSB suspend callbacks and core0's UsbSuspendMonitor. Remote wakeup may only be signalled for a
+// changed report, once per suspend and only when the host allowed it. Core1 has to be told about every
+// change of the bus state, also when the event queue was full at first. Every configuration descriptor
+// has to advertise remote wakeup for the host to allow it.
+//
+// Usage: usb_suspend_test [iterations] [seed]
+
+#include "gamepad.h"
+#include "storagemanager.h"
+#include "usb_driver.h"
+#include "xinput_driver.h"
+#include "usbsuspendmonitor.h"
+#include "host_usb.h"
+#include "GamepadDescriptors.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+
+// Offset of bmAttributes in the configuration descriptor header
+#define CONFIG_ATTRIBUTES_OFFSET 7
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			if (failures++ < 20) \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const long long a_ = (actual), e_ = (expected); \
+		if (a_ != e_) { \
+			if (failures++ < 20) \
+				printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+		} \
+	} while (0)
+
+static void setInputMode(InputMode mode)
+{
+	Storage::getInstance().getGamepadOptions().inputMode = mode;
+	initialize_driver(mode);
+
+	// XInput reports only go out once the host has opened the interface
+	if (mode == INPUT_MODE_XINPUT)
+	{
+		const tusb_desc_interface_t* itf = reinterpret_cast<const tusb_desc_interface_t*>(&xinput_configuration_descriptor[9]);
+		CHECK(xinput_driver.open(0, itf, sizeof(xinput_configuration_descriptor) - 9) > 0);
+	}
+}
+
+static void checkRemoteWakeup(const uint8_t* descriptor)
+{
+	CHECK_EQ(descriptor[1], TUSB_DESC_CONFIGURATION);
+	CHECK(descriptor[CONFIG_ATTRIBUTES_OFFSET] & 0x80);
+	CHECK(descriptor[CONFIG_ATTRIBUTES_OFFSET] & TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP);
+}
+
+// The fixed descriptors of every mode and the generated generic HID and composite ones
+static void testDescriptors()
+{
+	const InputMode modes[] = { INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4, INPUT_MODE_KEYBOARD };
+	for (InputMode mode : modes)
+	{
+		uint16_t size;
+		checkRemoteWakeup(getConfigurationDescriptor(&size, mode));
+	}
+
+	for (bool generic : { false, true })
+	{
+		if (generic)
+		{
+			HIDGeneric::configure(HID_GENERIC_MAX_BUTTONS, HID_GENERIC_MAX_AXES, 16);
+			checkRemoteWakeup(HIDGeneric::getConfigurationDescriptor());
+		}
+		HIDComposite::configure();
+		uint16_t size;
+		checkRemoteWakeup(HIDComposite::getConfigurationDescriptor(&size));
+		HIDComposite::disable();
+		HIDGeneric::disable();
+	}
+}
+
+// What the firmware is expected to have done, kept next to the stand-in bus
+struct Model
+{
+	bool busSuspended = false;
+	bool wakeupAllowed = false;
+	bool wakeupSignalled = false;
+	uint32_t expectedWakeups = 0;
+};
+
+static void suspendBus(Model& model, bool remoteWakeup)
+{
+	hostUsb.suspended = true;
+	tud_suspend_cb(remoteWakeup);
+	model.busSuspended = true;
+	model.wakeupAllowed = remoteWakeup;
+	model.wakeupSignalled = false;
+}
+
+static void resumeBus(Model& model)
+{
+	hostUsb.suspended = false;
+	tud_resume_cb();
+	model.busSuspended = false;
+}
+
+// One pass of the core0 loop: read the buttons, send the report, then let the monitor look at the bus
+static void runLoop(Gamepad& gamepad, Model& model, UsbSuspendMonitor& monitor, std::vector<uint8_t>& lastSent, bool changeButtons)
+{
+	if (changeButtons)
+		gamepad.state.buttons ^= GAMEPAD_MASK_B1;
+
+	// Some reports carry a counter, so compare the bytes rather than the state
+	const uint8_t* report = static_cast<const uint8_t*>(gamepad.getReport());
+	const std::vector<uint8_t> bytes(report, report + gamepad.getReportSize());
+	const bool changed = bytes != lastSent;
+	const uint32_t sent = hostUsb.reportsSent;
+	send_report((void*)report, bytes.size());
+
+	if (model.busSuspended)
+	{
+		// Nothing goes out, a press wakes the host at most once per suspend
+		CHECK_EQ(hostUsb.reportsSent, sent);
+		if (changed && model.wakeupAllowed && !model.wakeupSignalled)
+		{
+			model.expectedWakeups++;
+			model.wakeupSignalled = true;
+		}
+	}
+	else
+	{
+		// Whatever changed while the bus was suspended goes out after the resume
+		CHECK_EQ(hostUsb.reportsSent, sent + (changed ? 1 : 0));
+		lastSent = bytes;
+	}
+	CHECK_EQ(hostUsb.remoteWakeups, model.expectedWakeups);
+
+	const uint32_t events = Storage::getInstance().events;
+	const bool wasSuspended = monitor.isSuspended();
+	const bool suspended = monitor.update(tud_suspended());
+	CHECK_EQ(suspended, monitor.isSuspended());
+	if (Storage::getInstance().eventQueueFull)
+	{
+		CHECK_EQ(suspended, wasSuspended);
+		CHECK_EQ(Storage::getInstance().events, events);
+	}
+	else
+	{
+		CHECK_EQ(suspended, model.busSuspended);
+		CHECK_EQ(Storage::getInstance().events, events + (suspended != wasSuspended ? 1 : 0));
+		if (suspended != wasSuspended)
+		{
+			const GamepadEventType type = suspended ? GamepadEventType::USB_SUSPEND : GamepadEventType::USB_RESUME;
+			CHECK(Storage::getInstance().lastEvent.type == type);
+		}
+	}
+}
+
+static void testSuspend(Gamepad& gamepad, std::mt19937& rng, uint32_t iterations)
+{
+	const InputMode modes[] = { INPUT_MODE_XINPUT, INPUT_MODE_SWITCH, INPUT_MODE_HID, INPUT_MODE_PS4 };
+	for (InputMode mode : modes)
+	{
+		setInputMode(mode);
+		tud_mount_cb();
+
+		Model model;
+		model.expectedWakeups = hostUsb.remoteWakeups;
+		UsbSuspendMonitor monitor;
+		gamepad.state = GamepadState();
+		std::vector<uint8_t> lastSent;
+		runLoop(gamepad, model, monitor, lastSent, true);
+
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			switch (rng() % 8)
+			{
+				case 0:
+					if (!model.busSuspended)
+						suspendBus(model, rng() & 1);
+					break;
+				case 1:
+					if (model.busSuspended)
+						resumeBus(model);
+					break;
+				case 2:
+					Storage::getInstance().eventQueueFull = !Storage::getInstance().eventQueueFull;
+					break;
+				default:
+					break;
+			}
+			runLoop(gamepad, model, monitor, lastSent, (rng() % 3) == 0);
+		}
+
+		// Once the queue drains core1 catches up with the bus
+		Storage::getInstance().eventQueueFull = false;
+		CHECK_EQ(monitor.update(tud_suspended()), model.busSuspended);
+
+		if (model.busSuspended)
+			resumeBus(model);
+		monitor.update(tud_suspended());
+		tud_umount_cb();
+	}
+}
+
+// A host that suspends without allowing remote wakeup is never woken, not even after an unmount
+static void testWakeupNotAllowed(Gamepad& gamepad)
+{
+	setInputMode(INPUT_MODE_HID);
+	tud_mount_cb();
+	gamepad.state = GamepadState();
+	send_report(gamepad.getReport(), gamepad.getReportSize());
+
+	hostUsb.suspended = true;
+	tud_suspend_cb(true);
+	tud_umount_cb();
+	const uint32_t wakeups = hostUsb.remoteWakeups;
+	gamepad.state.buttons ^= GAMEPAD_MASK_B2;
+	send_report(gamepad.getReport(), gamepad.getReportSize());
+	CHECK_EQ(hostUsb.remoteWakeups, wakeups);
+
+	tud_suspend_cb(false);
+	gamepad.state.buttons ^= GAMEPAD_MASK_B3;
+	send_report(gamepad.getReport(), gamepad.getReportSize());
+	CHECK_EQ(hostUsb.remoteWakeups, wakeups);
+
+	hostUsb.suspended = false;
+	tud_resume_cb();
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 20000;
+	const uint32_t seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2040;
+	std::mt19937 rng(seed);
+
+	PinMappings& pins = Storage::getInstance().getPinMappings();
+	int32_t* gamepadPins[] =
+	{
+		&pins.pinDpadUp, &pins.pinDpadDown, &pins.pinDpadLeft, &pins.pinDpadRight,
+		&pins.pinButtonB1, &pins.pinButtonB2, &pins.pinButtonB3, &pins.pinButtonB4,
+		&pins.pinButtonL1, &pins.pinButtonR1, &pins.pinButtonL2, &pins.pinButtonR2,
+		&pins.pinButtonS1, &pins.pinButtonS2, &pins.pinButtonL3, &pins.pinButtonR3,
+		&pins.pinButtonA1, &pins.pinButtonA2,
+	};
+	for (size_t i = 0; i < sizeof(gamepadPins) / sizeof(gamepadPins[0]); i++)
+		*gamepadPins[i] = i;
+	pins.pinButtonFn = -1;
+
+	// Lives as long as in the firmware, its pin mappings are never freed
+	static Gamepad gamepad;
+	gamepad.setup();
+
+	testDescriptors();
+	testSuspend(gamepad, rng, iterations);
+	testWakeupNotAllowed(gamepad);
+
+	if (failures > 0)
+	{
+		printf("%d checks failed (seed %u)\n", failures, seed);
+		return 1;
+	}
+	printf("usb suspend: %u iterations passed (seed %u)\n", iterations, seed);
+	return 0;
+}
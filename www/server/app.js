@@ -28,7 +28,7 @@ app.use((req, res, next) => {
 });
 
 app.get("/api/getUsedPins", (req, res) => {
-	return res.send({ usedPins: Object.values(picoController) });
+	return res.send({ usedPins: Object.values(picoController), pinConflicts: [] });
 });
 
 app.get("/api/resetSettings", (req, res) => {
@@ -93,6 +93,13 @@ app.get("/api/getGamepadOptions", (req, res) => {
 		fourWayMode: 0,
 		fnButtonPin: -1,
 		profileNumber: 1,
+		hidCustomLayout: 0,
+		hidButtonCount: 16,
+		hidAxisCount: 6,
+		hidAxisResolution: 16,
+		inputModeAutoDetect: 0,
+		hidComposite: 0,
+		hidKeyboardRouteMask: 0,
 		hotkey01: {
 			auxMask: 32768,
 			buttonsMask: 66304,
@@ -223,6 +230,28 @@ app.get("/api/getPinMappings", (req, res) => {
 	return res.send(picoController);
 });
 
+app.get("/api/getProfileSettings", (req, res) => {
+	return res.send({
+		profileSettings: [
+			{
+				gamepadOptions: { socdMode: 2 },
+				addonOptions: {},
+				animationOptions: { baseAnimationIndex: 3, brightness: 2 },
+			},
+			{
+				gamepadOptions: { dpadMode: 1, fourWayMode: true },
+				addonOptions: { turboOptions: { shotCount: 20 } },
+				animationOptions: {},
+			},
+			{
+				gamepadOptions: {},
+				addonOptions: {},
+				animationOptions: {},
+			},
+		],
+	});
+});
+
 app.get("/api/getKeyMappings", (req, res) =>
 	res.send(mapValues(DEFAULT_KEYBOARD_MAPPING))
 );
@@ -311,6 +340,14 @@ app.get("/api/getAddonsOptions", (req, res) => {
 		tiltRightAnalogLeftPin: -1,
 		tiltRightAnalogRightPin: -1,
 		tiltSOCDMode: 0,
+		tilt1FactorLeftX: 11469,
+		tilt1FactorLeftY: 14746,
+		tilt2FactorLeftX: 21299,
+		tilt2FactorLeftY: 11469,
+		tilt1FactorRightX: 9830,
+		tilt1FactorRightY: 55706,
+		tilt2FactorRightX: 9830,
+		tilt2FactorRightY: 9830,
 		analogAdc1PinX: -1,
 		analogAdc1PinY: -1,
 		analogAdc1Mode: 1,
@@ -325,6 +362,7 @@ app.get("/api/getAddonsOptions", (req, res) => {
 		bootselButtonMap: 0,
 		buzzerPin: -1,
 		buzzerVolume: 100,
+		buzzerCueMask: 0x7f,
 		extraButtonPin: -1,
 		extraButtonMap: 0,
 		focusModePin: -1,
@@ -419,6 +457,25 @@ app.get("/api/getMemoryReport", (req, res) => {
 		staticAllocs: 200,
 		totalHeap: 2048,
 		usedHeap: 1048,
+		core0StackSize: 4096,
+		core0StackUsed: 1536,
+		core1StackSize: 4096,
+		core1StackUsed: 1024,
+	});
+});
+
+app.get("/api/getCpuLoad", (req, res) => {
+	return res.send({
+		core0Load1s: 412,
+		core0Load10s: 405,
+		core1Load1s: 238,
+		core1Load10s: 251,
+		gamepadMode: { core0Load1s: 87, core0Load10s: 91, core1Load1s: 241, core1Load10s: 247 },
+		tasks: [
+			{ name: 'I2CDisplay', periodUs: 33333, runs: 1799, overruns: 0, lastRunUs: 2105, maxRunUs: 9830 },
+			{ name: 'NeoPicoLED', periodUs: 10000, runs: 6000, overruns: 2, lastRunUs: 412, maxRunUs: 1870 },
+			{ name: 'OnBoardLed', periodUs: 1000, runs: 60000, overruns: 0, lastRunUs: 3, maxRunUs: 11 },
+		],
 	});
 });
 
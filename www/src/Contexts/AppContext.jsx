@@ -124,10 +124,12 @@ export const AppContextProvider = ({ children, ...props }) => {
 	};
 
 	const [usedPins, setUsedPins] = useState([]);
+	const [pinConflicts, setPinConflicts] = useState([]);
 
 	const updateUsedPins = async () => {
 		const data = await WebApi.getUsedPins(setLoading);
 		setUsedPins(data.usedPins);
+		setPinConflicts(data.pinConflicts || []);
 		console.log('usedPins updated:', data.usedPins);
 		return data;
 	};
@@ -173,6 +175,7 @@ export const AppContextProvider = ({ children, ...props }) => {
 				gradientPressedColor2,
 				savedColors,
 				usedPins,
+				pinConflicts,
 				setButtonLabels,
 				setGradientNormalColor1,
 				setGradientNormalColor2,
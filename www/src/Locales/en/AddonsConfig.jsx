@@ -79,9 +79,26 @@ export default {
 	'tilt-right-analog-left-pin-label': 'Tilt Right Analog Left Pin',
 	'tilt-right-analog-right-pin-label': 'Tilt Right Analog Right Pin',
 	'tilt-socd-mode-label': 'Tilt SOCD Mode',
+	'tilt-factor-sub-header-text': 'Stick factors are fixed point, 32768 = 1.0',
+	'tilt-1-factor-left-x-label': 'Tilt 1 Factor Left X',
+	'tilt-1-factor-left-y-label': 'Tilt 1 Factor Left Y',
+	'tilt-2-factor-left-x-label': 'Tilt 2 Factor Left X',
+	'tilt-2-factor-left-y-label': 'Tilt 2 Factor Left Y',
+	'tilt-1-factor-right-x-label': 'Tilt 1 Factor Right X',
+	'tilt-1-factor-right-y-label': 'Tilt 1 Factor Right Y',
+	'tilt-2-factor-right-x-label': 'Tilt 2 Factor Right X',
+	'tilt-2-factor-right-y-label': 'Tilt 2 Factor Right Y',
 	'buzzer-speaker-header-text': 'Buzzer Speaker',
 	'buzzer-speaker-pin-label': 'Buzzer Pin',
 	'buzzer-speaker-volume-label': 'Buzzer Volume',
+	'buzzer-speaker-cues-label': 'Sound Cues',
+	'buzzer-speaker-cue-socd-mode': 'SOCD Mode',
+	'buzzer-speaker-cue-dpad-mode': 'D-Pad Mode',
+	'buzzer-speaker-cue-profile': 'Profile Switch',
+	'buzzer-speaker-cue-input-mode': 'Input Mode',
+	'buzzer-speaker-cue-toggle': 'Invert Axis / 4-Way Toggles',
+	'buzzer-speaker-cue-turbo-rate': 'Turbo Rate',
+	'buzzer-speaker-cue-focus-mode': 'Focus Mode',
 	'extra-button-header-text': 'Extra Button Configuration',
 	'extra-button-pin-label': 'Extra Button Pin',
 	'extra-button-map-label': 'Extra Button',
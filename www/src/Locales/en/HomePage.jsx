@@ -1,8 +1,16 @@
 export default {
+	'cpu-load-core0-text': 'Core 0 (always busy while serving this page)',
+	'cpu-load-core1-text': 'Core 1',
+	'cpu-load-gamepad-core0-text': 'Core 0',
+	'cpu-load-gamepad-header-text': 'CPU Load in Gamepad Mode, before the reboot (% over 1s / 10s)',
+	'cpu-load-header-text': 'CPU Load (% over 1s / 10s)',
+	'cpu-load-task-text': '{{name}}: {{lastRunUs}} µs, peak {{maxRunUs}} µs, {{overruns}} overruns',
 	'current-text': 'Current: {{version}}',
 	'get-update-text': 'Get Latest Version',
 	'header-text': 'Welcome to the GP2040-CE Web Configurator!',
 	'latest-text': 'Latest: {{version}}',
+	'memory-core0-stack-text': 'Core 0 Stack (peak)',
+	'memory-core1-stack-text': 'Core 1 Stack (peak)',
 	'memory-flash-text': 'Flash',
 	'memory-header-text': 'Memory (KB)',
 	'memory-heap-text': 'Heap',
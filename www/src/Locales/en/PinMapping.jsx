@@ -1,6 +1,7 @@
 export default {
 	"header-text": "Pin Mapping",
 	"sub-header-text": "Use the form below to reconfigure your button-to-pin mapping.",
+	"pin-conflict-text": "GPIO {{pin}} is used by {{owner}}, {{conflictOwner}} can't use it as well.",
 	"alert-text": "Mapping buttons to pins that aren't connected or available can leave the device in non-functional state. To clear the the invalid configuration go to the <1>Reset Settings</1> page.",
 	"pin-header-label": "Pin",
 	"errors": {
@@ -6,4 +6,7 @@ export default {
 	"profile-3": "Profile 3",
 	"profile-4": "Profile 4",
 	"profile-pins-warning": "Try to avoid changing the buttons/directions used for your switch profile hotkeys, or else it will get hard to understand what profile you are selecting!",
+	"profile-settings-header-text": "Profile Settings",
+	"profile-settings-desc": "Profiles 2 through 4 can also override gamepad, add-on, animation and hotkey settings. Only the listed fields are overridden, everything else follows the core configuration. Field names match the configuration backup, e.g. { \"gamepadOptions\": { \"socdMode\": 2 } }. The input mode, turbo speed and tilt factors follow profile changes. Add-on pins, enabling or disabling an add-on and the remaining add-on settings are only read at boot and apply to the profile selected when the controller starts. Add-on and hotkey overrides are limited to 256 and 128 bytes, changes made with hotkeys while a profile is active are not saved once its overrides are full.",
+	"profile-settings-invalid": "Not a valid JSON object",
 }
@@ -2,6 +2,17 @@ export default {
 	'settings-header-text': 'Settings',
 	'input-mode-label': 'Input Mode',
 	'input-mode-extra-label': 'Switch Touchpad and Share',
+	'hid-custom-layout-label': 'Custom HID Layout',
+	'input-mode-auto-detect-label': 'Detect Input Mode',
+	'hid-composite-label': 'Keyboard Interfaces',
+	'hid-keyboard-route-label': 'Buttons sent as keys (see Keyboard Mapping)',
+	'hid-button-count-label': 'Buttons',
+	'hid-axis-count-label': 'Axes',
+	'hid-axis-resolution-label': 'Axis Resolution',
+	'hid-axis-resolution-options': {
+		'8-bit': '8-bit',
+		'16-bit': '16-bit'
+	},
 	'input-mode-options': {
 		'xinput': "XInput",
 		'nintendo-switch': "Nintendo Switch",
@@ -47,6 +58,7 @@ export default {
 		'l3-button': 'L3 Button',
 		'r3-button': 'R3 Button',
 		'touchpad-button': 'Touchpad Button',
+		'next-input-mode': 'Next Input Mode',
 		'load-profile-1': 'Load Profile #1',
 		'load-profile-2': 'Load Profile #2',
 		'load-profile-3': 'Load Profile #3',
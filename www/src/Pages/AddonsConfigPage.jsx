@@ -107,6 +107,16 @@ const REVERSE_ACTION = [
 	{ label: 'Neutral', value: 2 },
 ];
 
+const BUZZER_CUES = [
+	{ label: 'buzzer-speaker-cue-socd-mode',  value: (1 << 0) },
+	{ label: 'buzzer-speaker-cue-dpad-mode',  value: (1 << 1) },
+	{ label: 'buzzer-speaker-cue-profile',    value: (1 << 2) },
+	{ label: 'buzzer-speaker-cue-input-mode', value: (1 << 3) },
+	{ label: 'buzzer-speaker-cue-toggle',     value: (1 << 4) },
+	{ label: 'buzzer-speaker-cue-turbo-rate', value: (1 << 5) },
+	{ label: 'buzzer-speaker-cue-focus-mode', value: (1 << 6) },
+];
+
 const verifyAndSavePS4 = async () => {
 	let PS4Key = document.getElementById("ps4key-input");
 	let PS4Serial = document.getElementById("ps4serial-input");
@@ -268,6 +278,7 @@ const schema = yup.object().shape({
 	BuzzerSpeakerAddonEnabled:   yup.number().required().label('Buzzer Speaker Add-On Enabled'),
 	buzzerPin:                   yup.number().label('Buzzer Pin').validatePinWhenValue('BuzzerSpeakerAddonEnabled'),
 	buzzerVolume:                yup.number().label('Buzzer Volume').validateRangeWhenValue('BuzzerSpeakerAddonEnabled', 0, 100),
+	buzzerCueMask:               yup.number().label('Buzzer Sound Cues').validateRangeWhenValue('BuzzerSpeakerAddonEnabled', 0, (1 << 7) - 1),
 
 	DualDirectionalInputEnabled: yup.number().required().label('Dual Directional Input Enabled'),
 	dualDirUpPin:                yup.number().label('Dual Directional Up Pin').validatePinWhenValue('DualDirectionalInputEnabled')  ,
@@ -290,6 +301,14 @@ const schema = yup.object().shape({
 	tiltRightAnalogLeftPin:      yup.number().label('Tilt Right Analog Left Pin').validatePinWhenValue('TiltInputEnabled'),
 	tiltRightAnalogRightPin:     yup.number().label('Tilt Right Analog Right Pin').validatePinWhenValue('TiltInputEnabled'),
 	tiltSOCDMode:                yup.number().label('Tilt SOCE Mode').validateSelectionWhenValue('TiltInputEnabled', SOCD_MODES),
+	tilt1FactorLeftX:            yup.number().label('Tilt 1 Factor Left X').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt1FactorLeftY:            yup.number().label('Tilt 1 Factor Left Y').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt2FactorLeftX:            yup.number().label('Tilt 2 Factor Left X').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt2FactorLeftY:            yup.number().label('Tilt 2 Factor Left Y').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt1FactorRightX:           yup.number().label('Tilt 1 Factor Right X').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt1FactorRightY:           yup.number().label('Tilt 1 Factor Right Y').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt2FactorRightX:           yup.number().label('Tilt 2 Factor Right X').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
+	tilt2FactorRightY:           yup.number().label('Tilt 2 Factor Right Y').validateRangeWhenValue('TiltInputEnabled', 0, 65535),
 
 	ExtraButtonAddonEnabled:     yup.number().required().label('Extra Button Add-On Enabled'),
 	extraButtonPin:              yup.number().label('Extra Button Pin').validatePinWhenValue('ExtraButtonAddonEnabled'),
@@ -379,6 +398,14 @@ const defaultValues = {
 	tiltRightAnalogDownPin: -1,
 	tiltRightAnalogLeftPin: -1,
 	tiltRightAnalogRightPin: -1,
+	tilt1FactorLeftX: 11469,
+	tilt1FactorLeftY: 14746,
+	tilt2FactorLeftX: 21299,
+	tilt2FactorLeftY: 11469,
+	tilt1FactorRightX: 9830,
+	tilt1FactorRightY: 55706,
+	tilt2FactorRightX: 9830,
+	tilt2FactorRightY: 9830,
 	analogAdc1PinX : -1,
  	analogAdc1PinY : -1,
 	analogAdc1Mode: 1,
@@ -393,6 +420,7 @@ const defaultValues = {
 	bootselButtonMap: 0,
 	buzzerPin: -1,
 	buzzerVolume: 100,
+	buzzerCueMask: 0x7F,
 	extrabuttonPin: -1,
 	extraButtonMap: 0,
 	playerNumber: 1,
@@ -1468,6 +1496,107 @@ export default function AddonsConfigPage() {
 									{TILT_SOCD_MODES.map((o, i) => <option key={`button-tiltSOCDMode-option-${i}`} value={o.value}>{o.label}</option>)}
 								</FormSelect>
 							</Row>
+							<p>{t('AddonsConfig:tilt-factor-sub-header-text')}</p>
+							<Row className="mb-3">
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-1-factor-left-x-label')}
+									name="tilt1FactorLeftX"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt1FactorLeftX}
+									error={errors.tilt1FactorLeftX}
+									isInvalid={errors.tilt1FactorLeftX}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-1-factor-left-y-label')}
+									name="tilt1FactorLeftY"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt1FactorLeftY}
+									error={errors.tilt1FactorLeftY}
+									isInvalid={errors.tilt1FactorLeftY}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-2-factor-left-x-label')}
+									name="tilt2FactorLeftX"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt2FactorLeftX}
+									error={errors.tilt2FactorLeftX}
+									isInvalid={errors.tilt2FactorLeftX}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-2-factor-left-y-label')}
+									name="tilt2FactorLeftY"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt2FactorLeftY}
+									error={errors.tilt2FactorLeftY}
+									isInvalid={errors.tilt2FactorLeftY}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+							</Row>
+							<Row className="mb-3">
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-1-factor-right-x-label')}
+									name="tilt1FactorRightX"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt1FactorRightX}
+									error={errors.tilt1FactorRightX}
+									isInvalid={errors.tilt1FactorRightX}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-1-factor-right-y-label')}
+									name="tilt1FactorRightY"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt1FactorRightY}
+									error={errors.tilt1FactorRightY}
+									isInvalid={errors.tilt1FactorRightY}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-2-factor-right-x-label')}
+									name="tilt2FactorRightX"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt2FactorRightX}
+									error={errors.tilt2FactorRightX}
+									isInvalid={errors.tilt2FactorRightX}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+								<FormControl type="number"
+									label={t('AddonsConfig:tilt-2-factor-right-y-label')}
+									name="tilt2FactorRightY"
+									className="form-control-sm"
+									groupClassName="col-sm-3 mb-3"
+									value={values.tilt2FactorRightY}
+									error={errors.tilt2FactorRightY}
+									isInvalid={errors.tilt2FactorRightY}
+									onChange={handleChange}
+									min={0}
+									max={65535}
+								/>
+							</Row>
 						</div>
 						<FormCheck
 							label={t('Common:switch-enabled')}
@@ -1510,6 +1639,20 @@ export default function AddonsConfigPage() {
 									max={100}
 								/>
 							</Row>
+							<Row className="mb-3">
+								<Form.Label>{t('AddonsConfig:buzzer-speaker-cues-label')}</Form.Label>
+								<div className="col-sm-12">
+									{BUZZER_CUES.map(cue => <Form.Check
+										key={`buzzerCueMask-${cue.value}`}
+										label={t(`AddonsConfig:${cue.label}`)}
+										type="checkbox"
+										id={`buzzerCueMask-${cue.value}`}
+										inline
+										checked={Boolean(values.buzzerCueMask & cue.value)}
+										onChange={() => setFieldValue('buzzerCueMask', values.buzzerCueMask ^ cue.value)}
+									/>)}
+								</div>
+							</Row>
 						</div>
 						<FormCheck
 							label={t('Common:switch-enabled')}
@@ -10,6 +10,7 @@ import WebApi from '../Services/WebApi';
 
 const percentage = (x, y) => (x / y * 100).toFixed(2)
 const toKB = (x) => parseFloat((x / 1024).toFixed(2))
+const toPercent = (x) => (x / 10).toFixed(1)
 let loading = true;
 
 export default function HomePage() {
@@ -17,6 +18,7 @@ export default function HomePage() {
 	const [latestTag, setLatestTag] = useState('');
 	const [currentVersion, setCurrentVersion] = useState(import.meta.env.VITE_CURRENT_VERSION);
 	const [memoryReport, setMemoryReport] = useState(null);
+	const [cpuLoad, setCpuLoad] = useState(null);
 
 	const { t } = useTranslation('');
 
@@ -30,15 +32,39 @@ export default function HomePage() {
 
 		WebApi.getMemoryReport(setLoading).then(response => {
 			const unit = 1024;
-			const { totalFlash, usedFlash, staticAllocs, totalHeap, usedHeap } = response;
+			const { totalFlash, usedFlash, staticAllocs, totalHeap, usedHeap, core0StackSize, core0StackUsed, core1StackSize, core1StackUsed } = response;
 			setMemoryReport({
 				totalFlash: toKB(totalFlash),
 				usedFlash: toKB(usedFlash),
 				staticAllocs: toKB(staticAllocs),
 				totalHeap: toKB(totalHeap),
 				usedHeap: toKB(usedHeap),
+				core0StackSize: toKB(core0StackSize),
+				core0StackUsed: toKB(core0StackUsed),
+				core1StackSize: toKB(core1StackSize),
+				core1StackUsed: toKB(core1StackUsed),
 				percentageFlash: percentage(usedFlash, totalFlash),
-				percentageHeap: percentage(usedHeap, totalHeap)
+				percentageHeap: percentage(usedHeap, totalHeap),
+				percentageCore0Stack: percentage(core0StackUsed, core0StackSize),
+				percentageCore1Stack: percentage(core1StackUsed, core1StackSize)
+			});
+		})
+			.catch(console.error);
+
+		WebApi.getCpuLoad(setLoading).then(response => {
+			const { core0Load1s, core0Load10s, core1Load1s, core1Load10s, gamepadMode, tasks } = response;
+			setCpuLoad({
+				core0Load1s: toPercent(core0Load1s),
+				core0Load10s: toPercent(core0Load10s),
+				core1Load1s: toPercent(core1Load1s),
+				core1Load10s: toPercent(core1Load10s),
+				gamepadMode: gamepadMode && {
+					core0Load1s: toPercent(gamepadMode.core0Load1s),
+					core0Load10s: toPercent(gamepadMode.core0Load10s),
+					core1Load1s: toPercent(gamepadMode.core1Load1s),
+					core1Load10s: toPercent(gamepadMode.core1Load10s),
+				},
+				tasks: tasks || []
 			});
 		})
 			.catch(console.error);
@@ -80,6 +106,25 @@ export default function HomePage() {
 							<div>{t('HomePage:memory-flash-text')}: {memoryReport.usedFlash} / {memoryReport.totalFlash} ({memoryReport.percentageFlash}%)</div>
 							<div>{t('HomePage:memory-heap-text')}: {memoryReport.usedHeap} / {memoryReport.totalHeap} ({memoryReport.percentageHeap}%)</div>
 							<div>{t('HomePage:memory-static-allocations-text')}: {memoryReport.staticAllocs}</div>
+							<div>{t('HomePage:memory-core0-stack-text')}: {memoryReport.core0StackUsed} / {memoryReport.core0StackSize} ({memoryReport.percentageCore0Stack}%)</div>
+							<div>{t('HomePage:memory-core1-stack-text')}: {memoryReport.core1StackUsed} / {memoryReport.core1StackSize} ({memoryReport.percentageCore1Stack}%)</div>
+						</div>
+					}
+					{cpuLoad &&
+						<div>
+							<strong>{t('HomePage:cpu-load-header-text')}</strong>
+							<div>{t('HomePage:cpu-load-core0-text')}: {cpuLoad.core0Load1s} / {cpuLoad.core0Load10s}</div>
+							<div>{t('HomePage:cpu-load-core1-text')}: {cpuLoad.core1Load1s} / {cpuLoad.core1Load10s}</div>
+							{cpuLoad.tasks.map((task) =>
+								<div key={task.name}>{t('HomePage:cpu-load-task-text', task)}</div>
+							)}
+							{cpuLoad.gamepadMode &&
+								<div>
+									<strong>{t('HomePage:cpu-load-gamepad-header-text')}</strong>
+									<div>{t('HomePage:cpu-load-gamepad-core0-text')}: {cpuLoad.gamepadMode.core0Load1s} / {cpuLoad.gamepadMode.core0Load10s}</div>
+									<div>{t('HomePage:cpu-load-core1-text')}: {cpuLoad.gamepadMode.core1Load1s} / {cpuLoad.gamepadMode.core1Load10s}</div>
+								</div>
+							}
 						</div>
 					}
 				</div>
@@ -18,7 +18,7 @@ const errorType = {
 };
 
 export default function PinMappingPage() {
-	const { buttonLabels, setButtonLabels, usedPins, updateUsedPins } = useContext(AppContext);
+	const { buttonLabels, setButtonLabels, usedPins, pinConflicts, updateUsedPins } = useContext(AppContext);
 	const [validated, setValidated] = useState(false);
 	const [saveMessage, setSaveMessage] = useState('');
 	const [buttonMappings, setButtonMappings] = useState(baseButtonMappings);
@@ -155,6 +155,15 @@ export default function PinMappingPage() {
 						the invalid configuration go to the <NavLink exact="true" to="/reset-settings">Reset Settings</NavLink> page.
 					</Trans>
 				</div>
+				{pinConflicts.length > 0 &&
+					<div className="alert alert-danger">
+						{pinConflicts.map((c) =>
+							<div key={`pin-conflict-${c.pin}`}>
+								{t('PinMapping:pin-conflict-text', { pin: c.pin, owner: c.owner, conflictOwner: c.conflictOwner })}
+							</div>
+						)}
+					</div>
+				}
 				<table className="table table-sm pin-mapping-table">
 					<thead className="table">
 						<tr>
@@ -10,6 +10,13 @@ import './PinMappings.scss';
 import { Trans, useTranslation } from 'react-i18next';
 
 const requiredButtons = ['S2'];
+const SETTINGS_PROFILES = [0, 1, 2];
+const emptyProfileSettings = () => SETTINGS_PROFILES.map(() => JSON.stringify({
+	gamepadOptions: {},
+	addonOptions: {},
+	animationOptions: {},
+	hotkeyOptions: {},
+}, null, 2));
 const errorType = {
 	required: 'errors.required',
 	conflict: 'errors.conflict',
@@ -23,6 +30,9 @@ export default function ProfileOptionsPage() {
 	const [saveMessage, setSaveMessage] = useState('');
 	const [buttonMappings, setButtonMappings] = useState(baseButtonMappings);
 	const [profileOptions, setProfileOptions] = useState(baseProfileOptions);
+	const [profileSettings, setProfileSettings] = useState(emptyProfileSettings());
+	const [settingsErrors, setSettingsErrors] = useState([]);
+	const [settingsSaveMessage, setSettingsSaveMessage] = useState('');
 	const [selectedBoard] = useState(import.meta.env.VITE_GP2040_BOARD);
 	const { buttonLabelType } = buttonLabels;
 	const { setLoading } = useContext(AppContext);
@@ -35,6 +45,12 @@ export default function ProfileOptionsPage() {
 		async function fetchData() {
 			setButtonMappings(await WebApi.getPinMappings(setLoading));
 			setProfileOptions(await WebApi.getProfileOptions(setLoading));
+			const settings = await WebApi.getProfileSettings(setLoading);
+			if (settings) {
+				const loadedSettings = emptyProfileSettings();
+				settings.forEach((profile, index) => loadedSettings[index] = JSON.stringify(profile, null, 2));
+				setProfileSettings(loadedSettings);
+			}
 			setButtonLabels({});
 		}
 
@@ -69,6 +85,39 @@ export default function ProfileOptionsPage() {
 		setSaveMessage(success ? t('Common:saved-success-message') : t('Common:saved-error-message'));
 	};
 
+	const handleSettingsChange = (e, index) => {
+		const newProfileSettings = [...profileSettings];
+		newProfileSettings[index] = e.target.value;
+		setProfileSettings(newProfileSettings);
+	};
+
+	const handleSettingsSubmit = async (e) => {
+		e.preventDefault();
+		e.stopPropagation();
+
+		const errors = [];
+		const settings = profileSettings.map((text, index) => {
+			try {
+				const parsed = JSON.parse(text);
+				if (typeof parsed !== 'object' || parsed === null || Array.isArray(parsed))
+					throw new Error();
+				return parsed;
+			} catch (error) {
+				errors[index] = t('ProfileSettings:profile-settings-invalid');
+				return {};
+			}
+		});
+
+		setSettingsErrors(errors);
+		if (errors.length > 0) {
+			setSettingsSaveMessage(t('Common:errors.validation-error'));
+			return;
+		}
+
+		const success = await WebApi.setProfileSettings(settings);
+		setSettingsSaveMessage(success ? t('Common:saved-success-message') : t('Common:saved-error-message'));
+	};
+
 	const validateMappings = (mappings) => {
 		profileOptions['alternativePinMappings'].forEach((altMappings) => {
 			const buttons = Object.keys(altMappings);
@@ -161,6 +210,7 @@ export default function ProfileOptionsPage() {
 	};
 
 	return (
+		<>
 		<Section title={t('ProfileSettings:header-text')}>
 			<p>{t('ProfileSettings:profile-pins-desc')}</p>
 			<pre>&nbsp;&nbsp;{String(buttonMappings['Up'].pin).padStart(2)}<br />
@@ -195,5 +245,27 @@ export default function ProfileOptionsPage() {
 				{saveMessage ? <span className="alert">{saveMessage}</span> : null}
 			</Form>
 		</Section>
+		<Section title={t('ProfileSettings:profile-settings-header-text')}>
+			<p>{t('ProfileSettings:profile-settings-desc')}</p>
+			<Form noValidate onSubmit={handleSettingsSubmit}>
+				{SETTINGS_PROFILES.map((index) => (
+					<Form.Group key={index} className="mb-3">
+						<Form.Label>{t(`ProfileSettings:profile-${index + 2}`)}</Form.Label>
+						<Form.Control
+							as="textarea"
+							rows={8}
+							className="font-monospace form-control-sm"
+							value={profileSettings[index]}
+							isInvalid={!!settingsErrors[index]}
+							onChange={(e) => handleSettingsChange(e, index)}
+						/>
+						<Form.Control.Feedback type="invalid">{settingsErrors[index]}</Form.Control.Feedback>
+					</Form.Group>
+				))}
+				<Button type="submit">{t('Common:button-save-label')}</Button>
+				{settingsSaveMessage ? <span className="alert">{settingsSaveMessage}</span> : null}
+			</Form>
+		</Section>
+		</>
 	);
 }
@@ -10,11 +10,12 @@ import Section from '../Components/Section';
 import WebApi from '../Services/WebApi';
 import { BUTTONS, BUTTON_MASKS } from '../Data/Buttons';
 
+const HIDMode = 2;
 const PS4Mode = 4;
 const INPUT_MODES = [
 	{ labelKey: 'input-mode-options.xinput', value: 0 },
 	{ labelKey: 'input-mode-options.nintendo-switch', value: 1 },
-	{ labelKey: 'input-mode-options.ps3', value: 2 },
+	{ labelKey: 'input-mode-options.ps3', value: HIDMode },
 	{ labelKey: 'input-mode-options.keyboard', value: 3 },
 	{ labelKey: 'input-mode-options.ps4', value: PS4Mode }
 ];
@@ -56,6 +57,7 @@ const HOTKEY_ACTIONS = [
   { labelKey: 'hotkey-actions.l3-button', value: 19 },
 	{ labelKey: 'hotkey-actions.r3-button', value: 20 },
 	{ labelKey: 'hotkey-actions.touchpad-button', value: 21 },
+	{ labelKey: 'hotkey-actions.next-input-mode', value: 22 },
 ];
 
 const FORCED_SETUP_MODES = [
@@ -88,6 +90,13 @@ const schema = yup.object().shape({
 	lockHotkeys: yup.number().required().label('Lock Hotkeys'),
 	fourWayMode: yup.number().required().label('4-Way Joystick Mode'),
 	profileNumber: yup.number().required().label('Profile Number'),
+	hidCustomLayout: yup.number().required().label('Custom HID Layout'),
+	hidButtonCount: yup.number().required().min(0).max(30).label('HID Button Count'),
+	hidAxisCount: yup.number().required().min(0).max(6).label('HID Axis Count'),
+	hidAxisResolution: yup.number().required().oneOf([8, 16]).label('HID Axis Resolution'),
+	inputModeAutoDetect: yup.number().required().label('Detect Input Mode'),
+	hidComposite: yup.number().required().label('Keyboard Interfaces'),
+	hidKeyboardRouteMask: yup.number().required().label('Keyboard Buttons'),
 });
 
 const FormContext = ({ setButtonLabels }) => {
@@ -120,6 +129,20 @@ const FormContext = ({ setButtonLabels }) => {
 			values.fourWayMode = parseInt(values.fourWayMode);
 		if (!!values.profileNumber)
 			values.profileNumber = parseInt(values.profileNumber);
+		if (!!values.hidCustomLayout)
+			values.hidCustomLayout = parseInt(values.hidCustomLayout);
+		if (!!values.hidButtonCount)
+			values.hidButtonCount = parseInt(values.hidButtonCount);
+		if (!!values.hidAxisCount)
+			values.hidAxisCount = parseInt(values.hidAxisCount);
+		if (!!values.hidAxisResolution)
+			values.hidAxisResolution = parseInt(values.hidAxisResolution);
+		if (!!values.inputModeAutoDetect)
+			values.inputModeAutoDetect = parseInt(values.inputModeAutoDetect);
+		if (!!values.hidComposite)
+			values.hidComposite = parseInt(values.hidComposite);
+		if (!!values.hidKeyboardRouteMask)
+			values.hidKeyboardRouteMask = parseInt(values.hidKeyboardRouteMask);
 
 		setButtonLabels({ swapTpShareLabels: (values.switchTpShareForDs4 === 1) && (values.inputMode === 4) });
 
@@ -214,8 +237,86 @@ export default function SettingsPage() {
 									checked={Boolean(values.switchTpShareForDs4)}
 									onChange={(e) => { setFieldValue("switchTpShareForDs4", e.target.checked ? 1 : 0); }}
 								/>}
+								{values.inputMode === HIDMode && <Form.Check
+									label={t('SettingsPage:hid-custom-layout-label')}
+									type="switch"
+									name="hidCustomLayout"
+									isInvalid={false}
+									checked={Boolean(values.hidCustomLayout)}
+									onChange={(e) => { setFieldValue("hidCustomLayout", e.target.checked ? 1 : 0); }}
+								/>}
+								{values.inputMode === HIDMode && <Form.Check
+									label={t('SettingsPage:hid-composite-label')}
+									type="switch"
+									name="hidComposite"
+									isInvalid={false}
+									checked={Boolean(values.hidComposite)}
+									onChange={(e) => { setFieldValue("hidComposite", e.target.checked ? 1 : 0); }}
+								/>}
+							</div>
+							<div className="col-sm-3">
+								<Form.Check
+									label={t('SettingsPage:input-mode-auto-detect-label')}
+									type="switch"
+									name="inputModeAutoDetect"
+									isInvalid={false}
+									checked={Boolean(values.inputModeAutoDetect)}
+									onChange={(e) => { setFieldValue("inputModeAutoDetect", e.target.checked ? 1 : 0); }}
+								/>
 							</div>
 						</Form.Group>
+						{values.inputMode === HIDMode && Boolean(values.hidCustomLayout) && <Form.Group className="row mb-3">
+							<div className="col-sm-3">
+								<Form.Label>{t('SettingsPage:hid-button-count-label')}</Form.Label>
+								<Form.Control
+									type="number"
+									className="form-control-sm"
+									value={values.hidButtonCount}
+									min={0}
+									max={30}
+									isInvalid={errors.hidButtonCount}
+									onChange={(e) => { setFieldValue("hidButtonCount", parseInt(e.target.value)); }}
+								></Form.Control>
+								<Form.Control.Feedback type="invalid">{errors.hidButtonCount}</Form.Control.Feedback>
+							</div>
+							<div className="col-sm-3">
+								<Form.Label>{t('SettingsPage:hid-axis-count-label')}</Form.Label>
+								<Form.Control
+									type="number"
+									className="form-control-sm"
+									value={values.hidAxisCount}
+									min={0}
+									max={6}
+									isInvalid={errors.hidAxisCount}
+									onChange={(e) => { setFieldValue("hidAxisCount", parseInt(e.target.value)); }}
+								></Form.Control>
+								<Form.Control.Feedback type="invalid">{errors.hidAxisCount}</Form.Control.Feedback>
+							</div>
+							<div className="col-sm-3">
+								<Form.Label>{t('SettingsPage:hid-axis-resolution-label')}</Form.Label>
+								<Form.Select name="hidAxisResolution" className="form-select-sm" value={values.hidAxisResolution} onChange={handleChange} isInvalid={errors.hidAxisResolution}>
+									<option value={8}>{t('SettingsPage:hid-axis-resolution-options.8-bit')}</option>
+									<option value={16}>{t('SettingsPage:hid-axis-resolution-options.16-bit')}</option>
+								</Form.Select>
+								<Form.Control.Feedback type="invalid">{errors.hidAxisResolution}</Form.Control.Feedback>
+							</div>
+						</Form.Group>}
+						{values.inputMode === HIDMode && Boolean(values.hidComposite) && <Form.Group className="row mb-3">
+							<Form.Label>{t('SettingsPage:hid-keyboard-route-label')}</Form.Label>
+							<div className="col-sm-auto">
+								{BUTTON_MASKS.filter(mask => mask.value !== 0).map((mask, i) =>
+									<Form.Check
+										key={`hid-keyboard-route-${i}`}
+										inline
+										label={mask.label}
+										type="checkbox"
+										id={`hidKeyboardRoute${mask.label}`}
+										checked={Boolean(values.hidKeyboardRouteMask & mask.value)}
+										onChange={(e) => { setFieldValue("hidKeyboardRouteMask", e.target.checked ? values.hidKeyboardRouteMask | mask.value : values.hidKeyboardRouteMask & ~mask.value); }}
+									/>
+								)}
+							</div>
+						</Form.Group>}
 						<Form.Group className="row mb-3">
 							<Form.Label>{t('SettingsPage:d-pad-mode-label')}</Form.Label>
 							<div className="col-sm-3">
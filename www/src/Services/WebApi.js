@@ -318,6 +318,31 @@ async function setProfileOptions(options) {
 		});
 }
 
+async function getProfileSettings(setLoading) {
+	setLoading(true);
+
+	try {
+		const response = await axios.get(`${baseUrl}/api/getProfileSettings`);
+		setLoading(false);
+		return response.data['profileSettings'];
+	} catch (error) {
+		console.error(error);
+		return false;
+	}
+}
+
+async function setProfileSettings(profileSettings) {
+	return axios.post(`${baseUrl}/api/setProfileSettings`, { profileSettings })
+		.then((response) => {
+			console.log(response.data);
+			return true;
+		})
+		.catch((err) => {
+			console.error(err);
+			return false;
+		});
+}
+
 async function getKeyMappings(setLoading) {
 	setLoading(true);
 
@@ -426,6 +451,19 @@ async function getMemoryReport(setLoading) {
 	}
 }
 
+async function getCpuLoad(setLoading) {
+	setLoading(true);
+
+	try {
+		const response = await axios.get(`${baseUrl}/api/getCpuLoad`)
+		setLoading(false);
+		return response.data;
+	} catch (error) {
+		setLoading(false);
+		console.error(error);
+	}
+}
+
 
 async function getUsedPins(setLoading) {
 	setLoading(true);
@@ -470,6 +508,8 @@ const WebApi = {
 	setPinMappings,
 	getProfileOptions,
 	setProfileOptions,
+	getProfileSettings,
+	setProfileSettings,
 	getKeyMappings,
 	setKeyMappings,
 	getAddonsOptions,
@@ -479,6 +519,7 @@ const WebApi = {
 	setSplashImage,
 	getFirmwareVersion,
 	getMemoryReport,
+	getCpuLoad,
 	getUsedPins,
 	reboot
 };